@@ -0,0 +1,215 @@
+#include "host_kernel.h"
+
+#include <kernel.h>
+#include <io.h>
+#include "../kernel/drivers/timer.h"
+#include "../user/sys.h"
+#include "../user/buffer.h"
+#include "../user/conductor.h"
+#include "../user/displaysrv.h"
+#include "../user/telemetrysrv.h"
+#include "../user/trainsrv/track_control.h"
+
+bool host_verbose = false;
+
+static int ticks = 0;
+
+static void die(const char *msg) {
+	kputs(msg);
+	kputs(EOL);
+	halt();
+}
+
+void host_set_time(int t) {
+	ticks = t;
+}
+
+// kernel
+
+int boot(void (*init_task)(void), int init_task_priority, int debug) {
+	init_task();
+	return 0;
+}
+
+int try_create(int priority, void *code) {
+	return CREATE_INSUFFICIENT_RESOURCES;
+}
+
+void pass(void) {}
+
+void exitk(void) {
+	host_exit(0);
+}
+
+int tid(void) {
+	return 1;
+}
+
+int parent_tid(void) {
+	return 0;
+}
+
+int try_send(int tid, const void *msg, int msglen, void *reply, int replylen) {
+	return SEND_INVALID_TID;
+}
+
+int try_receive(int *tid, void *msg, int msglen) {
+	die("receive would block forever with only one task");
+	return -1;
+}
+
+int try_reply(int tid, const void *reply, int replylen) {
+	return REPLY_INVALID_TID;
+}
+
+int try_await(unsigned eid, char *buf, unsigned buflen) {
+	return AWAIT_UNKNOWN_EVENT;
+}
+
+// xorshift, so that runs are repeatable
+unsigned rand(void) {
+	static unsigned state = 0x2545f491;
+	state ^= state << 13;
+	state ^= state >> 17;
+	state ^= state << 5;
+	return state;
+}
+
+int should_idle(void) {
+	return 0;
+}
+
+int idle_permille(void) {
+	return 0;
+}
+
+void halt(void) {
+	host_exit(1);
+}
+
+void task_status(int tid, struct task_info *info) {
+	info->state = DEAD;
+}
+
+unsigned debug_timer_useconds(void) {
+	return host_nanotime() / 1000;
+}
+
+// io
+
+void fput_buf(const char *buf, int buflen, const int channel) {
+	switch (channel) {
+	case COM2: host_write(1, buf, buflen); break;
+	case COM2_DEBUG: host_write(2, buf, buflen); break;
+	default: break; // there's no train set to talk to
+	}
+}
+
+void fputs(const char *str, const int channel) {
+	fput_buf(str, strlen(str), channel);
+}
+
+void fputc(const char c, const int channel) {
+	fput_buf(&c, 1, channel);
+}
+
+void fgets(char *buf, int len, const int channel) {
+	die("no input on the host");
+}
+
+int fgetsnb(char *buf, int len, const int channel) {
+	return 0;
+}
+
+int fgetc(const int channel) {
+	die("no input on the host");
+	return -1;
+}
+
+// util functions which are written in assembly for the ARM
+
+void* (memcpy)(void *dst, const void *src, size_t len) {
+	char *d = dst;
+	const char *s = src;
+	while (len--) *d++ = *s++;
+	return dst;
+}
+
+unsigned sqrti(unsigned n) {
+	unsigned root = 0;
+	unsigned bit = 1u << 30;
+	while (bit > n) bit >>= 2;
+	while (bit != 0) {
+		if (n >= root + bit) {
+			n -= root + bit;
+			root = (root >> 1) + bit;
+		} else {
+			root >>= 1;
+		}
+		bit >>= 2;
+	}
+	return root;
+}
+
+void exited_main(void) {}
+
+// servers
+
+void start_servers(void) {}
+void stop_servers(void) {}
+
+int time(void) {
+	return ticks;
+}
+
+int delay(int t) {
+	ticks += t;
+	return ticks;
+}
+
+int delay_until(int t) {
+	if (t > ticks) ticks = t;
+	return ticks;
+}
+
+void delay_async(int t, void *msg, unsigned msglen, int msg_tick_offset) {
+	// nobody's listening
+}
+
+int try_whois(const char *name) {
+	return -1;
+}
+
+void register_as(const char *name) {}
+
+// Clients of the servers which don't run on the host. Anything sent to them is
+// dropped.
+
+void send_async(int tid, void *msg, unsigned msglen) {}
+
+void pubsub_publish(enum pubsub_topic topic, const void *msg, unsigned len) {}
+
+int conductor(int train_id) {
+	return -1;
+}
+
+struct switch_state tc_init_switches(void) {
+	struct switch_state switches = {};
+	return switches;
+}
+
+void telemetry_sensor_attribution(int sensor, int train, int time) {}
+
+void displaysrv_update_sensor_attribution(int displaysrv, int sensor, int train) {}
+void displaysrv_update_reliability(int displaysrv, const struct reliability_report *report) {}
+
+void displaysrv_log(const char *fmt, ...) {
+	if (!host_verbose) return;
+	char buf[256];
+	va_list va;
+	va_start(va, fmt);
+	vsnprintf(buf, sizeof(buf), fmt, va);
+	va_end(va);
+	kputs(buf);
+	kputs(EOL);
+}
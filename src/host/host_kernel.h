@@ -0,0 +1,16 @@
+#pragma once
+
+#include <util.h>
+#include "host_os.h"
+
+// Stub kernel for running the pure parts of the program on the host.
+//
+// There's only ever one task, so anything which would need another task to
+// answer it (creating tasks, sending to servers, waiting for events) fails,
+// or halts if it can't fail. The clock only moves when something delays, or
+// when it's set with host_set_time.
+
+// log lines are dropped unless this is set
+extern bool host_verbose;
+
+void host_set_time(int ticks);
@@ -0,0 +1,25 @@
+#define _POSIX_C_SOURCE 199309L
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "host_os.h"
+
+void host_write(int fd, const char *buf, int len) {
+	while (len > 0) {
+		ssize_t n = write(fd, buf, len);
+		if (n <= 0) return;
+		buf += n;
+		len -= n;
+	}
+}
+
+void host_exit(int status) {
+	exit(status);
+}
+
+long long host_nanotime(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
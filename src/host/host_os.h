@@ -0,0 +1,11 @@
+#pragma once
+
+// What the stub kernel needs from the host OS. host_os.c is the only file in
+// the host build which includes the C library's headers, since they clash with
+// our own.
+
+void host_write(int fd, const char *buf, int len);
+void host_exit(int status) __attribute__((noreturn));
+
+// monotonic, in nanoseconds
+long long host_nanotime(void);
@@ -0,0 +1,233 @@
+#include "host_kernel.h"
+
+#include <io.h>
+#include <astar.h>
+#include <hashtable.h>
+#include "../user/track.h"
+#include "../user/polymath.h"
+#include "../user/trainsrv/kalman.h"
+#include "../user/trainsrv/position.h"
+#include "../user/trainsrv/estimate_position.h"
+#include "../user/trainsrv/sensor_attribution.h"
+
+// Microbenchmarks of hot code, run natively so that they can be profiled with
+// perf, and compared across commits.
+//
+// Usage: microbench [name...]
+//
+// Each benchmark is run for at least MIN_RUN_NS, RUNS times over, and the
+// fastest time per iteration is reported, since the slower runs are just
+// picking up noise from the rest of the machine.
+
+#define MIN_RUN_NS 50000000LL
+#define RUNS 5
+
+struct microbench {
+	const char *name;
+	// called once, before the benchmark is timed
+	void (*setup)(void);
+	// runs n iterations
+	void (*run)(int n);
+};
+
+// keeps the compiler from optimizing away the work
+static volatile int sink;
+
+static bool blocked[TRACK_MAX];
+
+static void astar_run(int n) {
+	struct astar_node path[ASTAR_MAX_PATH];
+	for (int i = 0; i < n; i++) {
+		// A1 to the far side of the track, and back
+		sink = astar_find_path(&track[i % 2 ? 0 : 70], &track[i % 2 ? 70 : 0], path, blocked);
+	}
+}
+
+static struct trainsrv_state attribution_state;
+
+static void attribution_add_train(int train_id, int sensor, int time) {
+	struct trainsrv_state *state = &attribution_state;
+	struct internal_train_state *train = &state->train_states[state->num_active_trains++];
+	memset(train, 0, sizeof(*train));
+	train->train_id = train_id;
+	state->state_for_train[train_id - 1] = train;
+	sensor_historical_init(&train->sensor_history);
+	sensor_historical_set(&train->sensor_history, sensor, time);
+	speed_historical_init(&train->speed_history);
+	speed_historical_set(&train->speed_history, 8, 0);
+	for (int i = 1; i < ARRAY_LENGTH(train->est_velocities); i++) {
+		train->est_velocities[i] = 5000;
+		train->est_stopping_distances[i] = 700;
+	}
+}
+
+static void attribution_setup(void) {
+	memset(&attribution_state, 0, sizeof(attribution_state));
+	train_models_init();
+	reliability_init(&attribution_state.reliability);
+	switch_historical_init(&attribution_state.switch_history);
+	struct switch_state switches = {};
+	switch_historical_set(&attribution_state.switch_history, switches, 50);
+	attribution_add_train(63, 36, 200); // C5
+	attribution_add_train(58, 70, 200); // E7
+}
+
+static void attribution_run(int n) {
+	for (int i = 0; i < n; i++) {
+		// C15, which train 63 should have hit
+		sink = attribute_sensor_to_train(&attribution_state, 46, 250).distance_travelled;
+	}
+}
+
+static void position_run(int n) {
+	struct switch_state switches = {};
+	for (int i = 0; i < n; i++) {
+		struct position p = { &track[0].edge[0], 0 };
+		position_travel_forwards(&p, 1000 + (i & 0xff), &switches);
+		sink = p.displacement;
+	}
+}
+
+static void kalman_run(int n) {
+	struct kalman_state k;
+	kalman_init(&k, 0, 50, 500);
+	for (int i = 0; i < n; i++) {
+		kalman_predict(&k, i + 1, &k);
+		kalman_update(&k, (i & 0xff) * 100, 20);
+	}
+	sink = k.offset;
+}
+
+// The deceleration curve, integrated the way transition_distance does it,
+// with the reference implementation and then the prepared polynomial.
+
+static const long long deceleration_coefs[] = { 597828168, 0, -414289819, 231854274, -48630758, 3595593 };
+
+static void polynomial_reference_run(int n) {
+	long long total = 0;
+	for (int i = 0; i < n; i++) {
+		const long long lo = (i & 0xff) << 12;
+		total += integrate_polynomial(lo, lo + 4096 * 1000, deceleration_coefs,
+				ARRAY_LENGTH(deceleration_coefs));
+	}
+	sink = total;
+}
+
+static void polynomial_run(int n) {
+	long long total = 0;
+	for (int i = 0; i < n; i++) {
+		const long long lo = (i & 0xff) << 12;
+		total += polynomial_integrate(&deceleration_model, lo, lo + 4096 * 1000);
+	}
+	sink = total;
+}
+
+// from 0, the most common case, which only needs the one end evaluated
+static void polynomial_from_zero_run(int n) {
+	long long total = 0;
+	for (int i = 0; i < n; i++) {
+		total += polynomial_integrate(&deceleration_model, 0, stopping_time_coef - (i & 0xffff));
+	}
+	sink = total;
+}
+
+static void snprintf_run(int n) {
+	char buf[80];
+	for (int i = 0; i < n; i++) {
+		sink = snprintf(buf, sizeof(buf), "Next POI [%d]: %s + %d mm / %d ticks, type %s",
+				i & 0xf, "C13", 1234, i, "SWITCH");
+	}
+}
+
+static struct hashtable names;
+
+static void hashtable_setup(void) {
+	hashtable_init(&names);
+	hashtable_set(&names, "trains", 1);
+	hashtable_set(&names, "displaysrv", 2);
+	hashtable_set(&names, "commandsrv", 3);
+	hashtable_set(&names, "conductor_58", 4);
+}
+
+static void hashtable_run(int n) {
+	int val = 0;
+	for (int i = 0; i < n; i++) {
+		hashtable_get(&names, (i & 1) ? "conductor_58" : "trains", &val);
+	}
+	sink = val;
+}
+
+static char copy_src[4096], copy_dst[4096];
+
+static void memcpy_run(int n) {
+	for (int i = 0; i < n; i++) {
+		memcpy(copy_dst, copy_src, sizeof(copy_dst));
+	}
+	sink = copy_dst[0];
+}
+
+static void memset_run(int n) {
+	for (int i = 0; i < n; i++) {
+		memset(copy_dst, i, sizeof(copy_dst));
+	}
+	sink = copy_dst[0];
+}
+
+static const struct microbench benchmarks[] = {
+	{ "astar", NULL, astar_run },
+	{ "sensor_attribution", attribution_setup, attribution_run },
+	{ "position_travel", NULL, position_run },
+	{ "kalman", NULL, kalman_run },
+	{ "integrate_polynomial", NULL, polynomial_reference_run },
+	{ "polynomial_integrate", train_models_init, polynomial_run },
+	{ "polynomial_integrate_0", train_models_init, polynomial_from_zero_run },
+	{ "snprintf", NULL, snprintf_run },
+	{ "hashtable_get", hashtable_setup, hashtable_run },
+	{ "memcpy_4k", NULL, memcpy_run },
+	{ "memset_4k", NULL, memset_run },
+};
+
+static long long time_run(const struct microbench *b, int n) {
+	long long start = host_nanotime();
+	b->run(n);
+	return host_nanotime() - start;
+}
+
+static void run_benchmark(const struct microbench *b) {
+	if (b->setup) b->setup();
+
+	int n = 1;
+	while (time_run(b, n) < MIN_RUN_NS && n < (1 << 29)) n *= 2;
+
+	long long best = -1;
+	for (int i = 0; i < RUNS; i++) {
+		long long t = time_run(b, n);
+		if (best < 0 || t < best) best = t;
+	}
+
+	// picoseconds per iteration, so we can print fractions of a nanosecond
+	const long long ps = best * 1000 / n;
+	printf("%s", b->name);
+	for (int i = strlen(b->name); i < 24; i++) putc(' ');
+	printf("%d.%03d ns/op (%d iterations)" EOL, (int) (ps / 1000), (int) (ps % 1000), n);
+}
+
+static bool selected(const char *name, int argc, char *argv[]) {
+	if (argc <= 1) return true;
+	for (int i = 1; i < argc; i++) {
+		if (strcmp(argv[i], name) == 0) return true;
+	}
+	return false;
+}
+
+int main(int argc, char *argv[]) {
+#ifdef TRACKA
+	init_tracka(track);
+#else
+	init_trackb(track);
+#endif
+	for (int i = 0; i < ARRAY_LENGTH(benchmarks); i++) {
+		if (selected(benchmarks[i].name, argc, argv)) run_benchmark(&benchmarks[i]);
+	}
+	return 0;
+}
@@ -0,0 +1,38 @@
+#include "host_kernel.h"
+
+#include "../user/track.h"
+
+#include "../test/min_heap.h"
+#include "../test/memcpy_test.h"
+#include "../test/timer_wheel_test.h"
+#include "../test/calibration_test.h"
+#include "../test/kalman_test.h"
+#include "../test/polymath_test.h"
+#include "../test/motion_plan_test.h"
+#include "../test/reliability_test.h"
+#include "../test/screen_test.h"
+#include "../test/sensor_attribution_test.h"
+
+// The tests from src/test which don't need any other tasks, run natively.
+// Failures halt with the assertion message, like on the ARM.
+int main(int argc, char *argv[]) {
+	host_verbose = argc > 1;
+#ifdef TRACKA
+	init_tracka(track);
+#else
+	init_trackb(track);
+#endif
+
+	memcpy_tests();
+	memset_tests();
+	min_heap_tests();
+	timer_wheel_tests();
+	calibration_tests();
+	kalman_tests();
+	polymath_tests();
+	motion_plan_tests();
+	reliability_tests();
+	screen_tests();
+	sensor_attribution_tests();
+	return 0;
+}
@@ -1,4 +1,6 @@
-.text
+@ this is the kernel's hottest code, so it's kept with the rest of the hot path
+@ (see KERNEL_HOT in drivers/cache.h)
+.section .text.hot, "ax"
 .globl enter_kernel
 .globl enter_kernel_irq
 .globl exit_kernel
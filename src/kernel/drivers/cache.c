@@ -0,0 +1,88 @@
+#include "cache.h"
+
+// I (bit 12) and C (bit 2) of the cp15 control register
+#define CACHE_FLAG_BITS 0x1004
+#define ICACHE_FLAG_BIT 0x1000
+
+// The ARM920T's instruction cache has 8 segments of 64 lines of 32 bytes,
+// and consecutive lines fall in consecutive segments. Lines are locked by
+// index, across all of the segments at once, so each index holds 256
+// contiguous bytes.
+#define ICACHE_LINE_BYTES 32
+#define ICACHE_SEGMENTS 8
+#define ICACHE_INDEX_BYTES (ICACHE_SEGMENTS * ICACHE_LINE_BYTES)
+// never lock more than half of the cache, so that user code still has room
+#define ICACHE_MAX_LOCKED_INDICES 32
+
+static unsigned read_control(void) {
+	unsigned flags;
+	__asm__ __volatile__ ("mrc p15, 0, %0, c1, c0, 0" : "=r"(flags));
+	return flags;
+}
+
+static void write_control(unsigned flags) {
+	__asm__ __volatile__ ("mcr p15, 0, %0, c1, c0, 0" : : "r"(flags));
+}
+
+// Sets both the victim index and the lockdown base: lines are filled at the
+// victim index, and indices below the base are never replaced.
+static void icache_set_lockdown_base(unsigned index) {
+	__asm__ __volatile__ ("mcr p15, 0, %0, c9, c0, 1" : : "r"(index << 26));
+}
+
+static void icache_invalidate(void) {
+	__asm__ __volatile__ ("mcr p15, 0, %0, c7, c5, 0" : : "r"(0));
+}
+
+// Follows the lockdown procedure from the ARM920T TRM: the code doing the
+// locking must not itself be cached, or its own line fills would land in the
+// indices being locked. Without the MMU, every fetch is cacheable while the
+// cache is on, so this runs with the instruction cache turned off.
+// (QEMU doesn't model the caches, so there's nothing to do there.)
+static void icache_lock_hot_text(void) {
+#ifndef QEMU
+	extern char __hot_text_start__, __hot_text_end__;
+	// the linker scripts align the start to an index
+	unsigned addr = (unsigned) &__hot_text_start__;
+	const unsigned end = (unsigned) &__hot_text_end__;
+
+	const unsigned flags = read_control();
+	write_control(flags & ~ICACHE_FLAG_BIT);
+	icache_set_lockdown_base(0);
+	icache_invalidate();
+
+	unsigned index = 0;
+	for (; addr < end && index < ICACHE_MAX_LOCKED_INDICES; index++) {
+		icache_set_lockdown_base(index);
+		for (int i = 0; i < ICACHE_SEGMENTS; i++, addr += ICACHE_LINE_BYTES) {
+			// prefetch the line into the cache
+			__asm__ __volatile__ ("mcr p15, 0, %0, c7, c13, 1" : : "r"(addr));
+		}
+	}
+	icache_set_lockdown_base(index);
+	write_control(flags);
+#endif
+}
+
+void cache_set_mode(enum cache_mode mode) {
+	const unsigned flags = read_control();
+	switch (mode) {
+	case CACHE_OFF:
+		write_control(flags & ~CACHE_FLAG_BITS);
+		break;
+	case CACHE_ON:
+#ifndef QEMU
+		// unlock anything which was locked before, so it can be replaced
+		icache_set_lockdown_base(0);
+#endif
+		// throw away any stale instructions from the last time it was on (the
+		// data cache does nothing without the MMU, so it's never dirty)
+		icache_invalidate();
+		write_control(flags | CACHE_FLAG_BITS);
+		break;
+	case CACHE_LOCKED:
+		write_control(flags | CACHE_FLAG_BITS);
+		icache_lock_hot_text();
+		break;
+	}
+}
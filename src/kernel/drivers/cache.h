@@ -0,0 +1,14 @@
+#pragma once
+
+#include <kernel.h>
+
+// Turns the instruction and data caches on or off, or on with the kernel's
+// hot path locked into the instruction cache.
+// The kernel boots with them on (or locked, if built with CACHE_LOCKDOWN);
+// turning them off is only useful for benchmarking.
+void cache_set_mode(enum cache_mode mode);
+
+// Puts a function on the kernel's hot path: the linker scripts keep these
+// together, between __hot_text_start__ and __hot_text_end__, so that they
+// can be locked into the instruction cache.
+#define KERNEL_HOT __attribute__((section(".text.hot")))
@@ -59,9 +59,12 @@ void timer_deinit(void) {
 	*reg = 0;
 }
 
-/* unsigned timer_time(void) { */
-/* 	return *(volatile unsigned*)(TIMER_BASE + TIMER_VALUE_OFFSET); */
-/* } */
+unsigned tick_timer_useconds(void) {
+	// the tick timer counts down from TIMER_TICK_LEN, and then reloads
+	const unsigned value = *(volatile unsigned*)(TIMER_BASE + TIMER_VALUE_OFFSET);
+	const unsigned elapsed = TIMER_TICK_LEN - value;
+	return (unsigned long long) elapsed * 1000000 / TIME_SECOND;
+}
 
 void tick_timer_clear_interrupt(void) {
 	volatile unsigned *clr = (unsigned*)(TIMER_BASE + TIMER_INTCLR_OFFSET);
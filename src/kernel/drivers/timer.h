@@ -18,7 +18,9 @@
 void timer_init(void);
 void timer_deinit(void);
 
-/* unsigned timer_time(void); */
 void tick_timer_clear_interrupt(void);
+// How long it's been since the tick timer last fired, for measuring interrupt
+// latency. Only as precise as the tick timer's clock (256us on QEMU).
+unsigned tick_timer_useconds(void);
 
 unsigned debug_timer_useconds(void);
@@ -7,6 +7,7 @@
 #include "drivers/timer.h"
 #include "drivers/uart.h"
 #include "drivers/irq.h"
+#include "drivers/cache.h"
 #include "context_switch.h"
 #include "tasks.h"
 #include "kassert.h"
@@ -14,18 +15,6 @@
 
 /** @file */
 
-void setup_cache(void) {
-	unsigned flags;
-	__asm__("mrc p15, 0, %0, c1, c0, 0" : "=r"(flags));
-#define FLAG_BITS 0x1004
-#if BENCHMARK_CACHE
-	flags |= FLAG_BITS;
-#else
-	flags &= ~FLAG_BITS;
-#endif
-	__asm__ __volatile__ ("mcr p15, 0, %0, c1, c0, 0" : : "r"(flags));
-}
-
 void setup_irq_table(void) {
 	// Copy exception vector from where it's linked/loaded to the start of
 	// memory, where ARM expects to find it. Assumes all instructions in the
@@ -72,7 +61,11 @@ void setup(void) {
 	irq_setup();
 	kputc('.');
 
-	setup_cache();
+#ifdef CACHE_LOCKDOWN
+	cache_set_mode(CACHE_LOCKED);
+#else
+	cache_set_mode(CACHE_ON);
+#endif
 	kputc('.');
 
 	rand_init(0xdeadbeef);
@@ -117,7 +110,7 @@ void idle_task(void) {
 
 #include "../gen/syscalls.h"
 #define SYSCALL_IRQ 37
-int boot(void (*init_task)(void), int init_task_priority, int debug) {
+KERNEL_HOT int boot(void (*init_task)(void), int init_task_priority, int debug) {
 	setup();
 	unsigned ts_start = debug_timer_useconds();
 
@@ -165,6 +158,8 @@ int boot(void (*init_task)(void), int init_task_priority, int debug) {
 		case SYSCALL_HALT:        running = 0;                       break;
 		case SYSCALL_IDLE_PERMILLE: idle_permille_handler(current_task, ts_start); break;
 		case SYSCALL_TASK_STATUS: task_info_handler(current_task);   break;
+		case SYSCALL_DEBUG_SET_CACHE: debug_set_cache_handler(current_task); break;
+		case SYSCALL_DEBUG_BENCH_SCHEDULER: debug_bench_scheduler_handler(current_task); break;
 		default:
 			KASSERT(0 && "UNKNOWN SYSCALL NUMBER");
 			break;
@@ -2,7 +2,7 @@ import sys
 from os import path
 syscalls = ["try_create", "pass", "exitk", "tid", "parent_tid",
 			"try_send", "try_receive", "try_reply", "try_await", "rand", "should_idle",
-			"halt", "idle_permille", "task_status"]
+			"halt", "idle_permille", "task_status", "debug_set_cache", "debug_bench_scheduler"]
 
 gen_dir = sys.argv[1]
 
@@ -7,6 +7,7 @@
 #include "../tasks.h"
 #include "../drivers/irq.h"
 #include "../drivers/timer.h"
+#include "../drivers/cache.h"
 #include "await_io.h"
 
 static struct task_descriptor *await_blocked_tasks[EID_NUM_EVENTS] = {};
@@ -28,7 +29,7 @@ void clear_awaiting_task(int eid) {
 	await_blocked_tasks[eid] = NULL;
 }
 
-void await_event_occurred(int eid, int data) {
+KERNEL_HOT void await_event_occurred(int eid, int data) {
 	struct task_descriptor *task = get_awaiting_task(eid);
 	if (task) {
 		clear_awaiting_task(eid);
@@ -44,7 +45,7 @@ void await_init(void) {
 	io_irq_init();
 }
 
-void irq_handler(struct task_descriptor *current_task) {
+KERNEL_HOT void irq_handler(struct task_descriptor *current_task) {
 	unsigned long long irq_mask = irq_get_interrupt();
 	unsigned irq_mask_lo = irq_mask;
 	unsigned irq_mask_hi = irq_mask >> 32;
@@ -71,7 +72,7 @@ void uart_for_eid(int eid, int* channel, int* is_tx) {
 	*is_tx = (eid - EID_COM1_READ) % 2;
 }
 
-void await_handler(struct task_descriptor *current_task) {
+KERNEL_HOT void await_handler(struct task_descriptor *current_task) {
 	int eid = syscall_arg(current_task->context, 0);
 	if (eid < 0 || eid >= EID_NUM_EVENTS) {
 		syscall_set_return(current_task->context, AWAIT_UNKNOWN_EVENT);
@@ -0,0 +1,28 @@
+#include "debug.h"
+
+#include "../tasks.h"
+#include "../drivers/cache.h"
+#include "../drivers/timer.h"
+
+// Syscalls which only exist for benchmarking the kernel
+
+void debug_set_cache_handler(struct task_descriptor *current_task) {
+	cache_set_mode(syscall_arg(current_task->context, 0));
+	task_schedule(current_task);
+}
+
+void debug_bench_scheduler_handler(struct task_descriptor *current_task) {
+	const int iterations = syscall_arg(current_task->context, 0);
+	const unsigned start = debug_timer_useconds();
+	// If there are other tasks at the same priority, this rotates through
+	// them, but every task popped is pushed straight back on, so nothing is
+	// lost.
+	struct task_descriptor *td = current_task;
+	for (int i = 0; i < iterations; i++) {
+		task_schedule(td);
+		td = task_next_scheduled();
+	}
+	const unsigned end = debug_timer_useconds();
+	syscall_set_return(current_task->context, end - start);
+	task_schedule(td);
+}
@@ -0,0 +1,6 @@
+#pragma once
+
+#include "../task_descriptor.h"
+
+void debug_set_cache_handler(struct task_descriptor *current_task);
+void debug_bench_scheduler_handler(struct task_descriptor *current_task);
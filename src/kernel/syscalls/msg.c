@@ -2,8 +2,9 @@
 
 #include <util.h>
 #include "../tasks.h"
+#include "../drivers/cache.h"
 
-static void dispatch_msg(struct task_descriptor *to, struct task_descriptor *from) {
+KERNEL_HOT static void dispatch_msg(struct task_descriptor *to, struct task_descriptor *from) {
 	// write tid of sender to pointer provided by receiver
 	*(unsigned*)syscall_arg(to->context, 0) = from->tid;
 
@@ -20,7 +21,7 @@ static void dispatch_msg(struct task_descriptor *to, struct task_descriptor *fro
 	task_schedule(to);
 }
 
-void send_handler(struct task_descriptor *current_task) {
+KERNEL_HOT void send_handler(struct task_descriptor *current_task) {
 	struct user_context *uc = current_task->context;
 	int to_tid = syscall_arg(uc, 0);
 	// check if the tid exists & is not us
@@ -42,7 +43,7 @@ void send_handler(struct task_descriptor *current_task) {
 	}
 }
 
-void receive_handler(struct task_descriptor *current_task) {
+KERNEL_HOT void receive_handler(struct task_descriptor *current_task) {
 	struct task_descriptor *from_td = task_queue_pop(&current_task->waiting_for_replies);
 	if (from_td) {
 		dispatch_msg(current_task, from_td);
@@ -51,7 +52,7 @@ void receive_handler(struct task_descriptor *current_task) {
 	}
 }
 
-void reply_handler(struct task_descriptor *current_task) {
+KERNEL_HOT void reply_handler(struct task_descriptor *current_task) {
 	struct user_context *recv_context = current_task->context;
 	int send_tid = syscall_arg(recv_context, 0);
 
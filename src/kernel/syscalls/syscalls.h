@@ -4,3 +4,4 @@
 #include "await.h"
 #include "task_management.h"
 #include "rand.h"
+#include "debug.h"
@@ -3,16 +3,17 @@
 #include "util.h"
 #include <least_significant_set_bit.h>
 #include "kassert.h"
+#include "drivers/cache.h"
 
 void task_queue_init(struct task_queue *q) {
 	q->tail = q->head = 0;
 }
 
-int task_queue_empty(struct task_queue *q) {
+KERNEL_HOT int task_queue_empty(struct task_queue *q) {
 	return !q->head;
 }
 
-struct task_descriptor *task_queue_pop(struct task_queue *q) {
+KERNEL_HOT struct task_descriptor *task_queue_pop(struct task_queue *q) {
 	struct task_descriptor *d = q->head;
 	if (d) {
 		KASSERT(q->tail != 0 && "q->tail was null, but not q->head");
@@ -25,7 +26,7 @@ struct task_descriptor *task_queue_pop(struct task_queue *q) {
 	return d;
 }
 
-void task_queue_push(struct task_queue *q, struct task_descriptor *d) {
+KERNEL_HOT void task_queue_push(struct task_queue *q, struct task_descriptor *d) {
 	d->queue_next = 0;
 
 	if (q->tail) {
@@ -46,7 +47,7 @@ void priority_task_queue_init(struct priority_task_queue *q) {
 	}
 }
 
-struct task_descriptor *priority_task_queue_pop(struct priority_task_queue *q) {
+KERNEL_HOT struct task_descriptor *priority_task_queue_pop(struct priority_task_queue *q) {
 	if (q->priority_queue_mask) {
 		int priority = least_significant_set_bit(q->priority_queue_mask);
 		struct task_queue *pri_queue = &q->queues[priority];
@@ -60,7 +61,7 @@ struct task_descriptor *priority_task_queue_pop(struct priority_task_queue *q) {
 	}
 }
 
-void priority_task_queue_push(struct priority_task_queue *q, struct task_descriptor *d) {
+KERNEL_HOT void priority_task_queue_push(struct priority_task_queue *q, struct task_descriptor *d) {
 	int priority = d->priority;
 	struct task_queue *pri_queue = &q->queues[priority];
 
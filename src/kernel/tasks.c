@@ -4,6 +4,7 @@
 #include <prng.h>
 #include "kassert.h"
 #include "stack.h"
+#include "drivers/cache.h"
 
 static struct task_descriptor tasks[NUM_TD];
 static struct task_queue free_tds;
@@ -90,14 +91,14 @@ void task_kill(struct task_descriptor *task) {
 	task_queue_push(&free_tds, task);
 }
 
-void task_schedule(struct task_descriptor *task) {
+KERNEL_HOT void task_schedule(struct task_descriptor *task) {
 	priority_task_queue_push(&queue, task);
 }
-struct task_descriptor *task_next_scheduled() {
+KERNEL_HOT struct task_descriptor *task_next_scheduled() {
 	return priority_task_queue_pop(&queue);
 }
 
-int tid_valid(int tid) {
+KERNEL_HOT int tid_valid(int tid) {
 	return tid >= 0
 	       && tasks[tid % NUM_TD].tid == tid
 	       && tasks[tid % NUM_TD].state != DEAD;
@@ -105,7 +106,7 @@ int tid_valid(int tid) {
 int tid_possible(int tid) {
 	return tid >= 0;
 }
-struct task_descriptor *task_from_tid(int tid) {
+KERNEL_HOT struct task_descriptor *task_from_tid(int tid) {
 	KASSERT(tid >= 0);
 	struct task_descriptor *task = &tasks[tid % NUM_TD];
 	KASSERT(task->tid == tid); // Call tid_valid first to handle this gracefully.
@@ -137,14 +138,14 @@ void tasks_print_runtime(int total_runtime_us) {
 	kprintf("Ran for %d us total" EOL, total_runtime_us);
 }
 
-static void check_stack_canary(void *stack, int tid) {
+KERNEL_HOT static void check_stack_canary(void *stack, int tid) {
 	unsigned *canary = (unsigned*) stack;
 	for (unsigned i = 0; i < sizeof(stack_canary) / sizeof(stack_canary[0]); i++) {
 		KASSERTF(canary[i] == stack_canary[i], "Failed stack canary check for task %d, addr %x (%x != %x)", tid, (unsigned) stack, canary[i], stack_canary[i]);
 	}
 }
 
-void task_check_stack_canary(struct task_descriptor *td) {
+KERNEL_HOT void task_check_stack_canary(struct task_descriptor *td) {
 	int tid = td->tid;
 	// check the canary at the end of our stack
 	check_stack_canary(stacks[tid % NUM_TD], tid);
@@ -40,6 +40,11 @@ static int reconstruct_path(int *node_parents, int start, struct astar_node *pat
 
 int astar_find_path(const struct track_node *start, const struct track_node *end,
 					struct astar_node *path_out, bool *blocked_table) {
+	return astar_find_path_avoiding(start, end, path_out, blocked_table, 0);
+}
+
+int astar_find_path_avoiding(const struct track_node *start, const struct track_node *end,
+					struct astar_node *path_out, bool *blocked_table, unsigned avoid_switches) {
 	logf("Astar called between %s %s", start->name, end->name);
 	memset(path_out, 0, sizeof(*path_out)*ASTAR_MAX_PATH);
 	struct int_min_heap mh;
@@ -56,8 +61,10 @@ int astar_find_path(const struct track_node *start, const struct track_node *end
 		ASSERT(min_i >= 0 && min_i < TRACK_MAX);
 		const struct track_node *q = &track[min_i];
 		ASSERT(idx(q) == min_i);
+		const int switch_penalty = (q->type == NODE_BRANCH && (avoid_switches & SWITCH_BIT(q->num))) ?
+			ASTAR_AVOID_SWITCH_PENALTY : 0;
 		for (int i = 0; i < 2; i++) {
-			int cost = 0;
+			int cost = switch_penalty;
 			const struct track_edge *edge;
 			if (i >= 2) {
 				edge = &q->reverse->edge[i - 2];
@@ -11,4 +11,13 @@ struct astar_node {
 int astar_find_path(const struct track_node *start, const struct track_node *end,
 					struct astar_node *path_out, bool *blocked_table);
 
+// Going through a switch we'd rather avoid counts as this much further
+#define ASTAR_AVOID_SWITCH_PENALTY 2000 // mm
+
+// Like astar_find_path, but prefers not to take the branches of the switches
+// in avoid_switches (as bits of struct switch_state), since they might not go
+// the way we set them.
+int astar_find_path_avoiding(const struct track_node *start, const struct track_node *end,
+					struct astar_node *path_out, bool *blocked_table, unsigned avoid_switches);
+
 void astar_print_path(struct astar_node *path, int l);
@@ -66,18 +66,23 @@ int parent_tid(void);
 #define PRIORITY_IOSRV                    LOWER(PRIORITY_MAX, 3)
 #define PRIORITY_NAMESRV                  LOWER(PRIORITY_MAX, 4)
 #define PRIORITY_BUFFER_COURIER           LOWER(PRIORITY_MAX, 4)
+#define PRIORITY_PUBSUB                   LOWER(PRIORITY_MAX, 4)
 #define PRIORITY_HEARTBEAT_DEBUG          LOWER(PRIORITY_MAX, 4)
 
 #define PRIORITY_DISPLAYSRV               HIGHER(PRIORITY_MIN, 8)
+#define PRIORITY_DISPLAYSRV_FRAME         HIGHER(PRIORITY_MIN, 8)
 #define PRIORITY_SENSORSRV                HIGHER(PRIORITY_MIN, 7)
 #define PRIORITY_TRACKSRV                 HIGHER(PRIORITY_MIN, 6)
+#define PRIORITY_TELEMETRYSRV             HIGHER(PRIORITY_MIN, 5)
 #define PRIORITY_TRAIN_ALERT_SRV          HIGHER(PRIORITY_MIN, 3)
 #define PRIORITY_DISPLAYSRV_CLOCK_UPDATE  HIGHER(PRIORITY_MIN, 2)
+#define PRIORITY_TELEMETRY_SAMPLER        HIGHER(PRIORITY_MIN, 2)
 #define PRIORITY_TRAINSRV_DELAYED_REVERSE HIGHER(PRIORITY_MIN, 2)
 #define PRIORITY_TRAINSRV                 HIGHER(PRIORITY_MIN, 2)
 #define PRIORITY_CONDUCTOR                HIGHER(PRIORITY_MIN, 2)
 #define PRIORITY_COMMANDSRV               HIGHER(PRIORITY_MIN, 1)
 #define PRIORITY_ROUTESRV                 HIGHER(PRIORITY_MIN, 0)
+#define PRIORITY_PLANNERSRV               HIGHER(PRIORITY_MIN, 0)
 
 #define PRIORITY_CALIBRATE_DELAY PRIORITY_MAX // TODO: What priority?
 #define PRIORITY_CALIBRATE HIGHER(PRIORITY_MIN, 1)
@@ -130,6 +135,17 @@ unsigned rand(void);
 int should_idle(void); // Just for the idle task.
 int idle_permille(void); // debug info about how much we're idling
 
+// For benchmarking the kernel (see src/user/benchmark.c)
+enum cache_mode {
+	CACHE_OFF,
+	CACHE_ON,
+	CACHE_LOCKED, // on, with the kernel's hot path locked into the I-cache
+};
+void debug_set_cache(enum cache_mode mode);
+// Times scheduling the calling task and picking the next one, iterations
+// times over, in the kernel. Returns the time taken in microseconds.
+int debug_bench_scheduler(int iterations);
+
 void halt(void) __attribute__((noreturn)); // stop the kernel immediately, does not return
 enum task_state { DEAD, READY, SEND_BLK, RECV_BLK, REPLY_BLK };
 struct task_info {
@@ -31,10 +31,17 @@ static char bwa2i(char ch, const char **src, int base, int *nump) {
 	return ch;
 }
 
-static void bwui2a(producer produce, void *produce_state, unsigned int num,
+#ifdef HOST
+// pointers are wider than an int on the host, so %p needs the extra width
+typedef uintptr_t printf_uint;
+#else
+typedef unsigned int printf_uint;
+#endif
+
+static void bwui2a(producer produce, void *produce_state, printf_uint num,
                    unsigned int base, int padding, char padchar, int negative) {
 	int dgt;
-	unsigned int d = 1;
+	printf_uint d = 1;
 
 	padding--;
 
@@ -99,7 +106,7 @@ static void format(producer produce, void* produce_state, const char *fmt, va_li
 			case 0:
 				return;
 			case 'c':
-				produce(va_arg(va, char), produce_state);
+				produce((char) va_arg(va, int), produce_state);
 				break;
 			case 's': {
 				char *str = va_arg(va, char*);
@@ -111,9 +118,12 @@ static void format(producer produce, void* produce_state, const char *fmt, va_li
 			case 'u':
 				bwui2a(produce, produce_state, va_arg(va, unsigned int), 10, w, lz, 0);
 				break;
-			case 'x': case 'p':
+			case 'x':
 				bwui2a(produce, produce_state, va_arg(va, unsigned int), 16, w, lz, 0);
 				break;
+			case 'p':
+				bwui2a(produce, produce_state, (uintptr_t) va_arg(va, void*), 16, w, lz, 0);
+				break;
 			case 'd':
 				bwi2a(produce, produce_state, va_arg(va, int), w, lz);
 				break;
@@ -0,0 +1,105 @@
+#include "timer_wheel.h"
+
+#include <assert.h>
+
+#define MASK (TIMER_WHEEL_SLOTS - 1)
+
+void timer_wheel_list_init(struct timer_wheel_entry *head) {
+	head->next = head->prev = head;
+}
+
+bool timer_wheel_list_empty(const struct timer_wheel_entry *head) {
+	return head->next == head;
+}
+
+static void list_push(struct timer_wheel_entry *head, struct timer_wheel_entry *e) {
+	e->prev = head->prev;
+	e->next = head;
+	head->prev->next = e;
+	head->prev = e;
+}
+
+struct timer_wheel_entry *timer_wheel_list_pop(struct timer_wheel_entry *head) {
+	if (timer_wheel_list_empty(head)) return NULL;
+	struct timer_wheel_entry *e = head->next;
+	timer_wheel_cancel(e);
+	return e;
+}
+
+void timer_wheel_init(struct timer_wheel *tw, int now) {
+	tw->now = now;
+	for (int level = 0; level < TIMER_WHEEL_LEVELS; level++) {
+		for (int i = 0; i < TIMER_WHEEL_SLOTS; i++) {
+			timer_wheel_list_init(&tw->slots[level][i]);
+		}
+	}
+	timer_wheel_list_init(&tw->overflow);
+}
+
+static void place(struct timer_wheel *tw, struct timer_wheel_entry *e) {
+	int delta = e->expires - tw->now;
+	if (delta < 0) delta = 0;
+	if (delta < TIMER_WHEEL_SLOTS) {
+		list_push(&tw->slots[0][(tw->now + delta) & MASK], e);
+	} else if (delta < TIMER_WHEEL_SLOTS * TIMER_WHEEL_SLOTS) {
+		list_push(&tw->slots[1][(e->expires >> TIMER_WHEEL_BITS) & MASK], e);
+	} else {
+		list_push(&tw->overflow, e);
+	}
+}
+
+void timer_wheel_insert(struct timer_wheel *tw, struct timer_wheel_entry *e, int expires) {
+	e->expires = MAX(expires, tw->now + 1);
+	place(tw, e);
+}
+
+void timer_wheel_cancel(struct timer_wheel_entry *e) {
+	if (!timer_wheel_pending(e)) return;
+	e->prev->next = e->next;
+	e->next->prev = e->prev;
+	e->next = e->prev = NULL;
+}
+
+bool timer_wheel_pending(const struct timer_wheel_entry *e) {
+	return e->next != NULL;
+}
+
+// re-place everything on the list relative to the current time
+static void cascade(struct timer_wheel *tw, struct timer_wheel_entry *head) {
+	struct timer_wheel_entry list;
+	timer_wheel_list_init(&list);
+	if (timer_wheel_list_empty(head)) return;
+	// splice the whole list out first, since entries may be placed back on it
+	list.next = head->next;
+	list.prev = head->prev;
+	list.next->prev = &list;
+	list.prev->next = &list;
+	timer_wheel_list_init(head);
+
+	struct timer_wheel_entry *e;
+	while ((e = timer_wheel_list_pop(&list))) {
+		place(tw, e);
+	}
+}
+
+static void tick(struct timer_wheel *tw, struct timer_wheel_entry *expired) {
+	tw->now++;
+	if ((tw->now & (TIMER_WHEEL_SLOTS * TIMER_WHEEL_SLOTS - 1)) == 0) {
+		cascade(tw, &tw->overflow);
+	}
+	if ((tw->now & MASK) == 0) {
+		cascade(tw, &tw->slots[1][(tw->now >> TIMER_WHEEL_BITS) & MASK]);
+	}
+	struct timer_wheel_entry *slot = &tw->slots[0][tw->now & MASK];
+	struct timer_wheel_entry *e;
+	while ((e = timer_wheel_list_pop(slot))) {
+		ASSERT(e->expires <= tw->now);
+		list_push(expired, e);
+	}
+}
+
+void timer_wheel_advance(struct timer_wheel *tw, int now, struct timer_wheel_entry *expired) {
+	while (tw->now < now) {
+		tick(tw, expired);
+	}
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <util.h>
+
+/**
+ * @file
+ *
+ * Hierarchical timer wheel.
+ * Entries are embedded in the caller's own structs (so there's no allocation),
+ * and both inserting and cancelling are O(1).
+ * The wheel is advanced one tick at a time. Level 0 has one slot per tick,
+ * level 1 has one slot per TIMER_WHEEL_SLOTS ticks, and anything further out
+ * than that sits on an overflow list until it gets close enough.
+ */
+
+#define TIMER_WHEEL_BITS 6
+#define TIMER_WHEEL_SLOTS (1 << TIMER_WHEEL_BITS)
+#define TIMER_WHEEL_LEVELS 2
+
+// Lists are circular, with the heads acting as sentinels
+struct timer_wheel_entry {
+	struct timer_wheel_entry *next, *prev;
+	int expires;
+};
+
+struct timer_wheel {
+	int now;
+	struct timer_wheel_entry slots[TIMER_WHEEL_LEVELS][TIMER_WHEEL_SLOTS];
+	struct timer_wheel_entry overflow;
+};
+
+void timer_wheel_init(struct timer_wheel *tw, int now);
+
+// Entries which would expire at or before the current time will expire on the
+// next tick instead.
+void timer_wheel_insert(struct timer_wheel *tw, struct timer_wheel_entry *e, int expires);
+void timer_wheel_cancel(struct timer_wheel_entry *e);
+bool timer_wheel_pending(const struct timer_wheel_entry *e);
+
+// Advances the wheel up to the given time, moving any entries which have
+// expired onto the expired list (which must be initialized with
+// timer_wheel_list_init)
+void timer_wheel_advance(struct timer_wheel *tw, int now, struct timer_wheel_entry *expired);
+
+void timer_wheel_list_init(struct timer_wheel_entry *head);
+bool timer_wheel_list_empty(const struct timer_wheel_entry *head);
+// removes and returns the first entry, or NULL if the list is empty
+struct timer_wheel_entry *timer_wheel_list_pop(struct timer_wheel_entry *head);
@@ -15,25 +15,20 @@ void *memset(void *ptr, int value, int num) {
 	// word aligned
 	unsigned char * const max_c = ((unsigned char*) ptr) + num;
 	unsigned char *ptr_c = (unsigned char*) ptr;
-	unsigned char *word_aligned_begin = ptr_c + ((unsigned) ptr_c | 0x3);
+	while (ptr_c < max_c && ((uintptr_t) ptr_c & 0x3)) *ptr_c++ = value;
 
-	if (word_aligned_begin < max_c) {
-		// copy the bytes before the start of the word-aligned segment
-		while (ptr_c < word_aligned_begin) *ptr_c++ = value;
+	aliased_word *ptr_w = (aliased_word*) ptr_c;
+	aliased_word * const max_w = (aliased_word*) ((uintptr_t) max_c & ~0x3);
+	// We pad the value with itself to prepare for the word by word copy:
+	// 0x000000ab -> 0xabababab
+	unsigned word_value = value & 0xff;
+	word_value |= word_value << 8;
+	word_value |= word_value << 16;
+	while (ptr_w < max_w) *ptr_w++ = word_value;
 
-		unsigned *ptr_w = (unsigned*) ptr_c;
-		unsigned * const max_w = ptr_w + (num / 4);
-		// We pad the value with itself to prepare for the word by word copy:
-		// 0x000000ab -> 0xabababab
-		unsigned word_value = value | value << 8;
-		word_value |= word_value << 16;
-		while (ptr_w < max_w) *ptr_w++ = word_value;
-
-		// now copy any bytes left over that can't be done with the word-aligned copy
-		ptr_c = (unsigned char*) ptr_w;
-	}
-
-	while (ptr_c < max_c)  *ptr_c++ = value;
+	// now copy any bytes left over that can't be done with the word-aligned copy
+	ptr_c = (unsigned char*) ptr_w;
+	while (ptr_c < max_c) *ptr_c++ = value;
 
 	return ptr;
 }
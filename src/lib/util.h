@@ -33,6 +33,21 @@ void *memset(void *ptr, int value, int num);
 typedef unsigned size_t;
 void* memcpy(void *dst, const void *src, size_t len);
 
+// Copies of 4, 8 or 16 bytes (a tid, a switch_state, a position) are common
+// enough to be worth doing inline when the size is known at compile time, as
+// long as both pointers turn out to be word aligned.
+typedef unsigned __attribute__((__may_alias__)) aliased_word;
+static inline void *memcpy_small(void *dst, const void *src, size_t len) {
+	if (((uintptr_t) dst | (uintptr_t) src) & 3) return (memcpy)(dst, src, len);
+	aliased_word *d = dst;
+	const aliased_word *s = src;
+	for (int i = 0; i < len / 4; i++) d[i] = s[i];
+	return dst;
+}
+#define memcpy(dst, src, len) \
+	((__builtin_constant_p(len) && ((len) == 4 || (len) == 8 || (len) == 16)) \
+		? memcpy_small((dst), (src), (len)) : (memcpy)((dst), (src), (len)))
+
 int modi(int a, int b);
 int strlen(const char *s);
 char* strcpy(char *dst, const char *src);
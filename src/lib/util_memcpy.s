@@ -1,4 +1,5 @@
-.text
+@ on the kernel's hot path, since it copies every message (see KERNEL_HOT)
+.section .text.hot, "ax"
 .globl memcpy
 
 @ naive C code for this looks like:
@@ -11,37 +12,136 @@
 @     return dst;
 @ }
 
-@ TODO: we may want to try copying multiple words at once, if possible
+@ This is behind every message pass, so it does rather more than that:
+@  - copies shorter than MEMCPY_SHORT bytes are done a word or a byte at a
+@    time, without touching the stack
+@  - otherwise, bytes are copied until the destination is word aligned
+@  - if the source is then word aligned too, 32 bytes are copied at a time
+@    with ldm/stm bursts of 8 registers, then single words
+@  - if it isn't, whole words are read from the aligned address below the
+@    source, and neighbouring words are shifted together to make each
+@    destination word, 16 bytes at a time and then single words
+@  - whatever is left over is copied a byte at a time
+
+@ r0 is dst, r1 is src, r2 is len
+@ r3 and r12 are scratch, and r4-r10 are saved for the bursts
+
+.equ MEMCPY_SHORT, 16
 
 memcpy:
     @ deal with the zero/negative len case immediately,
     @ since this allows us to write do-loops
-    movs r3, r2
+    cmp r2, #0
     bxle lr
 
+    cmp r2, #MEMCPY_SHORT
+    blt memcpy_short
+
     @ save the destination pointer, as required by the spec
-    stmfd sp!, {r0}
+    stmfd sp!, {r0, r4-r10}
+
+    @ copy up to three bytes to word align the destination
+    @ (len >= MEMCPY_SHORT, so this can't run out)
+memcpy_align_dst:
+    tst r0, #3
+    beq memcpy_dst_aligned
+    ldrb r3, [r1], #1
+    sub r2, r2, #1
+    strb r3, [r0], #1
+    b memcpy_align_dst
+
+memcpy_dst_aligned:
+    ands r12, r1, #3
+    bne memcpy_misaligned
+
+    subs r2, r2, #32
+    blt memcpy_burst_done
+memcpy_burst:
+    ldmia r1!, {r3-r10}
+    subs r2, r2, #32
+    stmia r0!, {r3-r10}
+    bge memcpy_burst
+memcpy_burst_done:
+    add r2, r2, #32
+
+memcpy_words:
+    subs r2, r2, #4
+    ldrge r3, [r1], #4
+    strge r3, [r0], #4
+    bgt memcpy_words
+    @ undo the last subtraction if it went past the end
+    addlt r2, r2, #4
+    b memcpy_bytes
+
+memcpy_misaligned:
+    @ r12 is the right shift, r4 is the left shift, and r5 holds the bytes
+    @ from the last word read which haven't been written yet
+    bic r1, r1, #3
+    mov r12, r12, lsl #3
+    rsb r4, r12, #32
+    ldr r5, [r1], #4
 
-    @ check to see if we need to fall back to byte-aligned mode
-    @ either the pointers aren't both aligned to a word, or the
-    @ length isn't divisible by 4
+    subs r2, r2, #16
+    blt memcpy_misaligned_burst_done
+memcpy_misaligned_burst:
+    ldmia r1!, {r6-r9}
+    mov r3, r5, lsr r12
+    orr r3, r3, r6, lsl r4
+    mov r6, r6, lsr r12
+    orr r6, r6, r7, lsl r4
+    mov r7, r7, lsr r12
+    orr r7, r7, r8, lsl r4
+    mov r8, r8, lsr r12
+    orr r8, r8, r9, lsl r4
+    mov r5, r9
+    subs r2, r2, #16
+    stmia r0!, {r3, r6-r8}
+    bge memcpy_misaligned_burst
+memcpy_misaligned_burst_done:
+    adds r2, r2, #16 - 4
+    blt memcpy_misaligned_words_done
+memcpy_misaligned_words:
+    ldr r6, [r1], #4
+    mov r3, r5, lsr r12
+    orr r3, r3, r6, lsl r4
+    mov r5, r6
+    subs r2, r2, #4
+    str r3, [r0], #4
+    bge memcpy_misaligned_words
+memcpy_misaligned_words_done:
+    add r2, r2, #4
+    @ point the source back at the first byte which hasn't been copied
+    sub r1, r1, #4
+    add r1, r1, r12, lsr #3
+
+memcpy_bytes:
+    cmp r2, #0
+    beq memcpy_done
+memcpy_bytes_loop:
+    ldrb r3, [r1], #1
+    subs r2, r2, #1
+    strb r3, [r0], #1
+    bne memcpy_bytes_loop
+memcpy_done:
+    ldmfd sp!, {r0, r4-r10}
+    bx lr
+
+memcpy_short:
+    mov r12, r0
+    @ a whole number of aligned words (a tid, say) can still go a word at a time
     orr r3, r0, r1
     orr r3, r3, r2
-    ands r3, r3, #0x3
-    bne memcpy_byte_aligned
-memcpy_word_aligned:
+    tst r3, #3
+    bne memcpy_short_loop
+memcpy_short_words:
     ldr r3, [r1], #4
     subs r2, r2, #4
-    str r3, [r0], #4
-    bne memcpy_word_aligned
-    ldmfd sp!, {r0}
+    str r3, [r12], #4
+    bne memcpy_short_words
     bx lr
-
-memcpy_byte_aligned:
+memcpy_short_loop:
     ldrb r3, [r1], #1
     subs r2, r2, #1
-    strb r3, [r0], #1
-    bne memcpy_byte_aligned
-    ldmfd sp!, {r0}
+    strb r3, [r12], #1
+    bne memcpy_short_loop
     bx lr
-@ the naive implementation
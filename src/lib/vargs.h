@@ -1,5 +1,12 @@
 #pragma once
 
+#ifdef HOST
+// The host ABI passes arguments in registers, so walking the stack won't work
+typedef __builtin_va_list va_list;
+#define va_start(ap, pN) __builtin_va_start(ap, pN)
+#define va_end(ap) __builtin_va_end(ap)
+#define va_arg(ap, t) __builtin_va_arg(ap, t)
+#else
 typedef char *va_list;
 
 #define __va_argsiz(t)	\
@@ -11,3 +18,4 @@ typedef char *va_list;
 
 #define va_arg(ap, t)	\
 		 (((ap) = (ap) + __va_argsiz(t)), *((t*) (void*) ((ap) - __va_argsiz(t))))
+#endif
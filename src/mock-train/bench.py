@@ -0,0 +1,261 @@
+#!/usr/bin/python
+# End-to-end benchmark: runs the kernel under QEMU against simulator.py, and
+# measures how well it gets trains around the track.
+#
+# Usage:
+#     bench.py KERNEL SCENARIO [--out results.json]
+#
+# Scenarios are simulator scenarios (see simulator.py) with a few more lines:
+#
+#     duration 300            # how long to run for, in seconds
+#     start 58 8              # speed to drive at until the program finds it
+#     route 58 C13 E7 D9      # destinations to send the train to, in turn
+#
+# The kernel has to be built for the scenario's track. Once it has booted,
+# each train is driven at its start speed (8 by default) until the program
+# knows where it is, and then sent to each of its destinations in turn, over
+# and over until time runs out. A route is finished when the train stops
+# within ARRIVAL_MM of its destination, and abandoned after ROUTE_TIMEOUT
+# seconds.
+#
+# The results are written as JSON:
+#
+#     trains_per_hour         routes finished, per hour
+#     stop_error_mm           mean and p99 of how far from the destination
+#                             trains stopped (signed mean: + is overshoot)
+#     conflicts_per_min       reservations refused by the track server
+#     sensor_to_command_ms    mean and p99 time from a sensor dump with a
+#                             trip in it to the next command (see simulator.py)
+#     idle_permille           from idle_permille(), over the whole run
+#
+# plus the raw counts they're calculated from.
+from __future__ import print_function, division
+import json
+import math
+import os
+import select
+import shutil
+import subprocess
+import sys
+import tempfile
+import time
+
+import simulator
+import telemetry
+
+QEMU_SCRIPT = os.path.join(os.path.dirname(os.path.abspath(__file__)), '..', '..', 'scripts', 'qemu')
+
+# time for the kernel to boot before we start typing at it
+BOOT_SECONDS = 3.
+TELEMETRY_HZ = 2
+DEFAULT_START_SPEED = 8
+ARRIVAL_MM = 300
+ROUTE_TIMEOUT = 120.
+# how far to look along the track for a destination when scoring a stop
+SEARCH_MM = 2000
+# results which come from the kernel's stats records, so must never be null
+STATS_KEYS = ('conflicts', 'deadlocks', 'idle_permille')
+
+class BenchTrain():
+	def __init__(self, num, start_speed, route):
+		self.num = num
+		self.start_speed = start_speed
+		self.route = route
+		self.leg = 0
+		# 'waiting' to be found, then 'routing'
+		self.state = 'waiting'
+		self.route_started = None
+
+	def dest(self):
+		return self.route[self.leg % len(self.route)]
+
+def distance_ahead(sim, edge, offset, targets):
+	"""How far it is from offset along edge to any of the targets, following
+	the switches as they're set, or None if they're not within SEARCH_MM."""
+	distance = edge.dist - offset
+	node = edge.dest
+	while node is not None and distance <= SEARCH_MM:
+		if node in targets: return distance
+		edge = sim.next_edge(node)
+		if edge is None: return None
+		distance += edge.dist
+		node = edge.dest
+	return None
+
+def stop_error(sim, train, dest):
+	"""Signed distance from where the train stopped to dest: positive if it
+	overshot, negative if it stopped short, or None if it isn't nearby."""
+	targets = (dest, dest.reverse)
+	short = distance_ahead(sim, train.edge, train.offset, targets)
+	over = distance_ahead(sim, train.edge.reverse, train.edge.dist - train.offset, targets)
+	candidates = []
+	if short is not None: candidates.append(-short)
+	if over is not None: candidates.append(over)
+	if not candidates: return None
+	return min(candidates, key=abs)
+
+def percentile(values, p):
+	if not values: return None
+	values = sorted(values)
+	return values[min(len(values) - 1, max(0, int(math.ceil(p * len(values))) - 1))]
+
+def mean(values):
+	return sum(values) / len(values) if values else None
+
+class Bench():
+	def __init__(self, scenario):
+		self.duration = 300.
+		starts, routes = {}, {}
+		for words in scenario.extra:
+			if words[0] == 'duration': self.duration = float(words[1])
+			elif words[0] == 'start': starts[int(words[1])] = int(words[2])
+			elif words[0] == 'route': routes[int(words[1])] = words[2:]
+			else: raise simulator.ScenarioError("unknown scenario line '%s'" % ' '.join(words))
+
+		self.sim = simulator.Simulator(scenario)
+		self.sim.listeners.append(self.on_event)
+		self.trains = {}
+		for (num, route) in routes.items():
+			if num not in scenario.trains: raise simulator.ScenarioError("route for missing train %d" % num)
+			for name in route: self.sim.node(name)
+			self.trains[num] = BenchTrain(num, starts.get(num, DEFAULT_START_SPEED), route)
+
+		self.booted = False
+		# commands for the console
+		self.typed = []
+		self.stop_errors = []
+		self.routes_finished = 0
+		self.routes_abandoned = 0
+		self.collisions = 0
+		self.dead_ends = 0
+		self.stats = None
+
+	def type(self, line):
+		self.typed.append(line + '\r')
+
+	def send_route(self, train):
+		train.state = 'routing'
+		train.route_started = self.sim.t
+		self.type('route %d %s' % (train.num, train.dest()))
+
+	def next_leg(self, train):
+		train.leg += 1
+		self.send_route(train)
+
+	def on_event(self, fields):
+		kind = fields['event']
+		if kind == 'collision': self.collisions += 1
+		elif kind == 'dead_end': self.dead_ends += 1
+		elif kind == 'stop' and fields['train'] in self.trains:
+			train = self.trains[fields['train']]
+			if train.state != 'routing': return
+			error = stop_error(self.sim, self.sim.trains[train.num], self.sim.node(train.dest()))
+			# otherwise, it's probably just waiting for track
+			if error is not None and abs(error) <= ARRIVAL_MM:
+				self.stop_errors.append(error)
+				self.routes_finished += 1
+				self.next_leg(train)
+
+	def on_telemetry(self, records):
+		for record in records:
+			if isinstance(record, telemetry.Stats):
+				self.stats = record
+			elif isinstance(record, telemetry.Train) and record.node is not None:
+				train = self.trains.get(record.train)
+				if train is not None and train.state == 'waiting':
+					self.send_route(train)
+
+	def tick(self):
+		"""Returns what to type at the console next."""
+		if not self.booted and self.sim.t >= BOOT_SECONDS:
+			self.booted = True
+			self.type('tm %d' % TELEMETRY_HZ)
+			for num in sorted(self.trains):
+				self.type('tr %d %d' % (num, self.trains[num].start_speed))
+		for num in sorted(self.trains):
+			train = self.trains[num]
+			if train.state == 'routing' and self.sim.t - train.route_started > ROUTE_TIMEOUT:
+				self.routes_abandoned += 1
+				self.next_leg(train)
+		typed, self.typed = ''.join(self.typed), []
+		return typed
+
+	def results(self, name):
+		minutes = self.sim.t / 60
+		reactions = [r * 1000 for r in self.sim.reaction_times]
+		stats = self.stats
+		def rounded(v): return None if v is None else round(v, 1)
+		return {
+			'scenario': name,
+			'duration_s': round(self.sim.t, 1),
+			'routes_finished': self.routes_finished,
+			'routes_abandoned': self.routes_abandoned,
+			'trains_per_hour': rounded(self.routes_finished / (minutes / 60)) if minutes > 0 else None,
+			'stop_error_mm': {
+				'mean': rounded(mean(self.stop_errors)),
+				'mean_abs': rounded(mean([abs(e) for e in self.stop_errors])),
+				'p99_abs': rounded(percentile([abs(e) for e in self.stop_errors], 0.99)),
+			},
+			'conflicts': stats.conflicts if stats else None,
+			'conflicts_per_min': rounded(stats.conflicts / minutes) if stats and minutes > 0 else None,
+			'deadlocks': stats.deadlocks if stats else None,
+			'sensor_to_command_ms': {
+				'samples': len(reactions),
+				'mean': rounded(mean(reactions)),
+				'p99': rounded(percentile(reactions, 0.99)),
+			},
+			'idle_permille': stats.idle_permille if stats else None,
+			'collisions': self.collisions,
+			'dead_ends': self.dead_ends,
+		}
+
+def make_pipe(path):
+	for suffix in ('.in', '.out'):
+		os.mkfifo(path + suffix)
+	return simulator.PipeConn(path)
+
+def run(kernel, bench):
+	tmp = tempfile.mkdtemp(prefix='bench')
+	com1, com2 = os.path.join(tmp, 'com1'), os.path.join(tmp, 'com2')
+	com1_conn, com2_conn = make_pipe(com1), make_pipe(com2)
+	devnull = open(os.devnull, 'w')
+	qemu = subprocess.Popen([QEMU_SCRIPT, 'bench', kernel, com1, com2], stdout=devnull, stderr=devnull)
+	decoder = telemetry.Decoder()
+	sim = bench.sim
+	start = time.time()
+	try:
+		while sim.t < bench.duration:
+			if qemu.poll() is not None: raise SystemExit("qemu exited with %d" % qemu.returncode)
+			readable, _, _ = select.select([com1_conn, com2_conn], [], [], simulator.STEP_SECONDS)
+			sim.advance_to(time.time() - start)
+			if com1_conn in readable:
+				sim.feed(com1_conn.read())
+			if com2_conn in readable:
+				_, records = decoder.feed(bytes(com2_conn.read()))
+				bench.on_telemetry(records)
+			out = sim.take_output()
+			if out: com1_conn.write(out)
+			typed = bench.tick()
+			if typed: com2_conn.write(typed.encode('ascii'))
+	finally:
+		qemu.terminate()
+		qemu.wait()
+		shutil.rmtree(tmp)
+
+def main(args):
+	if len(args) < 2: raise SystemExit("usage: bench.py KERNEL SCENARIO [--out results.json]")
+	kernel, scenario_path = args[0], args[1]
+	out = sys.stdout
+	if args[2:4] and args[2] == '--out': out = open(args[3], 'w')
+	with open(scenario_path) as f: scenario = simulator.Scenario.parse(f)
+
+	bench = Bench(scenario)
+	run(kernel, bench)
+	results = bench.results(os.path.basename(scenario_path))
+	json.dump(results, out, indent=2, sort_keys=True)
+	out.write('\n')
+	missing = [key for key in STATS_KEYS if results[key] is None]
+	if missing: raise SystemExit("no stats telemetry received: %s are null" % ', '.join(missing))
+
+if __name__ == '__main__':
+	main(sys.argv[1:])
@@ -116,6 +116,7 @@ def main():
 	last_time = [time.time()]
 	last_sensor_poll = [0]
 	FPS = 30.
+	ground_truth = open('ground_truth.csv', 'w')
 	def my_draw(da, cr):
 		(typ, a1, a2) = conn.next_cmd()
 		if typ is None: pass
@@ -131,6 +132,11 @@ def main():
 		for train in trains:
 			for _ in range(0, num_steps): train.update()
 			train.draw(n_pos, da, cr)
+			# same layout as the train records from telemetry.py, timed in host
+			# ticks, which is what telemetry.py converts live records to
+			ground_truth.write('truth,%d,%d,%s,%d,%d\n' % (int(cur_time * 100),
+				train.num, train.edge.src.name, train.edge.src.edge.index(train.edge),
+				train.edge_dist))
 			cr.move_to(10., 10.)
 			cr.set_source_rgb(0., 0., 0.)
 			cr.set_font_size(12)
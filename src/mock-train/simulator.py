@@ -0,0 +1,419 @@
+#!/usr/bin/python
+# Headless, scriptable simulator of the train set.
+#
+# Unlike main.py, this needs no display and models the trains' physics:
+# per-train velocity profiles, acceleration and deceleration, sensors which
+# fire with some latency, and sensors which misfire or fail to fire.
+#
+# Usage:
+#     simulator.py SCENARIO [--connect host:port] [--pipe path]
+#                  [--events out.jsonl] [--duration seconds] [--pid pid]
+#
+# With --connect (the COM1 telnet socket from `scripts/qemu run`, i.e.
+# localhost:1230) or --pipe (the COM1 pipe from `scripts/qemu sim`), the
+# simulator plays the part of the train controller for a running program, in
+# real time. Without either, it just runs the commands in the scenario's
+# `at` lines, which is entirely deterministic.
+#
+# The pipe never reaches end of file, since it has to be held open for writing
+# too, so --pipe needs either --duration or --pid, the process id of QEMU: the
+# simulator stops when that process exits.
+#
+# Everything that happens to the trains is logged as JSON lines, so runs can be
+# checked by scripts.
+#
+# Scenario files are made of lines like these:
+#
+#     seed 42                 # for the random number generator
+#     track a                 # a or b
+#     latency 8 3             # sensor latency mean and stddev, in ms
+#     spurious 0.001          # chance per sensor poll of a spurious trip
+#     missed 0.01             # chance that a train passing a sensor isn't seen
+#     dead C13                # a sensor which never fires
+#     train 58 A1 100         # a train, with its pickup 100 mm past A1
+#     profile 58 0 10 40 ...  # its velocity in mm/s at speeds 0 to 14
+#     accel 58 120 180        # its acceleration and deceleration, in mm/s^2
+#     at 1.5 tr 58 10         # scripted commands, at the given time in seconds:
+#     at 3 rv 58              #   tr, rv, sw <n> s|c, and poll
+#     at 4 sw 11 c
+#     at 5 poll
+from __future__ import print_function, division
+import errno
+import json
+import os
+import random
+import select
+import socket
+import sys
+import time
+
+# use the generated track data directly, so this never goes stale
+sys.path.insert(0, os.path.join(os.path.dirname(os.path.abspath(__file__)), '..', '..', 'track'))
+import track
+
+# 2400 baud, with 8 data bits and 2 stop bits
+BYTE_SECONDS = 11 / 2400.
+STEP_SECONDS = 0.001
+SENSOR_BYTES = 10
+# trains closer than this on the same piece of track have collided
+COLLISION_MM = 50
+# commands sent this soon after a sensor dump with a trip in it are counted as
+# reactions to it
+REACTION_SECONDS = 0.5
+
+DEFAULT_PROFILE = [0, 10, 40, 80, 120, 160, 200, 250, 300, 350, 400, 450, 500, 550, 600]
+DEFAULT_ACCEL = 120.
+DEFAULT_DECEL = 180.
+
+class ScenarioError(Exception): pass
+
+class TrainSpec():
+	def __init__(self, num, node, offset):
+		self.num, self.node, self.offset = num, node, offset
+		self.profile = list(DEFAULT_PROFILE)
+		self.accel, self.decel = DEFAULT_ACCEL, DEFAULT_DECEL
+
+class Scenario():
+	def __init__(self):
+		self.seed = 0
+		self.track = 'a'
+		self.latency = (8., 3.)
+		self.spurious = 0.
+		self.missed = 0.
+		self.dead = set()
+		self.trains = {}
+		# (time, command words)
+		self.commands = []
+		# lines which the simulator doesn't know about, for other tools
+		self.extra = []
+
+	@staticmethod
+	def parse(lines):
+		s = Scenario()
+		for (lineno, line) in enumerate(lines, 1):
+			words = line.split('#')[0].split()
+			if not words: continue
+			try:
+				s._parse_line(words)
+			except (ValueError, IndexError, KeyError):
+				raise ScenarioError("line %d: can't parse '%s'" % (lineno, line.strip()))
+		return s
+
+	def _parse_line(self, w):
+		cmd = w[0]
+		if cmd == 'seed': self.seed = int(w[1])
+		elif cmd == 'track': self.track = w[1].lower()
+		elif cmd == 'latency': self.latency = (float(w[1]), float(w[2]))
+		elif cmd == 'spurious': self.spurious = float(w[1])
+		elif cmd == 'missed': self.missed = float(w[1])
+		elif cmd == 'dead': self.dead.add(w[1])
+		elif cmd == 'train':
+			self.trains[int(w[1])] = TrainSpec(int(w[1]), w[2], int(w[3]) if len(w) > 3 else 0)
+		elif cmd == 'profile':
+			profile = [float(v) for v in w[2:]]
+			if len(profile) != 15: raise ValueError()
+			self.trains[int(w[1])].profile = profile
+		elif cmd == 'accel':
+			spec = self.trains[int(w[1])]
+			spec.accel, spec.decel = float(w[2]), float(w[3])
+		elif cmd == 'at': self.commands.append((float(w[1]), w[2:]))
+		else: self.extra.append(w)
+
+def command_bytes(words):
+	"""Converts a scripted command into what the program would send."""
+	if words[0] == 'tr': return bytearray([int(words[2]), int(words[1])])
+	if words[0] == 'rv': return bytearray([15, int(words[1])])
+	if words[0] == 'sw': return bytearray([0x21 if words[2] == 's' else 0x22, int(words[1]), 0x20])
+	if words[0] == 'poll': return bytearray([0x85])
+	raise ValueError(words[0])
+
+class Train():
+	def __init__(self, sim, spec):
+		self.sim = sim
+		self.num = spec.num
+		node = sim.node(spec.node)
+		self.edge = node.edge[0]
+		self.offset = 0.
+		self.profile, self.accel, self.decel = spec.profile, spec.accel, spec.decel
+		self.speed = 0
+		self.velocity = 0.
+		self.stopping = False
+		self.move(spec.offset)
+
+	def position(self):
+		return {'node': self.edge.src.name, 'offset': int(round(self.offset))}
+
+	def step(self, dt):
+		target = self.profile[self.speed] if self.sim.powered else 0.
+		if self.velocity < target:
+			self.velocity = min(target, self.velocity + self.accel * dt)
+		elif self.velocity > target:
+			self.velocity = max(target, self.velocity - self.decel * dt)
+			if self.velocity == 0 and self.stopping:
+				self.stopping = False
+				self.sim.event('stop', train=self.num, **self.position())
+		self.move(self.velocity * dt)
+
+	def move(self, distance):
+		while distance > 0:
+			remaining = self.edge.dist - self.offset
+			if distance < remaining:
+				self.offset += distance
+				return
+			distance -= remaining
+			node = self.edge.dest
+			self.sim.crossed(self, node)
+			nxt = self.sim.next_edge(node)
+			if nxt is None:
+				self.offset = self.edge.dist
+				if self.velocity > 0:
+					self.sim.event('dead_end', train=self.num, node=node.name)
+				self.velocity = 0.
+				return
+			self.edge, self.offset = nxt, 0.
+
+	def set_speed(self, speed):
+		self.stopping = speed == 0 and (self.velocity > 0 or self.speed > 0)
+		self.speed = speed
+
+	def reverse(self):
+		if self.velocity > 0:
+			self.sim.event('reverse_while_moving', train=self.num, velocity=self.velocity)
+		self.offset = self.edge.dist - self.offset
+		self.edge = self.edge.reverse
+
+class Simulator():
+	def __init__(self, scenario, events=None):
+		self.scenario = scenario
+		self.rng = random.Random(scenario.seed)
+		self.track = track.init_trackb() if scenario.track == 'b' else track.init_tracka()
+		self.by_name = dict((n.name, n) for n in self.track)
+		for name in scenario.dead: self.node(name)
+		self.t = 0.
+		self.powered = True
+		self.events = events
+		# called with each event's fields
+		self.listeners = []
+		self.inbuf = bytearray()
+		# (time due, byte), in order
+		self.outbuf = []
+		# (time due, sensor) for sensors which have been hit, but haven't fired yet
+		self.pending_trips = []
+		self.latched = set()
+		self.colliding = set()
+		# when the last sensor dump with a trip in it finished sending
+		self.reported_at = None
+		# seconds from sensor dumps with trips to the commands which follow
+		self.reaction_times = []
+		self.trains = dict((num, Train(self, spec)) for (num, spec) in scenario.trains.items())
+
+	def node(self, name):
+		if name not in self.by_name: raise ScenarioError("no track node %s" % name)
+		return self.by_name[name]
+
+	def event(self, kind, **fields):
+		fields['t'] = round(self.t, 4)
+		fields['event'] = kind
+		if self.events is not None:
+			self.events.write(json.dumps(fields, sort_keys=True) + '\n')
+		for listener in self.listeners:
+			listener(fields)
+
+	def next_edge(self, node):
+		if node is None or node.typ == track.NODE_EXIT: return None
+		if node.typ == track.NODE_BRANCH: return node.edge[node.switch_direction]
+		return node.edge[track.DIR_AHEAD]
+
+	def crossed(self, train, node):
+		if node is None or node.typ != track.NODE_SENSOR: return
+		self.event('sensor', train=train.num, sensor=node.name)
+		if node.name in self.scenario.dead or self.rng.random() < self.scenario.missed:
+			self.event('missed', train=train.num, sensor=node.name)
+			return
+		mean, stddev = self.scenario.latency
+		latency = max(0., self.rng.gauss(mean, stddev)) / 1000.
+		self.pending_trips.append((self.t + latency, node.num))
+
+	def advance_to(self, t):
+		while self.t + STEP_SECONDS <= t:
+			self.t += STEP_SECONDS
+			for num in sorted(self.trains):
+				self.trains[num].step(STEP_SECONDS)
+			due = [s for (when, s) in self.pending_trips if when <= self.t]
+			self.pending_trips = [(when, s) for (when, s) in self.pending_trips if when > self.t]
+			self.latched.update(due)
+			self.check_collisions()
+
+	def check_collisions(self):
+		trains = [self.trains[num] for num in sorted(self.trains)]
+		for (i, a) in enumerate(trains):
+			for b in trains[i + 1:]:
+				if b.edge is a.edge: apart = abs(a.offset - b.offset)
+				elif b.edge is a.edge.reverse: apart = abs(a.offset - (a.edge.dist - b.offset))
+				else: apart = None
+				pair = (a.num, b.num)
+				if apart is not None and apart < COLLISION_MM:
+					if pair not in self.colliding:
+						self.colliding.add(pair)
+						self.event('collision', trains=list(pair), **a.position())
+				else:
+					self.colliding.discard(pair)
+
+	def send(self, data):
+		start = max([self.t] + [when for (when, _) in self.outbuf[-1:]])
+		for (i, b) in enumerate(bytearray(data)):
+			self.outbuf.append((start + (i + 1) * BYTE_SECONDS, b))
+
+	def take_output(self):
+		ready = bytearray(b for (when, b) in self.outbuf if when <= self.t)
+		self.outbuf = [(when, b) for (when, b) in self.outbuf if when > self.t]
+		return ready
+
+	def sensor_dump(self, modules):
+		if self.rng.random() < self.scenario.spurious:
+			sensor = self.rng.randrange(SENSOR_BYTES * 8)
+			self.latched.add(sensor)
+			self.event('spurious', sensor=sensor)
+		dump = bytearray(SENSOR_BYTES)
+		for sensor in self.latched:
+			dump[sensor // 8] |= 0x80 >> (sensor % 8)
+		self.latched = set(s for s in self.latched if s >= modules * 16)
+		return dump[:modules * 2]
+
+	def commanded(self):
+		if self.reported_at is not None and self.reported_at <= self.t:
+			if self.t - self.reported_at <= REACTION_SECONDS:
+				self.reaction_times.append(self.t - self.reported_at)
+			self.reported_at = None
+
+	def train(self, num):
+		if num not in self.trains:
+			self.event('unknown_train', train=num)
+			return None
+		return self.trains[num]
+
+	def set_switch(self, num, direction):
+		for node in self.track:
+			if node.typ == track.NODE_BRANCH and node.num == num:
+				node.switch_direction = direction
+				return
+		self.event('unknown_switch', switch=num)
+
+	def feed(self, data):
+		self.inbuf += bytearray(data)
+		while self.inbuf:
+			b = self.inbuf[0]
+			need = 2 if b < 0x20 or b in (0x21, 0x22) else 1
+			if len(self.inbuf) < need: return
+			arg = self.inbuf[1] if need == 2 else None
+			self.inbuf = self.inbuf[need:]
+			if b < 0x20 or b in (0x21, 0x22): self.commanded()
+			if b < 0x20:
+				train = self.train(arg)
+				if train is None: continue
+				if b & 0xf == 15: train.reverse()
+				else: train.set_speed(b & 0xf)
+			elif b in (0x21, 0x22): self.set_switch(arg, track.DIR_STRAIGHT if b == 0x21 else track.DIR_CURVED)
+			elif b == 0x20: pass # solenoid off
+			elif 0x81 <= b <= 0x85:
+				dump = self.sensor_dump(b - 0x80)
+				self.send(dump)
+				if any(dump): self.reported_at = self.outbuf[-1][0]
+			elif b == 0x60: self.powered = True
+			elif b == 0x61: self.powered = False
+			elif b == 0xc0: pass # reset mode on
+			else: self.event('unknown_byte', byte=b)
+
+class TelnetConn():
+	"""QEMU's telnet server, with just enough of telnet to get by."""
+	IAC = 0xff
+	def __init__(self, host, port):
+		self.sock = socket.create_connection((host, port))
+		self.pending = bytearray()
+	def fileno(self): return self.sock.fileno()
+	def read(self):
+		self.pending += bytearray(self.sock.recv(4096))
+		data = bytearray()
+		while self.pending:
+			b = self.pending[0]
+			if b != self.IAC:
+				data.append(b)
+				self.pending = self.pending[1:]
+			elif len(self.pending) < 2: break
+			elif self.pending[1] == self.IAC:
+				data.append(b)
+				self.pending = self.pending[2:]
+			elif self.pending[1] >= 251: # WILL, WONT, DO, DONT take an option
+				if len(self.pending) < 3: break
+				self.pending = self.pending[3:]
+			else:
+				self.pending = self.pending[2:]
+		return data
+	def write(self, data):
+		self.sock.sendall(bytes(bytearray(data).replace(b'\xff', b'\xff\xff')))
+
+class PipeConn():
+	"""A QEMU pipe chardev: it reads path.in, and writes path.out.
+
+	Both are opened read-write, like QEMU does, so that neither side blocks
+	waiting for the other to start. That also means reads never see end of
+	file, so whoever uses this has to notice QEMU exiting some other way."""
+	def __init__(self, path):
+		self.out = os.open(path + '.in', os.O_RDWR)
+		self.inp = os.open(path + '.out', os.O_RDWR)
+	def fileno(self): return self.inp
+	def read(self): return bytearray(os.read(self.inp, 4096))
+	def write(self, data): os.write(self.out, bytes(data))
+
+def process_alive(pid):
+	try: os.kill(pid, 0)
+	except OSError as e: return e.errno == errno.EPERM
+	return True
+
+def run_realtime(sim, conn, duration, pid):
+	start = time.time()
+	while duration is None or sim.t < duration:
+		if pid is not None and not process_alive(pid): break
+		readable, _, _ = select.select([conn], [], [], STEP_SECONDS)
+		sim.advance_to(time.time() - start)
+		if readable:
+			data = conn.read()
+			if not data: break
+			sim.feed(data)
+		out = sim.take_output()
+		if out: conn.write(out)
+
+def run_scripted(sim, duration):
+	for (when, words) in sorted(sim.scenario.commands, key=lambda c: c[0]):
+		sim.advance_to(when)
+		sim.feed(command_bytes(words))
+		sim.take_output()
+	sim.advance_to(duration)
+
+def main(args):
+	if not args: raise SystemExit(__doc__ if __doc__ else "usage: simulator.py SCENARIO [options]")
+	with open(args.pop(0)) as f: scenario = Scenario.parse(f)
+	conn, events, duration, pid = None, sys.stdout, None, None
+	while args:
+		arg = args.pop(0)
+		if arg == '--connect':
+			host, port = args.pop(0).split(':')
+			conn = TelnetConn(host, int(port))
+		elif arg == '--pipe': conn = PipeConn(args.pop(0))
+		elif arg == '--events': events = open(args.pop(0), 'w')
+		elif arg == '--duration': duration = float(args.pop(0))
+		elif arg == '--pid': pid = int(args.pop(0))
+		else: raise SystemExit("unknown argument %s" % arg)
+	if isinstance(conn, PipeConn) and duration is None and pid is None:
+		raise SystemExit("--pipe never sees QEMU exit; give --duration or --pid too")
+
+	sim = Simulator(scenario, events)
+	if conn is not None:
+		run_realtime(sim, conn, duration, pid)
+	else:
+		last = max([0.] + [when for (when, _) in scenario.commands])
+		run_scripted(sim, duration if duration is not None else last + 10.)
+	sim.event('end', trains=dict((str(num), t.position()) for (num, t) in sim.trains.items()))
+
+if __name__ == '__main__':
+	main(sys.argv[1:])
@@ -0,0 +1,229 @@
+#!/usr/bin/python
+# Decoder for the binary telemetry the train program mixes into its COM2
+# output. See src/user/telemetrysrv.h for the format.
+#
+# Usage:
+#     telemetry.py [--track a|b] [--csv out.csv] [file | host:port]
+#
+# Reads from the QEMU COM2 telnet socket (localhost:1231) by default, or a
+# capture file, and logs the decoded records as CSV. With --csv, the console
+# output is written through to stdout, so this can stand in for the terminal.
+#
+# main.py logs the simulated trains to ground_truth.csv in the same format,
+# so the two can be graphed against each other. The kernel's clock starts
+# whenever it boots, so when reading from a socket, record times are
+# converted to host time in ticks (time.time() * 100), which the ground
+# truth also uses. Times read from a capture file are left as kernel ticks.
+from __future__ import print_function
+import base64
+import socket
+import struct
+import sys
+import time
+from collections import namedtuple
+
+import track
+
+VERSION = 1
+
+RECORD_TRAIN = 1
+RECORD_ATTRIBUTION = 2
+RECORD_RESERVATIONS = 3
+RECORD_STATS = 4
+
+APC_START = b'\x1b_T'
+APC_END = b'\x1b\\'
+
+Header = namedtuple('Header', 'version type seq time')
+Train = namedtuple('Train', 'header train speed node edge displacement velocity stddev error stopping_distance')
+Attribution = namedtuple('Attribution', 'header sensor train')
+Reservations = namedtuple('Reservations', 'header owners')
+Stats = namedtuple('Stats', 'header idle_permille conflicts deadlocks victims')
+
+def crc16(data):
+	crc = 0xffff
+	for b in bytearray(data):
+		crc ^= b << 8
+		for _ in range(8):
+			crc = ((crc << 1) ^ 0x1021) if crc & 0x8000 else crc << 1
+			crc &= 0xffff
+	return crc
+
+class FrameError(Exception): pass
+
+def decode_frame(frame):
+	if len(frame) < 12: raise FrameError("short frame")
+	(crc,) = struct.unpack('<H', frame[-2:])
+	if crc16(frame[:-2]) != crc: raise FrameError("bad crc")
+	version, typ, seq, time, length = struct.unpack('<BBHIH', frame[:10])
+	if version != VERSION: raise FrameError("unknown version %d" % version)
+	payload = frame[10:-2]
+	if len(payload) != length: raise FrameError("bad length")
+	header = Header(version, typ, seq, time)
+	if typ == RECORD_TRAIN:
+		fields = struct.unpack('<BBHBhiHiH', payload)
+		node = None if fields[2] == 0xffff else fields[2]
+		return Train(header, fields[0], fields[1], node, *fields[3:])
+	elif typ == RECORD_ATTRIBUTION:
+		sensor, train = struct.unpack('<Bb', payload)
+		return Attribution(header, sensor, train)
+	elif typ == RECORD_RESERVATIONS:
+		return Reservations(header, list(bytearray(payload)))
+	elif typ == RECORD_STATS:
+		return Stats(header, *struct.unpack('<HIII', payload))
+	raise FrameError("unknown record type %d" % typ)
+
+def encode_frame(typ, seq, time, payload):
+	frame = struct.pack('<BBHIH', VERSION, typ, seq, time, len(payload)) + payload
+	frame += struct.pack('<H', crc16(frame))
+	return APC_START + base64.b64encode(frame) + APC_END
+
+class Decoder():
+	"""Splits a COM2 byte stream into console output and telemetry records.
+
+	Frames may be split across calls to feed. Frames which fail their CRC are
+	counted in self.errors and skipped, as are gaps in the sequence numbers in
+	self.dropped."""
+	def __init__(self):
+		self.buf = b''
+		self.errors = 0
+		self.dropped = 0
+		self.last_seq = None
+
+	def feed(self, data):
+		self.buf += data
+		text, records = b'', []
+		while True:
+			start = self.buf.find(APC_START)
+			if start < 0:
+				# hold back anything which could be the start of a frame
+				keep = 0
+				for n in range(1, len(APC_START)):
+					if self.buf.endswith(APC_START[:n]): keep = n
+				text += self.buf[:len(self.buf) - keep]
+				self.buf = self.buf[len(self.buf) - keep:]
+				break
+			end = self.buf.find(APC_END, start)
+			text += self.buf[:start]
+			if end < 0:
+				self.buf = self.buf[start:]
+				break
+			encoded = self.buf[start + len(APC_START):end]
+			self.buf = self.buf[end + len(APC_END):]
+			try:
+				record = decode_frame(base64.b64decode(encoded))
+			except (FrameError, TypeError, ValueError, struct.error):
+				self.errors += 1
+				continue
+			seq = record.header.seq
+			if self.last_seq is not None:
+				self.dropped += (seq - self.last_seq - 1) & 0xffff
+			self.last_seq = seq
+			records.append(record)
+		return text, records
+
+class HostClock():
+	"""Maps kernel ticks onto host ticks. Frames only ever arrive late, so the
+	smallest offset seen is the best guess at the real one."""
+	def __init__(self):
+		self.offset = None
+
+	def to_host(self, kernel_ticks):
+		offset = int(time.time() * 100) - kernel_ticks
+		if self.offset is None or offset < self.offset: self.offset = offset
+		return kernel_ticks + self.offset
+
+def with_host_time(clock, record):
+	header = record.header._replace(time=clock.to_host(record.header.time))
+	return record._replace(header=header)
+
+def node_name(cur_track, index):
+	return 'unknown' if index is None else cur_track[index].name
+
+def csv_row(cur_track, record):
+	h = record.header
+	if isinstance(record, Train):
+		return 'train,%d,%d,%s,%d,%d,%d,%d,%d,%d,%d' % (h.time, record.train,
+			node_name(cur_track, record.node), record.edge, record.displacement,
+			record.velocity, record.stddev, record.error,
+			record.stopping_distance, record.speed)
+	elif isinstance(record, Attribution):
+		return 'attribution,%d,%d,%s' % (h.time, record.train, cur_track[sensor_node(cur_track, record.sensor)].name)
+	elif isinstance(record, Stats):
+		return 'stats,%d,%d,%d,%d,%d' % (h.time, record.idle_permille,
+			record.conflicts, record.deadlocks, record.victims)
+	else:
+		owned = ['%s:%d' % (cur_track[i].name, o) for (i, o) in enumerate(record.owners) if o != 0]
+		return 'reservations,%d,%s' % (h.time, ' '.join(owned))
+
+def sensor_node(cur_track, sensor):
+	for (i, node) in enumerate(cur_track):
+		if node.typ == track.NODE_SENSOR and node.num == sensor: return i
+	return None
+
+def open_stream(where):
+	if ':' in where:
+		host, port = where.split(':')
+		sock = socket.create_connection((host, int(port)))
+		return lambda: sock.recv(4096)
+	f = open(where, 'rb')
+	return lambda: f.read(4096)
+
+def main(args):
+	cur_track = track.init_tracka()
+	out = sys.stdout
+	where = 'localhost:1231'
+	while args:
+		arg = args.pop(0)
+		if arg == '--track': cur_track = track.init_trackb() if args.pop(0) == 'b' else track.init_tracka()
+		elif arg == '--csv': out = open(args.pop(0), 'w')
+		else: where = arg
+
+	read = open_stream(where)
+	clock = HostClock() if ':' in where else None
+	decoder = Decoder()
+	console = getattr(sys.stdout, 'buffer', sys.stdout)
+	while True:
+		data = read()
+		if not data: break
+		text, records = decoder.feed(data)
+		if out is not sys.stdout:
+			console.write(text)
+			console.flush()
+		for record in records:
+			if clock: record = with_host_time(clock, record)
+			print(csv_row(cur_track, record), file=out)
+	print('%d bad frames, %d dropped' % (decoder.errors, decoder.dropped), file=sys.stderr)
+
+def self_test():
+	frame = encode_frame(RECORD_TRAIN, 7, 1234, struct.pack('<BBHBhiHiH', 58, 10, 3, 0, 120, 5000, 12, -4, 800))
+	frame2 = encode_frame(RECORD_ATTRIBUTION, 8, 1240, struct.pack('<Bb', 44, -1))
+	frame3 = encode_frame(RECORD_STATS, 9, 1250, struct.pack('<HIII', 873, 12, 1, 1))
+	stream = b'hello\x1b[2J' + frame + b'world' + frame2 + frame3
+	decoder = Decoder()
+	text, records = b'', []
+	# feed a byte at a time, to check frames split across reads
+	for i in range(len(stream)):
+		t, r = decoder.feed(stream[i:i + 1])
+		text += t
+		records += r
+	assert text == b'hello\x1b[2Jworld', text
+	assert len(records) == 3 and decoder.errors == 0 and decoder.dropped == 0
+	assert records[0].train == 58 and records[0].node == 3 and records[0].error == -4
+	assert records[1].sensor == 44 and records[1].train == -1
+	assert records[2].idle_permille == 873 and records[2].conflicts == 12
+
+	clock = HostClock()
+	now = int(time.time() * 100)
+	assert abs(with_host_time(clock, records[1]).header.time - now) <= 1
+	# a frame which took longer to arrive doesn't move the clock
+	assert abs(with_host_time(clock, records[0]).header.time - (now - 6)) <= 1
+
+	corrupt = frame[:10] + (b'B' if frame[10:11] != b'B' else b'C') + frame[11:]
+	text, records = Decoder().feed(corrupt)
+	assert records == []
+	print('ok')
+
+if __name__ == '__main__':
+	if sys.argv[1:] == ['--test']: self_test()
+	else: main(sys.argv[1:])
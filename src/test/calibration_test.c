@@ -0,0 +1,90 @@
+#include "calibration_test.h"
+
+#include <assert.h>
+#include <util.h>
+#include "../user/trainsrv/calibration.h"
+
+static void test_calibration_update(void) {
+	int entry = 0;
+	unsigned char samples = 0, outliers = 0;
+
+	// the first measurement of an unknown entry is taken as-is
+	ASSERT(calibration_update(&entry, &samples, &outliers, 4000) == CALIBRATION_ACCEPTED);
+	ASSERT_INTEQ(entry, 4000);
+	ASSERT_INTEQ(samples, 1);
+
+	ASSERT(calibration_update(&entry, &samples, &outliers, 4200) == CALIBRATION_ACCEPTED);
+	ASSERT_INTEQ(entry, 4100);
+	ASSERT(calibration_update(&entry, &samples, &outliers, 4100) == CALIBRATION_ACCEPTED);
+	ASSERT_INTEQ(samples, 3);
+
+	// now that we trust the entry, wild measurements are rejected
+	ASSERT(calibration_update(&entry, &samples, &outliers, 9000) == CALIBRATION_OUTLIER);
+	ASSERT_INTEQ(entry, 4100);
+	ASSERT_INTEQ(samples, 3);
+	// a good measurement in between means they were just misreadings
+	ASSERT(calibration_update(&entry, &samples, &outliers, 4100) == CALIBRATION_ACCEPTED);
+	ASSERT(calibration_update(&entry, &samples, &outliers, 9000) == CALIBRATION_OUTLIER);
+	ASSERT(calibration_update(&entry, &samples, &outliers, 9000) == CALIBRATION_OUTLIER);
+	ASSERT_INTEQ(entry, 4100);
+
+	// the gain bottoms out, so old entries still move
+	entry = 1000;
+	samples = CALIBRATION_MAX_SAMPLES;
+	ASSERT(calibration_update(&entry, &samples, &outliers, 1100) == CALIBRATION_ACCEPTED);
+	ASSERT_INTEQ(entry, 1010);
+	ASSERT_INTEQ(samples, CALIBRATION_MAX_SAMPLES);
+
+	// however long we've known it, a train which has really changed is
+	// followed after a few measurements
+	ASSERT(calibration_update(&entry, &samples, &outliers, 1500) == CALIBRATION_OUTLIER);
+	ASSERT(calibration_update(&entry, &samples, &outliers, 1500) == CALIBRATION_OUTLIER);
+	ASSERT(calibration_update(&entry, &samples, &outliers, 1500) == CALIBRATION_ACCEPTED);
+	ASSERT_INTEQ(entry, 1500);
+	ASSERT_INTEQ(samples, 1);
+	// and the gain is back up, so it settles quickly
+	ASSERT(calibration_update(&entry, &samples, &outliers, 1600) == CALIBRATION_ACCEPTED);
+	ASSERT_INTEQ(entry, 1550);
+}
+
+static void test_calibration_blob(void) {
+	struct internal_train_state orig, loaded;
+	memset(&orig, 0, sizeof(orig));
+	orig.train_id = 62;
+	for (int i = 0; i < NUM_SPEED_SETTINGS; i++) {
+		orig.est_velocities[i] = i * 211;
+		orig.est_stopping_distances[i] = i * 29;
+		orig.velocity_samples[i] = i;
+		orig.stopping_distance_samples[i] = 255 - i;
+	}
+
+	char hex[CALIBRATION_BLOB_HEX_LEN + 1];
+	calibration_serialize(&orig, hex);
+	ASSERT_INTEQ(strlen(hex), CALIBRATION_BLOB_HEX_LEN);
+
+	memset(&loaded, 0, sizeof(loaded));
+	loaded.train_id = 62;
+	ASSERT(calibration_deserialize(&loaded, hex));
+	for (int i = 0; i < NUM_SPEED_SETTINGS; i++) {
+		ASSERT_INTEQ(orig.est_velocities[i], loaded.est_velocities[i]);
+		ASSERT_INTEQ(orig.est_stopping_distances[i], loaded.est_stopping_distances[i]);
+		ASSERT_INTEQ(orig.velocity_samples[i], loaded.velocity_samples[i]);
+		ASSERT_INTEQ(orig.stopping_distance_samples[i], loaded.stopping_distance_samples[i]);
+	}
+
+	// blobs for other trains don't load
+	loaded.train_id = 58;
+	ASSERT(!calibration_deserialize(&loaded, hex));
+
+	// corrupted blobs don't load
+	loaded.train_id = 62;
+	hex[20] = (hex[20] == '0') ? '1' : '0';
+	ASSERT(!calibration_deserialize(&loaded, hex));
+	hex[20] = '\0';
+	ASSERT(!calibration_deserialize(&loaded, hex));
+}
+
+void calibration_tests(void) {
+	test_calibration_update();
+	test_calibration_blob();
+}
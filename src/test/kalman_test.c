@@ -0,0 +1,62 @@
+#include "kalman_test.h"
+
+#include <assert.h>
+#include <util.h>
+#include "../user/trainsrv/kalman.h"
+
+// A train which actually goes 200 micrometers per tick faster than the model
+// says should have the filter pick up the difference, and get more certain
+// of its position as it hits sensors.
+void kalman_tests(void) {
+	struct kalman_state k;
+	kalman_init(&k, 0, 20, 500);
+	const int bias = 200;
+	const int sensor_spacing = 100; // ticks between sensors
+
+	int last_stddev = 0x7fffffff;
+	for (int i = 1; i <= 20; i++) {
+		const int now = i * sensor_spacing;
+		kalman_predict(&k, now, &k);
+		ASSERT_INTEQ(k.time, now);
+		const int stddev_before = kalman_position_stddev(&k);
+
+		// the model thinks the train covered model_distance, but it went
+		// bias * dt further; the filter already accounts for k.offset of that
+		const int innovation = bias * sensor_spacing - k.offset;
+		kalman_update(&k, innovation, 20);
+		ASSERT(kalman_position_stddev(&k) <= stddev_before);
+		if (i > 5) {
+			ASSERT(stddev_before <= last_stddev);
+		}
+		last_stddev = stddev_before;
+
+		// reanchor at the sensor
+		k.offset -= bias * sensor_spacing;
+	}
+	ASSERTF(abs(k.velocity - bias) < bias / 10, "velocity correction %d, expected ~%d", k.velocity, bias);
+
+	// a speed change makes us less sure about the velocity, and so the position
+	struct kalman_state before, after;
+	kalman_predict(&k, 2100, &before);
+	kalman_velocity_changed(&k, 1000);
+	kalman_predict(&k, 2100, &after);
+	ASSERT(kalman_position_stddev(&after) > kalman_position_stddev(&before));
+
+	// once the train has stopped, we don't get any less sure of where it is
+	kalman_velocity_changed(&k, 5000 / 4);
+	kalman_stops_at(&k, 2300);
+	struct kalman_state stopped, parked;
+	kalman_predict(&k, 3000, &stopped);
+	kalman_predict(&k, 8100, &parked);
+	ASSERT_INTEQ(kalman_position_stddev(&parked), kalman_position_stddev(&stopped));
+	ASSERT_INTEQ(parked.p11, 0);
+	ASSERT_INTEQ(parked.p01, 0);
+	ASSERT_INTEQ(parked.offset, stopped.offset);
+	// it only grew while the train was still moving
+	ASSERTF(kalman_position_stddev(&parked) < 400, "stddev %d", kalman_position_stddev(&parked));
+	// and predicting in steps gets the same answer, give or take rounding
+	kalman_predict(&k, 2200, &k);
+	kalman_predict(&k, 2500, &k);
+	kalman_predict(&k, 8100, &k);
+	ASSERT_INTEQ(kalman_position_stddev(&k), kalman_position_stddev(&parked));
+}
@@ -7,10 +7,18 @@
 #include <util.h>
 
 #include "min_heap.h"
+#include "memcpy_test.h"
 #include "track_test.h"
 #include "sensor_attribution_test.h"
 #include "astar_test.h"
 #include "clockserver_test.h"
+#include "timer_wheel_test.h"
+#include "calibration_test.h"
+#include "kalman_test.h"
+#include "polymath_test.h"
+#include "motion_plan_test.h"
+#include "reliability_test.h"
+#include "screen_test.h"
 
 #include "../user/sys.h"
 #include "../user/signal.h"
@@ -24,48 +32,6 @@ void child(void) {
 void nop(void) {
 }
 
-void memcpy_tests(void) {
-	const unsigned bufsz = 80;
-	unsigned char buf_a[bufsz], buf_b[bufsz];
-	unsigned i, offset_a, offset_b, len;
-
-	for (i = 0; i < bufsz; i++) {
-		buf_a[i] = i;
-	}
-
-	for (offset_a = 0; offset_a < 3; offset_a++) {
-		for (offset_b = 0; offset_b < 3; offset_b++) {
-			len = bufsz - ((offset_a > offset_b) ? offset_a : offset_b);
-			memcpy(buf_b + offset_b, buf_a + offset_a, len);
-			for (i = 0; i < len; i++) {
-				ASSERT(buf_b[i + offset_b] == i + offset_a);
-			}
-		}
-	}
-}
-
-void memset_tests(void) {
-	const unsigned bufsz = 80;
-	unsigned char buf[bufsz];
-	const char init = '\0';
-	const char filler = '@';
-
-	for (int lo = 0; lo < bufsz; lo++) {
-		for (int hi = lo; hi < bufsz; hi++) {
-			int len = hi - lo + 1;
-
-			// naive memset to clear out the memory
-			for (int i = 0; i < bufsz; i++) buf[i] = init;
-
-			memset(buf + lo, filler, len);
-			for (int i = 0; i < bufsz; i++) {
-				const char expected = (lo <= i && i <= hi) ? filler : init;
-				ASSERTF(buf[i] == expected, "buf[%d] = %d != %d", i, buf[i], expected);
-			}
-		}
-	}
-}
-
 void sqrti_tests(void) {
 	for (unsigned n = 0; n < 1000; n++) {
 		unsigned m = sqrti(n);
@@ -269,6 +235,13 @@ void init_task(void) {
 	sqrti_tests();
 	powi_tests();
 	min_heap_tests();
+	timer_wheel_tests();
+	calibration_tests();
+	kalman_tests();
+	polymath_tests();
+	motion_plan_tests();
+	reliability_tests();
+	screen_tests();
 	/* curve_scaling_tests(); */
 	track_tests();
 	sensor_attribution_tests();
@@ -0,0 +1,101 @@
+#include "memcpy_test.h"
+
+#include <assert.h>
+#include <util.h>
+
+// Long enough to cover the burst loops a few times over, plus their tails
+#define MAX_LEN 160
+// room for a guard on either side, and for every alignment
+#define BUFSZ (MAX_LEN + 16)
+
+// What a byte at index i in the source buffer is, so that a byte copied from
+// the wrong place is always noticed
+static unsigned char src_byte(int i) {
+	return (i * 7 + 3) & 0xff;
+}
+
+static void check_copy(const unsigned char *dst_buf, int dst_offset, int src_offset, int len) {
+	for (int i = 0; i < BUFSZ; i++) {
+		const bool copied = dst_offset <= i && i < dst_offset + len;
+		const unsigned char expected = copied ? src_byte(i - dst_offset + src_offset) : 0xee;
+		ASSERTF(dst_buf[i] == expected, "memcpy(dst + %d, src + %d, %d): dst[%d] = %d != %d",
+				dst_offset, src_offset, len, i, dst_buf[i], expected);
+	}
+}
+
+// Every length up to MAX_LEN, for every alignment of the source and
+// destination, and nothing outside the destination is touched.
+static void memcpy_exhaustive_tests(void) {
+	unsigned char src[BUFSZ] __attribute__((aligned(4)));
+	unsigned char dst[BUFSZ] __attribute__((aligned(4)));
+	for (int i = 0; i < BUFSZ; i++) src[i] = src_byte(i);
+
+	for (int src_offset = 4; src_offset < 8; src_offset++) {
+		for (int dst_offset = 4; dst_offset < 8; dst_offset++) {
+			for (int len = 0; len <= MAX_LEN; len++) {
+				memset(dst, 0xee, sizeof(dst));
+				ASSERT(memcpy(dst + dst_offset, src + src_offset, len) == dst + dst_offset);
+				check_copy(dst, dst_offset, src_offset, len);
+			}
+		}
+	}
+}
+
+// The sizes which are copied inline when they're known at compile time
+static void memcpy_small_tests(void) {
+	unsigned char src[BUFSZ] __attribute__((aligned(4)));
+	unsigned char dst[BUFSZ] __attribute__((aligned(4)));
+	for (int i = 0; i < BUFSZ; i++) src[i] = src_byte(i);
+
+	for (int src_offset = 4; src_offset < 8; src_offset++) {
+		for (int dst_offset = 4; dst_offset < 8; dst_offset++) {
+			memset(dst, 0xee, sizeof(dst));
+			memcpy(dst + dst_offset, src + src_offset, 4);
+			check_copy(dst, dst_offset, src_offset, 4);
+
+			memset(dst, 0xee, sizeof(dst));
+			memcpy(dst + dst_offset, src + src_offset, 8);
+			check_copy(dst, dst_offset, src_offset, 8);
+
+			memset(dst, 0xee, sizeof(dst));
+			memcpy(dst + dst_offset, src + src_offset, 16);
+			check_copy(dst, dst_offset, src_offset, 16);
+		}
+	}
+
+	// and through a struct, which is what they're for
+	struct { int tid; void *p; } a = { 63, &a }, b = {};
+	memcpy(&b, &a, sizeof(b));
+	ASSERT(b.tid == 63 && b.p == &a);
+}
+
+void memcpy_tests(void) {
+	memcpy_exhaustive_tests();
+	memcpy_small_tests();
+}
+
+void memset_tests(void) {
+	const unsigned bufsz = 80;
+	unsigned char buf[bufsz];
+	const char init = '\0';
+	const char filler = '@';
+
+	for (int lo = 0; lo < bufsz; lo++) {
+		for (int hi = lo; hi < bufsz; hi++) {
+			int len = hi - lo + 1;
+
+			// naive memset to clear out the memory
+			for (int i = 0; i < bufsz; i++) buf[i] = init;
+
+			memset(buf + lo, filler, len);
+			for (int i = 0; i < bufsz; i++) {
+				const char expected = (lo <= i && i <= hi) ? filler : init;
+				ASSERTF(buf[i] == expected, "buf[%d] = %d != %d", i, buf[i], expected);
+			}
+		}
+	}
+
+	// only the low byte of the value counts
+	memset(buf, 0x1ab, bufsz);
+	for (int i = 0; i < bufsz; i++) ASSERT(buf[i] == 0xab);
+}
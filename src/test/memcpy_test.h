@@ -0,0 +1,4 @@
+#pragma once
+
+void memcpy_tests(void);
+void memset_tests(void);
@@ -0,0 +1,64 @@
+#include "motion_plan_test.h"
+
+#include <assert.h>
+#include <util.h>
+#include "../user/trainsrv/estimate_position.h"
+
+// train 62's velocities and stopping distances
+static const int velocities[NUM_SPEED_SETTINGS] = {0, 0, 0, 0, 0, 1150, 1150, 1825, 1825, 2350, 2350,
+	2800, 2800, 3500, 3500, 4000, 4000, 4500, 4500, 4900, 4900,
+	5400, 5400, 6000, 6000, 6100, 6100, 5900};
+static const int stopping_distances[NUM_SPEED_SETTINGS] = {0, 0, 0, 0, 0, 189, 189, 189, 189, 260, 260, 330,
+	330, 389, 389, 447, 447, 500, 500, 559, 559, 635, 635, 700, 700,
+	816, 816, 812};
+
+static void init_train(struct internal_train_state *train) {
+	memset(train, 0, sizeof(*train));
+	memcpy(train->est_velocities, velocities, sizeof(velocities));
+	memcpy(train->est_stopping_distances, stopping_distances, sizeof(stopping_distances));
+}
+
+void motion_plan_tests(void) {
+	train_models_init();
+	struct internal_train_state train;
+	init_train(&train);
+	struct motion_plan plan;
+
+	// long moves get up to the fastest speed, and stop from it
+	train_plan_motion(&train, 10000, 14, &plan);
+	ASSERT_INTEQ(plan.speed, 12);
+	ASSERT(!plan.short_move);
+	ASSERT_INTEQ(plan.stop_lead, 700);
+	ASSERT(plan.stop_time < plan.duration);
+
+	// unless we're told not to go that fast
+	train_plan_motion(&train, 10000, 8, &plan);
+	ASSERT_INTEQ(plan.speed, 8);
+	ASSERT_INTEQ(plan.stop_lead, 447);
+
+	// short moves stop while still speeding up, so stop short of the end by
+	// less than the full stopping distance
+	train_plan_motion(&train, 300, 14, &plan);
+	ASSERT(plan.short_move);
+	ASSERT(0 < plan.stop_time && plan.stop_time < plan.duration);
+	ASSERT(0 < plan.stop_lead && plan.stop_lead < train.est_stopping_distances[plan.speed * 2 - 1]);
+
+	// further always takes longer
+	int last_duration = 0;
+	for (int distance = 10; distance < 20000; distance = distance * 3 / 2) {
+		train_plan_motion(&train, distance, 14, &plan);
+		ASSERT(plan.speed > 0);
+		ASSERTF(plan.duration > last_duration, "%d mm took %d ticks, vs %d for less",
+				distance, plan.duration, last_duration);
+		last_duration = plan.duration;
+	}
+
+	// there's nowhere to go
+	train_plan_motion(&train, 0, 14, &plan);
+	ASSERT_INTEQ(plan.speed, 0);
+
+	// and we can't plan for a train we know nothing about
+	memset(train.est_velocities, 0, sizeof(train.est_velocities));
+	train_plan_motion(&train, 1000, 14, &plan);
+	ASSERT_INTEQ(plan.speed, 0);
+}
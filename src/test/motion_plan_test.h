@@ -0,0 +1,3 @@
+#pragma once
+
+void motion_plan_tests(void);
@@ -0,0 +1,59 @@
+#include "polymath_test.h"
+
+#include <assert.h>
+#include <util.h>
+#include "../user/polymath.h"
+#include "../user/trainsrv/estimate_position.h"
+
+// The prepared polynomials round differently to the reference implementation
+// (which truncates at every step, and so is itself a few hundred units off),
+// so they're only expected to agree to about one part in 2^20.
+static void assert_close(long long actual, long long expected) {
+	const long long tolerance = 2048 + (expected < 0 ? -expected : expected) / fixed_point_scale;
+	const long long diff = actual - expected;
+	ASSERTF(-tolerance <= diff && diff <= tolerance, "%d != %d (/ 2^10)",
+			(int) (actual >> 10), (int) (expected >> 10));
+}
+
+static const long long deceleration_coefs[] = { 597828168, 0, -414289819, 231854274, -48630758, 3595593 };
+static const long long acceleration_coefs[] = { 0, 0, 119318217, -10618953, 32740221, -3109563 };
+
+static void test_against_reference(const struct polynomial *p, const long long *coefs, unsigned n) {
+	const long long step = p->end / 64;
+	for (long long x = 0; x <= p->end; x += step) {
+		assert_close(polynomial_evaluate(p, x), evaluate_polynomial_fp(x, coefs, n));
+		assert_close(polynomial_integrate(p, 0, x), integrate_polynomial(0, x, coefs, n));
+		assert_close(polynomial_integrate(p, x, p->end), integrate_polynomial(x, p->end, coefs, n));
+		assert_close(polynomial_integrate(p, x / 2, x), integrate_polynomial(x / 2, x, coefs, n));
+	}
+	assert_close(p->value_at_end, evaluate_polynomial_fp(p->end, coefs, n));
+	assert_close(p->area, integrate_polynomial(0, p->end, coefs, n));
+}
+
+// the precomputed ends should agree exactly with working them out
+static void test_precomputed_ends(const struct polynomial *p) {
+	const long long mid = p->end / 3;
+	ASSERT(polynomial_integrate(p, 0, 0) == 0);
+	ASSERT(polynomial_integrate(p, 0, mid) + polynomial_integrate(p, mid, p->end) == p->area);
+	ASSERT(polynomial_integrate(p, p->end, mid) == -polynomial_integrate(p, mid, p->end));
+	ASSERT(polynomial_evaluate(p, p->end) == p->value_at_end);
+}
+
+static void test_scale_deceleration(void) {
+	// 6 mm/tick, stopping in 957 mm
+	const long long v0 = 6 * fixed_point_scale, d = 957 * fixed_point_scale;
+	struct curve_scaling expected = scale_deceleration_curve(v0, d, deceleration_coefs,
+			ARRAY_LENGTH(deceleration_coefs), stopping_time_coef);
+	struct curve_scaling actual = polynomial_scale_deceleration(v0, d, &deceleration_model);
+	ASSERT(actual.y_scale == expected.y_scale);
+	assert_close(actual.x_scale, expected.x_scale);
+}
+
+void polymath_tests(void) {
+	train_models_init();
+	test_against_reference(&deceleration_model, deceleration_coefs, ARRAY_LENGTH(deceleration_coefs));
+	test_against_reference(&acceleration_model, acceleration_coefs, ARRAY_LENGTH(acceleration_coefs));
+	test_precomputed_ends(&deceleration_model);
+	test_precomputed_ends(&acceleration_model);
+	test_scale_deceleration();
+}
@@ -0,0 +1,92 @@
+#include "reliability_test.h"
+
+#include <assert.h>
+#include <util.h>
+#include "../user/trainsrv/reliability.h"
+
+#define C3 34
+#define E12 75
+
+static void assert_near(int actual, int expected) {
+	ASSERTF(expected - 3 <= actual && actual <= expected + 3, "%d != %d", actual, expected);
+}
+
+void reliability_tests(void) {
+	struct reliability r;
+	reliability_init(&r);
+
+	// before anything has gone wrong, everything costs the priors
+	assert_near(r.sensors[C3].missed_cost, 400);
+	assert_near(r.sensors[C3].spurious_cost, 800);
+	assert_near(reliability_wrong_switch_cost(&r, 153), 450);
+	ASSERT_INTEQ(r.unreliable_switches, 0);
+
+	// a sensor which misses half the time gets cheaper to miss
+	for (int i = 0; i < 20; i++) {
+		reliability_sensor_hit(&r, C3);
+		reliability_sensor_missed(&r, C3);
+	}
+	// 100 ln((40 + 55) / 21)
+	assert_near(r.sensors[C3].missed_cost, 151);
+	ASSERT(!reliability_sensor_blacklisted(&r, C3));
+
+	// one we've never seen a train trip might have been a train we hadn't found
+	// yet, so isn't cheaper to write off than that, however often it triggers
+	for (int i = 0; i < BLACKLIST_MIN_PHANTOMS; i++) {
+		reliability_sensor_phantom(&r, E12);
+		ASSERT(r.sensors[E12].spurious_cost > COST_UNKNOWN_TRAIN);
+	}
+	ASSERT(!reliability_sensor_blacklisted(&r, E12));
+
+	// but one which triggers on its own more than under trains gets ignored
+	reliability_init(&r);
+	for (int i = 0; i < 20; i++) {
+		reliability_sensor_hit(&r, C3);
+		reliability_sensor_missed(&r, C3);
+	}
+	reliability_sensor_hit(&r, E12);
+	for (int i = 0; i < BLACKLIST_MIN_PHANTOMS - 1; i++) {
+		reliability_sensor_phantom(&r, E12);
+	}
+	ASSERT(!reliability_sensor_blacklisted(&r, E12));
+	reliability_sensor_phantom(&r, E12);
+	ASSERT(reliability_sensor_blacklisted(&r, E12));
+	ASSERT_INTEQ(r.sensors[E12].missed_cost, 0);
+	// we can't tell if it missed, since we're not listening to it
+	reliability_sensor_missed(&r, E12);
+	ASSERT_INTEQ(r.sensors[E12].misses, 0);
+
+	// switches which keep going the wrong way are routed around
+	for (int i = 0; i < 20 && !(r.unreliable_switches & SWITCH_BIT(153)); i++) {
+		reliability_switches_traversed(&r, SWITCH_BIT(153) | SWITCH_BIT(3));
+		reliability_switch_misrouted(&r, 153);
+	}
+	ASSERT(r.unreliable_switches & SWITCH_BIT(153));
+	ASSERT(!(r.unreliable_switches & SWITCH_BIT(3)));
+	ASSERT(reliability_wrong_switch_cost(&r, 153) <= UNRELIABLE_SWITCH_COST);
+
+	// worst first, by how far below the prior each has fallen: the blacklisted
+	// sensor, then C3, then the switch, which only just got bad enough to avoid
+	struct reliability_report report;
+	reliability_report(&r, &report);
+	ASSERT_INTEQ(report.len, 3);
+	ASSERT_INTEQ(report.entries[0].failure, FAILURE_PHANTOM);
+	ASSERT_INTEQ(report.entries[0].num, E12);
+	ASSERT(report.entries[0].excluded);
+	ASSERT_INTEQ(report.entries[1].failure, FAILURE_MISSED);
+	ASSERT_INTEQ(report.entries[1].num, C3);
+	ASSERT_INTEQ(report.entries[1].failures, 20);
+	ASSERT_INTEQ(report.entries[1].trials, 40);
+	ASSERT(!report.entries[1].excluded);
+	ASSERT_INTEQ(report.entries[2].failure, FAILURE_MISROUTE);
+	ASSERT_INTEQ(report.entries[2].num, 153);
+	ASSERT(report.entries[2].excluded);
+
+	// hits still count while a sensor is blacklisted, so it can recover
+	while (r.sensors[E12].hits < r.sensors[E12].phantoms) {
+		ASSERT(reliability_sensor_blacklisted(&r, E12));
+		reliability_sensor_hit(&r, E12);
+	}
+	ASSERT(!reliability_sensor_blacklisted(&r, E12));
+	ASSERT(r.sensors[E12].missed_cost > 0);
+}
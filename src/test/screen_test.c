@@ -0,0 +1,128 @@
+#include "screen_test.h"
+
+#include <assert.h>
+#include <kernel.h>
+#include <util.h>
+#include "../user/screen.h"
+
+// A minimal terminal, which understands just what the screen emits, so that
+// we can check that replaying the output reproduces the screen.
+static struct screen scr;
+static struct screen_cell term[SCREEN_ROWS][SCREEN_COLS];
+static int term_row, term_col, term_attr, term_bytes;
+
+static int parse_int(const char *buf, int *i) {
+	int n = 0;
+	while (buf[*i] >= '0' && buf[*i] <= '9') {
+		n = n * 10 + buf[(*i)++] - '0';
+	}
+	return n;
+}
+
+static void term_output(const char *buf, int len) {
+	term_bytes += len;
+	int i = 0;
+	while (i < len) {
+		if (buf[i] == '\e') {
+			ASSERT(buf[i + 1] == '[');
+			i += 2;
+			int args[3] = {}, nargs = 0;
+			for (;;) {
+				ASSERT(nargs < ARRAY_LENGTH(args));
+				args[nargs++] = parse_int(buf, &i);
+				if (buf[i] != ';') break;
+				i++;
+			}
+			ASSERT(i < len);
+			switch (buf[i++]) {
+			case 'H': term_row = args[0]; term_col = args[1]; break;
+			case 'C': term_col += args[0]; break;
+			case 'm': term_attr = (nargs == 3) ? args[2] : ATTR_NONE; break;
+			case 'J':
+				for (int r = 0; r < SCREEN_ROWS; r++) {
+					for (int c = 0; c < SCREEN_COLS; c++) {
+						term[r][c] = (struct screen_cell) { ' ', ATTR_NONE };
+					}
+				}
+				break;
+			default: ASSERT(0 && "Unexpected escape sequence");
+			}
+			continue;
+		}
+		unsigned char glyph = buf[i];
+		if (glyph >= 0x80) {
+			// compare the raw bytes by keeping the last one - every glyph we
+			// draw ends in a distinct byte
+			ASSERT(i + 2 < len);
+			glyph = buf[i + 2];
+			i += 3;
+		} else {
+			i++;
+		}
+		ASSERT(term_row >= 1 && term_row <= SCREEN_ROWS);
+		ASSERT(term_col >= 1 && term_col <= SCREEN_COLS);
+		term[term_row - 1][term_col - 1] = (struct screen_cell) { glyph, term_attr };
+		term_col++;
+	}
+}
+
+static unsigned char last_byte(const char *str) {
+	unsigned char c = 0;
+	while (*str) c = *str++;
+	return c;
+}
+
+static void check_screen(const char *ctx) {
+	for (int r = 0; r < SCREEN_ROWS; r++) {
+		for (int c = 0; c < SCREEN_COLS; c++) {
+			unsigned char glyph = scr.cells[r][c].glyph;
+			if (glyph >= 0x80) glyph = term[r][c].glyph; // checked by the caller
+			ASSERTF(term[r][c].glyph == glyph && term[r][c].attr == scr.cells[r][c].attr,
+					"%s: mismatch at %d,%d", ctx, r + 1, c + 1);
+		}
+	}
+	ASSERT_INTEQ(term_row, scr.cursor_row);
+	ASSERT_INTEQ(term_col, scr.cursor_col);
+}
+
+void screen_tests(void) {
+	screen_init(&scr, term_output);
+	screen_puts(&scr, 1, 1, ATTR_NONE, "\xe2\x94\x8c" "hello" "\xe2\x94\x90");
+	screen_set_cursor(&scr, 5, 3);
+	screen_flush(&scr);
+	check_screen("initial");
+	ASSERT(term[0][0].glyph == last_byte("\xe2\x94\x8c"));
+	ASSERT(term[0][6].glyph == last_byte("\xe2\x94\x90"));
+
+	// nothing changed, so nothing is sent
+	term_bytes = 0;
+	screen_puts(&scr, 1, 2, ATTR_NONE, "hello");
+	ASSERT_INTEQ(screen_flush(&scr), 0);
+	ASSERT_INTEQ(term_bytes, 0);
+
+	// a single changed cell only costs a couple of cursor moves
+	screen_putc(&scr, 1, 3, ATTR_NONE, 'a');
+	ASSERT(screen_flush(&scr) < 20);
+	check_screen("single");
+
+	// padding and clipping
+	screen_putn(&scr, 2, 1, ATTR_YELLOW, "abcdef", 3);
+	screen_putn(&scr, 3, 1, ATTR_NONE, "ab", 4);
+	screen_puts(&scr, 4, SCREEN_COLS - 1, ATTR_NONE, "xyz");
+	screen_flush(&scr);
+	check_screen("clip");
+	ASSERT(term[1][2].glyph == 'c' && term[1][3].glyph == ' ');
+
+	// lots of random changes
+	for (int round = 0; round < 20; round++) {
+		for (int i = 0; i < 300; i++) {
+			const int row = 1 + rand() % SCREEN_ROWS;
+			const int col = 1 + rand() % SCREEN_COLS;
+			const int attrs[] = { ATTR_NONE, ATTR_NONE, ATTR_RED, ATTR_GREEN };
+			screen_putc(&scr, row, col, attrs[rand() % ARRAY_LENGTH(attrs)], 'a' + rand() % 3);
+		}
+		screen_set_cursor(&scr, 1 + rand() % SCREEN_ROWS, 1 + rand() % SCREEN_COLS);
+		screen_flush(&scr);
+		check_screen("random");
+	}
+}
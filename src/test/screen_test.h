@@ -0,0 +1,3 @@
+#pragma once
+
+void screen_tests(void);
@@ -1,9 +1,11 @@
 #include "sensor_attribution_test.h"
 #include "../user/trainsrv/estimate_position.h"
 #include "../user/trainsrv/sensor_attribution.h"
+#include "../user/track.h"
 
 static struct internal_train_state* init_train(struct trainsrv_state *state, int train_id, int sensor, int time, int velocity) {
 	struct internal_train_state *train = &state->train_states[state->num_active_trains++];
+	memset(train, 0, sizeof(*train));
 	train->train_id = train_id;
 	state->state_for_train[train_id - 1] = train;
 
@@ -21,9 +23,9 @@ static struct internal_train_state* init_train(struct trainsrv_state *state, int
 		train->est_stopping_distances[i] = 700;
 	}
 
-	// NOTE: we leave a bunch of state uninitialized, since it shouldn't be used for this
-	// test.
-	// It's debatable whether it's better to leave it undefined, or zero it out, or define values.
+	// NOTE: we leave a bunch of state zeroed, since it shouldn't be used for this
+	// test. (It used to be left undefined, but then the results depended on
+	// whatever happened to be on the stack.)
 	// Arguably, the best way to do this is to mock out the behaviour of the functions that
 	// interact with it, but that's too fancy for C.
 
@@ -31,15 +33,158 @@ static struct internal_train_state* init_train(struct trainsrv_state *state, int
 }
 
 static void init_state(struct trainsrv_state *state) {
+	train_models_init();
+	reliability_init(&state->reliability);
 	state->num_active_trains = 0;
-	state->unknown_train_id = 0;
 	switch_historical_init(&state->switch_history);
 	struct switch_state switches = {};
 	switch_historical_set(&state->switch_history, switches, 50);
 	// sens_prev & sensors_are_known should not be used
 }
 
+// what sensor_cb does with a sensor hit, as far as attribution is concerned
+static const struct internal_train_state *hit(struct trainsrv_state *state, int sensor, int time) {
+	struct attribution attr = attribute_sensor_to_train(state, sensor, time);
+	attribution_record(state, &attr, sensor, time);
+	if (attr.train != NULL) {
+		struct internal_train_state *train = get_train_state(state, attr.train->train_id);
+		sensor_historical_set(&train->sensor_history, sensor, time);
+	}
+	return attr.train;
+}
+
+// a train we've set moving, but haven't found yet
+static struct internal_train_state* init_unknown_train(struct trainsrv_state *state, int train_id, int velocity) {
+	struct internal_train_state *train = init_train(state, train_id, 0, 0, velocity);
+	sensor_historical_init(&train->sensor_history);
+	return train;
+}
+
+// Two trains we haven't found yet start moving. The first sensor hit could be
+// either, but only the faster one could have gone on to the next so soon.
+static void test_several_unknown_trains(void) {
+	struct trainsrv_state state;
+	init_state(&state);
+
+	struct internal_train_state *slow = init_unknown_train(&state, 63, 2000);
+	struct internal_train_state *fast = init_unknown_train(&state, 58, 8000);
+
+	ASSERT(slow == hit(&state, 36, 1000)); // C5
+	ASSERT_INTEQ(fast->num_alternatives, 1);
+	ASSERT_INTEQ(fast->alternatives[0].sensor, 36);
+
+	// C15 is ~300mm on, which the fast train covers in ~40 ticks, and the
+	// slow one in ~150
+	ASSERT(fast == hit(&state, 46, 1040)); // C15
+	ASSERT_INTEQ(fast->sensor_history.len, 2);
+	ASSERT_INTEQ(sensor_historical_get_by_index(&fast->sensor_history, 2), 36);
+	// so the slow train is back to being lost
+	ASSERT_INTEQ(slow->sensor_history.len, 0);
+	ASSERT(position_is_uninitialized(&slow->last_known_position));
+
+	// and it gets the next sensor hit nobody else could have made
+	ASSERT(slow == hit(&state, 2, 1100)); // A3
+
+	// stopped trains can't hit sensors
+	struct internal_train_state *stopped = init_unknown_train(&state, 62, 5000);
+	speed_historical_set(&stopped->speed_history, 0, 50);
+	ASSERT(NULL == attribute_sensor_to_train(&state, 10, 1200).train); // A11
+}
+
+// What we've learned about the track changes what we're willing to assume
+static void test_learned_reliability(void) {
+	struct trainsrv_state state;
+	init_state(&state);
+	struct internal_train_state *train_a = init_train(&state, 63, 36, 200, 5000); // C5
+
+	// a sensor which keeps triggering on its own is ignored, even with a train
+	// right where it should be to hit it
+	reliability_sensor_hit(&state.reliability, 46);
+	for (int i = 0; i < BLACKLIST_MIN_PHANTOMS; i++) {
+		reliability_sensor_phantom(&state.reliability, 46);
+	}
+	ASSERT(NULL == hit(&state, 46, 250)); // C15
+	// and nobody is thought to maybe be there because of it
+	ASSERT_INTEQ(train_a->num_alternatives, 0);
+	// but the train would have hit it, so once that's happened enough, the
+	// sensor is trusted again
+	for (int i = 0; i < BLACKLIST_MIN_PHANTOMS && reliability_sensor_blacklisted(&state.reliability, 46); i++) {
+		ASSERT(NULL == hit(&state, 46, 250));
+	}
+	ASSERT(!reliability_sensor_blacklisted(&state.reliability, 46));
+	ASSERT(train_a == hit(&state, 46, 250));
+
+	init_state(&state);
+	train_a = init_train(&state, 63, 31, 200, 5000); // B16
+	struct switch_state switches = {};
+	switch_set(&switches, 4, CURVED);
+	switch_set(&switches, 15, CURVED);
+	switch_set(&switches, 16, CURVED);
+	switch_historical_set(&state.switch_history, switches, 51);
+
+	// 1 bad sensor & 1 bad turnout is too much to assume...
+	ASSERT(NULL == attribute_sensor_to_train(&state, 16, 250).train); // B1
+	// ...unless the sensor is known to be dead
+	const struct track_node *b1 = track_node_from_sensor(16);
+	int dead = -1, distance = 0;
+	for (int p = 0; p < b1->num_predecessors; p++) {
+		if (b1->predecessors[p].sensor == 31) {
+			dead = b1->predecessors[p].missed_sensor;
+			distance = b1->predecessors[p].distance;
+		}
+	}
+	ASSERT(dead >= 0 && dead != NO_MISSED_SENSOR);
+	for (int i = 0; i < 20; i++) {
+		reliability_sensor_missed(&state.reliability, dead);
+	}
+	// (as long as it was on time, since the wrong turnout still costs plenty)
+	const int now = 200 + distance * 1000 / 5000;
+	struct attribution attr = attribute_sensor_to_train(&state, 16, now);
+	ASSERT(train_a == attr.train);
+	ASSERT_INTEQ(attr.missed_sensor, dead);
+
+	// and the train having gone over it, and the wrong way over a switch, counts
+	// against them
+	attribution_record(&state, &attr, 16, now);
+	ASSERT_INTEQ(state.reliability.sensors[16].hits, 1);
+	ASSERT_INTEQ(state.reliability.sensors[dead].misses, 21);
+	ASSERT(attr.changed_switch >= 0);
+	ASSERT_INTEQ(state.reliability.switches[switch_packed_num(attr.changed_switch)].misroutes, 1);
+}
+
+// With every switch set the same way, the next sensor along from each sensor
+// should list it as a predecessor, at the same distance, going the right way
+// over every switch.
+static void test_predecessor_tables(enum sw_direction dir) {
+	struct switch_state switches = {};
+	for (int i = 0; i < TRACK_MAX; i++) {
+		if (track[i].type == NODE_BRANCH) switch_set(&switches, track[i].num, dir);
+	}
+	for (int i = 0; i < TRACK_MAX; i++) {
+		const struct track_node *sensor = &track[i];
+		if (sensor->type != NODE_SENSOR) continue;
+		int distance;
+		const struct track_node *next = track_next_sensor(sensor, &switches, &distance);
+		if (next->type != NODE_SENSOR) continue;
+
+		bool found = false;
+		for (int p = 0; p < next->num_predecessors; p++) {
+			const struct sensor_predecessor *pred = &next->predecessors[p];
+			if (pred->sensor == sensor->num && pred->missed_sensor == NO_MISSED_SENSOR && pred->distance == distance &&
+					(pred->switches & (pred->curved ^ switches.packed)) == 0) {
+				found = true;
+			}
+		}
+		ASSERTF(found, "%s is missing predecessor %s", next->name, sensor->name);
+	}
+}
+
 void sensor_attribution_tests(void) {
+	test_predecessor_tables(STRAIGHT);
+	test_predecessor_tables(CURVED);
+	test_several_unknown_trains();
+	test_learned_reliability();
+
 	{
 		struct trainsrv_state state;
 		init_state(&state);
@@ -49,7 +194,7 @@ void sensor_attribution_tests(void) {
 
 		// we expect train A to hit this (travelling 300mm in ~ 60 ticks, and actually takes 50)
 		struct attribution attr = attribute_sensor_to_train(&state, 46, 250);
-		ASSERTF(train_a == attr.train, "%x != %x", (unsigned) train_a, (unsigned) attr.train); // C15
+		ASSERTF(train_a == attr.train, "%p != %p", train_a, attr.train); // C15
 
 		// shouldn't attribute a totally random value to a sensor
 		ASSERT(NULL == attribute_sensor_to_train(&state, 10, 250).train); // A11
@@ -0,0 +1,53 @@
+#include "timer_wheel_test.h"
+
+#include <timer_wheel.h>
+#include <assert.h>
+#include <util.h>
+
+#define NUM_TIMERS 200
+
+// Timers far enough out to need both levels of the wheel and the overflow
+// list must still fire on exactly the right tick, and cancelled ones never.
+void timer_wheel_tests(void) {
+	struct timer_wheel tw;
+	struct timer_wheel_entry timers[NUM_TIMERS];
+	struct timer_wheel_entry expired;
+	bool fired[NUM_TIMERS] = {};
+
+	const int start = 12345;
+	timer_wheel_init(&tw, start);
+	timer_wheel_list_init(&expired);
+	memset(timers, 0, sizeof(timers));
+
+	for (int i = 0; i < NUM_TIMERS; i++) {
+		timer_wheel_insert(&tw, &timers[i], start + 1 + (rand() % 10000));
+		ASSERT(timer_wheel_pending(&timers[i]));
+	}
+	for (int i = 0; i < NUM_TIMERS; i += 3) {
+		timer_wheel_cancel(&timers[i]);
+		ASSERT(!timer_wheel_pending(&timers[i]));
+	}
+
+	for (int now = start + 1; now <= start + 10001; now += 1 + (now % 3)) {
+		timer_wheel_advance(&tw, now, &expired);
+		struct timer_wheel_entry *e;
+		while ((e = timer_wheel_list_pop(&expired))) {
+			int i = e - timers;
+			ASSERT(i >= 0 && i < NUM_TIMERS);
+			ASSERT(i % 3 != 0);
+			ASSERT(!fired[i]);
+			ASSERTF(e->expires <= now && e->expires > now - 3,
+					"timer %d for %d fired at %d", i, e->expires, now);
+			fired[i] = true;
+		}
+	}
+	for (int i = 0; i < NUM_TIMERS; i++) {
+		ASSERT(fired[i] == (i % 3 != 0));
+	}
+
+	// timers in the past go off on the next tick
+	timer_wheel_insert(&tw, &timers[0], 0);
+	timer_wheel_advance(&tw, tw.now + 1, &expired);
+	ASSERT(timer_wheel_list_pop(&expired) == &timers[0]);
+	ASSERT(timer_wheel_list_empty(&expired));
+}
@@ -212,11 +212,11 @@ void int_test_train_alert_srv(void) {
 	trains_set_speed(58, 8);
 
 	sensor_set(&sensors, 77, 1); // e14
-	sensors.ticks = 50;
+	sensors.ticks = sensors.trip_ticks[77 / 8] = 50;
 	trains_send_sensors(sensors);
 
 	sensor_set(&sensors, 72, 1); // e9
-	sensors.ticks = 100;
+	sensors.ticks = sensors.trip_ticks[72 / 8] = 100;
 	trains_send_sensors(sensors);
 
 	int ticks;
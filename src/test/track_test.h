@@ -3,3 +3,5 @@
 void track_tests(void);
 void test_train_alert_srv(void);
 void int_test_train_alert_srv(void);
+// no-op displaysrv, for tests of servers which update the display
+void stub_displaysrv(void);
@@ -2,8 +2,10 @@
 
 #include "../user/track.h"
 #include "../user/sys.h"
+#include "../user/signal.h"
 #include "../user/tracksrv.h"
 #include "../user/routesrv.h"
+#include "track_test.h"
 
 void tracksrv_test_basic(void) {
 	struct astar_node path[ASTAR_MAX_PATH];
@@ -28,13 +30,48 @@ void tracksrv_test_basic(void) {
 	ASSERT(l2 < 0); // There is only one possible route from track[0] to track[1].
 }
 
+static void tracksrv_test_deadlock(void) {
+	bool a[TRACK_MAX] = {}, b[TRACK_MAX] = {}, ab[TRACK_MAX] = {}, none[TRACK_MAX] = {};
+	a[120] = ab[120] = true;
+	b[121] = ab[121] = true;
+	ASSERT(tracksrv_reserve(3, a) == 1);
+	ASSERT(tracksrv_reserve(4, b) == 1);
+
+	// 3 waits on 4, then 4 waits on 3. Both hold the same amount of track,
+	// so the newer owner is the one told to back off.
+	ASSERT(tracksrv_reserve(3, ab) == -1);
+	ASSERT(tracksrv_reserve(4, ab) == TRACKSRV_DEADLOCK_VICTIM);
+	ASSERT(tracksrv_reserve(4, none) == 0);
+	ASSERT(tracksrv_reserve(3, ab) == 2);
+	ASSERT(tracksrv_reserve(3, none) == 0);
+
+	// an owner which gave up waiting (to go somewhere else) isn't part of a
+	// cycle any more
+	ASSERT(tracksrv_reserve(3, a) == 1);
+	ASSERT(tracksrv_reserve(4, b) == 1);
+	ASSERT(tracksrv_reserve(3, ab) == -1);
+	tracksrv_stop_waiting(3);
+	ASSERT(tracksrv_reserve(4, ab) == -1);
+	tracksrv_stop_waiting(4);
+	ASSERT(tracksrv_reserve(3, none) == 0);
+	ASSERT(tracksrv_reserve(4, none) == 0);
+
+	struct tracksrv_stats stats;
+	tracksrv_get_stats(&stats);
+	ASSERT(stats.deadlocks == 1);
+	ASSERT(stats.victims == 1);
+	ASSERT(tracksrv_reserve(3, none) == 0);
+}
+
 void tracksrv_tests_init(void) {
 	init_tracka(track);
 
 	start_servers();
+	signal_send(create(HIGHER(PRIORITY_MIN, 1), stub_displaysrv));
 	tracksrv_start();
 
 	tracksrv_test_basic();
+	tracksrv_test_deadlock();
 
 	stop_servers();
 }
@@ -1,66 +1,283 @@
 #include "benchmark.h"
 #include <kernel.h>
 #include <assert.h>
+#include <util.h>
+#include <io.h>
+#include "sys.h"
 #include "../kernel/drivers/timer.h"
 
-// we expect the build script to provide BENCHMARK_SEND_FIRST, BENCHMARK_CACHE,
-// and BENCHMARK_MSG_SIZE
+// Benchmarks of the kernel primitives, all run in one boot, with the results
+// printed as a table at the end.
+//
+// The debug timer only counts microseconds, so the throughput benchmarks
+// repeat each operation ITERATIONS times, and divide the total out.
+// The latency benchmarks instead time each wakeup against the tick timer,
+// and so are only as precise as it is (2us on the TS7200, 256us on QEMU).
 
-#if BENCHMARK_SEND_FIRST
-#define SEND_PRIORITY 14
-#define RECV_PRIORITY 15
-#else
-#define SEND_PRIORITY 15
-#define RECV_PRIORITY 14
-#endif
-
-#define RECEIVER_TID 3
 #define ITERATIONS 2000
+#define LATENCY_SAMPLES 50
+#define MAX_MSG_SIZE 1024
+#define MAX_RESULTS 80
+
+#define PRIORITY_BENCH_HIGH HIGHER(PRIORITY_MIN, 2)
+#define PRIORITY_BENCH_LOW HIGHER(PRIORITY_MIN, 1)
+
+struct result {
+	const char *name;
+	char config[32];
+	int samples;
+	int mean_ns;
+	// -1 if only the mean is known
+	int min_ns;
+	int max_ns;
+};
+
+static struct result results[MAX_RESULTS];
+static int num_results = 0;
+
+static struct result *add_result(const char *name, int samples) {
+	ASSERT(num_results < MAX_RESULTS);
+	struct result *r = &results[num_results++];
+	r->name = name;
+	r->config[0] = '\0';
+	r->samples = samples;
+	r->min_ns = r->max_ns = -1;
+	return r;
+}
+
+static void add_throughput(const char *name, const char *config, int samples, unsigned elapsed_us) {
+	struct result *r = add_result(name, samples);
+	strcpy(r->config, config);
+	r->mean_ns = elapsed_us * 1000 / samples;
+}
+
+// Collects latency samples, in microseconds
+struct latency {
+	int samples;
+	unsigned total, min, max;
+};
 
+static void latency_add(struct latency *l, unsigned us) {
+	if (l->samples == 0 || us < l->min) l->min = us;
+	if (l->samples == 0 || us > l->max) l->max = us;
+	l->total += us;
+	l->samples++;
+}
+
+static void add_latency(const char *name, const char *config, const struct latency *l) {
+	struct result *r = add_result(name, l->samples);
+	strcpy(r->config, config);
+	r->mean_ns = l->total * 1000 / l->samples;
+	r->min_ns = l->min * 1000;
+	r->max_ns = l->max * 1000;
+}
+
+// The tasks being timed send the time they took to their parent when done
+static unsigned wait_for_elapsed(void) {
+	int tid;
+	unsigned elapsed;
+	receive(&tid, &elapsed, sizeof(elapsed));
+	reply(tid, NULL, 0);
+	return elapsed;
+}
+
+static void report_elapsed(unsigned start) {
+	const unsigned elapsed = debug_timer_useconds() - start;
+	send(parent_tid(), &elapsed, sizeof(elapsed), NULL, 0);
+}
 
-static void sender(void) {
-	unsigned char send_buf[BENCHMARK_MSG_SIZE];
-	unsigned char recv_buf[BENCHMARK_MSG_SIZE];
-	for (unsigned j = 0; j < BENCHMARK_MSG_SIZE; j++) {
-		send_buf[j] = 0xcd;
+// send/receive/reply
+
+static const int msg_sizes[] = { 4, 64, 256, MAX_MSG_SIZE };
+
+// parameters for the message tasks, set before they're created
+static int msg_size;
+static int msg_receiver_tid;
+
+static void msg_sender(void) {
+	unsigned char send_buf[MAX_MSG_SIZE], reply_buf[MAX_MSG_SIZE];
+	memset(send_buf, 0xcd, msg_size);
+	const unsigned start = debug_timer_useconds();
+	for (int i = 0; i < ITERATIONS; i++) {
+		send(msg_receiver_tid, send_buf, msg_size, reply_buf, msg_size);
 	}
-	for (unsigned i = 0; i < ITERATIONS; i++) {
-		send(RECEIVER_TID, send_buf, BENCHMARK_MSG_SIZE, recv_buf, BENCHMARK_MSG_SIZE);
-		/* for (unsigned j = 0; j < BENCHMARK_MSG_SIZE; j++) { */
-		/*     ASSERT(recv_buf[j] == 0xab); */
-		/* } */
+	report_elapsed(start);
+}
+
+static void msg_receiver(void) {
+	unsigned char recv_buf[MAX_MSG_SIZE], reply_buf[MAX_MSG_SIZE];
+	memset(reply_buf, 0xab, msg_size);
+	for (int i = 0; i < ITERATIONS; i++) {
+		int tid;
+		receive(&tid, recv_buf, msg_size);
+		reply(tid, reply_buf, msg_size);
 	}
 }
 
-static void receiver(void) {
-	int tid;
-	unsigned char recv_buf[BENCHMARK_MSG_SIZE];
-	unsigned char repl_buf[BENCHMARK_MSG_SIZE];
-	for (unsigned j = 0; j < BENCHMARK_MSG_SIZE; j++) {
-		repl_buf[j] = 0xab;
+// Whichever of the two has the higher priority blocks first, so that's what
+// decides whether the send or the receive comes first.
+static const char *cache_mode_names[] = { "off", "on", "locked" };
+
+static void bench_messages(int size, bool send_first, enum cache_mode cache) {
+	msg_size = size;
+	msg_receiver_tid = create(send_first ? PRIORITY_BENCH_LOW : PRIORITY_BENCH_HIGH, msg_receiver);
+	create(send_first ? PRIORITY_BENCH_HIGH : PRIORITY_BENCH_LOW, msg_sender);
+	const unsigned elapsed = wait_for_elapsed();
+
+	char config[32];
+	snprintf(config, sizeof(config), "%dB %s-first cache %s",
+			size, send_first ? "send" : "receive", cache_mode_names[cache]);
+	add_throughput("send/receive/reply", config, ITERATIONS, elapsed);
+}
+
+// memcpy, which is behind every message
+
+static const int copy_sizes[] = { 1, 4, 8, 16, 32, 64, 128, 256, 512 };
+#define MAX_COPY_SIZE 512
+static unsigned char copy_src[MAX_COPY_SIZE + 4] __attribute__((aligned(4)));
+static unsigned char copy_dst[MAX_COPY_SIZE] __attribute__((aligned(4)));
+
+static void bench_memcpy(int size, int src_align) {
+	const unsigned start = debug_timer_useconds();
+	for (int i = 0; i < ITERATIONS; i++) {
+		memcpy(copy_dst, copy_src + src_align, size);
+	}
+	const unsigned elapsed = debug_timer_useconds() - start;
+
+	char config[32];
+	snprintf(config, sizeof(config), "%dB src + %d", size, src_align);
+	add_throughput("memcpy", config, ITERATIONS, elapsed);
+}
+
+// create/exit
+
+static void bench_nop(void) {}
+
+static void bench_create_exit(void) {
+	// the child has a higher priority, so it runs and exits straight away
+	const unsigned start = debug_timer_useconds();
+	for (int i = 0; i < ITERATIONS; i++) {
+		create(PRIORITY_BENCH_HIGH, bench_nop);
 	}
-	for (unsigned i = 0; i < ITERATIONS; i++) {
-		receive(&tid, recv_buf, BENCHMARK_MSG_SIZE);
-		/* for (unsigned j = 0; j < BENCHMARK_MSG_SIZE; j++) { */
-		/*     ASSERT(recv_buf[j] == 0xcd); */
-		/* } */
-		reply(tid, repl_buf, BENCHMARK_MSG_SIZE);
+	add_throughput("create/exit", "", ITERATIONS, debug_timer_useconds() - start);
+}
+
+// pass, with and without another task to switch to
+
+static void bench_pass(void) {
+	const unsigned start = debug_timer_useconds();
+	for (int i = 0; i < ITERATIONS; i++) {
+		pass();
 	}
-	send(parent_tid(), 0, 0, recv_buf, BENCHMARK_MSG_SIZE);
+	add_throughput("pass", "no other task", ITERATIONS, debug_timer_useconds() - start);
 }
 
-void benchmark(void) {
-	unsigned dummy;
-	int tid;
+static void switch_partner(void) {
+	// switch_timer's loop, plus the two passes before it starts timing
+	for (int i = 0; i < ITERATIONS + 2; i++) {
+		pass();
+	}
+}
 
-	unsigned start = debug_timer_useconds();
+static void switch_timer(void) {
+	// the partner is scheduled ahead of us, so runs first
+	create(PRIORITY_BENCH_LOW, switch_partner);
+	pass();
+	const unsigned start = debug_timer_useconds();
+	for (int i = 0; i < ITERATIONS; i++) {
+		pass();
+	}
+	report_elapsed(start);
+}
+
+static void bench_context_switch(void) {
+	create(PRIORITY_BENCH_LOW, switch_timer);
+	// every pass switches to the other task
+	add_throughput("pass", "context switch", 2 * ITERATIONS, wait_for_elapsed());
+}
 
-	create(SEND_PRIORITY, sender);
-	create(RECV_PRIORITY, receiver);
-	receive(&tid, &dummy, sizeof(dummy));
+// the kernel's ready queue
 
-	unsigned end = debug_timer_useconds();
+static void bench_scheduler(void) {
+	const int iterations = 10 * ITERATIONS;
+	add_throughput("task_schedule/next", "", iterations, debug_bench_scheduler(iterations));
+}
+
+// interrupt latency
+
+// This has to run before the clock server starts, since only one task can
+// wait on the tick at once.
+static void bench_await_latency(void) {
+	struct latency l = {};
+	await(EID_TIMER_TICK, NULL, 0);
+	for (int i = 0; i < LATENCY_SAMPLES; i++) {
+		await(EID_TIMER_TICK, NULL, 0);
+		latency_add(&l, tick_timer_useconds());
+	}
+	add_latency("await tick latency", "no other tasks", &l);
+}
+
+static void bench_delay_latency(void) {
+	struct latency l = {};
+	delay(1);
+	for (int i = 0; i < LATENCY_SAMPLES; i++) {
+		delay(1);
+		latency_add(&l, tick_timer_useconds());
+	}
+	add_latency("delay wakeup latency", "", &l);
+}
+
+static void print_padded(const char *s, int width) {
+	printf("%s", s);
+	for (int i = strlen(s); i < width; i++) putc(' ');
+}
+
+static void print_ns(int ns) {
+	if (ns < 0) printf("           -");
+	else printf("%12d", ns);
+}
+
+static void print_results(void) {
+	print_padded("benchmark", 24);
+	print_padded("config", 32);
+	printf("     samples     mean ns      min ns      max ns" EOL);
+	for (int i = 0; i < num_results; i++) {
+		const struct result *r = &results[i];
+		print_padded(r->name, 24);
+		print_padded(r->config, 32);
+		printf("%12d", r->samples);
+		print_ns(r->mean_ns);
+		print_ns(r->min_ns);
+		print_ns(r->max_ns);
+		printf(EOL);
+	}
+}
+
+void benchmark(void) {
+	const enum cache_mode cache_modes[] = { CACHE_ON, CACHE_LOCKED, CACHE_OFF };
+	for (int m = 0; m < ARRAY_LENGTH(cache_modes); m++) {
+		const enum cache_mode cache = cache_modes[m];
+		debug_set_cache(cache);
+		for (int i = 0; i < ARRAY_LENGTH(msg_sizes); i++) {
+			bench_messages(msg_sizes[i], true, cache);
+			bench_messages(msg_sizes[i], false, cache);
+		}
+	}
+	debug_set_cache(CACHE_ON);
+
+	for (int i = 0; i < ARRAY_LENGTH(copy_sizes); i++) {
+		for (int align = 0; align < 4; align++) {
+			bench_memcpy(copy_sizes[i], align);
+		}
+	}
+	bench_create_exit();
+	bench_pass();
+	bench_context_switch();
+	bench_scheduler();
+	bench_await_latency();
 
-	printf("Benchmark took %d ns (msg_size = %d, iterations = %d, pdelta = %d)" EOL,
-	       (end - start) * 1000 / ITERATIONS, BENCHMARK_MSG_SIZE, ITERATIONS, SEND_PRIORITY - RECV_PRIORITY);
+	start_servers();
+	bench_delay_latency();
+	print_results();
+	stop_servers();
 }
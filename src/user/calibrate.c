@@ -351,10 +351,18 @@ void run_acc_calibration(void) {
 }
 
 
+static void handle_sensors_published(const void *msg, unsigned len) {
+	ASSERT(len == sizeof(struct sensor_dump));
+	const struct sensor_dump *dump = msg;
+	struct sensor_state sensors = dump->sensors;
+	calibrate_send_sensors(whois(CALIBRATESRV_NAME), &sensors);
+}
+
 void calibratesrv_start(void) {
 	/* int tid = create(PRIORITY_CALIBRATE, start_calibrate); */
 	int tid = create(PRIORITY_CALIBRATE, run_acc_calibration);
 	signal_send(tid);
+	pubsub_subscribe(TOPIC_SENSORS, PRIORITY_CALIBRATE, handle_sensors_published, false, sensor_dump_merge);
 }
 void calibrate_send_sensors(int calibratesrv, struct sensor_state *st) {
 	struct calibrate_req req;
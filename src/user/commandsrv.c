@@ -11,6 +11,9 @@
 #include "trainsrv/track_control.h" // TODO: remove this
 #include "track.h"
 #include "conductor.h"
+#include "plannersrv.h"
+#include "telemetrysrv.h"
+#include "discovery.h"
 
 static void get_command(char *buf, int buflen, int displaysrv) {
 	int i = 0;
@@ -80,8 +83,8 @@ static void consume_whitespace(char *cmd, int *ip) {
 	*ip = i;
 };
 
-enum command_type { TR, SW, RV, QUIT, STOP, BSW, BISECT, ROUTE, FREEZE, INVALID };
-char *command_listing[] = { "tr", "sw", "rv", "q", "stop", "bsw", "bisect", "route", "f", "" };
+enum command_type { TR, SW, RV, QUIT, STOP, BSW, BISECT, ROUTE, FREEZE, PLANNER, CALIBRATION, FPS, TELEMETRY, FIND, INVALID };
+char *command_listing[] = { "tr", "sw", "rv", "q", "stop", "bsw", "bisect", "route", "f", "planner", "cal", "fps", "tm", "find", "" };
 
 static enum command_type get_command_type(char *cmd, int *ip) {
 	int i = *ip;
@@ -446,6 +449,58 @@ static void process_command(char *cmd, int displaysrv) {
 		send(tid, &req, sizeof(req), NULL, 0);
 		return;
 	}
+	case PLANNER: {
+		int enabled;
+		if (get_integer(cmd, &i, &enabled) || (enabled != 0 && enabled != 1)) {
+			displaysrv_console_feedback(displaysrv, "Expected planner 0 or 1");
+			return;
+		}
+		plannersrv_set_enabled(enabled);
+		displaysrv_console_feedback(displaysrv, "");
+		return;
+	}
+	case CALIBRATION: {
+		int train;
+		if (!get_train_number(cmd, &i, &train)) return;
+		trains_dump_calibration(train);
+		displaysrv_console_feedback(displaysrv, "");
+		return;
+	}
+	case FPS: {
+		int fps;
+		if (get_integer(cmd, &i, &fps) || fps < 1 || fps > DISPLAYSRV_MAX_FPS) {
+			displaysrv_console_feedback(displaysrv, "Expected fps between 1 and 100");
+			return;
+		}
+		displaysrv_set_fps(displaysrv, fps);
+		displaysrv_console_feedback(displaysrv, "");
+		return;
+	}
+	case TELEMETRY: {
+		int hz;
+		if (get_integer(cmd, &i, &hz) || hz < 0 || hz > TELEMETRY_MAX_HZ) {
+			displaysrv_console_feedback(displaysrv, "Expected telemetry rate between 0 and 20");
+			return;
+		}
+		telemetry_set_rate(hz);
+		displaysrv_console_feedback(displaysrv, "");
+		return;
+	}
+	case FIND: {
+		int trains[DISCOVERY_MAX_TRAINS];
+		int num_trains = 0;
+		do {
+			if (num_trains == DISCOVERY_MAX_TRAINS) {
+				displaysrv_console_feedback(displaysrv, "Too many trains");
+				return;
+			}
+			if (!get_train_number(cmd, &i, &trains[num_trains++])) return;
+			consume_whitespace(cmd, &i);
+		} while (cmd[i] != '\0');
+		discovery_start(trains, num_trains);
+		displaysrv_console_feedback(displaysrv, "");
+		return;
+	}
 	case FREEZE: {
 		displaysrv_console_freeze();
 	}
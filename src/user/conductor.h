@@ -23,6 +23,13 @@ struct conductor_req {
 		} switch_timeout;
 		struct {
 			int expected_time;
+			// the departure it was timed from, which is stale once we've
+			// set off again
+			int route_generation;
+			int departure;
 		} stop_timeout;
+		struct {
+			int route_generation;
+		} depart;
 	} u;
 };
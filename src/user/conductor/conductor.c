@@ -8,6 +8,7 @@
 #include "../trainsrv.h"
 #include "../sys.h"
 #include "../routesrv.h"
+#include "../plannersrv.h"
 #include "../tracksrv.h"
 #include "conductor_internal.h"
 #include "../displaysrv.h"
@@ -186,6 +187,8 @@ static void handle_poi(struct conductor_state *state, int _) {
 	case STOPPING_POINT:
 		req.type = CND_STOP_TIMEOUT;
 		req.u.stop_timeout.expected_time = time() + state->poi.delay;
+		req.u.stop_timeout.route_generation = state->route_generation;
+		req.u.stop_timeout.departure = state->departure;
 		/* offset = offsetof(struct conductor_req, u.stop_timeout.time); */
 		break;
 	case SWITCH:
@@ -209,92 +212,298 @@ static void handle_poi(struct conductor_state *state, int _) {
 
 const int max_speed = 14;
 
-static void handle_set_destination(const struct track_node *dest, struct conductor_state *state) {
+// How long to wait before retrying a reservation that somebody else is
+// holding track for, and how long to back off for when we're told to give way
+// to break a deadlock.
+#define RESERVE_RETRY_TICKS 20
+#define DEADLOCK_BACKOFF_TICKS 100
+// Most extra track we'll reserve for being unsure of where the train is
+#define MAX_POSITION_PADDING 300
+
+static void set_next_poi(int time, struct conductor_state *state) {
 	struct train_state train_state = {};
 	trains_query_spatials(state->train_id, &train_state);
+	int velocity = train_state.velocity;
+	if (velocity == 0) {
+		velocity = state->last_velocity;
+	} else {
+		state->last_velocity = velocity;
+	}
 
-	state->path_index = 0;
-	state->poi_context.poi_index = 0;
-	state->poi_context.stopped = false;
+	state->poi = get_next_poi(state->path, state->path_len, &state->poi_context,
+			state->motion.stop_lead, velocity);
+	if (state->poi.type != NONE) {
+		if (state->poi.path_index == state->path_index - 1) {
+			// account for time passed we hit the last sensor
+			state->poi.delay -= time - state->last_sensor_time;
+			if (state->poi.delay < 0) {
+				logf("We passed (%d ticks late) this POI already, begin event now",
+					state->poi.delay);
+				state->poi.delay = 0;
+			}
+			handle_poi(state, time);
+		} else if (state->poi.path_index < state->path_index) {
+			logf("We passed [path_index] (%d ticks late) this POI already, begin event now",
+				state->poi.delay);
+			// fuck - we've passed this already - just kick off the event immediately
+			state->poi.delay = 0;
+			handle_poi(state, time);
+		}
+	}
+}
 
-	// TODO: We should really *reserve* from edge.src -> dest, but *route* from
-	// edge.dest -> src.
-	const struct track_node *start = train_state.position.edge->dest;
-	state->path_len = routesrv_plan(start, dest, state->path);
-	if (state->path_len < 0) {
-		start = train_state.position.edge->src->reverse;
-		state->path_len = routesrv_plan(start, dest, state->path);
-		if (state->path_len < 0) {
-			logf("Failed to find route from %s to %s", start->name, dest->name);
-			return;
+// how far the train has to go to get to the end of the path
+static int route_length(const struct conductor_state *state, const struct train_state *train_state) {
+	const struct position *pos = &train_state->position;
+	int from = state->path_index;
+	int length = 0;
+	if (pos->edge != NULL) {
+		// the rest of the path starts from the end of the edge we're on, or
+		// from its start if we're reversing to set off
+		while (from < state->path_len && state->path[from].node != pos->edge->dest) from++;
+		if (from < state->path_len) {
+			length = pos->edge->dist - pos->displacement;
+		} else {
+			from = state->path_index;
+			length = pos->displacement;
 		}
-		trains_reverse_unsafe(state->train_id);
 	}
+	for (int i = from; i + 1 < state->path_len; i++) {
+		length += edge_between(state->path[i].node, state->path[i + 1].node)->dist;
+	}
+	return length;
+}
 
-	logf("We're routing from %s to %s, found a path of length %d",
-			start->name, dest->name, state->path_len);
+// if there's no sensor still ahead of us to time the stop from
+static bool stop_before_next_sensor(struct conductor_state *state) {
+	struct point_of_interest poi = {};
+	poi_from_node(state->path, state->path_len, state->path_len - 1, &poi, state->motion.stop_lead);
+	return poi.sensor_num == -1 || poi.path_index < state->path_index;
+}
+
+static void end_route(struct conductor_state *state) {
+	state->poi.type = NONE;
+	state->path_len = -1;
+	state->dest = NULL;
+	plannersrv_release(state->train_id);
+}
+
+// Works out how to get from a standstill to the end of the path. Returns false
+// if it's too close to get moving, in which case the route is over.
+static bool plan_move(struct conductor_state *state) {
+	struct train_state train_state = {};
+	trains_query_spatials(state->train_id, &train_state);
+
+	struct motion_plan *motion = &state->motion;
+	const int length = route_length(state, &train_state);
+	trains_plan_motion(state->train_id, length, state->speed, motion);
+	if (motion->speed == 0) {
+		logf("Only %d mm to %s, which is too close to get moving", length, state->dest->name);
+		end_route(state);
+		return false;
+	}
+	logf("Moving %d mm at speed %d, stopping after %d ticks (%d mm short)%s",
+			length, motion->speed, motion->stop_time, motion->stop_lead,
+			motion->short_move ? ", before getting up to speed" : "");
+	state->speed = motion->speed;
+
+	// We're still speeding up when we stop (which timing from a sensor
+	// doesn't account for), or there's no sensor to time it from anyway,
+	// so time it from when we set off.
+	state->timed_stop = motion->short_move || stop_before_next_sensor(state);
+	state->poi_context.stopped = state->timed_stop;
+	return true;
+}
+
+// only once we have the track for it
+static void set_off(struct conductor_state *state) {
+	trains_set_speed(state->train_id, state->speed);
+	state->departure++;
+	if (!state->timed_stop) return;
+
+	struct conductor_req req = {
+		.type = CND_STOP_TIMEOUT,
+		.u.stop_timeout.expected_time = time() + state->motion.stop_time,
+		.u.stop_timeout.route_generation = state->route_generation,
+		.u.stop_timeout.departure = state->departure,
+	};
+	delay_async(state->motion.stop_time, &req, sizeof(req), -1);
+}
+
+// After being held for track, we set off from a standstill again, so
+// whatever stop we'd planned is off.
+static void resume(struct conductor_state *state) {
+	if (!plan_move(state)) return;
+	set_off(state);
+	if (state->poi.type == STOPPING_POINT) state->poi.type = NONE;
+	if (state->poi.type == NONE) set_next_poi(time(), state);
+}
+
+// Returns false if we couldn't get the track we need, in which case the train
+// has been stopped, and we'll either retry or reroute later.
+static bool reserve_from(struct conductor_state *state, int index) {
+	// leave room for the train being further along than we think it is
+	struct train_state train_state;
+	trains_query_spatials(state->train_id, &train_state);
+	int stopping_distance = trains_get_stopping_distance(state->train_id) +
+		MIN(2 * train_state.position_stddev, MAX_POSITION_PADDING);
+	int num_seg = tracksrv_reserve_path(state->path + index, state->path_len - index, stopping_distance);
+	state->reserve_index = index;
+	if (num_seg >= 0) {
+		if (state->waiting_for_track) {
+			logf("Got track from %s, resuming", state->path[index].node->name);
+			state->waiting_for_track = false;
+			resume(state);
+		}
+		return true;
+	}
+
+	trains_set_speed(state->train_id, 0);
+	if (num_seg == TRACKSRV_DEADLOCK_VICTIM) {
+		logf("Backing off to break deadlock, will reroute to %s", state->dest->name);
+		state->waiting_for_track = false;
+		state->poi.type = NONE;
+		// hang on to only the track we're sitting on
+		const struct track_node *here = state->path[index].node;
+		if (tracksrv_reserve_path(state->path + index, 1, 0) < 0) {
+			// we keep what we had, which had better include where we are,
+			// or somebody could be routed right into us
+			logf("Couldn't give up all but %s while backing off", here->name);
+			int table[TRACK_MAX];
+			tracksrv_get_reservation_table(table);
+			ASSERTF(table[TRACK_NODE_INDEX(here)] == tid(),
+					"Stopped at %s without holding it", here->name);
+		}
+		tracksrv_stop_waiting(tid());
+		plannersrv_release(state->train_id);
+		struct conductor_req req = { .type = CND_DEST, .u.dest.dest = state->dest };
+		delay_async(DEADLOCK_BACKOFF_TICKS, &req, sizeof(req), -1);
+	} else {
+		logf("Track conflict on %d segments from %s, waiting",
+				-num_seg, state->path[index].node->name);
+		state->waiting_for_track = true;
+		struct conductor_req req = { .type = CND_RESERVE_RETRY };
+		delay_async(RESERVE_RETRY_TICKS, &req, sizeof(req), -1);
+	}
+	return false;
+}
+
+static void start_route(struct conductor_state *state) {
+	// we're assuming the train is stopped, which routing needs anyway
+	if (!plan_move(state)) return;
 
 	// NOTE: this is a bit of a hack - we really just want to check for poi whose sensor we've already passed over
 	// we don't know the train's speed yet, so we just fudge it with a value that shouldn't matter anyway
 	// (the velocity is only used if we need to delay a long time ahead of the switch, but if we're at a dead
 	// stop, we don't)
-	trains_set_speed(state->train_id, max_speed);
+	struct train_state train_state = {};
 	trains_query_spatials(state->train_id, &train_state);
-
 	int velocity = train_state.velocity;
 	state->last_velocity = velocity;
 
-	int stopping_distance = trains_get_stopping_distance(state->train_id);
 	// TODO: We should really *reserve* from edge.src -> dest, but *route* from
 	// edge.dest -> src.
-	tracksrv_reserve_path(state->path, state->path_len, stopping_distance);
+	// If we're held, we set off when we get the track (see reserve_from).
+	if (reserve_from(state, 0)) {
+		set_off(state);
+	} else if (!state->waiting_for_track) {
+		return; // backing off
+	}
 
 	logf("Calculating inital pois...");
-	state->poi = get_next_poi(state->path, state->path_len, &state->poi_context, stopping_distance, velocity);
-	ASSERT(state->poi.type != NONE);
-	ASSERT(state->poi.type != STOPPING_POINT);
+	state->poi = get_next_poi(state->path, state->path_len, &state->poi_context, state->motion.stop_lead, velocity);
 
 	// Fire off any events that are before the first sensor on our route.
 	while (state->poi.type != NONE && state->poi.sensor_num == -1) {
 		ASSERT(state->poi.type != STOPPING_POINT);
 		handle_switch_timeout(state->poi.u.switch_info.num, state->poi.u.switch_info.dir);
-		state->poi = get_next_poi(state->path, state->path_len, &state->poi_context, stopping_distance, velocity);
+		state->poi = get_next_poi(state->path, state->path_len, &state->poi_context, state->motion.stop_lead, velocity);
 	}
 
 	logf("Waiting to hit first sensor...");
 }
 
-static void set_next_poi(int time, struct conductor_state *state) {
+// Ask the central planner for a route. Returns false if the planner is
+// disabled, and we should route by ourselves.
+static bool plan_destination(const struct track_node *dest, struct conductor_state *state,
+		const struct track_node *start, const struct track_node *alt_start) {
+	struct planner_plan plan;
+	int len = plannersrv_plan(state->train_id, start, alt_start, dest, &plan);
+	if (len == PLANNER_DISABLED) return false;
+	if (len == PLANNER_SUPERSEDED) return true; // we've since been sent somewhere else
+	if (len < 0) {
+		logf("Planner could not find a route from %s to %s", start->name, dest->name);
+		state->path_len = -1;
+		return true;
+	}
+
+	memcpy(state->path, plan.path, sizeof(plan.path[0]) * len);
+	state->path_len = len;
+	state->speed = plan.speed;
+	if (plan.reversed) {
+		trains_reverse_unsafe(state->train_id);
+	}
+
+	logf("We're routing from %s to %s, planned a path of length %d",
+			plan.path[0].node->name, dest->name, state->path_len);
+
+	if (plan.start_delay > 0) {
+		logf("Holding for %d ticks before departing", plan.start_delay);
+		struct conductor_req req = {
+			.type = CND_DEPART,
+			.u.depart.route_generation = state->route_generation,
+		};
+		delay_async(plan.start_delay, &req, sizeof(req), -1);
+	} else {
+		start_route(state);
+	}
+	return true;
+}
+
+static void handle_set_destination(const struct track_node *dest, struct conductor_state *state) {
 	struct train_state train_state = {};
 	trains_query_spatials(state->train_id, &train_state);
-	int velocity = train_state.velocity;
-	if (velocity == 0) {
-		velocity = state->last_velocity;
-	} else {
-		state->last_velocity = velocity;
+	// attribution may have lost track of the train, in which case there's
+	// nowhere to route from until it hits a sensor again
+	if (position_is_uninitialized(&train_state.position)) {
+		char fb[64];
+		snprintf(fb, sizeof(fb), "Train %d's position is unknown", state->train_id);
+		displaysrv_console_feedback(whois(DISPLAYSRV_NAME), fb);
+		logf("Not routing to %s, since we don't know where we are", dest->name);
+		return;
 	}
 
-	int stopping_distance = trains_get_stopping_distance(state->train_id);
-	state->poi = get_next_poi(state->path, state->path_len, &state->poi_context,
-			stopping_distance, velocity);
-	if (state->poi.type != NONE) {
-		if (state->poi.path_index == state->path_index - 1) {
-			// account for time passed we hit the last sensor
-			state->poi.delay -= time - state->last_sensor_time;
-			if (state->poi.delay < 0) {
-				logf("We passed (%d ticks late) this POI already, begin event now",
-					state->poi.delay);
-				state->poi.delay = 0;
-			}
-			handle_poi(state, time);
-		} else if (state->poi.path_index < state->path_index) {
-			logf("We passed [path_index] (%d ticks late) this POI already, begin event now",
-				state->poi.delay);
-			// fuck - we've passed this already - just kick off the event immediately
-			state->poi.delay = 0;
-			handle_poi(state, time);
+	state->path_index = 0;
+	state->poi_context.poi_index = 0;
+	state->poi_context.stopped = false;
+	state->dest = dest;
+	state->route_generation++;
+	// whatever we were waiting on was for the old route
+	state->waiting_for_track = false;
+	tracksrv_stop_waiting(tid());
+
+	// TODO: We should really *reserve* from edge.src -> dest, but *route* from
+	// edge.dest -> src.
+	const struct track_node *start = train_state.position.edge->dest;
+	const struct track_node *alt_start = train_state.position.edge->src->reverse;
+	if (plan_destination(dest, state, start, alt_start)) return;
+
+	state->path_len = routesrv_plan(start, dest, state->path);
+	if (state->path_len < 0) {
+		start = alt_start;
+		state->path_len = routesrv_plan(start, dest, state->path);
+		if (state->path_len < 0) {
+			logf("Failed to find route from %s to %s", start->name, dest->name);
+			return;
 		}
+		trains_reverse_unsafe(state->train_id);
 	}
+
+	logf("We're routing from %s to %s, found a path of length %d",
+			start->name, dest->name, state->path_len);
+
+	state->speed = max_speed;
+	start_route(state);
 }
 
 static void handle_sensor_hit(int sensor_num, int time, struct conductor_state *state) {
@@ -318,18 +527,24 @@ static void handle_sensor_hit(int sensor_num, int time, struct conductor_state *
 		state->poi.type = NONE; // go to idle mode
 		trains_set_speed(state->train_id, 0);
 		logf("We've diverged from our desired path at sensor %s", repr);
+		state->waiting_for_track = false;
+		tracksrv_stop_waiting(tid());
+		plannersrv_release(state->train_id);
 		// TODO: later, we should reroute when we error out like this
 		return;
 	}
 	if (i >= state->path_len) {
 		logf("At end of path, ignored sensor hit.");
 		tracksrv_reserve_path(NULL, 0, 0); // Release all track
+		plannersrv_release(state->train_id);
 		return;
 	}
 
-	int stopping_distance = trains_get_stopping_distance(state->train_id);
-	int num_seg = tracksrv_reserve_path(state->path + i, state->path_len - i, stopping_distance);
-	logf("Reserved %d segments from %s, max length %d", num_seg, state->path[i].node->name, state->path_len - i);
+	// we're past it, which matters if we have to plan a move from here
+	state->path_index = i + 1;
+	if (!reserve_from(state, i) && !state->waiting_for_track) {
+		return; // backing off
+	}
 	if (state->poi.type != NONE && i >= state->poi.path_index) {
 		logf("Approaching poi %s %d at sensor %s", state->poi.original->name, state->poi.delay, repr);
 		handle_poi(state, time);
@@ -337,8 +552,6 @@ static void handle_sensor_hit(int sensor_num, int time, struct conductor_state *
 	} else {
 		logf("On track at sensor %s", repr);
 	}
-
-	state->path_index = i + 1;
 }
 
 static void run_conductor(int train_id) {
@@ -356,6 +569,19 @@ static void run_conductor(int train_id) {
 			logf("Conductor got dest request");
 			handle_set_destination(req.u.dest.dest, &state);
 			break;
+		case CND_DEPART:
+			if (req.u.depart.route_generation != state.route_generation) {
+				logf("Ignoring departure for an old route");
+				break;
+			}
+			logf("Conductor departing");
+			start_route(&state);
+			break;
+		case CND_RESERVE_RETRY:
+			if (state.waiting_for_track) {
+				reserve_from(&state, state.reserve_index);
+			}
+			break;
 		case CND_SENSOR:
 			//logf("Conductor got sensor request");
 			handle_sensor_hit(req.u.sensor.sensor_num, req.u.sensor.time, &state);
@@ -373,6 +599,11 @@ static void run_conductor(int train_id) {
 		}
 		case CND_STOP_TIMEOUT: {
 			logf("Conductor got stop timeout request");
+			if (req.u.stop_timeout.route_generation != state.route_generation ||
+					req.u.stop_timeout.departure != state.departure) {
+				logf("Ignoring stop timeout from before we last set off");
+				break;
+			}
 			int now = time();
 			if (req.u.stop_timeout.expected_time != now) {
 				logf("Got stop timeout at %d, expected at %d", now,
@@ -1,5 +1,6 @@
 #pragma once
 #include "../routesrv.h"
+#include "../trainsrv.h"
 
 enum poi_type { NONE = 0, SWITCH, STOPPING_POINT, NUM_POI_TYPE };
 
@@ -7,8 +8,8 @@ enum poi_type { NONE = 0, SWITCH, STOPPING_POINT, NUM_POI_TYPE };
 // We're assuming that the train is travelling only on the specified path.
 // If the sensor is negative, this means that the point of interest is
 // before the first sensor on our path, and should be triggered immediately.
-// Clearly, this doesn't work for the stopping position (ie: short moves don't
-// work)
+// This doesn't work for the stopping position, so short moves time the stop
+// from when we set off instead (see plan_move).
 struct point_of_interest {
 	int sensor_num;
 	int delay;
@@ -37,6 +38,22 @@ struct conductor_state {
 	struct astar_node path[ASTAR_MAX_PATH];
 	int path_len;
 	int path_index;
+	// speed setting we run the path at
+	int speed;
+	// when to stop to get to the end of the path soonest, worked out on departure
+	struct motion_plan motion;
+	// stop motion.stop_time after setting off, rather than from a sensor
+	bool timed_stop;
+	const struct track_node *dest;
+	// bumped for every new destination, so we can tell which route delayed
+	// requests were sent for
+	int route_generation;
+	// bumped every time we set off, including after being held for track
+	int departure;
+
+	// set if we stopped because somebody else holds track we need
+	bool waiting_for_track;
+	int reserve_index;
 
 	struct point_of_interest poi;
 	struct poi_context poi_context;
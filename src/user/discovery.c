@@ -0,0 +1,187 @@
+#include "discovery.h"
+#include <assert.h>
+#include <util.h>
+#include "sys.h"
+#include "displaysrv.h"
+#include "sensorsrv.h"
+
+// Trains are set off a few at a time, each at a speed whose velocity is well
+// apart from those of the others moving, so there's nothing to do by hand
+// before starting a session.
+// The first sensor each train hits can't be told apart, but sensor
+// attribution keeps alternatives around for that, and the next hit only fits
+// one train's speed (see sensor_attribution.c). A train counts as found once
+// its position has held for DISCOVERY_CONFIRM_HITS sensors, and is stopped
+// then, which gets it out of the way of the others too, and lets the next
+// train go. If it later turns out we mixed it up with another train, it's
+// sent off again once it can be told apart from those moving.
+// A train we know no velocities for can't be told apart by timing at all, so
+// it's only moved when nothing else is, and nothing else moves until it stops.
+// A train which hasn't hit anything after a while is probably facing a dead
+// end, so it's turned around, and one which still hasn't is given up on.
+
+#define DISCOVERY_POLL_TICKS 5
+#define DISCOVERY_CONFIRM_HITS 2
+// at the slowest speed, trains take about this long to get between sensors
+#define DISCOVERY_REVERSE_TICKS 600 // 6 s
+#define DISCOVERY_TIMEOUT_TICKS 1500 // 15 s, for each train
+
+// Slow, so that trains can't go far wrong. Within that, each train goes at
+// the slowest speed whose velocity differs from every other moving train's by
+// at least 25%, which is more than the velocity tables are off by.
+#define DISCOVERY_MIN_SPEED 6
+#define DISCOVERY_MAX_SPEED 11
+#define DISCOVERY_SEPARATION_NUM 5
+#define DISCOVERY_SEPARATION_DEN 4
+// for trains we have no velocities for
+#define DISCOVERY_BLIND_SPEED 8
+
+struct discovery_params {
+	int num_trains;
+	int trains[DISCOVERY_MAX_TRAINS];
+};
+
+struct discovery_train {
+	int train;
+	int speed; // 0 if not moving
+	int velocity; // at that speed, or 0 if we don't know it
+	int started; // the time it was last set off
+	int last_sensor; // -1 while we don't know where it is
+	int hits; // sensors since its position was last unknown
+	bool found;
+	bool given_up;
+	bool reversed;
+};
+
+static bool velocities_separated(int a, int b) {
+	if (a > b) {
+		int tmp = a;
+		a = b;
+		b = tmp;
+	}
+	return b * DISCOVERY_SEPARATION_DEN >= a * DISCOVERY_SEPARATION_NUM;
+}
+
+// Returns the speed to set the given train off at, 0 if it has to wait for
+// others to stop first, or -1 if we know no velocities for it at all.
+static int pick_speed(const struct discovery_train *t, int *velocity,
+		const struct discovery_train *trains, int num_trains) {
+	bool known = false;
+	for (int speed = DISCOVERY_MIN_SPEED; speed <= DISCOVERY_MAX_SPEED; speed++) {
+		const int v = trains_query_velocity(t->train, speed);
+		if (v <= 0) continue;
+		known = true;
+		bool separated = true;
+		for (int i = 0; i < num_trains && separated; i++) {
+			if (trains[i].speed > 0) {
+				separated = velocities_separated(v, trains[i].velocity);
+			}
+		}
+		if (separated) {
+			*velocity = v;
+			return speed;
+		}
+	}
+	return known ? 0 : -1;
+}
+
+static void start_train(struct discovery_train *t, int speed, int velocity) {
+	t->speed = speed;
+	t->velocity = velocity;
+	t->started = time();
+	t->hits = 0;
+	t->reversed = false;
+	trains_set_speed(t->train, speed);
+}
+
+static void stop_train(struct discovery_train *t) {
+	t->speed = 0;
+	t->velocity = 0;
+	trains_set_speed(t->train, 0);
+}
+
+static void discovery_task(void) {
+	struct discovery_params params;
+	int tid;
+	receive(&tid, &params, sizeof(params));
+	reply(tid, NULL, 0);
+
+	struct discovery_train trains[DISCOVERY_MAX_TRAINS];
+	for (int i = 0; i < params.num_trains; i++) {
+		trains[i] = (struct discovery_train) {
+			.train = params.trains[i],
+			.last_sensor = trains_get_last_known_sensor(params.trains[i]),
+		};
+	}
+	const int start = time();
+	int num_found = 0, num_given_up = 0;
+	int num_moving = 0;
+	bool moving_alone = false;
+	while (num_found + num_given_up < params.num_trains) {
+		for (int i = 0; i < params.num_trains && !moving_alone; i++) {
+			struct discovery_train *t = &trains[i];
+			if (t->found || t->given_up || t->speed > 0) continue;
+			int velocity = 0;
+			const int speed = pick_speed(t, &velocity, trains, params.num_trains);
+			if (speed > 0) {
+				start_train(t, speed, velocity);
+				num_moving++;
+			} else if (speed < 0 && num_moving == 0) {
+				logf("No velocities for train %d, so moving it on its own", t->train);
+				start_train(t, DISCOVERY_BLIND_SPEED, 0);
+				num_moving++;
+				moving_alone = true;
+			}
+		}
+
+		delay(DISCOVERY_POLL_TICKS);
+		for (int i = 0; i < params.num_trains; i++) {
+			struct discovery_train *t = &trains[i];
+			const int sensor = trains_get_last_known_sensor(t->train);
+			if (sensor < 0) {
+				t->hits = 0;
+				if (t->found) {
+					logf("Lost train %d again, restarting it", t->train);
+					t->found = false;
+					num_found--;
+				}
+			} else if (sensor != t->last_sensor) {
+				t->hits++;
+			}
+			t->last_sensor = sensor;
+			if (t->speed == 0) continue;
+
+			const int moving = time() - t->started;
+			if (t->hits >= DISCOVERY_CONFIRM_HITS) {
+				t->found = true;
+				num_found++;
+				stop_train(t);
+				num_moving--;
+				moving_alone = false;
+				char repr[4];
+				sensor_repr(sensor, repr);
+				logf("Found train %d after %d ticks, last at %s", t->train, time() - start, repr);
+			} else if (moving >= DISCOVERY_TIMEOUT_TICKS) {
+				t->given_up = true;
+				num_given_up++;
+				stop_train(t);
+				num_moving--;
+				moving_alone = false;
+				logf("Couldn't find train %d", t->train);
+			} else if (!t->reversed && t->hits == 0 && moving >= DISCOVERY_REVERSE_TICKS) {
+				t->reversed = true;
+				trains_reverse(t->train);
+			}
+		}
+	}
+	logf("Found %d of %d trains in %d ticks", num_found, params.num_trains, time() - start);
+}
+
+void discovery_start(const int *trains, int num_trains) {
+	ASSERT(num_trains <= DISCOVERY_MAX_TRAINS);
+	struct discovery_params params;
+	params.num_trains = num_trains;
+	memcpy(params.trains, trains, num_trains * sizeof(*trains));
+	int tid = create(PRIORITY_COMMANDSRV, discovery_task);
+	send(tid, &params, sizeof(params), NULL, 0);
+}
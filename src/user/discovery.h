@@ -0,0 +1,10 @@
+#pragma once
+
+#include "trainsrv.h"
+
+// trainsrv keeps one train state spare
+#define DISCOVERY_MAX_TRAINS (MAX_ACTIVE_TRAINS - 1)
+
+// Finds where each of the given trains are on the track, all at once, and
+// leaves them stopped. Progress is logged.
+void discovery_start(const int *trains, int num_trains);
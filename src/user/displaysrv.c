@@ -5,6 +5,7 @@
 #include "switch_state.h"
 #include "trainsrv.h"
 #include "track.h"
+#include "screen.h"
 
 #include <assert.h>
 #include <kernel.h>
@@ -149,6 +150,7 @@ static const struct sensor_display sensor_display_info[] = {
 #define UTEE "\xe2\x94\xb4"
 #define CROSS "\xe2\x94\xbc"
 
+// width of the main panels - the log goes to the right of these
 #define SCREEN_WIDTH 80
 #define TRACK_X_OFFSET (1 + 1)
 #define TRACK_Y_OFFSET (1 + 1)
@@ -159,79 +161,77 @@ static const struct sensor_display sensor_display_info[] = {
 #define SENSORS_Y_OFFSET (CLOCK_Y_OFFSET + 2)
 #define TRAIN_STATUS_X_OFFSET TRACK_X_OFFSET
 #define TRAIN_STATUS_Y_OFFSET (1 + TRACK_DISPLAY_HEIGHT + 1 + 2 + 1)
+#define RELIABILITY_X_OFFSET TRACK_X_OFFSET
+#define RELIABILITY_Y_OFFSET (TRAIN_STATUS_Y_OFFSET + 4)
 #define FEEDBACK_X_OFFSET TRACK_X_OFFSET
-#define FEEDBACK_Y_OFFSET (TRAIN_STATUS_Y_OFFSET + 4 + 1)
+#define FEEDBACK_Y_OFFSET (RELIABILITY_Y_OFFSET + 1 + 1)
 #define CONSOLE_X_OFFSET TRACK_X_OFFSET
 #define CONSOLE_Y_OFFSET (FEEDBACK_Y_OFFSET + 2)
+#define LOG_X_OFFSET (SCREEN_WIDTH + 2)
 
-static inline void reset_console_cursor(void) {
-	printf("\e[%d;%dH", CONSOLE_Y_OFFSET, CONSOLE_X_OFFSET);
+// The screen is redrawn at most this many times a second (a tick is 10ms)
+#define DEFAULT_FPS 25
+
+// Everything is drawn here, and sent to the terminal once per frame
+static struct screen screen;
+static int console_col = CONSOLE_X_OFFSET;
+
+static void screen_output_com2(const char *buf, int len) {
+	fput_buf(buf, len, COM2);
 }
 
-static inline void hline(int l, const char *left, const char *right) {
-	puts(left);
-	for (int i = 0; i < l - 2; i++) puts(HLINE);
-	puts(right);
+static void reset_console_cursor(void) {
+	screen_set_cursor(&screen, CONSOLE_Y_OFFSET, console_col);
 }
 
-static inline void vbox(int h, int w, int xoffset) {
-	for (int i = 0; i < h; i++) {
-		if (xoffset != 0) {
-			printf("\e[%dC" VLINE "\e[%dC" VLINE EOL, xoffset, w);
-		} else {
-			printf(VLINE "\e[%dC" VLINE EOL, w);
-		}
-	}
+static void hline(int row, int col, int l, const char *left, const char *right) {
+	screen_puts(&screen, row, col, ATTR_NONE, left);
+	for (int i = 1; i < l - 1; i++) screen_puts(&screen, row, col + i, ATTR_NONE, HLINE);
+	screen_puts(&screen, row, col + l - 1, ATTR_NONE, right);
+}
+
+static void vline(int col, int top, int bottom) {
+	for (int row = top; row <= bottom; row++) screen_puts(&screen, row, col, ATTR_NONE, VLINE);
 }
 
 static void clear_line(int line) {
-	char buf[SCREEN_WIDTH - 2 + 1];
-	memset(buf, ' ', sizeof(buf));
-	buf[sizeof(buf) - 1] = '\0';
-	printf("\e[%d;%dH%s\e[%d;%dH", line, CONSOLE_X_OFFSET, buf, line, CONSOLE_X_OFFSET);
+	screen_fill(&screen, line, CONSOLE_X_OFFSET, ATTR_NONE, ' ', SCREEN_WIDTH - 2);
 }
 
 static void initial_draw(void) {
-	puts("\e[2J\e[;H");
-	hline(TRACK_DISPLAY_WIDTH, ULCORNER, DTEE);
-	hline(SCREEN_WIDTH - TRACK_DISPLAY_WIDTH, HLINE, URCORNER);
-	puts(EOL);
-
-	// print out the starting track
-	for (int i = 0; i < TRACK_DISPLAY_HEIGHT; i++) {
-		printf(VLINE "%s                     " VLINE EOL, track_repr[i]);
+	screen_init(&screen, screen_output_com2);
+
+	const int track_bottom = TRACK_Y_OFFSET + TRACK_DISPLAY_HEIGHT;
+	const int right_bar = RIGHT_BAR_X_OFFSET + 1;
+	const int bottom = CONSOLE_Y_OFFSET + 1;
+
+	hline(1, 1, SCREEN_WIDTH, ULCORNER, URCORNER);
+	screen_puts(&screen, 1, right_bar, ATTR_NONE, DTEE);
+	vline(1, 2, bottom - 1);
+	vline(SCREEN_WIDTH, 2, bottom - 1);
+
+	// print out the starting track, up to the right menu
+	for (int y = 0; y <= TRACK_DISPLAY_HEIGHT; y++) {
+		for (int x = 0; x < right_bar - TRACK_X_OFFSET && track_repr[y][x]; x++) {
+			screen_putc(&screen, TRACK_Y_OFFSET + y, TRACK_X_OFFSET + x, ATTR_NONE, track_repr[y][x]);
+		}
 	}
-	vbox(1, SCREEN_WIDTH - 2, 0);
-
-	// reset the cursor to where the track is, then print out the right menu
-	printf("\e[%d;%dH" VLINE "          " VLINE "          " VLINE EOL, 2, RIGHT_BAR_X_OFFSET + 1);
-	printf("\e[%dC", RIGHT_BAR_X_OFFSET);
-	hline(SCREEN_WIDTH - TRACK_DISPLAY_WIDTH + 1, LTEE, RTEE);
-	puts(EOL);
-	vbox(TRACK_DISPLAY_HEIGHT - 1, SCREEN_WIDTH - 2 - TRACK_DISPLAY_WIDTH + 1,
-	     RIGHT_BAR_X_OFFSET);
-
-	// print out the bar below the track
-	hline(TRACK_DISPLAY_WIDTH, LTEE, UTEE);
-	hline(SCREEN_WIDTH - TRACK_DISPLAY_WIDTH, HLINE, RTEE);
-	puts(EOL);
-
-	// print out a box for train status info
-	vbox(4 + 1, SCREEN_WIDTH - 2, 0);
-	hline(SCREEN_WIDTH, LTEE, RTEE);
-	puts(EOL);
-	// print out title set within the train status box
-	printf("\e[s\e[%d;%dHTrain states\e[u", TRAIN_STATUS_Y_OFFSET - 1, TRAIN_STATUS_X_OFFSET);
-
-	// print out a box for console feedback
-	vbox(1, SCREEN_WIDTH - 2, 0);
-	hline(SCREEN_WIDTH, LTEE, RTEE);
-	puts(EOL);
-
-	// print out a box for console commands
-	vbox(1, SCREEN_WIDTH - 2, 0);
-	hline(SCREEN_WIDTH, BLCORNER, BRCORNER);
-	puts(EOL);
+
+	// the right menu, with the clock above the sensor list
+	vline(right_bar, 2, track_bottom);
+	hline(CLOCK_Y_OFFSET + 1, right_bar, SCREEN_WIDTH - right_bar + 1, LTEE, RTEE);
+
+	// the bar below the track
+	hline(track_bottom + 1, 1, SCREEN_WIDTH, LTEE, RTEE);
+	screen_puts(&screen, track_bottom + 1, right_bar, ATTR_NONE, UTEE);
+
+	// box for train status info, with the title set within it
+	screen_puts(&screen, TRAIN_STATUS_Y_OFFSET - 1, TRAIN_STATUS_X_OFFSET, ATTR_NONE, "Train states");
+	hline(FEEDBACK_Y_OFFSET - 1, 1, SCREEN_WIDTH, LTEE, RTEE);
+
+	// then console feedback and console commands
+	hline(CONSOLE_Y_OFFSET - 1, 1, SCREEN_WIDTH, LTEE, RTEE);
+	hline(bottom, 1, SCREEN_WIDTH, BLCORNER, BRCORNER);
 
 	reset_console_cursor();
 }
@@ -252,9 +252,9 @@ static void initial_draw(void) {
 #endif
 enum displaysrv_req_type {
 	UPDATE_SWITCH, UPDATE_SENSOR, UPDATE_SENSOR_ATTRIBUTION,
-	UPDATE_TIME, UPDATE_TRACK,
+	UPDATE_TIME, UPDATE_TRACK, UPDATE_RELIABILITY,
 	CONSOLE_INPUT, CONSOLE_BACKSPACE, CONSOLE_CLEAR, CONSOLE_FEEDBACK,
-	CONSOLE_LOG, CONSOLE_FREEZE, QUIT};
+	CONSOLE_LOG, CONSOLE_FREEZE, FLUSH_FRAME, SET_FPS, QUIT};
 
 struct display_train_state {
 	int train_id;
@@ -281,6 +281,7 @@ struct displaysrv_req {
 		struct {
 			int *table;
 		} track;
+		struct reliability_report reliability;
 		struct {
 			char input;
 		} console_input;
@@ -296,6 +297,9 @@ struct displaysrv_req {
 		struct {
 			char msg[LOG_LINE_BUFSIZE];
 		} log;
+		struct {
+			int fps;
+		} fps;
 	} data;
 };
 
@@ -318,18 +322,13 @@ static void log_print(char *buf, const char *fmt, va_list va) {
 	}
 }
 static void handle_log(char *msg) {
-	printf("\e[s");
 	// +2 => 1 for 0->1 based index translation, 1 for header line.
-	printf("\e[%d;%dH%s", current_log_line + 2, 82, msg);
+	screen_putn(&screen, current_log_line + 2, LOG_X_OFFSET, ATTR_NONE, msg, MAX_LOG_LEN);
 	if (current_log_line < MAX_LOG_LINES - 1) {
 		// Print black line after current line to make log easier to follow.
-		char empty[LOG_LINE_BUFSIZE];
-		memset(empty, ' ', sizeof(empty));
-		empty[MAX_LOG_LEN] = '\0';
-		printf("\e[%d;%dH%s", current_log_line + 3, 82, empty);
+		screen_fill(&screen, current_log_line + 3, LOG_X_OFFSET, ATTR_NONE, ' ', MAX_LOG_LEN);
 	}
 	current_log_line = (current_log_line + 1) % MAX_LOG_LINES;
-	printf("\e[u");
 }
 // For logging internal to displaysrv.
 void dlogf(const char *fmt, ...) {
@@ -350,11 +349,9 @@ struct sensor_reads {
 	int start, len;
 	struct sensor_record sensors[SENSOR_BUF_SIZE];
 };
+#define SENSOR_LIST_WIDTH 20
 static void update_sensor_list_display(struct sensor_reads *reads) {
-	// TODO: It's pretty abusrdly wastefull how we reprint this whole sensor
-	// buffer every time an update comes in- we can just reprint the necessary
-	// line(s).
-	printf("\e[s");
+	// Only the lines which actually changed make it to the terminal.
 	for (int j = reads->len - 1; j >= 0; j--) {
 		char buf[4];
 		int i = (reads->start + j) % SENSOR_BUF_SIZE;
@@ -367,15 +364,15 @@ static void update_sensor_list_display(struct sensor_reads *reads) {
 		if (tr == -1) snprintf(attr, sizeof(attr), "!!"); // Spurious sensor
 		else if (tr == 0) snprintf(attr, sizeof(attr), "??"); // Unknown/no data
 		else snprintf(attr, sizeof(attr), "%2d", tr);
-		printf("\e[%d;%dH%6d %s     tr%s", SENSORS_Y_OFFSET + i,
-			   SENSORS_X_OFFSET, reads->sensors[i].time, buf, attr);
+		char line[SENSOR_LIST_WIDTH + 1];
+		snprintf(line, sizeof(line), "%6d %s     tr%s", reads->sensors[i].time, buf, attr);
+		screen_putn(&screen, SENSORS_Y_OFFSET + i, SENSORS_X_OFFSET, ATTR_NONE,
+				line, SENSOR_LIST_WIDTH);
 	}
 	if (reads->len == SENSOR_BUF_SIZE && reads->start > 0) {
-		printf("\e[%d;%dH                    ",
-			SENSORS_Y_OFFSET + (reads->start % SENSOR_BUF_SIZE),
-			SENSORS_X_OFFSET);
+		screen_fill(&screen, SENSORS_Y_OFFSET + (reads->start % SENSOR_BUF_SIZE),
+				SENSORS_X_OFFSET, ATTR_NONE, ' ', SENSOR_LIST_WIDTH);
 	}
-	printf("\e[u");
 }
 static void record_sensor_read(struct sensor_reads *reads, int ticks, int sensor) {
 	int last = (reads->start + reads->len) % SENSOR_BUF_SIZE;
@@ -401,8 +398,7 @@ static void update_sensor_display(int sensor, int blank) {
 		buf[2] = ' ';
 		buf[3] = '\0';
 	}
-	printf("\e[s\e[%d;%dH%s\e[u", coords.y + TRACK_Y_OFFSET,
-	       coords.x + TRACK_X_OFFSET, buf);
+	screen_puts(&screen, coords.y + TRACK_Y_OFFSET, coords.x + TRACK_X_OFFSET, ATTR_NONE, buf);
 }
 
 static void update_sensor_attribution(int sensor, int train,
@@ -413,22 +409,37 @@ static void update_sensor_attribution(int sensor, int train,
 
 		ASSERT(reads->sensors[i].train == 0);
 		reads->sensors[i].train = train;
-		update_sensor_list_display(reads);
 		return;
 	}
 	WTF("Attempted to attribute nonexistent sensor %d to train %d!", sensor, train);
 }
-static void update_sensor(struct sensor_state *sensors, struct sensor_state *old_sensors, struct sensor_reads *reads, unsigned delay_time) {
+// Every trip goes into the list, even if we never get to draw the state it
+// came from.
+static bool record_sensor_trips(struct sensor_state *sensors, struct sensor_state *old_sensors, struct sensor_reads *reads) {
+	bool recorded = false;
+	for (int i = 0; i < SENSOR_COUNT; i += 2) {
+		int s1 = sensor_get(sensors, i);
+		int s2 = sensor_get(sensors, i + 1);
+		if (s1 != sensor_get(old_sensors, i) || s2 != sensor_get(old_sensors, i + 1)) {
+			if (s1 || s2) {
+				record_sensor_read(reads, sensors->ticks, s1 ? i : i + 1);
+				recorded = true;
+			}
+		}
+	}
+	*old_sensors = *sensors;
+	return recorded;
+}
+static void update_sensor(struct sensor_state *sensors, struct sensor_state *old_sensors, unsigned delay_time) {
 	// update displayed sensor delay time
-	printf("\e[s\e[%d;%dH%03d\e[u", CLOCK_Y_OFFSET, CLOCK_X_OFFSET + 17, delay_time);
+	char delay[4];
+	snprintf(delay, sizeof(delay), "%03d", delay_time);
+	screen_puts(&screen, CLOCK_Y_OFFSET, CLOCK_X_OFFSET + 17, ATTR_NONE, delay);
 	for (int i = 0; i < SENSOR_COUNT; i += 2) {
 		int s1 = sensor_get(sensors, i);
 		int s2 = sensor_get(sensors, i + 1);
 		if (s1 != sensor_get(old_sensors, i) || s2 != sensor_get(old_sensors, i + 1)) {
-			int to_draw = s1 ? i : i + 1;
-			update_sensor_display(to_draw, !(s1 || s2));
-			if (s1 || s2) record_sensor_read(reads, sensors->ticks, to_draw);
-			update_sensor_list_display(reads);
+			update_sensor_display(s1 ? i : i + 1, !(s1 || s2));
 		}
 	}
 	*old_sensors = *sensors;
@@ -463,9 +474,10 @@ static void update_single_2switch(int sw, enum sw_direction pos) {
 			filler_char = (pos == STRAIGHT) ? '_' : ' ';
 			last_x += (disp.cr == '/') ? 1 : -1;
 		}
-		printf("\e[s\e[%d;%dH\e[1;33m%c\e[0m\e[%d;%dH%c\e[u",
-		       current_y + TRACK_Y_OFFSET, current_x + TRACK_X_OFFSET, switch_char,
-		       last_y + TRACK_Y_OFFSET, last_x + TRACK_X_OFFSET, filler_char);
+		screen_putc(&screen, current_y + TRACK_Y_OFFSET, current_x + TRACK_X_OFFSET,
+				ATTR_YELLOW, switch_char);
+		screen_putc(&screen, last_y + TRACK_Y_OFFSET, last_x + TRACK_X_OFFSET,
+				ATTR_NONE, filler_char);
 	} else {
 		//ASSERT(0 && "Unknown switch number");
 	}
@@ -506,11 +518,9 @@ static void update_single_3switch(int first_switch, enum sw_direction s1, enum s
 		b2x = coords->rx;
 		b2y = coords->ry;
 	}
-	printf("\e[s\e[%d;%dH\e[1;33m%c\e[0m\e[%d;%dH \e[%d;%dH \e[u",
-	       ty + TRACK_Y_OFFSET, tx + TRACK_X_OFFSET, switch_char,
-	       b1y + TRACK_Y_OFFSET, b1x + TRACK_X_OFFSET,
-	       b2y + TRACK_Y_OFFSET, b2x + TRACK_Y_OFFSET);
-
+	screen_putc(&screen, ty + TRACK_Y_OFFSET, tx + TRACK_X_OFFSET, ATTR_YELLOW, switch_char);
+	screen_putc(&screen, b1y + TRACK_Y_OFFSET, b1x + TRACK_X_OFFSET, ATTR_NONE, ' ');
+	screen_putc(&screen, b2y + TRACK_Y_OFFSET, b2x + TRACK_X_OFFSET, ATTR_NONE, ' ');
 }
 
 static void update_switch(struct switch_state *state, struct switch_state *old_state) {
@@ -542,47 +552,69 @@ static void update_time(unsigned millis) {
 	int idle_whole = idle / 10;
 	int idle_decimal = idle % 10;
 
-	printf("\e[s\e[%d;%dH%02d:%02d:%d " VLINE " %02d.%d%% " VLINE "\e[u",
-			CLOCK_Y_OFFSET, CLOCK_X_OFFSET - 1, minutes, seconds, tenths,
-			idle_whole, idle_decimal);
+	char buf[32];
+	snprintf(buf, sizeof(buf), "%02d:%02d:%d " VLINE " %02d.%d%% " VLINE,
+			minutes, seconds, tenths, idle_whole, idle_decimal);
+	screen_puts(&screen, CLOCK_Y_OFFSET, CLOCK_X_OFFSET - 1, ATTR_NONE, buf);
 }
 
 static void update_train_states(int active_trains, struct display_train_state *active_train_states,
                                 const struct switch_state *switches) {
 
-	puts("\e[s");
 	ASSERT(active_trains <= 4);
-	for (int i = 0; i < active_trains; i++) {
+	for (int i = 0; i < 4; i++) {
 		const int row = i;
 
 		const int term_col = TRAIN_STATUS_X_OFFSET;
 		const int term_row = TRAIN_STATUS_Y_OFFSET + row;
+		char buf[SCREEN_WIDTH - 2 + 1] = "";
 
-		const int train_id = active_train_states[i].train_id;
-
-		if (position_is_uninitialized(&active_train_states[i].state.position)) {
-			printf("\e[%d;%dH%d / %d => Train %d, position unknown",
-			       term_row, term_col, i, active_trains, train_id);
+		if (i >= active_trains) {
+			// leave the line blank
+		} else if (position_is_uninitialized(&active_train_states[i].state.position)) {
+			snprintf(buf, sizeof(buf), "%d / %d => Train %d, position unknown",
+			       i, active_trains, active_train_states[i].train_id);
 		} else {
+			const int train_id = active_train_states[i].train_id;
 			const int displacement = active_train_states[i].state.position.displacement;
 			const char *pos_name = active_train_states[i].state.position.edge->src->name;
 			const int velocity = active_train_states[i].state.velocity;
 			const int stopping_distance = active_train_states[i].est_stopping_distance;
 			const int error = active_train_states[i].error;
 
-			char buf[78];
-			int len = snprintf(buf, sizeof(buf), "\e[%d;%dH%d / %d => Train %d, %d mm past %s, vel %d, %d to stop, %d error",
-			       term_row, term_col, i, active_trains, train_id, displacement, pos_name, velocity,
+			snprintf(buf, sizeof(buf), "%d / %d => Train %d, %d mm past %s, vel %d, %d to stop, %d error",
+			       i, active_trains, train_id, displacement, pos_name, velocity,
 			       stopping_distance, error);
-			while (len < 78) {
-				buf[len] = ' ';
-				len++;
-			}
-			fput_buf(buf, sizeof(buf), COM2);
 		}
+		screen_putn(&screen, term_row, term_col, ATTR_NONE, buf, SCREEN_WIDTH - 2);
 	}
-	puts("\e[u");
 }
+// The worst sensors and switches, with the ones we've given up on in red
+static void update_reliability(const struct reliability_report *report) {
+	static const char *failure_names[] = { "missed", "phantom", "wrong" };
+	const int end = RELIABILITY_X_OFFSET + SCREEN_WIDTH - 2;
+	int col = screen_puts(&screen, RELIABILITY_Y_OFFSET, RELIABILITY_X_OFFSET, ATTR_NONE, "Track faults:");
+	if (report->len == 0) {
+		col = screen_puts(&screen, RELIABILITY_Y_OFFSET, col, ATTR_NONE, " none");
+	}
+	for (int i = 0; i < report->len; i++) {
+		const int failure = report->entries[i].failure;
+		char name[8];
+		if (failure == FAILURE_MISROUTE) {
+			snprintf(name, sizeof(name), "SW%d", report->entries[i].num);
+		} else {
+			sensor_repr(report->entries[i].num, name);
+		}
+		char buf[32];
+		snprintf(buf, sizeof(buf), " %s %s %d/%d", name, failure_names[failure],
+				report->entries[i].failures, report->entries[i].trials);
+		if (col + strlen(buf) > end) break;
+		col = screen_puts(&screen, RELIABILITY_Y_OFFSET, col,
+				report->entries[i].excluded ? ATTR_RED : ATTR_NONE, buf);
+	}
+	screen_fill(&screen, RELIABILITY_Y_OFFSET, col, ATTR_NONE, ' ', end - col);
+}
+
 struct node_display {
 	const char *name;
 	const char *name_r;
@@ -688,7 +720,7 @@ static int int_idx(int *a, int l, int n) {
 }
 static void update_track(int *track_table) {
 	//dlogf("Update_track called");
-	static int colors[] = {32, 34, 35, 36, 31};
+	static int colors[] = {ATTR_GREEN, ATTR_BLUE, ATTR_MAGENTA, ATTR_CYAN, ATTR_RED};
 	int ids[ARRAY_LENGTH(colors)] = {};
 	int id_i = 0;
 	for (int i = 0; i < TRACK_MAX; i++) {
@@ -701,44 +733,104 @@ static void update_track(int *track_table) {
 		ASSERT(id_i < ARRAY_LENGTH(colors));
 	}
 	dlogf("Found %d different trains reserving.", id_i);
-	puts("\e[s");
 	for (int i = 0; i < TRACK_MAX; i++) {
 		int x = -1, y = -1;
-		find_track_node_pos(track[i].name, &x, &y);
+		if (!find_track_node_pos(track[i].name, &x, &y)) continue;
 		if (track_table[i] > 0) {
-			printf("\e[%d;%dH\e[1;%dm#\e[0m", y + 2, x + 2,
-				   colors[int_idx(ids, id_i, track_table[i])]);
+			screen_putc(&screen, y + TRACK_Y_OFFSET, x + TRACK_X_OFFSET,
+					colors[int_idx(ids, id_i, track_table[i])], '#');
 		} else {
-			ASSERTF(x >= 0 && y >= 0, "%d %d", x, y);
-			printf("\e[%d;%dH%c", y + 2, x + 2, track_repr[y][x]);
+			screen_putc(&screen, y + TRACK_Y_OFFSET, x + TRACK_X_OFFSET,
+					ATTR_NONE, track_repr[y][x]);
 		}
-// 			puts("\e[s");
-// 			printf("\e[%d;%dH\e[1;31m%c\e[0m", y + 2, x + 2, track_repr[y][x]);
-// 			puts("\e[u");
 	}
-	puts("\e[u");
 }
 
 static void console_input(char c) {
-	putc(c);
+	if (console_col >= SCREEN_WIDTH - 1) return;
+	screen_putc(&screen, CONSOLE_Y_OFFSET, console_col++, ATTR_NONE, c);
+	reset_console_cursor();
 }
 
 static void console_backspace(void) {
-	puts("\b \b");
+	if (console_col <= CONSOLE_X_OFFSET) return;
+	screen_putc(&screen, CONSOLE_Y_OFFSET, --console_col, ATTR_NONE, ' ');
+	reset_console_cursor();
 }
 
 static void console_feedback(char *fb) {
-	puts("\e[s");
-	clear_line(FEEDBACK_Y_OFFSET);
-	puts(fb);
-	puts("\e[u");
+	screen_putn(&screen, FEEDBACK_Y_OFFSET, FEEDBACK_X_OFFSET, ATTR_NONE, fb, SCREEN_WIDTH - 2);
 }
 
 static void console_clear(void) {
 	clear_line(CONSOLE_Y_OFFSET);
+	console_col = CONSOLE_X_OFFSET;
+	reset_console_cursor();
 }
 
 static void displaysrv_update_time(int displaysrv, unsigned millis, int active_trains, const struct display_train_state *active_train_states);
+static int displaysrv_flush_frame(int displaysrv);
+
+// The displaysrv tells us how long to wait until the next frame each time
+static void frame_task(void) {
+	int displaysrv = parent_tid();
+	int ticks = time();
+	int frame_ticks = 1;
+	for (;;) {
+		ticks = delay_until(ticks + frame_ticks);
+		frame_ticks = displaysrv_flush_frame(displaysrv);
+	}
+}
+
+// Latest values of the widgets which are only drawn once per frame.
+// Updates which arrive between frames replace each other, so producers never
+// wait on us drawing states which nobody would get to see.
+struct widget_slots {
+	bool time_dirty;
+	unsigned millis;
+	int active_trains;
+	struct display_train_state active_train_states[MAX_ACTIVE_TRAINS];
+
+	bool sensors_dirty;
+	struct sensor_state sensors;
+	unsigned sensor_delay;
+	bool sensor_list_dirty;
+
+	bool switches_dirty;
+	struct switch_state switches;
+
+	bool track_dirty;
+	int track_table[TRACK_MAX];
+
+	bool reliability_dirty;
+	struct reliability_report reliability;
+};
+
+static void draw_frame(struct widget_slots *slots, struct sensor_state *drawn_sensors,
+		struct switch_state *drawn_switches, struct sensor_reads *sensor_reads) {
+	if (slots->time_dirty) {
+		update_time(slots->millis);
+		update_train_states(slots->active_trains, slots->active_train_states, drawn_switches);
+	}
+	if (slots->sensors_dirty) {
+		update_sensor(&slots->sensors, drawn_sensors, slots->sensor_delay);
+	}
+	if (slots->sensor_list_dirty) {
+		update_sensor_list_display(sensor_reads);
+	}
+	if (slots->switches_dirty) {
+		update_switch(&slots->switches, drawn_switches);
+	}
+	if (slots->track_dirty) {
+		update_track(slots->track_table);
+	}
+	if (slots->reliability_dirty) {
+		update_reliability(&slots->reliability);
+	}
+	slots->time_dirty = slots->sensors_dirty = slots->sensor_list_dirty = false;
+	slots->switches_dirty = slots->track_dirty = slots->reliability_dirty = false;
+	screen_flush(&screen);
+}
 
 static void clock_update_task(void) {
 	int ticks = 0;
@@ -777,6 +869,7 @@ void displaysrv(void) {
 	register_as(DISPLAYSRV_NAME);
 	ptid();
 	create(PRIORITY_DISPLAYSRV_CLOCK_UPDATE, clock_update_task);
+	create(PRIORITY_DISPLAYSRV_FRAME, frame_task);
 	signal_recv();
 
 #ifdef QEMU
@@ -785,12 +878,15 @@ void displaysrv(void) {
 #endif
 	initial_draw();
 
-	struct sensor_state old_sensors = {};
+	struct widget_slots slots = {};
+	slots.reliability_dirty = true;
+	struct sensor_state old_sensors = {}, drawn_sensors = {};
 	struct sensor_reads sensor_reads = {};
-	struct switch_state old_switches = {};
+	struct switch_state drawn_switches = {};
 	bool console_frozen = false;
+	int frame_ticks = (100 + DEFAULT_FPS - 1) / DEFAULT_FPS;
 
-	printf("\e[s\e[1;82H------LOG:-----\e[u");
+	screen_puts(&screen, 1, LOG_X_OFFSET, ATTR_NONE, "------LOG:-----");
 	int mock_table[TRACK_MAX] = {77, 77, 77, 77, 77, 77, 77, 77, 88, 88, 88, 88, 88, 88, 88, 88, 88, 88, 88, 88, 88, 88}; // For testing.
 	for (int i = 0; i < ARRAY_LENGTH(mock_table); i++) {
 		if (mock_table[i] == 0) mock_table[i] = 1;
@@ -801,29 +897,48 @@ void displaysrv(void) {
 		struct displaysrv_req req = {};
 		int tid = -1;
 		receive(&tid, &req, sizeof(req));
-		// requests are fire and forget, and provide no feedback
-		reply(tid, NULL, 0);
+		// requests are fire and forget, and provide no feedback, except for
+		// telling the frame task when to come back
+		if (req.type == FLUSH_FRAME) {
+			reply(tid, &frame_ticks, sizeof(frame_ticks));
+		} else {
+			reply(tid, NULL, 0);
+		}
 
 		if (console_frozen && req.type != CONSOLE_FREEZE) continue;
 
 		switch (req.type) {
 		case UPDATE_SWITCH:
-			update_switch(&req.data.sw.state, &old_switches);
+			slots.switches = req.data.sw.state;
+			slots.switches_dirty = true;
 			break;
 		case UPDATE_SENSOR:
-			update_sensor(&req.data.sensor.state, &old_sensors, &sensor_reads, req.data.sensor.avg_delay);
+			slots.sensor_list_dirty |= record_sensor_trips(&req.data.sensor.state, &old_sensors, &sensor_reads);
+			slots.sensors = req.data.sensor.state;
+			slots.sensor_delay = req.data.sensor.avg_delay;
+			slots.sensors_dirty = true;
 			break;
 		case UPDATE_SENSOR_ATTRIBUTION:
 			update_sensor_attribution(req.data.sensor_attribution.sensor,
 									  req.data.sensor_attribution.train,
 								&sensor_reads);
+			slots.sensor_list_dirty = true;
 			break;
 		case UPDATE_TIME:
-			update_time(req.data.time.millis);
-			update_train_states(req.data.time.active_trains, req.data.time.active_train_states, &old_switches);
+			slots.millis = req.data.time.millis;
+			slots.active_trains = req.data.time.active_trains;
+			memcpy(slots.active_train_states, req.data.time.active_train_states,
+					sizeof(struct display_train_state) * req.data.time.active_trains);
+			slots.time_dirty = true;
 			break;
 		case UPDATE_TRACK:
-			update_track(req.data.track.table);
+			// the table is on the sender's stack, so copy it before it runs again
+			memcpy(slots.track_table, req.data.track.table, sizeof(slots.track_table));
+			slots.track_dirty = true;
+			break;
+		case UPDATE_RELIABILITY:
+			slots.reliability = req.data.reliability;
+			slots.reliability_dirty = true;
 			break;
 		case CONSOLE_INPUT:
 			console_input(req.data.console_input.input);
@@ -845,7 +960,16 @@ void displaysrv(void) {
 		case CONSOLE_LOG:
 			handle_log(req.data.log.msg);
 			break;
+		case FLUSH_FRAME:
+			draw_frame(&slots, &drawn_sensors, &drawn_switches, &sensor_reads);
+			break;
+		case SET_FPS:
+			ASSERT(req.data.fps.fps > 0 && req.data.fps.fps <= DISPLAYSRV_MAX_FPS);
+			frame_ticks = (100 + req.data.fps.fps - 1) / req.data.fps.fps;
+			dlogf("Drawing the display every %d ticks", frame_ticks);
+			break;
 		case QUIT:
+			draw_frame(&slots, &drawn_sensors, &drawn_switches, &sensor_reads);
 			nameserver_dump_names();
 #ifdef QEMU
 			// http://invisible-island.net/xterm/ctlseqs/ctlseqs.html#h2-The-Alternate-Screen-Buffer
@@ -860,10 +984,30 @@ void displaysrv(void) {
 	}
 }
 
+// The display only ever needs to show the latest state, so it coalesces these.
+// Coalesced dumps are merged rather than replaced, so record_sensor_trips
+// still sees every trip.
+static void handle_sensors_published(const void *msg, unsigned len) {
+	ASSERT(len == sizeof(struct sensor_dump));
+	const struct sensor_dump *dump = msg;
+	struct sensor_state sensors = dump->sensors;
+	displaysrv_update_sensor(whois(DISPLAYSRV_NAME), &sensors, dump->delay_time);
+}
+
+static void handle_switches_published(const void *msg, unsigned len) {
+	ASSERT(len == sizeof(struct switch_state));
+	struct switch_state switches;
+	memcpy(&switches, msg, sizeof(switches));
+	displaysrv_update_switch(whois(DISPLAYSRV_NAME), &switches);
+}
+
 void displaysrv_start(void) {
 	int tid = create(PRIORITY_DISPLAYSRV, displaysrv);
 	// block until displaysrv has registered itself with the nameserver
 	signal_send(tid);
+
+	pubsub_subscribe(TOPIC_SENSORS, PRIORITY_DISPLAYSRV, handle_sensors_published, true, sensor_dump_merge);
+	pubsub_subscribe(TOPIC_SWITCHES, PRIORITY_DISPLAYSRV, handle_switches_published, true, NULL);
 }
 
 // external interface to displaysrv
@@ -926,6 +1070,12 @@ void displaysrv_update_track_table(int displaysrv, int *track_table) {
 	displaysrv_send(displaysrv, UPDATE_TRACK, &req);
 }
 
+void displaysrv_update_reliability(int displaysrv, const struct reliability_report *report) {
+	struct displaysrv_req req;
+	req.data.reliability = *report;
+	displaysrv_send(displaysrv, UPDATE_RELIABILITY, &req);
+}
+
 void displaysrv_log(const char *fmt, ...) {
 	va_list va;
 	va_start(va,fmt);
@@ -948,3 +1098,18 @@ static void displaysrv_update_time(int displaysrv, unsigned millis, int active_t
 	memcpy(&req.data.time.active_train_states, active_train_states, sizeof(struct display_train_state) * active_trains);
 	displaysrv_send(displaysrv, UPDATE_TIME, &req);
 }
+
+void displaysrv_set_fps(int displaysrv, int fps) {
+	struct displaysrv_req req;
+	req.data.fps.fps = fps;
+	displaysrv_send(displaysrv, SET_FPS, &req);
+}
+
+// returns the number of ticks until the next frame
+static int displaysrv_flush_frame(int displaysrv) {
+	struct displaysrv_req req;
+	req.type = FLUSH_FRAME;
+	int frame_ticks = 1;
+	send(displaysrv, &req, sizeof(req), &frame_ticks, sizeof(frame_ticks));
+	return frame_ticks;
+}
@@ -11,6 +11,7 @@ void displaysrv_update_switch(int displaysrv, struct switch_state *state);
 void displaysrv_update_sensor(int displaysrv, struct sensor_state *state, unsigned avg_delay);
 void displaysrv_update_sensor_attribution(int displaysrv, int sensor, int train);
 void displaysrv_update_track_table(int displaysrv, int *reservation_table);
+void displaysrv_update_reliability(int displaysrv, const struct reliability_report *report);
 void displaysrv_log(const char *fmt, ...);
 #define logf(...) displaysrv_log(__VA_ARGS__)
 void displaysrv_console_clear(int displaysrv);
@@ -18,4 +19,7 @@ void displaysrv_console_backspace(int displaysrv);
 void displaysrv_console_input(int displaysrv, char c);
 void displaysrv_console_feedback(int displaysrv, char *fb);
 void displaysrv_console_freeze(void); // Stops all console output.
+// Limits how often the screen is redrawn. Updates in between are dropped.
+#define DISPLAYSRV_MAX_FPS 100
+void displaysrv_set_fps(int displaysrv, int fps);
 void displaysrv_quit(int displaysrv);
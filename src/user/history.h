@@ -25,6 +25,7 @@
 #define HISTORY_GET_KVP PASTER(HISTORY_PREFIX, get_kvp)
 #define HISTORY_GET_KVP_BY_INDEX PASTER(HISTORY_PREFIX, get_kvp_by_index)
 #define HISTORY_SET PASTER(HISTORY_PREFIX, set)
+#define HISTORY_RETRACT PASTER(HISTORY_PREFIX, retract)
 
 HISTORY_KVP {
 	HISTORY_VAL st;
@@ -55,6 +56,8 @@ static inline HISTORY_KVP HISTORY_GET_KVP(const HISTORY_T *s, int time) {
 }
 
 void HISTORY_SET(HISTORY_T *s, HISTORY_VAL current, int time);
+// forgets the most recent state, for when it turns out to have been wrong
+void HISTORY_RETRACT(HISTORY_T *s);
 
 static inline HISTORY_VAL HISTORY_GET_BY_INDEX(const HISTORY_T *s, int index) {
 	ASSERTF(s->len >= index, "%d = index > len = %d in %s", index, s->len, __func__);
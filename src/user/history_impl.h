@@ -65,3 +65,9 @@ void HISTORY_SET(HISTORY_T *s, HISTORY_VAL current, int time) {
 		if (s->len != HISTORY_LEN) s->len++;
 	}
 }
+
+void HISTORY_RETRACT(HISTORY_T *s) {
+	ASSERT(s->len > 0);
+	s->offset = NORMALIZE_OFFSET(s->offset, -1);
+	s->len--;
+}
@@ -8,9 +8,12 @@
 #include "sensorsrv.h"
 #include "trainsrv.h"
 #include "routesrv.h"
+#include "plannersrv.h"
 #include "calibrate.h"
 #include "track.h"
 #include "tracksrv.h"
+#include "telemetrysrv.h"
+#include "benchmark.h"
 
 void print_stacked_registers(int *sp) {
 	int p = 0;
@@ -69,14 +72,20 @@ void init(void) {
 #else
 	tracksrv_start();
 	displaysrv_start();
+	telemetrysrv_start();
 	commandsrv_start();
 	trains_start();
 	routesrv_start();
+	plannersrv_start();
 	heartbeat_start();
 #endif
 	sensorsrv_start();
 }
 
 int main(int argc, char *argv[]) {
+#if BENCHMARK
+	boot(benchmark, PRIORITY_MIN, 0);
+#else
 	boot(init, PRIORITY_MIN, 1);
+#endif
 }
@@ -0,0 +1,413 @@
+#include "plannersrv.h"
+
+#include <kernel.h>
+#include <util.h>
+#include <assert.h>
+#include "request_type.h"
+#include "signal.h"
+#include "sys.h"
+#include "trainsrv.h"
+#include "tracksrv.h"
+#include "routesrv.h"
+#include "displaysrv.h"
+
+#define MIN_HEAP_PREFIX int
+#define MIN_HEAP_VALUE int
+#include <min_heap.h>
+
+#define idx TRACK_NODE_INDEX
+
+// A node is considered occupied for this many slots either side of the time
+// we expect the train to pass over it.
+#define PLANNER_PAD_SLOTS 1
+// If we can't find a plan departing right away, try waiting up to this many
+// slots before we leave.
+#define PLANNER_MAX_WAIT_SLOTS 8
+// Requests arriving within this many ticks of each other are planned jointly.
+#define PLANNER_BATCH_TICKS 5
+// Rough allowance for getting up to speed from a dead stop.
+#define PLANNER_ACCEL_TICKS 150
+
+static const int planner_speeds[] = { 14, 11, 8 };
+
+struct planner_request {
+	enum request_type type;
+	union {
+		struct {
+			int train_id;
+			const struct track_node *start;
+			const struct track_node *alt_start;
+			const struct track_node *dest;
+		} plan;
+		struct {
+			int train_id;
+		} release;
+		struct {
+			bool enabled;
+		} enable;
+	} u;
+};
+
+struct pending_plan {
+	int tid;
+	int train_id;
+	const struct track_node *start;
+	const struct track_node *alt_start;
+	const struct track_node *dest;
+};
+
+// Rows of the table are reused in a ring: row (slot % PLANNER_HORIZON)
+// describes absolute slot epoch[row], and is treated as empty if it describes
+// some other (stale) slot.
+struct st_table {
+	int epoch[PLANNER_HORIZON];
+	unsigned char owner[PLANNER_HORIZON][TRACK_MAX];
+};
+
+struct planner_state {
+	bool enabled;
+	bool round_pending;
+	struct pending_plan pending[MAX_ACTIVE_TRAINS];
+	int num_pending;
+	struct st_table st;
+};
+
+static int st_owner(const struct st_table *st, int slot, const struct track_node *node) {
+	if (slot < 0) return 0;
+	int row = slot % PLANNER_HORIZON;
+	if (st->epoch[row] != slot) return 0;
+	return st->owner[row][idx(node)];
+}
+
+static void st_claim(struct st_table *st, int now_slot, int slot,
+		const struct track_node *node, int train_id) {
+	// we can't see past the horizon, and the past doesn't matter
+	if (slot < now_slot || slot >= now_slot + PLANNER_HORIZON) return;
+	int row = slot % PLANNER_HORIZON;
+	if (st->epoch[row] != slot) {
+		memset(st->owner[row], 0, sizeof(st->owner[row]));
+		st->epoch[row] = slot;
+	}
+	st->owner[row][idx(node)] = train_id;
+	st->owner[row][idx(node->reverse)] = train_id;
+}
+
+static void st_release(struct st_table *st, int train_id) {
+	for (int row = 0; row < PLANNER_HORIZON; row++) {
+		for (int i = 0; i < TRACK_MAX; i++) {
+			if (st->owner[row][i] == train_id) st->owner[row][i] = 0;
+		}
+	}
+}
+
+static bool st_free(const struct st_table *st, int train_id,
+		const struct track_node *node, int ticks) {
+	int slot = ticks / PLANNER_SLOT_TICKS;
+	for (int s = slot - PLANNER_PAD_SLOTS; s <= slot + PLANNER_PAD_SLOTS; s++) {
+		int owner = st_owner(st, s, node);
+		if (owner != 0 && owner != train_id) return false;
+	}
+	return true;
+}
+
+// the train will sit at its destination once it gets there
+static bool st_free_from(const struct st_table *st, int train_id,
+		const struct track_node *node, int ticks, int now_slot) {
+	for (int s = ticks / PLANNER_SLOT_TICKS; s < now_slot + PLANNER_HORIZON; s++) {
+		int owner = st_owner(st, s, node);
+		if (owner != 0 && owner != train_id) return false;
+	}
+	return true;
+}
+
+static int h(const struct track_node *start, const struct track_node *end) {
+	int dx = start->coord_x - end->coord_x, dy = start->coord_y - end->coord_y;
+	return sqrti(dx*dx + dy*dy);
+}
+
+static int travel_ticks(int dist, int velocity) {
+	if (dist == 0) return 0;
+	return PLANNER_ACCEL_TICKS + dist * 1000 / velocity;
+}
+
+// Same as astar_find_path_avoiding, except that a node is only usable if it's
+// free in the space-time table at the time we expect to be passing over it.
+static int plan_search(const struct st_table *st, int train_id, int velocity,
+		int depart, int now_slot, const bool *blocked, unsigned avoid_switches,
+		const struct track_node *start, const struct track_node *end,
+		struct planner_plan *plan) {
+	if (blocked[idx(start)] || !st_free(st, train_id, start, depart)) return -1;
+
+	struct int_min_heap mh;
+	int_min_heap_init(&mh);
+	int_min_heap_push(&mh, 0, idx(start));
+	int node_g[TRACK_MAX] = {[0 ... TRACK_MAX-1] = 0x7FFFFFFF};
+	int node_f[TRACK_MAX] = {[0 ... TRACK_MAX-1] = 0x7FFFFFFF};
+	int node_parents[TRACK_MAX] = {[0 ... TRACK_MAX-1] = -1};
+	// node_g is the distance, which the timing depends on, so the penalties
+	// for avoided switches are kept separately
+	int node_penalty[TRACK_MAX];
+	node_g[idx(start)] = 0;
+	node_f[idx(start)] = 0;
+	node_penalty[idx(start)] = 0;
+
+	int found = -1;
+	if (start == end) {
+		found = idx(start);
+	}
+	while (found < 0 && !int_min_heap_empty(&mh)) {
+		int min_i = int_min_heap_pop(&mh);
+		const struct track_node *q = &track[min_i];
+		int suc_penalty = node_penalty[min_i];
+		if (q->type == NODE_BRANCH && (avoid_switches & SWITCH_BIT(q->num))) {
+			suc_penalty += ASTAR_AVOID_SWITCH_PENALTY;
+		}
+		for (int i = 0; i < 2; i++) {
+			const struct track_edge *edge = &q->edge[i];
+			const struct track_node *suc = edge->dest;
+			if (!suc) continue;
+			if (blocked[idx(suc)]) continue;
+
+			int suc_g = node_g[min_i] + edge->dist;
+			int suc_f = suc_g + suc_penalty + h(suc, end);
+			if (node_f[idx(suc)] < suc_f) continue;
+
+			int t = depart + travel_ticks(suc_g, velocity);
+			if (!st_free(st, train_id, suc, t)) continue;
+			if (suc == end && !st_free_from(st, train_id, suc, t, now_slot)) continue;
+
+			node_g[idx(suc)] = suc_g;
+			node_f[idx(suc)] = suc_f;
+			node_penalty[idx(suc)] = suc_penalty;
+			node_parents[idx(suc)] = min_i;
+			if (suc == end) {
+				found = idx(suc);
+				break;
+			}
+			int_min_heap_push(&mh, suc_f, idx(suc));
+		}
+	}
+	if (found < 0) return -1;
+
+	int l = 0;
+	for (int cur = found; cur >= 0; cur = node_parents[cur]) l++;
+	if (l > ASTAR_MAX_PATH) return -1;
+	int j = l;
+	for (int cur = found; cur >= 0; cur = node_parents[cur]) {
+		j--;
+		plan->path[j].node = &track[cur];
+		plan->arrival[j] = travel_ticks(node_g[cur], velocity);
+	}
+	plan->len = l;
+	return l;
+}
+
+static void claim_plan(struct st_table *st, int train_id, int now,
+		const struct planner_plan *plan) {
+	const int now_slot = now / PLANNER_SLOT_TICKS;
+	const int depart = now + plan->start_delay;
+
+	// we sit at the start until we depart
+	for (int s = now_slot; s <= depart / PLANNER_SLOT_TICKS; s++) {
+		st_claim(st, now_slot, s, plan->path[0].node, train_id);
+	}
+	for (int i = 0; i < plan->len; i++) {
+		int slot = (depart + plan->arrival[i]) / PLANNER_SLOT_TICKS;
+		for (int s = slot - PLANNER_PAD_SLOTS; s <= slot + PLANNER_PAD_SLOTS; s++) {
+			st_claim(st, now_slot, s, plan->path[i].node, train_id);
+		}
+	}
+	// and at the end after we arrive
+	int arrived = (depart + plan->arrival[plan->len - 1]) / PLANNER_SLOT_TICKS;
+	for (int s = arrived; s < now_slot + PLANNER_HORIZON; s++) {
+		st_claim(st, now_slot, s, plan->path[plan->len - 1].node, train_id);
+	}
+}
+
+// Try every speed, waiting time and starting direction, and keep whichever
+// plan gets us to the destination soonest.
+static void plan_one(struct planner_state *ps, const struct pending_plan *p,
+		int now, const bool *blocked, unsigned avoid_switches, struct planner_plan *best) {
+	const int now_slot = now / PLANNER_SLOT_TICKS;
+	struct planner_plan candidate;
+	int best_finish = 0x7FFFFFFF;
+	best->len = -1;
+
+	for (int si = 0; si < ARRAY_LENGTH(planner_speeds); si++) {
+		int velocity = trains_query_velocity(p->train_id, planner_speeds[si]);
+		if (velocity <= 0) continue;
+		for (int wait = 0; wait <= PLANNER_MAX_WAIT_SLOTS; wait++) {
+			int depart = now + wait * PLANNER_SLOT_TICKS;
+			const struct track_node *starts[] = { p->start, p->alt_start };
+			for (int r = 0; r < ARRAY_LENGTH(starts); r++) {
+				if (starts[r] == NULL) continue;
+				if (plan_search(&ps->st, p->train_id, velocity, depart, now_slot,
+							blocked, avoid_switches, starts[r], p->dest, &candidate) < 0) {
+					continue;
+				}
+				int finish = depart + candidate.arrival[candidate.len - 1];
+				if (finish < best_finish) {
+					best_finish = finish;
+					candidate.start_delay = depart - now;
+					candidate.speed = planner_speeds[si];
+					candidate.reversed = r == 1;
+					memcpy(best, &candidate, sizeof(*best));
+				}
+			}
+		}
+	}
+
+	if (best->len < 0) {
+		logf("Planner: no conflict-free plan for train %d to %s",
+				p->train_id, p->dest->name);
+		return;
+	}
+	claim_plan(&ps->st, p->train_id, now, best);
+	logf("Planner: train %d to %s, %d nodes at speed %d, departing in %d ticks",
+			p->train_id, p->dest->name, best->len, best->speed, best->start_delay);
+}
+
+static void planning_round(struct planner_state *ps) {
+	const int now = time();
+	int reservation_table[TRACK_MAX];
+	tracksrv_get_reservation_table(reservation_table);
+	const unsigned avoid_switches = trains_get_unreliable_switches();
+
+	// plans for trains in this round replace whatever they had before
+	for (int i = 0; i < ps->num_pending; i++) {
+		st_release(&ps->st, ps->pending[i].train_id);
+	}
+
+	// longest trips first, since those are the hardest to fit in later
+	for (int i = 1; i < ps->num_pending; i++) {
+		struct pending_plan p = ps->pending[i];
+		int key = h(p.start, p.dest);
+		int j = i - 1;
+		while (j >= 0 && h(ps->pending[j].start, ps->pending[j].dest) < key) {
+			ps->pending[j + 1] = ps->pending[j];
+			j--;
+		}
+		ps->pending[j + 1] = p;
+	}
+
+	for (int i = 0; i < ps->num_pending; i++) {
+		const struct pending_plan *p = &ps->pending[i];
+		bool blocked[TRACK_MAX];
+		routesrv_blocked_table_from_reservation_table(reservation_table, blocked, p->tid);
+		struct planner_plan plan;
+		plan_one(ps, p, now, blocked, avoid_switches, &plan);
+		reply(p->tid, &plan, sizeof(plan));
+	}
+	ps->num_pending = 0;
+	ps->round_pending = false;
+}
+
+static void handle_plan(struct planner_state *ps, int tid, struct planner_request *req) {
+	if (!ps->enabled) {
+		int len = PLANNER_DISABLED;
+		reply(tid, &len, sizeof(len));
+		return;
+	}
+	// only the latest request for each train gets planned
+	int i;
+	for (i = 0; i < ps->num_pending; i++) {
+		if (ps->pending[i].train_id == req->u.plan.train_id) break;
+	}
+	if (i < ps->num_pending) {
+		int len = PLANNER_SUPERSEDED;
+		reply(ps->pending[i].tid, &len, sizeof(len));
+	} else {
+		ASSERT(ps->num_pending < MAX_ACTIVE_TRAINS);
+		ps->num_pending++;
+	}
+	ps->pending[i] = (struct pending_plan) {
+		.tid = tid,
+		.train_id = req->u.plan.train_id,
+		.start = req->u.plan.start,
+		.alt_start = req->u.plan.alt_start,
+		.dest = req->u.plan.dest,
+	};
+	if (!ps->round_pending) {
+		struct planner_request round = { .type = PLN_ROUND };
+		delay_async(PLANNER_BATCH_TICKS, &round, sizeof(round), -1);
+		ps->round_pending = true;
+	}
+}
+
+static void plannersrv(void) {
+	register_as("planner");
+	signal_recv();
+
+	struct planner_state ps;
+	memset(&ps, 0, sizeof(ps));
+	for (int i = 0; i < PLANNER_HORIZON; i++) ps.st.epoch[i] = -1;
+
+	for (;;) {
+		int tid = -1;
+		struct planner_request req;
+		receive(&tid, &req, sizeof(req));
+		switch (req.type) {
+		case PLN_PLAN:
+			handle_plan(&ps, tid, &req);
+			break;
+		case PLN_ROUND:
+			reply(tid, NULL, 0);
+			planning_round(&ps);
+			break;
+		case PLN_RELEASE:
+			reply(tid, NULL, 0);
+			st_release(&ps.st, req.u.release.train_id);
+			break;
+		case PLN_ENABLE:
+			reply(tid, NULL, 0);
+			ps.enabled = req.u.enable.enabled;
+			logf("Planner %s", ps.enabled ? "enabled" : "disabled");
+			break;
+		default:
+			WTF("Unknown planner request %d from %d", req.type, tid);
+		}
+	}
+}
+
+void plannersrv_start(void) {
+	int tid = create(PRIORITY_PLANNERSRV, plannersrv);
+	signal_send(tid);
+}
+
+static int plannersrv_tid(void) {
+	static int tid = -1;
+	if (tid < 0) tid = whois("planner");
+	return tid;
+}
+
+int plannersrv_plan(int train_id, const struct track_node *start,
+		const struct track_node *alt_start, const struct track_node *dest,
+		struct planner_plan *plan) {
+	struct planner_request req = {
+		.type = PLN_PLAN,
+		.u.plan.train_id = train_id,
+		.u.plan.start = start,
+		.u.plan.alt_start = alt_start,
+		.u.plan.dest = dest,
+	};
+	// a disabled planner only replies with the length
+	plan->len = PLANNER_DISABLED;
+	send(plannersrv_tid(), &req, sizeof(req), plan, sizeof(*plan));
+	return plan->len;
+}
+
+void plannersrv_release(int train_id) {
+	struct planner_request req = {
+		.type = PLN_RELEASE,
+		.u.release.train_id = train_id,
+	};
+	send(plannersrv_tid(), &req, sizeof(req), NULL, 0);
+}
+
+void plannersrv_set_enabled(bool enabled) {
+	struct planner_request req = {
+		.type = PLN_ENABLE,
+		.u.enable.enabled = enabled,
+	};
+	send(plannersrv_tid(), &req, sizeof(req), NULL, 0);
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <astar.h>
+
+// Centralised multi-train planner.
+//
+// Conductors hand their destination requests to the planner instead of
+// routing on their own. Requests which arrive close together are batched into
+// a planning round, and planned one train at a time (longest trip first)
+// against a space-time reservation table, so that each plan avoids the track
+// which earlier plans will be occupying when it gets there.
+
+// Length of one slot of the space-time reservation table, in ticks
+#define PLANNER_SLOT_TICKS 50
+// Number of slots we look into the future
+#define PLANNER_HORIZON 64
+
+#define PLANNER_DISABLED -2
+// another plan request for the same train came in before this one was planned
+#define PLANNER_SUPERSEDED -3
+
+struct planner_plan {
+	// length of path, or < 0 if no conflict-free plan could be found
+	int len;
+	// speed profile: hold at the start for start_delay ticks, then run the
+	// whole path at the given speed setting
+	int start_delay;
+	int speed;
+	// if true, the train has to be reversed before departing
+	bool reversed;
+	struct astar_node path[ASTAR_MAX_PATH];
+	// expected ticks after departure at which we reach each node of the path
+	int arrival[ASTAR_MAX_PATH];
+};
+
+void plannersrv_start(void);
+
+// Blocks until the next planning round has finished.
+// Returns plan->len, or PLANNER_DISABLED if the planner is turned off, in
+// which case the caller should fall back to routesrv_plan, or
+// PLANNER_SUPERSEDED if the train asked again for somewhere else.
+int plannersrv_plan(int train_id, const struct track_node *start,
+		const struct track_node *alt_start, const struct track_node *dest,
+		struct planner_plan *plan);
+
+// Drop all space-time reservations held by this train
+void plannersrv_release(int train_id);
+
+void plannersrv_set_enabled(bool enabled);
@@ -1,9 +1,9 @@
 #include "polymath.h"
 #include <assert.h>
 
-const long long fixed_point_scale = 1 << 20;
+const long long fixed_point_scale = 1 << FIXED_POINT_BITS;
 
-// internally, we use fixed point math (10 binary places) for x
+// internally, we use fixed point math (20 binary places) for x
 long long evaluate_polynomial_fp(long long x, const long long *coefs, unsigned n) {
 	long long result = 0;
 	long long xp = 1 * fixed_point_scale;
@@ -48,3 +48,61 @@ struct curve_scaling scale_deceleration_curve(long long v0, long long d, const l
 
 	return cs;
 }
+
+// c[n - 1] x^(n - 1) + ... + c[1] x + c[0], as (((c[n - 1]) x + ...) x + c[0]
+// The partial sums don't fit in 32 bits for the acceleration curve, so each
+// step is a 64x32 bit multiply-accumulate.
+static inline long long horner(const long long *c, unsigned n, int x) {
+	long long r = c[n - 1];
+	for (int i = n - 2; i >= 0; i--) {
+		r = ((r * x + (1 << (FIXED_POINT_BITS - 1))) >> FIXED_POINT_BITS) + c[i];
+	}
+	return r;
+}
+
+static long long div_round(long long num, long long den) {
+	return (num + (num < 0 ? -den : den) / 2) / den;
+}
+
+static long long drop_guard_bits(long long r) {
+	return (r + (1 << (POLYNOMIAL_GUARD_BITS - 1))) >> POLYNOMIAL_GUARD_BITS;
+}
+
+static long long antiderivative(const struct polynomial *p, long long x) {
+	const long long r = horner(p->antiderivative, p->n, x) * x;
+	return (r + (1LL << (FIXED_POINT_BITS + POLYNOMIAL_GUARD_BITS - 1)))
+		>> (FIXED_POINT_BITS + POLYNOMIAL_GUARD_BITS);
+}
+
+void polynomial_init(struct polynomial *p, const long long *coefs, unsigned n, long long end) {
+	ASSERT(0 < n && n <= POLYNOMIAL_MAX_TERMS);
+	p->n = n;
+	for (unsigned i = 0; i < n; i++) {
+		p->coefs[i] = coefs[i];
+		p->horner_coefs[i] = coefs[i] * (1 << POLYNOMIAL_GUARD_BITS);
+		p->antiderivative[i] = div_round(p->horner_coefs[i], i + 1);
+	}
+	p->end = end;
+	p->value_at_end = polynomial_evaluate(p, end);
+	p->area = antiderivative(p, end);
+}
+
+long long polynomial_evaluate(const struct polynomial *p, long long x) {
+	return drop_guard_bits(horner(p->horner_coefs, p->n, x));
+}
+
+long long polynomial_integrate(const struct polynomial *p, long long lo, long long hi) {
+	// Almost every integral starts at 0 or runs to the end of the curve, and
+	// the antiderivative is already known at both.
+	const long long from = lo == 0 ? 0 : lo == p->end ? p->area : antiderivative(p, lo);
+	const long long to = hi == 0 ? 0 : hi == p->end ? p->area : antiderivative(p, hi);
+	return to - from;
+}
+
+struct curve_scaling polynomial_scale_deceleration(long long v0, long long d, const struct polynomial *p) {
+	struct curve_scaling cs;
+	ASSERT(p->coefs[0] != 0);
+	cs.y_scale = v0 * fixed_point_scale / p->coefs[0];
+	cs.x_scale = cs.y_scale * p->area / d;
+	return cs;
+}
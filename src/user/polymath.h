@@ -3,17 +3,51 @@
 // a polynomial is represented as an array of coefficients
 // { a, b, c } represents the polynomial a + b x + b x^2
 
+#define FIXED_POINT_BITS 20
+
 extern const long long fixed_point_scale;
 
-long long integrate_polynomial(long long lo, long long hi, const long long *coefs, unsigned n);
+#define POLYNOMIAL_MAX_TERMS 8
+// extra binary places kept while evaluating, to make up for Horner form
+// multiplying the rounding error of each step by x in the next
+#define POLYNOMIAL_GUARD_BITS 4
+
+// A polynomial prepared for repeated evaluation over [0, end].
+// The antiderivative's coefficients are worked out once up front, and both are
+// evaluated in Horner form, so each term costs one multiply-accumulate rather
+// than two multiplies and a division.
+// x must be within [0, end], or the partial sums may overflow.
+struct polynomial {
+	unsigned n;
+	// as given, so coefs[0] is f(0)
+	long long coefs[POLYNOMIAL_MAX_TERMS];
+	// the coefficients, and those of F(x) / x, where F is the antiderivative
+	// with F(0) = 0, both with the guard bits
+	long long horner_coefs[POLYNOMIAL_MAX_TERMS];
+	long long antiderivative[POLYNOMIAL_MAX_TERMS];
+	// the end of the curve, which most integrals run to, and its values there
+	long long end;
+	long long value_at_end;
+	long long area;
+};
+
+void polynomial_init(struct polynomial *p, const long long *coefs, unsigned n, long long end);
+long long polynomial_evaluate(const struct polynomial *p, long long x);
+long long polynomial_integrate(const struct polynomial *p, long long lo, long long hi);
 
 struct curve_scaling {
 	long long x_scale;
 	long long y_scale;
 };
 
+// fits p to stopping from v0 in d, by the end of the curve
+struct curve_scaling polynomial_scale_deceleration(long long v0, long long d, const struct polynomial *p);
+
+// The originals, which evaluate every power of x from scratch.
+// These are kept as a reference for the tests and benchmarks.
+long long integrate_polynomial(long long lo, long long hi, const long long *coefs, unsigned n);
+
 struct curve_scaling scale_deceleration_curve(long long v0, long long d, const long long *coefs,
 		unsigned n, long long t1_generic);
 
-// should be static
 long long evaluate_polynomial_fp(long long x, const long long *coefs, unsigned n);
@@ -9,8 +9,14 @@ enum request_type {
 	QUERY_ACTIVE, QUERY_SPATIALS, QUERY_ARRIVAL, SEND_SENSORS,
 	SET_SPEED, REVERSE, REVERSE_UNSAFE, SWITCH_SWITCH, SWITCH_GET,
     GET_STOPPING_DISTANCE, SET_STOPPING_DISTANCE, GET_LAST_KNOWN_SENSOR,
-    QUERY_ERROR, // Trains server
+    QUERY_ERROR, QUERY_VELOCITY, PLAN_MOTION, DUMP_CALIBRATION,
+    SWITCH_GET_UNRELIABLE, // Trains server
 
-	CND_DEST, CND_SENSOR, CND_SWITCH_TIMEOUT, CND_STOP_TIMEOUT, // Conductor
-	TRK_RESERVE_PATH, TRK_RESERVE, TRK_SET_ID, TRK_TABLE, // tracksrv
+	CND_DEST, CND_SENSOR, CND_SWITCH_TIMEOUT, CND_STOP_TIMEOUT, CND_DEPART,
+	CND_RESERVE_RETRY, // Conductor
+	TRK_RESERVE_PATH, TRK_RESERVE, TRK_SET_ID, TRK_TABLE, TRK_STATS,
+	TRK_STOP_WAITING, // tracksrv
+	PLN_PLAN, PLN_ROUND, PLN_RELEASE, PLN_ENABLE, // plannersrv
+	PUB_PUBLISH, PUB_SUBSCRIBE, PUB_NEXT, // pubsub
+	TLM_SAMPLE, TLM_ATTRIBUTION, TLM_RESERVATIONS, TLM_SET_RATE, // telemetrysrv
 };
@@ -4,12 +4,14 @@
 #include "tracksrv.h"
 #include "sys/nameserver.h"
 #include "displaysrv.h"
+#include "trainsrv.h"
 
 struct route_request {
 	const struct track_node *start;
 	const struct track_node *end;
 	struct astar_node *path_out;
 	bool *blocked_table;
+	unsigned avoid_switches;
 };
 
 void routesrv(void) {
@@ -21,7 +23,8 @@ void routesrv(void) {
 		recv(&tid, &req, sizeof(req));
 		// TODO: this should be message passing the path back - this thing
 		// is just writing memory which belongs to another task, which is ~illegal
-		int res = astar_find_path(req.start, req.end, req.path_out, req.blocked_table);
+		int res = astar_find_path_avoiding(req.start, req.end, req.path_out, req.blocked_table,
+				req.avoid_switches);
 		reply(tid, &res, sizeof(res));
 	}
 }
@@ -56,6 +59,7 @@ int routesrv_plan(const struct track_node *start, const struct track_node *end,
 		.end = end,
 		.path_out = path_out,
 		.blocked_table = blocked_table,
+		.avoid_switches = trains_get_unreliable_switches(),
 	};
 	int result = -2;
 	send(route_tid, &req, sizeof(req), &result, sizeof(result));
@@ -0,0 +1,229 @@
+#include "screen.h"
+
+#include <io.h>
+
+// Glyphs >= GLYPH_BASE are indices into this table
+#define GLYPH_BASE 0x80
+static const char *glyphs[] = {
+	"\xe2\x94\x80", // horizontal line
+	"\xe2\x94\x82", // vertical line
+	"\xe2\x94\x8c", // upper left corner
+	"\xe2\x94\x90", // upper right corner
+	"\xe2\x94\x94", // lower left corner
+	"\xe2\x94\x98", // lower right corner
+	"\xe2\x94\x9c", // left tee
+	"\xe2\x94\xa4", // right tee
+	"\xe2\x94\xac", // down tee
+	"\xe2\x94\xb4", // up tee
+	"\xe2\x94\xbc", // cross
+	"\xe2\x80\xa6", // ellipsis
+};
+
+// Unchanged cells between two changed runs are resent rather than moving the
+// cursor over them, if there are at most this many of them.
+#define MAX_RUN_GAP 4
+
+#define OUTPUT_BUFSIZE 256
+// the longest thing we emit at once - a cursor move or attribute change
+#define MAX_TOKEN_LEN 16
+
+static bool in_bounds(int row, int col) {
+	return row >= 1 && row <= SCREEN_ROWS && col >= 1 && col <= SCREEN_COLS;
+}
+
+void screen_init(struct screen *s, screen_output output) {
+	const struct screen_cell blank = { ' ', ATTR_NONE };
+	for (int r = 0; r < SCREEN_ROWS; r++) {
+		for (int c = 0; c < SCREEN_COLS; c++) {
+			s->cells[r][c] = s->shown[r][c] = blank;
+		}
+		s->dirty_lo[r] = SCREEN_COLS;
+		s->dirty_hi[r] = 0;
+	}
+	s->cursor_row = s->cursor_col = 1;
+	s->cursor_moved = true;
+	s->needs_clear = true;
+	s->output = output;
+}
+
+static void put_glyph(struct screen *s, int row, int col, int attr, unsigned char glyph) {
+	if (!in_bounds(row, col)) return;
+	struct screen_cell *cell = &s->cells[row - 1][col - 1];
+	if (cell->glyph == glyph && cell->attr == attr) return;
+	cell->glyph = glyph;
+	cell->attr = attr;
+	if (col - 1 < s->dirty_lo[row - 1]) s->dirty_lo[row - 1] = col - 1;
+	if (col > s->dirty_hi[row - 1]) s->dirty_hi[row - 1] = col;
+}
+
+void screen_putc(struct screen *s, int row, int col, int attr, char c) {
+	put_glyph(s, row, col, attr, (c < ' ' || c > '~') ? '?' : c);
+}
+
+// Decodes the character at str into a glyph, returning the number of bytes it
+// took up.
+static int decode_glyph(const char *str, unsigned char *glyph) {
+	const unsigned char lead = str[0];
+	if (lead < 0x80) {
+		*glyph = (lead < ' ' || lead > '~') ? '?' : lead;
+		return 1;
+	}
+	int len = (lead >= 0xf0) ? 4 : (lead >= 0xe0) ? 3 : 2;
+	for (int i = 1; i < len; i++) {
+		if (str[i] == '\0') len = i;
+	}
+	*glyph = '?';
+	for (int i = 0; i < ARRAY_LENGTH(glyphs); i++) {
+		if (len == 3 && glyphs[i][0] == str[0] && glyphs[i][1] == str[1] && glyphs[i][2] == str[2]) {
+			*glyph = GLYPH_BASE + i;
+			break;
+		}
+	}
+	return len;
+}
+
+int screen_puts(struct screen *s, int row, int col, int attr, const char *str) {
+	while (*str) {
+		unsigned char glyph;
+		str += decode_glyph(str, &glyph);
+		put_glyph(s, row, col++, attr, glyph);
+	}
+	return col;
+}
+
+void screen_putn(struct screen *s, int row, int col, int attr, const char *str, int width) {
+	int i = 0;
+	while (*str && i < width) {
+		unsigned char glyph;
+		str += decode_glyph(str, &glyph);
+		put_glyph(s, row, col + i++, attr, glyph);
+	}
+	screen_fill(s, row, col + i, attr, ' ', width - i);
+}
+
+void screen_fill(struct screen *s, int row, int col, int attr, char c, int width) {
+	for (int i = 0; i < width; i++) {
+		put_glyph(s, row, col + i, attr, c);
+	}
+}
+
+void screen_set_cursor(struct screen *s, int row, int col) {
+	if (row == s->cursor_row && col == s->cursor_col) return;
+	s->cursor_row = row;
+	s->cursor_col = col;
+	s->cursor_moved = true;
+}
+
+// Output state for a single flush
+struct emitter {
+	struct screen *s;
+	char buf[OUTPUT_BUFSIZE];
+	int len, total;
+	// where the terminal's cursor is, or row < 0 if we don't know
+	int row, col;
+	int attr;
+};
+
+static void emit_flush(struct emitter *e) {
+	if (e->len == 0) return;
+	e->s->output(e->buf, e->len);
+	e->total += e->len;
+	e->len = 0;
+}
+
+static void emit_reserve(struct emitter *e, int len) {
+	if (e->len + len > sizeof(e->buf)) emit_flush(e);
+}
+
+static void emit_move(struct emitter *e, int row, int col) {
+	if (e->row == row && e->col == col) return;
+	emit_reserve(e, MAX_TOKEN_LEN);
+	char *buf = e->buf + e->len;
+	if (e->row == row && col > e->col) {
+		e->len += snprintf(buf, MAX_TOKEN_LEN, "\e[%dC", col - e->col);
+	} else {
+		e->len += snprintf(buf, MAX_TOKEN_LEN, "\e[%d;%dH", row, col);
+	}
+	e->row = row;
+	e->col = col;
+}
+
+static void emit_cell(struct emitter *e, struct screen_cell cell) {
+	emit_reserve(e, MAX_TOKEN_LEN);
+	if (cell.attr != e->attr) {
+		char *buf = e->buf + e->len;
+		if (cell.attr == ATTR_NONE) {
+			e->len += snprintf(buf, MAX_TOKEN_LEN, "\e[0m");
+		} else {
+			e->len += snprintf(buf, MAX_TOKEN_LEN, "\e[0;1;%dm", cell.attr);
+		}
+		e->attr = cell.attr;
+	}
+	if (cell.glyph >= GLYPH_BASE) {
+		const char *g = glyphs[cell.glyph - GLYPH_BASE];
+		while (*g) e->buf[e->len++] = *g++;
+	} else {
+		e->buf[e->len++] = cell.glyph;
+	}
+	// terminals differ on what happens after writing the last column
+	if (++e->col > SCREEN_COLS) e->row = -1;
+}
+
+static bool cell_changed(struct screen *s, int r, int c) {
+	return s->cells[r][c].glyph != s->shown[r][c].glyph ||
+		s->cells[r][c].attr != s->shown[r][c].attr;
+}
+
+static void flush_row(struct emitter *e, int r) {
+	struct screen *s = e->s;
+	const int hi = s->dirty_hi[r];
+	int c = s->dirty_lo[r];
+	while (c < hi) {
+		if (!cell_changed(s, r, c)) {
+			c++;
+			continue;
+		}
+		// find the end of this run, bridging small unchanged gaps
+		int last = c;
+		for (int i = c + 1; i < hi && i - last <= MAX_RUN_GAP; i++) {
+			if (cell_changed(s, r, i)) last = i;
+		}
+		emit_move(e, r + 1, c + 1);
+		for (; c <= last; c++) {
+			emit_cell(e, s->cells[r][c]);
+			s->shown[r][c] = s->cells[r][c];
+		}
+	}
+	s->dirty_lo[r] = SCREEN_COLS;
+	s->dirty_hi[r] = 0;
+}
+
+int screen_flush(struct screen *s) {
+	struct emitter e = { .s = s, .row = -1, .col = -1, .attr = ATTR_NONE };
+	if (s->needs_clear) {
+		e.len += snprintf(e.buf, MAX_TOKEN_LEN, "\e[0m\e[2J");
+		for (int r = 0; r < SCREEN_ROWS; r++) {
+			for (int c = 0; c < SCREEN_COLS; c++) {
+				s->shown[r][c] = (struct screen_cell) { ' ', ATTR_NONE };
+			}
+			// everything that isn't blank needs to be redrawn
+			s->dirty_lo[r] = 0;
+			s->dirty_hi[r] = SCREEN_COLS;
+		}
+		s->needs_clear = false;
+	}
+	for (int r = 0; r < SCREEN_ROWS; r++) {
+		flush_row(&e, r);
+	}
+	if (e.len + e.total > 0 || s->cursor_moved) {
+		if (e.attr != ATTR_NONE) {
+			emit_reserve(&e, MAX_TOKEN_LEN);
+			e.len += snprintf(e.buf + e.len, MAX_TOKEN_LEN, "\e[0m");
+		}
+		e.row = -1;
+		emit_move(&e, s->cursor_row, s->cursor_col);
+		s->cursor_moved = false;
+	}
+	emit_flush(&e);
+	return e.total;
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <util.h>
+
+// Virtual terminal screen with damage tracking.
+//
+// Drawing only updates an in-memory grid of cells. screen_flush then
+// compares the grid against what we last sent to the terminal, and emits just
+// the cursor moves and runs of cells which changed, so redrawing something
+// which hasn't changed costs nothing on the wire.
+//
+// Rows and columns are 1-based, to match ANSI cursor addressing.
+
+// big enough for the main panels plus the log to the right of them
+#define SCREEN_ROWS 61
+#define SCREEN_COLS 181
+
+// Attributes are 0 for plain text, or an ANSI foreground colour (30-37),
+// which is drawn bold.
+#define ATTR_NONE 0
+#define ATTR_RED 31
+#define ATTR_GREEN 32
+#define ATTR_YELLOW 33
+#define ATTR_BLUE 34
+#define ATTR_MAGENTA 35
+#define ATTR_CYAN 36
+
+struct screen_cell {
+	// ASCII, or one of the multibyte glyphs we know how to draw (see screen.c)
+	unsigned char glyph;
+	unsigned char attr;
+};
+
+// Called with chunks of output. Escape sequences are never split across
+// chunks.
+typedef void (*screen_output)(const char *buf, int len);
+
+struct screen {
+	// what we want on the terminal
+	struct screen_cell cells[SCREEN_ROWS][SCREEN_COLS];
+	// what we think is on the terminal
+	struct screen_cell shown[SCREEN_ROWS][SCREEN_COLS];
+	// columns [dirty_lo, dirty_hi) of each row may differ from what's shown
+	short dirty_lo[SCREEN_ROWS], dirty_hi[SCREEN_ROWS];
+
+	// where the cursor is left after each flush
+	int cursor_row, cursor_col;
+	bool cursor_moved;
+	bool needs_clear;
+
+	screen_output output;
+};
+
+// The first flush clears the terminal, and draws everything from scratch.
+void screen_init(struct screen *s, screen_output output);
+
+// Non-printable characters are drawn as '?'
+void screen_putc(struct screen *s, int row, int col, int attr, char c);
+
+// Draws a UTF-8 string, returning the column after the last cell drawn.
+// Multibyte characters other than the box drawing characters and ellipsis are
+// drawn as '?'.
+int screen_puts(struct screen *s, int row, int col, int attr, const char *str);
+
+// Like screen_puts, but clipped or padded with spaces to exactly width cells
+void screen_putn(struct screen *s, int row, int col, int attr, const char *str, int width);
+
+void screen_fill(struct screen *s, int row, int col, int attr, char c, int width);
+
+void screen_set_cursor(struct screen *s, int row, int col);
+
+// Sends everything which changed since the last flush to the output.
+// Returns the number of bytes written.
+int screen_flush(struct screen *s);
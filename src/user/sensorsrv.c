@@ -1,7 +1,6 @@
 #include "sensorsrv.h"
 #include "displaysrv.h"
 #include "sys.h"
-#include "calibrate.h"
 #include <assert.h>
 #include <io.h>
 #include <kernel.h>
@@ -46,6 +45,55 @@ void sensor_each_new(struct sensor_state *old, struct sensor_state *new,
 	}
 }
 
+int sensor_trip_time(const struct sensor_state *s, int num) {
+	const int word_num = num / 8;
+	ASSERTF(word_num < ARRAY_LENGTH(s->trip_ticks), "%d %d", word_num, ARRAY_LENGTH(s->trip_ticks));
+	return s->trip_ticks[word_num];
+}
+
+// sensor dumps only just fit in a pubsub update
+typedef char sensor_dump_fits_in_msg[(sizeof(struct sensor_dump) <= PUBSUB_MAX_MSG) ? 1 : -1];
+
+void sensor_dump_merge(void *older, const void *newer) {
+	struct sensor_dump *a = older;
+	const struct sensor_dump *b = newer;
+	for (int i = 0; i < SENSOR_BYTES; i++) {
+		// A byte which already had trips keeps its trip time, which is off for
+		// any sensors in it which only tripped in the newer dump, but that's
+		// better than losing them.
+		if (a->sensors.packed[i] == 0) {
+			a->sensors.trip_ticks[i] = b->sensors.trip_ticks[i];
+		}
+		a->sensors.packed[i] |= b->sensors.packed[i];
+	}
+	a->sensors.ticks = b->sensors.ticks;
+	// the trips could have happened any time over both polls
+	a->sensors.poll_ms += b->sensors.poll_ms;
+	a->delay_time = b->delay_time;
+}
+
+// time to send one byte at 2400 baud with 2 stop bits
+#define BYTE_USECONDS 4583
+
+// The controller samples each byte just before sending it, so a sensor in
+// byte i tripped somewhere between when byte i was sampled for the last dump,
+// and when it was sampled for this one.
+static void estimate_trip_times(struct sensor_state *sensors, const unsigned *arrival,
+		const unsigned *prev_arrival, unsigned end_time) {
+	int widest = 0;
+	for (int i = 0; i < SENSOR_BYTES; i++) {
+		const unsigned sampled = arrival[i] - BYTE_USECONDS;
+		const unsigned prev_sampled = prev_arrival[i] - BYTE_USECONDS;
+		// differences are wraparound safe, since the timer is unsigned
+		const unsigned window = sampled - prev_sampled;
+		const unsigned midpoint = sampled - window / 2;
+		const int ago = (end_time - midpoint) / 10000; // ticks
+		sensors->trip_ticks[i] = sensors->ticks - ago;
+		widest = MAX(widest, (int) window / 1000);
+	}
+	sensors->poll_ms = widest;
+}
+
 static void tc_send_sensor_poll(void) {
 #ifdef ASCII_TC
 	fputs("Sending sensor poll"EOL, COM1);
@@ -54,59 +102,40 @@ static void tc_send_sensor_poll(void) {
 #endif
 }
 
-void sensorsrv(void) {
+static void sensorsrv(void) {
 	// discard sensor input stuck in the train controller from the last run
 	delay(100);
 	char buf[80];
 	fgetsnb(buf, sizeof(buf), COM1);
 
-	int displaysrv = whois(DISPLAYSRV_NAME);
-	struct sensor_state sensors;
-#if CALIBRATE
-	int calibratesrv = whois(CALIBRATESRV_NAME);
-#endif
-#if 0
-	// Test just to try and crash everything.
-	delay(100);
-	char test[10] = {0x00, 0x00, 0x00, 0x00, 0x00, 0x10, 0x00, 0x00, 0x00, 0x00};
-	memcpy(sensors.packed, test, sizeof(test));
-	sensors.ticks = time();
-	trains_send_sensors(sensors);
-	delay(100);
-	char test2[10] = {0x00, 0x00, 0x00, 0x00, 0x00, 0x20, 0x00, 0x00, 0x00, 0x00};
-	memcpy(sensors.packed, test2, sizeof(test2));
-	sensors.ticks = time();
-	trains_send_sensors(sensors);
-	delay(100);
-	char test3[10] = {0x00, 0x00, 0x00, 0x00, 0x00, 0x40, 0x00, 0x00, 0x00, 0x00};
-	memcpy(sensors.packed, test3, sizeof(test3));
-	sensors.ticks = time();
-	trains_send_sensors(sensors);
-	delay(100);
-	char test4[10] = {0x00, 0x00, 0x00, 0x00, 0x00, 0x80, 0x00, 0x00, 0x00, 0x00};
-	memcpy(sensors.packed, test4, sizeof(test4));
-	sensors.ticks = time();
-	trains_send_sensors(sensors);
-#endif
+	struct sensor_dump dump;
+	struct sensor_state *sensors = &dump.sensors;
+	unsigned arrival[SENSOR_BYTES], prev_arrival[SENSOR_BYTES];
+	for (int i = 0; i < SENSOR_BYTES; i++) prev_arrival[i] = debug_timer_useconds();
+
+	unsigned poll_time = debug_timer_useconds();
+	tc_send_sensor_poll();
 	for (;;) {
-		unsigned start_time = debug_timer_useconds();
+		// read a byte at a time, so we know when each one showed up
+		for (int i = 0; i < SENSOR_BYTES; i++) {
+			fgets((char*) &sensors->packed[i], 1, COM1);
+			arrival[i] = debug_timer_useconds();
+		}
+
+		// get the next dump going before we deal with this one
+		const unsigned next_poll_time = debug_timer_useconds();
 		tc_send_sensor_poll();
-		fgets((char*) &sensors, 10, COM1);
-		sensors.ticks = time();
 
+		sensors->ticks = time();
 		unsigned end_time = debug_timer_useconds();
-		unsigned delay_time = (end_time - start_time) / 1000;
+		dump.delay_time = (arrival[SENSOR_BYTES - 1] - poll_time) / 1000;
+		estimate_trip_times(sensors, arrival, prev_arrival, end_time);
+		memcpy(prev_arrival, arrival, sizeof(arrival));
+		poll_time = next_poll_time;
 
-		// notify the tasks which need to know about sensor updates
-		displaysrv_update_sensor(displaysrv, &sensors, delay_time);
-#if CALIBRATE
-		calibrate_send_sensors(calibratesrv, &sensors);
-#else
-		trains_send_sensors(sensors);
-#endif
+		// this doesn't wait for anybody to consume the dump
+		pubsub_publish(TOPIC_SENSORS, &dump, sizeof(dump));
 	}
-	/* delay(100); */
-	/* printf("%d bytes in the buffer after stop" EOL, fbuflen(COM1)); */
 }
 
 void sensorsrv_start(void) {
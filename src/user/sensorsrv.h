@@ -3,11 +3,33 @@
 #define SENSOR_COUNT 80
 
 // sensors are packed so it's cheap to message pass this struct around
+#define SENSOR_BYTES 10
+
 struct sensor_state {
-	unsigned char packed[10];
+	unsigned char packed[SENSOR_BYTES];
 	int ticks;
+	// Best guess of when the sensors reported in each byte actually tripped.
+	// Each byte of the dump covers everything since the same byte of the last
+	// dump, so we take the middle of that window.
+	int trip_ticks[SENSOR_BYTES];
+	// width of that window (ie. the time between polls), in milliseconds
+	int poll_ms;
+};
+
+// published on TOPIC_SENSORS for every dump
+struct sensor_dump {
+	struct sensor_state sensors;
+	unsigned delay_time; // ms from poll to the end of the dump
 };
 
+// Folds a newer dump into an older one, so that the result has every trip
+// from either. Subscribers pass it to pubsub_subscribe, so that dumps they
+// fall behind on are merged rather than dropped.
+void sensor_dump_merge(void *older, const void *newer);
+
+// estimated time the given sensor tripped, if it's tripped
+int sensor_trip_time(const struct sensor_state *s, int num);
+
 int sensor_get(const struct sensor_state *s, int num);
 void sensor_set(struct sensor_state *s, int num, int tripped);
 void sensor_repr(int n, char *buf);
@@ -32,6 +32,13 @@ static inline int switch_packed_num(int num) {
 	}
 }
 
+// the inverse of switch_packed_num, given the switch's bit in packed
+static inline int switch_from_bit(unsigned bit) {
+	int packed_num = 0;
+	while (bit >>= 1) packed_num++;
+	return packed_num <= 18 ? packed_num : packed_num - 18 - 1 + 145;
+}
+
 static inline void switch_set(struct switch_state *s, int num, enum sw_direction d) {
 	const int bit = 0x1 << switch_packed_num(num);
 	s->packed = (d == CURVED) ? (s->packed | bit) : (s->packed & ~bit);
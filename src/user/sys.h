@@ -4,3 +4,4 @@
 #include "sys/clockserver.h"
 #include "sys/nameserver.h"
 #include "sys/servers.h"
+#include "sys/pubsub.h"
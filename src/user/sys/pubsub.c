@@ -0,0 +1,232 @@
+#include "pubsub.h"
+
+#include "nameserver.h"
+#include "../request_type.h"
+#include <kernel.h>
+#include <assert.h>
+
+#define PUBSUB_NAME "pubsub"
+#define MAX_SUBSCRIBERS 16
+// deep enough that a subscriber has to fall seconds behind before we drop
+// anything on it
+#define QUEUE_LEN 16
+
+struct pubsub_msg {
+	unsigned len;
+	int data[PUBSUB_MAX_MSG / sizeof(int)]; // int, for alignment
+};
+
+// set once, before any subscriptions
+static pubsub_logger logger;
+
+// what a courier gets back for each update
+struct pubsub_delivery {
+	int dropped; // in total, so far
+	int data[PUBSUB_MAX_MSG / sizeof(int)];
+};
+
+struct subscriber {
+	enum pubsub_topic topic;
+	bool coalesce;
+	pubsub_merge merge;
+	// courier blocked waiting for an update, or -1
+	int waiting_tid;
+	int start, len;
+	struct pubsub_msg queue[QUEUE_LEN];
+	// updates we had to throw away because the subscriber fell too far behind
+	int dropped;
+};
+
+struct pubsub_req {
+	enum request_type type;
+	union {
+		struct {
+			enum pubsub_topic topic;
+			struct pubsub_msg msg;
+		} publish;
+		struct {
+			enum pubsub_topic topic;
+			bool coalesce;
+			pubsub_merge merge;
+		} subscribe;
+		int subscriber;
+	} u;
+};
+
+struct pubsub_state {
+	int num_subscribers;
+	int subscribers_for_topic[NUM_TOPICS];
+	struct subscriber subscribers[MAX_SUBSCRIBERS];
+};
+
+static void deliver(struct subscriber *sub) {
+	if (sub->waiting_tid < 0 || sub->len == 0) return;
+	const struct pubsub_msg *msg = &sub->queue[sub->start];
+	struct pubsub_delivery delivery;
+	delivery.dropped = sub->dropped;
+	memcpy(delivery.data, msg->data, msg->len);
+	reply(sub->waiting_tid, &delivery, offsetof(struct pubsub_delivery, data) + msg->len);
+	sub->waiting_tid = -1;
+	sub->start = (sub->start + 1) % QUEUE_LEN;
+	sub->len--;
+}
+
+static void enqueue(struct subscriber *sub, const struct pubsub_msg *msg) {
+	if (sub->coalesce && sub->len > 0) {
+		// replace the update they haven't seen yet, keeping whatever of it
+		// we can't lose
+		struct pubsub_msg *pending = &sub->queue[(sub->start + sub->len - 1) % QUEUE_LEN];
+		if (sub->merge) {
+			sub->merge(pending->data, msg->data);
+		} else {
+			*pending = *msg;
+		}
+		return;
+	}
+	if (sub->len == QUEUE_LEN) {
+		struct pubsub_msg *oldest = &sub->queue[sub->start];
+		sub->start = (sub->start + 1) % QUEUE_LEN;
+		sub->len--;
+		if (sub->merge) {
+			// fold the oldest into the next, rather than losing it
+			struct pubsub_msg *next = &sub->queue[sub->start];
+			sub->merge(oldest->data, next->data);
+			*next = *oldest;
+		} else {
+			sub->dropped++;
+		}
+	}
+	sub->queue[(sub->start + sub->len) % QUEUE_LEN] = *msg;
+	sub->len++;
+}
+
+static void handle_publish(struct pubsub_state *state, enum pubsub_topic topic, const struct pubsub_msg *msg) {
+	for (int i = 0; i < state->num_subscribers; i++) {
+		struct subscriber *sub = &state->subscribers[i];
+		if (sub->topic != topic) continue;
+		enqueue(sub, msg);
+		deliver(sub);
+	}
+}
+
+static int handle_subscribe(struct pubsub_state *state, enum pubsub_topic topic, bool coalesce,
+		pubsub_merge merge) {
+	ASSERT(state->num_subscribers < MAX_SUBSCRIBERS);
+	const int id = state->num_subscribers++;
+	struct subscriber *sub = &state->subscribers[id];
+	sub->topic = topic;
+	sub->coalesce = coalesce;
+	sub->merge = merge;
+	sub->waiting_tid = -1;
+	sub->start = sub->len = 0;
+	sub->dropped = 0;
+	state->subscribers_for_topic[topic]++;
+	return id;
+}
+
+static void pubsub_server(void) {
+	register_as(PUBSUB_NAME);
+	struct pubsub_state state;
+	memset(&state, 0, sizeof(state));
+
+	for (;;) {
+		int tid;
+		struct pubsub_req req;
+		receive(&tid, &req, sizeof(req));
+		switch (req.type) {
+		case PUB_PUBLISH: {
+			reply(tid, NULL, 0);
+			const enum pubsub_topic topic = req.u.publish.topic;
+			ASSERT(0 <= topic && topic < NUM_TOPICS);
+			// nobody is listening, so don't bother copying it anywhere
+			if (state.subscribers_for_topic[topic] == 0) break;
+			handle_publish(&state, topic, &req.u.publish.msg);
+			break;
+		}
+		case PUB_SUBSCRIBE: {
+			int id = handle_subscribe(&state, req.u.subscribe.topic, req.u.subscribe.coalesce,
+					req.u.subscribe.merge);
+			reply(tid, &id, sizeof(id));
+			break;
+		}
+		case PUB_NEXT: {
+			const int id = req.u.subscriber;
+			ASSERT(0 <= id && id < state.num_subscribers);
+			struct subscriber *sub = &state.subscribers[id];
+			ASSERT(sub->waiting_tid < 0);
+			sub->waiting_tid = tid;
+			deliver(sub);
+			break;
+		}
+		default:
+			WTF("Unknown pubsub request %d from %d", req.type, tid);
+			break;
+		}
+	}
+}
+
+void pubsub_start(pubsub_logger log) {
+	logger = log;
+	create(PRIORITY_PUBSUB, pubsub_server);
+}
+
+static int pubsub_tid(void) {
+	static int tid = -1;
+	if (tid < 0) tid = whois(PUBSUB_NAME);
+	return tid;
+}
+
+void pubsub_publish(enum pubsub_topic topic, const void *msg, unsigned len) {
+	ASSERT(len <= PUBSUB_MAX_MSG);
+	struct pubsub_req req;
+	req.type = PUB_PUBLISH;
+	req.u.publish.topic = topic;
+	req.u.publish.msg.len = len;
+	memcpy(req.u.publish.msg.data, msg, len);
+	// only send as much of the message as there is
+	const unsigned req_len = (char*) req.u.publish.msg.data - (char*) &req + len;
+	send(pubsub_tid(), &req, req_len, NULL, 0);
+}
+
+struct subscription_params {
+	enum pubsub_topic topic;
+	pubsub_handler handler;
+	bool coalesce;
+	pubsub_merge merge;
+};
+
+static void subscription_courier(void) {
+	int tid;
+	struct subscription_params params;
+	receive(&tid, &params, sizeof(params));
+	reply(tid, NULL, 0);
+
+	struct pubsub_req req;
+	req.type = PUB_SUBSCRIBE;
+	req.u.subscribe.topic = params.topic;
+	req.u.subscribe.coalesce = params.coalesce;
+	req.u.subscribe.merge = params.merge;
+	int id;
+	send(pubsub_tid(), &req, sizeof(req), &id, sizeof(id));
+
+	req.type = PUB_NEXT;
+	req.u.subscriber = id;
+	struct pubsub_delivery delivery;
+	int dropped = 0;
+	for (;;) {
+		int len = send(pubsub_tid(), &req, sizeof(req), &delivery, sizeof(delivery));
+		if (delivery.dropped != dropped) {
+			logger("Subscriber to topic %d fell behind, %d updates dropped so far",
+					params.topic, delivery.dropped);
+			dropped = delivery.dropped;
+		}
+		params.handler(delivery.data, len - offsetof(struct pubsub_delivery, data));
+	}
+}
+
+void pubsub_subscribe(enum pubsub_topic topic, int priority, pubsub_handler handler,
+		bool coalesce, pubsub_merge merge) {
+	int tid = create(priority, subscription_courier);
+	struct subscription_params params = { topic, handler, coalesce, merge };
+	send(tid, &params, sizeof(params), NULL, 0);
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <util.h>
+
+// Topic based publish/subscribe.
+//
+// Producers publish updates without knowing (or waiting on) who consumes
+// them. Each subscription gets its own queue in the pubsub server, and a
+// courier which hands the updates to the subscriber's handler one at a time,
+// so a slow subscriber only ever holds up itself.
+// A subscriber which falls too far behind loses its oldest updates, unless it
+// gave a way to merge them, in which case they're folded together instead.
+// Drops are logged.
+enum pubsub_topic {
+	TOPIC_SENSORS, // struct sensor_dump
+	TOPIC_SWITCHES, // struct switch_state
+	TOPIC_TRAIN_POSITIONS, // struct train_position_update
+	NUM_TOPICS,
+};
+
+#define PUBSUB_MAX_MSG 64
+
+// Called from the subscription's courier task, not the subscriber itself
+typedef void (*pubsub_handler)(const void *msg, unsigned len);
+// Folds a newer update into an older one, in the pubsub server's task
+typedef void (*pubsub_merge)(void *older, const void *newer);
+typedef void (*pubsub_logger)(const char *fmt, ...);
+
+// log is used to report dropped updates
+void pubsub_start(pubsub_logger log);
+
+// Returns immediately - the update is copied into each subscriber's queue.
+void pubsub_publish(enum pubsub_topic topic, const void *msg, unsigned len);
+
+// Creates a courier at the given priority, which calls handler with each
+// update on the topic, in order.
+// Subscribers which only care about the latest value (like the display)
+// should set coalesce, so that updates they haven't got to yet are replaced
+// rather than queued. If merge isn't NULL, updates are merged into the one
+// they would have replaced or pushed out, rather than being lost.
+void pubsub_subscribe(enum pubsub_topic topic, int priority, pubsub_handler handler,
+		bool coalesce, pubsub_merge merge);
@@ -1,4 +1,5 @@
 #include "../sys.h"
+#include "../displaysrv.h"
 #include <kernel.h>
 
 void start_servers(void) {
@@ -6,6 +7,7 @@ void start_servers(void) {
 	ioserver(COM1);
 	ioserver(COM2);
 	create(PRIORITY_CLOCKSRV, clockserver);
+	pubsub_start(displaysrv_log);
 }
 
 void stop_servers(void) {
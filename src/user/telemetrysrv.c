@@ -0,0 +1,321 @@
+#include "telemetrysrv.h"
+
+#include <kernel.h>
+#include <util.h>
+#include <assert.h>
+#include <io.h>
+#include "request_type.h"
+#include "signal.h"
+#include "sys.h"
+#include "track.h"
+#include "trainsrv.h"
+#include "tracksrv.h"
+#include "displaysrv.h"
+
+#define TELEMETRY_NAME "telemetry"
+
+struct telemetry_train {
+	int train_id;
+	struct train_state state;
+	int error;
+	int stopping_distance;
+};
+
+struct telemetry_request {
+	enum request_type type;
+	union {
+		struct {
+			int time;
+			int active_trains;
+			struct telemetry_train trains[MAX_ACTIVE_TRAINS];
+			int idle_permille;
+			struct tracksrv_stats track_stats;
+		} sample;
+		struct {
+			int sensor;
+			int train;
+			int time;
+		} attribution;
+		struct {
+			const int *table;
+		} reservations;
+		struct {
+			int hz;
+		} rate;
+	} u;
+};
+
+#define FRAME_HEADER_LEN 10
+#define FRAME_MAX_PAYLOAD TRACK_MAX
+#define FRAME_MAX_LEN (FRAME_HEADER_LEN + FRAME_MAX_PAYLOAD + 2)
+// ESC _ T, the base64 frame, then ESC backslash
+#define ENCODED_MAX_LEN (3 + (FRAME_MAX_LEN + 2) / 3 * 4 + 2)
+
+struct frame {
+	unsigned char buf[FRAME_MAX_LEN];
+	int len;
+};
+
+static void put_u8(struct frame *f, int v) {
+	ASSERT(f->len < sizeof(f->buf));
+	f->buf[f->len++] = v & 0xff;
+}
+
+static void put_u16(struct frame *f, int v) {
+	put_u8(f, v);
+	put_u8(f, v >> 8);
+}
+
+static void put_u32(struct frame *f, int v) {
+	put_u16(f, v);
+	put_u16(f, v >> 16);
+}
+
+static unsigned crc16(const unsigned char *buf, int len) {
+	unsigned crc = 0xffff;
+	for (int i = 0; i < len; i++) {
+		crc ^= buf[i] << 8;
+		for (int bit = 0; bit < 8; bit++) {
+			crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+		}
+	}
+	return crc & 0xffff;
+}
+
+static const char base64_chars[] =
+	"ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+static int base64_encode(const unsigned char *in, int len, char *out) {
+	int n = 0;
+	for (int i = 0; i < len; i += 3) {
+		unsigned v = in[i] << 16;
+		if (i + 1 < len) v |= in[i + 1] << 8;
+		if (i + 2 < len) v |= in[i + 2];
+		out[n++] = base64_chars[(v >> 18) & 0x3f];
+		out[n++] = base64_chars[(v >> 12) & 0x3f];
+		out[n++] = (i + 1 < len) ? base64_chars[(v >> 6) & 0x3f] : '=';
+		out[n++] = (i + 2 < len) ? base64_chars[v & 0x3f] : '=';
+	}
+	return n;
+}
+
+static void frame_start(struct frame *f, enum telemetry_record type, int seq, int time) {
+	f->len = 0;
+	put_u8(f, TELEMETRY_VERSION);
+	put_u8(f, type);
+	put_u16(f, seq);
+	put_u32(f, time);
+	put_u16(f, 0); // payload length, filled in by frame_send
+}
+
+// Finishes off the frame, and sends it out as a single write so that it
+// can't be interleaved with other console output.
+static void frame_send(struct frame *f) {
+	const int payload_len = f->len - FRAME_HEADER_LEN;
+	f->buf[FRAME_HEADER_LEN - 2] = payload_len & 0xff;
+	f->buf[FRAME_HEADER_LEN - 1] = payload_len >> 8;
+	put_u16(f, crc16(f->buf, f->len));
+
+	char out[ENCODED_MAX_LEN];
+	int n = 0;
+	out[n++] = '\e';
+	out[n++] = '_';
+	out[n++] = 'T';
+	n += base64_encode(f->buf, f->len, out + n);
+	out[n++] = '\e';
+	out[n++] = '\\';
+	fput_buf(out, n, COM2);
+}
+
+static void send_train(const struct telemetry_train *t, int seq, int time) {
+	struct frame f;
+	frame_start(&f, TELEMETRY_TRAIN, seq, time);
+	put_u8(&f, t->train_id);
+	put_u8(&f, t->state.speed_setting);
+	const struct position *pos = &t->state.position;
+	if (position_is_uninitialized(pos)) {
+		put_u16(&f, 0xffff);
+		put_u8(&f, 0);
+		put_u16(&f, 0);
+	} else {
+		put_u16(&f, TRACK_NODE_INDEX(pos->edge->src));
+		put_u8(&f, pos->edge - pos->edge->src->edge);
+		put_u16(&f, pos->displacement);
+	}
+	put_u32(&f, t->state.velocity);
+	// saturates, rather than wrapping around to look certain
+	put_u16(&f, MIN(t->state.position_stddev, 0xffff));
+	put_u32(&f, t->error);
+	put_u16(&f, t->stopping_distance);
+	frame_send(&f);
+}
+
+static void send_attribution(int sensor, int train, int seq, int time) {
+	struct frame f;
+	frame_start(&f, TELEMETRY_ATTRIBUTION, seq, time);
+	put_u8(&f, sensor);
+	put_u8(&f, train);
+	frame_send(&f);
+}
+
+static void send_reservations(const unsigned char *table, int seq, int time) {
+	struct frame f;
+	frame_start(&f, TELEMETRY_RESERVATIONS, seq, time);
+	for (int i = 0; i < TRACK_MAX; i++) {
+		put_u8(&f, table[i]);
+	}
+	frame_send(&f);
+}
+
+static void send_stats(int idle_permille, const struct tracksrv_stats *stats, int seq, int time) {
+	struct frame f;
+	frame_start(&f, TELEMETRY_STATS, seq, time);
+	put_u16(&f, idle_permille);
+	put_u32(&f, stats->conflicts);
+	put_u32(&f, stats->deadlocks);
+	put_u32(&f, stats->victims);
+	frame_send(&f);
+}
+
+static int hz_to_ticks(int hz) {
+	return (hz > 0) ? (100 + hz - 1) / hz : 0;
+}
+
+// Samples the trains each period, and hands them off to the server
+static void telemetry_sampler(void) {
+	int server = parent_tid();
+	int ticks = time();
+	int period = 0;
+	int trainsrv = -1;
+	for (;;) {
+		// poll for telemetry being turned on once a second
+		ticks = delay_until(ticks + (period > 0 ? period : 100));
+
+		struct telemetry_request req;
+		req.type = TLM_SAMPLE;
+		req.u.sample.time = ticks;
+		req.u.sample.active_trains = 0;
+		req.u.sample.idle_permille = -1; // not sampled
+		if (period > 0) {
+			req.u.sample.idle_permille = idle_permille();
+			tracksrv_get_stats(&req.u.sample.track_stats);
+		}
+		if (trainsrv < 0) trainsrv = try_whois("trains");
+		if (period > 0 && trainsrv >= 0) {
+			int ids[MAX_ACTIVE_TRAINS];
+			const int n = trains_query_active(ids);
+			for (int i = 0; i < n; i++) {
+				struct telemetry_train *t = &req.u.sample.trains[i];
+				t->train_id = ids[i];
+				trains_query_spatials(ids[i], &t->state);
+				t->error = trains_query_error(ids[i]);
+				t->stopping_distance = trains_get_stopping_distance(ids[i]);
+			}
+			req.u.sample.active_trains = n;
+		}
+		send(server, &req, sizeof(req), &period, sizeof(period));
+	}
+}
+
+static void telemetrysrv(void) {
+	register_as(TELEMETRY_NAME);
+	signal_recv();
+	create(PRIORITY_TELEMETRY_SAMPLER, telemetry_sampler);
+
+	int period = hz_to_ticks(TELEMETRY_DEFAULT_HZ);
+	int seq = 0;
+	// reservations are only sent once per period, whatever the rate of change
+	unsigned char reservations[TRACK_MAX] = {};
+	bool reservations_dirty = false;
+
+	for (;;) {
+		struct telemetry_request req;
+		int tid = -1;
+		receive(&tid, &req, sizeof(req));
+
+		switch (req.type) {
+		case TLM_SAMPLE:
+			reply(tid, &period, sizeof(period));
+			if (period == 0) break;
+			for (int i = 0; i < req.u.sample.active_trains; i++) {
+				send_train(&req.u.sample.trains[i], seq++, req.u.sample.time);
+			}
+			if (req.u.sample.idle_permille >= 0) {
+				send_stats(req.u.sample.idle_permille, &req.u.sample.track_stats,
+						seq++, req.u.sample.time);
+			}
+			if (reservations_dirty) {
+				send_reservations(reservations, seq++, req.u.sample.time);
+				reservations_dirty = false;
+			}
+			break;
+		case TLM_ATTRIBUTION:
+			reply(tid, NULL, 0);
+			if (period == 0) break;
+			send_attribution(req.u.attribution.sensor, req.u.attribution.train,
+					seq++, req.u.attribution.time);
+			break;
+		case TLM_RESERVATIONS:
+			// the table is on the sender's stack, so copy it before replying
+			for (int i = 0; i < TRACK_MAX; i++) {
+				const unsigned char owner = req.u.reservations.table[i];
+				reservations_dirty |= owner != reservations[i];
+				reservations[i] = owner;
+			}
+			reply(tid, NULL, 0);
+			break;
+		case TLM_SET_RATE:
+			reply(tid, NULL, 0);
+			period = hz_to_ticks(req.u.rate.hz);
+			reservations_dirty = true;
+			logf("Telemetry %s", period > 0 ? "on" : "off");
+			break;
+		default:
+			WTF("Unknown telemetry request type %d", req.type);
+			break;
+		}
+	}
+}
+
+void telemetrysrv_start(void) {
+	int tid = create(PRIORITY_TELEMETRYSRV, telemetrysrv);
+	signal_send(tid);
+}
+
+// Returns -1 if the server isn't running, in which case telemetry is dropped
+static int telemetrysrv_tid(void) {
+	static int tid = -1;
+	if (tid < 0) tid = try_whois(TELEMETRY_NAME);
+	return tid;
+}
+
+static void telemetry_send(struct telemetry_request *req) {
+	int tid = telemetrysrv_tid();
+	if (tid < 0) return;
+	send(tid, req, sizeof(*req), NULL, 0);
+}
+
+void telemetry_set_rate(int hz) {
+	ASSERT(hz >= 0 && hz <= TELEMETRY_MAX_HZ);
+	struct telemetry_request req = {
+		.type = TLM_SET_RATE,
+		.u.rate.hz = hz,
+	};
+	telemetry_send(&req);
+}
+
+void telemetry_sensor_attribution(int sensor, int train, int time) {
+	struct telemetry_request req = {
+		.type = TLM_ATTRIBUTION,
+		.u.attribution = { sensor, train, time },
+	};
+	telemetry_send(&req);
+}
+
+void telemetry_reservations(const int *track_table) {
+	struct telemetry_request req = {
+		.type = TLM_RESERVATIONS,
+		.u.reservations.table = track_table,
+	};
+	telemetry_send(&req);
+}
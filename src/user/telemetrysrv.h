@@ -0,0 +1,56 @@
+#pragma once
+
+// Binary telemetry for off-board tools (see src/mock-train/telemetry.py).
+//
+// Records are sent on COM2, mixed in with the console output. Each one is
+// base64 encoded and wrapped in an ANSI APC string, which terminals silently
+// drop:
+//
+//     ESC _ T <base64 frame> ESC \ (string terminator)
+//
+// A frame is, little endian:
+//
+//     u8  version (TELEMETRY_VERSION)
+//     u8  record type (enum telemetry_record)
+//     u16 sequence number, so that dropped frames can be detected
+//     u32 time, in ticks
+//     u16 payload length
+//         payload
+//     u16 CRC-16/CCITT (poly 0x1021, init 0xffff) of everything before it
+//
+// Bump the version whenever the layout of a frame or record changes.
+#define TELEMETRY_VERSION 1
+
+enum telemetry_record {
+	// Sent for each active train, at the rate set by telemetry_set_rate:
+	//     u8 train, u8 speed setting,
+	//     u16 node index and u8 edge index of the edge the train is on,
+	//     s16 mm along that edge (0xffff node index if unknown),
+	//     s32 velocity (um/tick), u16 position stddev (mm),
+	//     s32 measurement error at the last sensor (mm), u16 stopping distance (mm)
+	TELEMETRY_TRAIN = 1,
+	// Sent as sensors are attributed, with the time of the trip:
+	//     u8 sensor, s8 train (-1 if spurious)
+	TELEMETRY_ATTRIBUTION = 2,
+	// Sent at most once per sample period, when reservations have changed:
+	//     u8 reserving train for each track node index (0 if free)
+	TELEMETRY_RESERVATIONS = 3,
+	// Sent once per sample period, with counters since boot:
+	//     u16 idle permille, u32 reservation conflicts, u32 deadlocks,
+	//     u32 deadlock victims
+	TELEMETRY_STATS = 4,
+};
+
+// Off until turned on with telemetry_set_rate, since it eats into the
+// terminal's bandwidth.
+#define TELEMETRY_DEFAULT_HZ 0
+#define TELEMETRY_MAX_HZ 20
+
+void telemetrysrv_start(void);
+
+// 0 turns telemetry off
+void telemetry_set_rate(int hz);
+
+// These are dropped if the telemetry server isn't running, or is off.
+void telemetry_sensor_attribution(int sensor, int train, int time);
+void telemetry_reservations(const int *track_table);
@@ -6,6 +6,7 @@
 #include "sys.h"
 #include "signal.h"
 #include "displaysrv.h"
+#include "telemetrysrv.h"
 #define idx(node) ({ \
 	int ix = TRACK_NODE_INDEX(node); \
 	ASSERTF(ix >= 0 && ix < TRACK_MAX, "%d", ix); \
@@ -30,21 +31,134 @@ struct tracksrv_request {
 		struct {
 			int *table_out;
 		} table;
+		struct {
+			struct tracksrv_stats *stats_out;
+		} stats;
+		struct {
+			int tid;
+		} stop_waiting;
 	} u;
 };
 
 static int conductor_train_ids[256] = {}; // Just for debugging
 static int reservation_table[TRACK_MAX] = {};
+static struct tracksrv_stats stats = {};
+
+// Wait-for graph. An owner whose reservation failed waits on the segments it
+// couldn't get, and so (implicitly) on whoever currently holds them.
+#define MAX_WAITERS 16
+struct waiter {
+	int tid;
+	bool segments[TRACK_MAX];
+};
+static struct waiter waiters[MAX_WAITERS] = {};
+// Owners we've picked to break a deadlock, who haven't been told yet.
+static bool victims[256] = {};
+
+static struct waiter *find_waiter(int tid) {
+	for (int i = 0; i < MAX_WAITERS; i++) {
+		if (waiters[i].tid == tid) return &waiters[i];
+	}
+	return NULL;
+}
+
+static void clear_waiter(int tid) {
+	struct waiter *w = find_waiter(tid);
+	if (w) w->tid = 0;
+}
+
+static void set_waiter(int tid, bool *desired) {
+	struct waiter *w = find_waiter(tid);
+	if (!w) w = find_waiter(0);
+	ASSERTF(w != NULL, "Too many owners waiting on track");
+	w->tid = tid;
+	for (int i = 0; i < TRACK_MAX; i++) {
+		w->segments[i] = desired[i] && reservation_table[i] && reservation_table[i] != tid;
+	}
+}
+
+static int held_segments(int tid) {
+	int n = 0;
+	for (int i = 0; i < TRACK_MAX; i++) {
+		if (reservation_table[i] == tid) n++;
+	}
+	return n;
+}
+
+// Depth first search along the wait-for graph, looking for a path back to
+// target. On success, the owners along the cycle are written to cycle.
+static bool find_cycle(int tid, int target, int *cycle, int depth, bool *visited) {
+	struct waiter *w = find_waiter(tid);
+	if (w == NULL) return false;
+	ASSERT(depth < MAX_WAITERS);
+	cycle[depth] = tid;
+	for (int i = 0; i < TRACK_MAX; i++) {
+		if (!w->segments[i]) continue;
+		int holder = reservation_table[i];
+		if (holder == 0 || holder == tid) continue;
+		if (holder == target) {
+			cycle[depth + 1] = 0;
+			return true;
+		}
+		if (visited[holder]) continue;
+		visited[holder] = true;
+		if (find_cycle(holder, target, cycle, depth + 1, visited)) return true;
+	}
+	return false;
+}
+
+// Called after tid fails to reserve track. If tid is now part of a deadlock,
+// pick the owner in the cycle holding the least track to back off, since it
+// has the least to lose.
+static int detect_deadlock(int tid) {
+	int cycle[MAX_WAITERS + 1];
+	bool visited[256] = {};
+	if (!find_cycle(tid, tid, cycle, 0, visited)) return 0;
+
+	int victim = cycle[0];
+	int victim_held = held_segments(victim);
+	for (int i = 1; cycle[i]; i++) {
+		int held = held_segments(cycle[i]);
+		if (held < victim_held || (held == victim_held && cycle[i] > victim)) {
+			victim = cycle[i];
+			victim_held = held;
+		}
+	}
+	stats.deadlocks++;
+	logf("Track deadlock detected involving %d; backing off conductor %d", tid, victim);
+	logf("Track contention so far: %d conflicts, %d deadlocks, %d backed off",
+			stats.conflicts, stats.deadlocks, stats.victims);
+	clear_waiter(victim);
+	victims[victim] = true;
+	return victim;
+}
 
 // Either replaces tid's reservation bitmap with desired, or returns < 0.
 static int reserve_desired(int tid, bool *desired) {
+	ASSERT(tid > 0 && tid < ARRAY_LENGTH(victims));
+	if (victims[tid]) {
+		victims[tid] = false;
+		stats.victims++;
+		return TRACKSRV_DEADLOCK_VICTIM;
+	}
+
 	int unreservable = 0;
 	for (int i = 0; i < TRACK_MAX; i++) {
 		if (desired[i] && reservation_table[i] && (reservation_table[i] != tid)) {
 			unreservable++;
 		}
 	}
-	if (unreservable > 0) return -unreservable;
+	if (unreservable > 0) {
+		stats.conflicts++;
+		set_waiter(tid, desired);
+		if (detect_deadlock(tid) == tid) {
+			victims[tid] = false;
+			stats.victims++;
+			return TRACKSRV_DEADLOCK_VICTIM;
+		}
+		return -unreservable;
+	}
+	clear_waiter(tid);
 
 	int reserved = 0;
 	for (int i = 0; i < TRACK_MAX; i++) {
@@ -171,6 +285,11 @@ void tracksrv(void) {
 			reply(tid, &res, sizeof(res));
 			break;
 		}
+		case TRK_RESERVE: {
+			int res = reserve_desired(req.u.reserve.tid, req.u.reserve.desired);
+			reply(tid, &res, sizeof(res));
+			break;
+		}
 		case TRK_SET_ID: {
 			int trid = req.u.set_train_id.train_id;
 			ASSERT(conductor_train_ids[trid] == 0); // No changing trains?
@@ -183,6 +302,19 @@ void tracksrv(void) {
 			reply(tid, NULL, 0);
 			break;
 		}
+		case TRK_STATS: {
+			*req.u.stats.stats_out = stats;
+			reply(tid, NULL, 0);
+			break;
+		}
+		case TRK_STOP_WAITING: {
+			const int owner = req.u.stop_waiting.tid;
+			ASSERT(owner > 0 && owner < ARRAY_LENGTH(victims));
+			clear_waiter(owner);
+			victims[owner] = false;
+			reply(tid, NULL, 0);
+			break;
+		}
 		default:
 			WTF();
 		}
@@ -237,6 +369,7 @@ int tracksrv_reserve_path(struct astar_node *path, int len, int stopping_distanc
 	int track_table[TRACK_MAX];
 	tracksrv_get_reservation_table(track_table);
 	displaysrv_update_track_table(whois("displaysrv"), track_table);
+	telemetry_reservations(track_table);
 	return n;
 }
 
@@ -247,3 +380,19 @@ void tracksrv_get_reservation_table(int *table_out) {
 	};
 	send(tracksrv_tid(), &req, sizeof(req), NULL, 0);
 }
+
+void tracksrv_get_stats(struct tracksrv_stats *stats_out) {
+	struct tracksrv_request req = (struct tracksrv_request) {
+		.type = TRK_STATS,
+		.u.stats.stats_out = stats_out,
+	};
+	send(tracksrv_tid(), &req, sizeof(req), NULL, 0);
+}
+
+void tracksrv_stop_waiting(int tid) {
+	struct tracksrv_request req = (struct tracksrv_request) {
+		.type = TRK_STOP_WAITING,
+		.u.stop_waiting.tid = tid,
+	};
+	send(tracksrv_tid(), &req, sizeof(req), NULL, 0);
+}
@@ -6,6 +6,18 @@
 
 void tracksrv_start(void);
 
+// Returned from a reservation request when the caller has been picked to
+// break a deadlock. The caller should stop, give up whatever track it can,
+// and then reroute.
+#define TRACKSRV_DEADLOCK_VICTIM (-1000)
+
+struct tracksrv_stats {
+	int conflicts; // reservations refused because track was held by someone else
+	int deadlocks; // cycles found in the wait-for graph
+	int victims; // owners told to back off
+};
+void tracksrv_get_stats(struct tracksrv_stats *stats_out);
+
 // For debugging: associate a train_id with this conductor_id.
 void tracksrv_set_train_id(int train_id);
 
@@ -17,7 +29,8 @@ void tracksrv_get_reservation_table(int *table_out);
 // given path or branches.
 // This operation is atomic. Either all the track will be reserved, and the
 // total number of reserved segments is returned, or none of it will, and an
-// error code < 0 will be returned.
+// error code < 0 will be returned. If the caller is waiting on track in a
+// cycle with other owners, TRACKSRV_DEADLOCK_VICTIM may be returned.
 int tracksrv_reserve_path(struct astar_node *path, int len, int stopping_distance);
 
 // desired is a desired bitmap of size TRACK_MAX. Replaces previous reservations
@@ -25,5 +38,10 @@ int tracksrv_reserve_path(struct astar_node *path, int len, int stopping_distanc
 // -number of conflicts on failure.
 int tracksrv_reserve(int tid, bool *desired);
 
+// Stop waiting on whatever track the owner couldn't get last time, because
+// it's going somewhere else instead. This keeps it out of deadlock detection
+// until it next fails to reserve something.
+void tracksrv_stop_waiting(int tid);
+
 // For tests only
 int tracksrv_reserve_path_test(struct astar_node *path, int len, int stopping_distance, int tid);
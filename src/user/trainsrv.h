@@ -15,6 +15,42 @@ struct train_state {
 	int velocity;
 
 	int speed_setting;
+
+	// standard deviation of the position estimate, in mm
+	int position_stddev;
+};
+
+// published on TOPIC_TRAIN_POSITIONS each time a train hits a sensor
+struct train_position_update {
+	int train_id;
+	struct position position;
+};
+
+// The sensors and switches which have failed the most, worst first
+#define RELIABILITY_REPORT_LEN 4
+enum reliability_failure { FAILURE_MISSED, FAILURE_PHANTOM, FAILURE_MISROUTE };
+struct reliability_report {
+	int len;
+	struct {
+		enum reliability_failure failure;
+		// the sensor, or the switch number
+		int num;
+		int failures, trials;
+		// if the sensor is blacklisted, or the switch is routed around
+		bool excluded;
+	} entries[RELIABILITY_REPORT_LEN];
+};
+
+// How to move a stopped train a given distance as quickly as we can: set it
+// to speed, and then to stop stop_time ticks later, which is stop_lead mm short
+// of where it should end up.
+// For short moves, the train never gets up to speed before we stop it.
+struct motion_plan {
+	int speed; // 0 if the train can't make such a short move at all
+	int stop_time;
+	int stop_lead;
+	int duration; // ticks until it should have come to a stop
+	bool short_move;
 };
 
 #define MAX_ACTIVE_TRAINS 8 // way more than we'll be able to have on the track in practice
@@ -24,16 +60,25 @@ int trains_query_active(int *trains_out);
 void trains_query_spatials(int train, struct train_state *state_out);
 int trains_query_arrival_time(int train, int distance);
 int trains_query_error(int train_id);
+// estimated velocity after accelerating from a stop to the given speed setting
+int trains_query_velocity(int train, int speed);
+void trains_plan_motion(int train, int distance, int max_speed, struct motion_plan *plan);
 void trains_send_sensors(struct sensor_state state);
 void trains_set_speed(int train, int speed);
 void trains_reverse(int train);
 void trains_reverse_unsafe(int train);
 void trains_switch(int switch_numuber, enum sw_direction d);
 struct switch_state trains_get_switches(void);
+// the switches which go the wrong way too often to route over, as bits of
+// struct switch_state
+unsigned trains_get_unreliable_switches(void);
 
 void trains_set_stopping_distance(int train_id, int stopping_distance);
 int trains_get_stopping_distance(int train_id);
+// -1 if we don't know where the train is
 int trains_get_last_known_sensor(int train_id);
+// logs the learned velocity and stopping distance tables as a loadable blob
+void trains_dump_calibration(int train_id);
 
 void trains_start(void);
 
@@ -0,0 +1,144 @@
+#include "calibration.h"
+
+#include <assert.h>
+#include "../displaysrv.h"
+
+// Paste the output of the "cal <train>" command in here to have the next boot
+// start from what we learned.
+static const char *const saved_calibrations[] = {
+	NULL,
+};
+
+#define CALIBRATION_MAGIC 0xca
+#define CALIBRATION_VERSION 1
+#define CALIBRATION_BLOB_LEN (CALIBRATION_BLOB_HEX_LEN / 2)
+
+// an entry needs this many samples before we trust it enough to reject outliers
+#define TRUSTED_SAMPLES 3
+// the gain never drops below 1 / MIN_GAIN_DIVISOR
+#define MIN_GAIN_DIVISOR 10
+// this many outliers in a row, and the train has changed rather than misread
+#define PERSISTENT_OUTLIERS 3
+
+enum calibration_result calibration_update(int *entry, unsigned char *samples,
+		unsigned char *outliers, int measured) {
+	if (*samples >= TRUSTED_SAMPLES) {
+		const int deviation = abs(measured - *entry);
+		if (deviation > abs(*entry) / 3) {
+			if (++(*outliers) < PERSISTENT_OUTLIERS) return CALIBRATION_OUTLIER;
+			// whatever we'd learned is out of date, so start over
+			*entry = measured;
+			*samples = 1;
+			*outliers = 0;
+			return CALIBRATION_ACCEPTED;
+		}
+	}
+	*outliers = 0;
+
+	// v' = (1 - alpha) * v + alpha * v_actual, where alpha = 1 / (samples + 1)
+	// until it hits the floor
+	const int divisor = MIN(*samples + 1, MIN_GAIN_DIVISOR);
+	*entry = ((divisor - 1) * *entry + measured) / divisor;
+	if (*samples < CALIBRATION_MAX_SAMPLES) (*samples)++;
+	return CALIBRATION_ACCEPTED;
+}
+
+static unsigned short fletcher16(const unsigned char *data, int len) {
+	unsigned a = 0, b = 0;
+	for (int i = 0; i < len; i++) {
+		a = (a + data[i]) % 255;
+		b = (b + a) % 255;
+	}
+	return (b << 8) | a;
+}
+
+static void put_u16(unsigned char **p, int value) {
+	value = MAX(0, MIN(value, 0xffff));
+	*(*p)++ = value & 0xff;
+	*(*p)++ = value >> 8;
+}
+
+static int get_u16(const unsigned char **p) {
+	int value = (*p)[0] | ((*p)[1] << 8);
+	*p += 2;
+	return value;
+}
+
+static int hex_digit(char c) {
+	if ('0' <= c && c <= '9') return c - '0';
+	if ('a' <= c && c <= 'f') return c - 'a' + 10;
+	if ('A' <= c && c <= 'F') return c - 'A' + 10;
+	return -1;
+}
+
+void calibration_serialize(const struct internal_train_state *train_state, char *hex_out) {
+	unsigned char blob[CALIBRATION_BLOB_LEN];
+	unsigned char *p = blob;
+	*p++ = CALIBRATION_MAGIC;
+	*p++ = CALIBRATION_VERSION;
+	*p++ = train_state->train_id;
+	*p++ = NUM_SPEED_SETTINGS;
+	for (int i = 0; i < NUM_SPEED_SETTINGS; i++) put_u16(&p, train_state->est_velocities[i]);
+	for (int i = 0; i < NUM_SPEED_SETTINGS; i++) put_u16(&p, train_state->est_stopping_distances[i]);
+	for (int i = 0; i < NUM_SPEED_SETTINGS; i++) *p++ = train_state->velocity_samples[i];
+	for (int i = 0; i < NUM_SPEED_SETTINGS; i++) *p++ = train_state->stopping_distance_samples[i];
+	put_u16(&p, fletcher16(blob, p - blob));
+	ASSERT(p - blob == CALIBRATION_BLOB_LEN);
+
+	static const char digits[] = "0123456789abcdef";
+	for (int i = 0; i < CALIBRATION_BLOB_LEN; i++) {
+		hex_out[2*i] = digits[blob[i] >> 4];
+		hex_out[2*i + 1] = digits[blob[i] & 0xf];
+	}
+	hex_out[CALIBRATION_BLOB_HEX_LEN] = '\0';
+}
+
+bool calibration_deserialize(struct internal_train_state *train_state, const char *hex) {
+	unsigned char blob[CALIBRATION_BLOB_LEN];
+	for (int i = 0; i < CALIBRATION_BLOB_LEN; i++) {
+		int hi = hex_digit(hex[2*i]);
+		if (hi < 0) return false;
+		int lo = hex_digit(hex[2*i + 1]);
+		if (lo < 0) return false;
+		blob[i] = (hi << 4) | lo;
+	}
+	if (hex[CALIBRATION_BLOB_HEX_LEN] != '\0') return false;
+
+	const unsigned char *p = blob;
+	if (*p++ != CALIBRATION_MAGIC) return false;
+	if (*p++ != CALIBRATION_VERSION) return false;
+	if (*p++ != train_state->train_id) return false;
+	if (*p++ != NUM_SPEED_SETTINGS) return false;
+	const unsigned char *checksum = blob + CALIBRATION_BLOB_LEN - 2;
+	if (get_u16(&checksum) != fletcher16(blob, CALIBRATION_BLOB_LEN - 2)) return false;
+
+	for (int i = 0; i < NUM_SPEED_SETTINGS; i++) train_state->est_velocities[i] = get_u16(&p);
+	for (int i = 0; i < NUM_SPEED_SETTINGS; i++) train_state->est_stopping_distances[i] = get_u16(&p);
+	for (int i = 0; i < NUM_SPEED_SETTINGS; i++) train_state->velocity_samples[i] = *p++;
+	for (int i = 0; i < NUM_SPEED_SETTINGS; i++) train_state->stopping_distance_samples[i] = *p++;
+	return true;
+}
+
+bool calibration_load_saved(struct internal_train_state *train_state) {
+	for (int i = 0; saved_calibrations[i] != NULL; i++) {
+		if (calibration_deserialize(train_state, saved_calibrations[i])) return true;
+	}
+	return false;
+}
+
+void calibration_dump(const struct internal_train_state *train_state) {
+	char hex[CALIBRATION_BLOB_HEX_LEN + 1];
+	calibration_serialize(train_state, hex);
+
+	// the log line prefix and quotes eat into MAX_LOG_LEN
+	const int chunk = 80;
+	logf("// calibration for train %d", train_state->train_id);
+	for (int i = 0; i < CALIBRATION_BLOB_HEX_LEN; i += chunk) {
+		char line[chunk + 1];
+		const int len = MIN(chunk, CALIBRATION_BLOB_HEX_LEN - i);
+		memcpy(line, hex + i, len);
+		line[len] = '\0';
+		const bool last = i + chunk >= CALIBRATION_BLOB_HEX_LEN;
+		logf("\"%s\"%s", line, last ? "," : "");
+	}
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <util.h>
+#include "estimate_position.h"
+
+// Online calibration of the per-train velocity and stopping distance tables.
+//
+// Each table entry is learned with an exponentially weighted moving average,
+// whose gain starts high (so an uncalibrated train becomes usable after a few
+// sensor hits) and settles to a fixed rate once the entry has enough samples.
+// Measurements which are way off an entry we trust are rejected as outliers,
+// unless several come in a row, in which case the train has really changed
+// (eg. its wheels got cleaned), and the entry starts over from them.
+//
+// The learned tables can be dumped as a hex blob, and pasted into
+// saved_calibrations in calibration.c so the next boot starts warm.
+
+#define CALIBRATION_MAX_SAMPLES 255
+
+enum calibration_result {
+	CALIBRATION_ACCEPTED,
+	CALIBRATION_OUTLIER,
+};
+
+// updates *entry with a new measurement, tracking the number of samples it has
+// been learned from in *samples, and the outliers since the last of them in
+// *outliers
+enum calibration_result calibration_update(int *entry, unsigned char *samples,
+		unsigned char *outliers, int measured);
+
+// number of hex characters in a serialized blob (not including the null terminator)
+#define CALIBRATION_BLOB_HEX_LEN (2 * (4 + 6 * NUM_SPEED_SETTINGS + 2))
+
+void calibration_serialize(const struct internal_train_state *train_state, char *hex_out);
+// returns false if the blob is malformed, or for a different train
+bool calibration_deserialize(struct internal_train_state *train_state, const char *hex);
+
+// loads the saved calibration for the train, returning false if there isn't one
+bool calibration_load_saved(struct internal_train_state *train_state);
+
+// logs the blob for the train, split over several lines
+void calibration_dump(const struct internal_train_state *train_state);
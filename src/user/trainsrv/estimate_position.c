@@ -2,8 +2,10 @@
 #include "track_control.h"
 #include "train_alert_srv.h"
 #include "sensor_attribution.h"
+#include "calibration.h"
 #include "../track.h"
 #include "../displaysrv.h"
+#include "../telemetrysrv.h"
 #include "../sys.h"
 #include "../conductor.h"
 #include "../buffer.h"
@@ -11,11 +13,21 @@
 
 // constants derived from fitting a curve to velocity data collected via a camera
 // we multiply these constants by 2^20 since our fixed point notation uses 20 bits right of the decimal place
-const long long deceleration_model_coefs[6] = { 597828168, 0, -414289819, 231854274, -48630758, 3595593 };
-const unsigned deceleration_model_arity = sizeof(deceleration_model_coefs) / sizeof(deceleration_model_coefs[0]);
+static const long long deceleration_model_coefs[6] = { 597828168, 0, -414289819, 231854274, -48630758, 3595593 };
 const long long stopping_time_coef = 4701115LL;
-const unsigned acceleration_model_arity = sizeof(acceleration_model_coefs) / sizeof(acceleration_model_coefs[0]);
-const long long acceleration_model_coefs[6] = { 0, 0, 119318217, -10618953, 32740221, -3109563 };
+static const long long acceleration_model_coefs[6] = { 0, 0, 119318217, -10618953, 32740221, -3109563 };
+// x at which the acceleration curve levels off (its first maximum)
+const long long acceleration_time_coef = 8804662LL;
+
+struct polynomial deceleration_model;
+struct polynomial acceleration_model;
+
+void train_models_init(void) {
+	polynomial_init(&deceleration_model, deceleration_model_coefs,
+			ARRAY_LENGTH(deceleration_model_coefs), stopping_time_coef);
+	polynomial_init(&acceleration_model, acceleration_model_coefs,
+			ARRAY_LENGTH(acceleration_model_coefs), acceleration_time_coef);
+}
 
 int train_speed_index(const struct internal_train_state *train_state, int offset) {
 	int cur_speed = speed_historical_get_by_index(&train_state->speed_history, offset);
@@ -35,66 +47,239 @@ int train_velocity_from_state(const struct internal_train_state *train_state) {
 	return train_state->est_velocities[train_speed_index(train_state, 1)];
 }
 
-int train_eta_from_state(const struct trainsrv_state *state, const struct internal_train_state *train_state, int distance) {
-	ASSERT(train_state != NULL);
-	int velocity = train_velocity_from_state(train_state);
-	int time = (velocity > 0) ? distance * 1000 / velocity : -1;
-	return time;
+// x_scale which fits the deceleration curve to stopping from velocity v in
+// stopping_distance mm
+static long long deceleration_x_scale(int velocity, int stopping_distance) {
+	if (velocity <= 0 || stopping_distance <= 0) return 0;
+	long long velocity_fp = ((long long) velocity) * fixed_point_scale / 1000LL;
+	struct curve_scaling scale = polynomial_scale_deceleration(velocity_fp,
+			stopping_distance * fixed_point_scale, &deceleration_model);
+	return scale.x_scale;
 }
-int train_eta(struct trainsrv_state *state, int train_id, int distance) {
-	struct internal_train_state *train_state = get_train_state(state, train_id);
-	return train_eta_from_state(state, train_state, distance);
+
+static bool transition_accelerating(const struct speed_transition *tr) {
+	return tr->v1 > tr->v0;
 }
 
-int get_estimated_distance_travelled(struct internal_train_state *train_state, int now) {
+static long long transition_curve_end(const struct speed_transition *tr) {
+	return transition_accelerating(tr) ? acceleration_time_coef : stopping_time_coef;
+}
 
-	int distance;
-	if (train_state->speed_history.len >= 2 && speed_historical_get_current(&train_state->speed_history) == 0) {
-		// we stopped - for the period of time that we were slowing down, project our distance forwards
+// ticks after the start of the transition that we reach the new velocity
+static int transition_duration(const struct speed_transition *tr) {
+	if (tr->x_scale <= 0) return 0;
+	return (transition_curve_end(tr) + tr->x_scale - 1) / tr->x_scale;
+}
 
-		// get the time we stopped at, and the velocity we used to be going at
-		int index = train_speed_index(train_state, 2);
-		int velocity = train_state->est_velocities[index];
-		int stopping_distance = train_state->est_stopping_distances[index];
-		int time_stopped = speed_historical_get_kvp_by_index(&train_state->speed_history, 1).time;
+static int transition_velocity(const struct speed_transition *tr, int t) {
+	if (t < 0) return tr->v0;
+	if (t >= transition_duration(tr)) return tr->v1;
+	long long x = t * tr->x_scale;
+	if (transition_accelerating(tr)) {
+		// v = v0 + (v1 - v0) * A(x) / A(end)
+		return tr->v0 + (tr->v1 - tr->v0) * polynomial_evaluate(&acceleration_model, x)
+			/ acceleration_model.value_at_end;
+	} else {
+		// v = v1 + (v0 - v1) * D(x) / D(0)
+		return tr->v1 + (tr->v0 - tr->v1) * polynomial_evaluate(&deceleration_model, x)
+			/ deceleration_model.coefs[0];
+	}
+}
 
-		// we should have reanchored when stopping
-		ASSERT(train_state->last_known_time >= time_stopped);
+// distance in micrometers covered between a and b ticks after the start of the transition
+static long long transition_distance(const struct speed_transition *tr, int a, int b) {
+	if (b <= a) return 0;
+	long long um = 0;
+	if (a < 0) {
+		um += (long long) tr->v0 * (MIN(b, 0) - a);
+		a = 0;
+	}
+	const int duration = transition_duration(tr);
+	if (a < duration && a < b) {
+		const int end = MIN(b, duration);
+		long long lo = a * tr->x_scale;
+		long long hi = MIN(end * tr->x_scale, transition_curve_end(tr));
+		if (transition_accelerating(tr)) {
+			long long integral = polynomial_integrate(&acceleration_model, lo, hi);
+			um += (long long) tr->v0 * (end - a)
+				+ (tr->v1 - tr->v0) * integral / acceleration_model.value_at_end
+				* fixed_point_scale / tr->x_scale;
+		} else {
+			long long integral = polynomial_integrate(&deceleration_model, lo, hi);
+			um += (long long) tr->v1 * (end - a)
+				+ (tr->v0 - tr->v1) * integral / deceleration_model.coefs[0] * fixed_point_scale / tr->x_scale;
+		}
+		a = end;
+	}
+	um += (long long) tr->v1 * (b - a);
+	return um;
+}
 
-		// scale the deceleration curve so that it fits this particular set of velocities / times
-		long long velocity_fp = ((long long) velocity) * fixed_point_scale / 1000LL;
-		struct curve_scaling scale = scale_deceleration_curve(velocity_fp,
-				stopping_distance * fixed_point_scale, deceleration_model_coefs,
-				acceleration_model_arity, stopping_time_coef);
+// Stopping from v, when the train was going at (or getting up to) speed index
+// i, takes the fraction of that speed's stopping distance that a constant
+// deceleration would.
+static int stopping_distance_from(const struct internal_train_state *train_state, int i, int v) {
+	const int full_velocity = train_state->est_velocities[i];
+	const int stopping_distance = train_state->est_stopping_distances[i];
+	if (v >= full_velocity) return stopping_distance;
+	return (long long) stopping_distance * v * v / ((long long) full_velocity * full_velocity);
+}
 
-		// prepare the interal boundaries
-		// we want to integrate over the velocity curve to get the distance travelled.
-		// if we've passed a sensor since we started stopping, only integrate the part of the curve
-		// after the time we hit the sensor
-		long long integral_start = MAX((train_state->last_known_time - time_stopped) * scale.x_scale, 0);
+static long long slowing_x_scale(int v0, int v1, int stopping_distance) {
+	// Shedding all of v0 takes as long as stopping from it does, so shedding
+	// part of it takes proportionally less time.
+	return deceleration_x_scale(v0, stopping_distance) * v0 / (v0 - v1);
+}
 
-		// clip off excess time, if a lot of time passed between us stopping, and reanchoring
-		// this shouldn't really happen.
-		integral_start = MIN(integral_start, stopping_time_coef);
+static long long speeding_x_scale(int v0, int v1, int stopping_distance) {
+	// We don't have good data on how long trains take to get up to speed,
+	// so we assume it's as long as it takes to stop from that speed.
+	long long full = deceleration_x_scale(v1, stopping_distance);
+	return full * acceleration_time_coef / stopping_time_coef * v1 / (v1 - v0);
+}
 
-		// integrate for delta_t time after the start of the integral
-		int delta_t = now - MAX(train_state->last_known_time, time_stopped);
-		long long integral_end = MIN(integral_start + delta_t * scale.x_scale, stopping_time_coef);
+// Called after the speed history has been updated with the new speed
+static void start_speed_transition(struct internal_train_state *train_state, int now) {
+	struct speed_transition *tr = &train_state->transition;
+	const int v0 = transition_velocity(tr, now - tr->start_time);
+	const int v1 = train_velocity_from_state(train_state);
+
+	tr->start_time = now;
+	tr->v0 = v0;
+	tr->v1 = v1;
+	tr->x_scale = 0;
+	if (v0 == v1) return;
+
+	if (v1 < v0) {
+		if (train_state->speed_history.len < 2) return;
+		tr->x_scale = slowing_x_scale(v0, v1,
+				stopping_distance_from(train_state, train_speed_index(train_state, 2), v0));
+	} else {
+		tr->x_scale = speeding_x_scale(v0, v1,
+				train_state->est_stopping_distances[train_speed_index(train_state, 1)]);
+	}
+}
 
-		/* printf("integrating from %d to %d, last known at %d, stopped at %d, now %d, delta_t %d" EOL, */
-		/* 		(int) integral_start, (int) integral_end, train_state->last_known_time, time_stopped, now, delta_t); */
+// how far we'd get, in micrometers, if we started accelerating from a stop,
+// and set the train to stop t ticks later
+static long long distance_stopping_at(const struct internal_train_state *train_state, int i,
+		const struct speed_transition *up, int t) {
+	const int v = transition_velocity(up, t);
+	return transition_distance(up, 0, t) + stopping_distance_from(train_state, i, v) * 1000LL;
+}
 
-		long long integral = integrate_polynomial(integral_start, integral_end,
-			deceleration_model_coefs, deceleration_model_arity);
-		distance = scale.y_scale * integral / scale.x_scale / fixed_point_scale;
+// ticks it takes to stop from v, partway up to speed index i
+static int stopping_time_from(const struct internal_train_state *train_state, int i, int v) {
+	if (v <= 0) return 0;
+	const struct speed_transition down = {
+		.v0 = v, .v1 = 0,
+		.x_scale = slowing_x_scale(v, 0, stopping_distance_from(train_state, i, v)),
+	};
+	return transition_duration(&down);
+}
 
-	} else {
-		const int velocity = train_velocity_from_state(train_state);
-		const int delta_t = now - train_state->last_known_time;
-		distance = delta_t * velocity / 1000;
+void train_plan_motion(const struct internal_train_state *train_state, int distance, int max_speed,
+		struct motion_plan *plan) {
+	memset(plan, 0, sizeof(*plan));
+	if (distance <= 0) return;
+	const long long target = distance * 1000LL;
+
+	for (int speed = 1; speed <= max_speed; speed++) {
+		// accelerating from a stop into the speed setting
+		const int i = speed * 2 - 1;
+		const int velocity = train_state->est_velocities[i];
+		const int stopping_distance = train_state->est_stopping_distances[i];
+		if (velocity <= 0 || stopping_distance <= 0) continue;
+		const struct speed_transition up = {
+			.v0 = 0, .v1 = velocity,
+			.x_scale = speeding_x_scale(0, velocity, stopping_distance),
+		};
+		const int up_time = transition_duration(&up);
+
+		struct motion_plan p = { .speed = speed };
+		const long long cruise = target - distance_stopping_at(train_state, i, &up, up_time);
+		if (cruise >= 0) {
+			// accelerate, cruise, then stop
+			p.stop_time = up_time + cruise / velocity;
+			p.stop_lead = stopping_distance;
+			p.duration = p.stop_time + stopping_time_from(train_state, i, velocity);
+		} else {
+			// stop before we're up to speed, as late as we can without overshooting
+			int lo = 0, hi = up_time;
+			while (lo < hi) {
+				int mid = (lo + hi + 1) / 2;
+				if (distance_stopping_at(train_state, i, &up, mid) <= target) lo = mid;
+				else hi = mid - 1;
+			}
+			if (lo == 0) continue; // we can't even get going
+			const int v = transition_velocity(&up, lo);
+			p.stop_time = lo;
+			p.stop_lead = distance - transition_distance(&up, 0, lo) / 1000;
+			p.duration = lo + stopping_time_from(train_state, i, v);
+			p.short_move = true;
+		}
+		if (plan->speed == 0 || p.duration < plan->duration) *plan = p;
 	}
+}
 
-	const int overshoot_tolerance = 50;
+int train_current_velocity(const struct internal_train_state *train_state, int now) {
+	return transition_velocity(&train_state->transition, now - train_state->transition.start_time);
+}
+
+int train_eta_from_state(const struct trainsrv_state *state, const struct internal_train_state *train_state, int distance) {
+	return train_eta_from_time(state, train_state, time(), distance);
+}
+
+int train_eta_from_time(const struct trainsrv_state *state, const struct internal_train_state *train_state,
+		int from, int distance) {
+	ASSERT(train_state != NULL);
+	const struct speed_transition *tr = &train_state->transition;
+	const int t0 = from - tr->start_time;
+	const int remaining = transition_duration(tr) - t0;
+	if (remaining <= 0) {
+		int velocity = train_velocity_from_state(train_state);
+		int time = (velocity > 0) ? distance * 1000 / velocity : -1;
+		return time;
+	}
+
+	// we're changing speed, so search for the time we'll have covered the distance
+	const long long target = distance * 1000LL;
+	int hi = remaining + ((tr->v1 > 0) ? target / tr->v1 + 1 : 0);
+	if (transition_distance(tr, t0, t0 + hi) < target) return -1;
+	int lo = 0;
+	while (lo < hi) {
+		int mid = (lo + hi) / 2;
+		if (transition_distance(tr, t0, t0 + mid) >= target) hi = mid;
+		else lo = mid + 1;
+	}
+	return lo;
+}
+int train_eta(struct trainsrv_state *state, int train_id, int distance) {
+	struct internal_train_state *train_state = get_train_state(state, train_id);
+	return train_eta_from_state(state, train_state, distance);
+}
+
+// we never let the estimate run further than this past the sensor we expect
+// to hit next, however unsure we are
+#define MIN_OVERSHOOT_TOLERANCE 50
+
+int train_position_stddev(const struct internal_train_state *train_state, int now) {
+	struct kalman_state predicted;
+	kalman_predict(&train_state->kalman, now, &predicted);
+	return kalman_position_stddev(&predicted);
+}
+
+int get_estimated_distance_travelled(struct internal_train_state *train_state, int now) {
+	const struct speed_transition *tr = &train_state->transition;
+	struct kalman_state predicted;
+	kalman_predict(&train_state->kalman, now, &predicted);
+	const long long modelled = transition_distance(tr, train_state->last_known_time - tr->start_time,
+			now - tr->start_time);
+	const int distance = (modelled + predicted.offset) / 1000;
+
+	// If we haven't hit the sensor yet, the train is probably being held up,
+	// but we can't rule out being off by a couple of standard deviations.
+	const int overshoot_tolerance = MAX(MIN_OVERSHOOT_TOLERANCE, 2 * kalman_position_stddev(&predicted));
 	const int maximum_acceptable_distance = train_state->mm_to_next_sensor + overshoot_tolerance;
 
 	return MIN(distance, maximum_acceptable_distance);
@@ -113,7 +298,7 @@ struct position get_estimated_train_position(struct trainsrv_state *state,
 	// find how much time has passed since the recorded position on the internal
 	// train state, and how far we expect to have moved since then
 	struct switch_state switches = switch_historical_get_current(&state->switch_history);
-	position_travel_forwards(&position, get_estimated_distance_travelled(train_state, time()), &switches);
+	position_travel_forwards(&position, MAX(0, get_estimated_distance_travelled(train_state, time())), &switches);
 
 	return position;
 }
@@ -124,7 +309,30 @@ struct internal_train_state* get_train_state(struct trainsrv_state *state, int t
 	return train_state;
 }
 
+// uncertainty in our velocity model, in micrometers per tick
+#define INITIAL_VELOCITY_STDDEV 500
+#define MIN_VELOCITY_STDDEV 100
+
+// where along the track a sensor trips depends on the train's pickup, how
+// fast it's going, and how dirty the track is
+#define SENSOR_POSITION_STDDEV 20 // mm
+
+// hardcoded table entries count as this many samples
+#define PRIOR_SAMPLES 3
+
+static void initialize_hardcoded_velocity_table(struct internal_train_state *train_state, int train_id);
+
 static void initialize_train_velocity_table(struct internal_train_state *train_state, int train_id) {
+	if (calibration_load_saved(train_state)) return;
+
+	initialize_hardcoded_velocity_table(train_state, train_id);
+	for (int i = 0; i < NUM_SPEED_SETTINGS; i++) {
+		train_state->velocity_samples[i] = (train_state->est_velocities[i] > 0) ? PRIOR_SAMPLES : 0;
+		train_state->stopping_distance_samples[i] = (train_state->est_stopping_distances[i] > 0) ? PRIOR_SAMPLES : 0;
+	}
+}
+
+static void initialize_hardcoded_velocity_table(struct internal_train_state *train_state, int train_id) {
 	// our model is v = offset + speed_coef * speed + is_accelerated * is_accelerated_coef
 	// basic linear model fitted in R
 	// all of these are denominated in micrometers
@@ -232,6 +440,27 @@ static void reanchor(struct trainsrv_state *state,
 	train_state->last_known_position = get_estimated_train_position(state, train_state);
 	train_state->last_known_time = now;
 	train_state->mm_to_next_sensor -= get_estimated_distance_travelled(train_state, now);
+	// the correction is now part of the anchor
+	kalman_predict(&train_state->kalman, now, &train_state->kalman);
+	train_state->kalman.offset = 0;
+}
+
+void train_adopt_hypothesis(struct internal_train_state *train_state, const struct sensor_hypothesis *h) {
+	struct sensor_historical_state *history = &train_state->sensor_history;
+	while (history->len > 0 && sensor_historical_get_kvp_current(history).time >= h->time) {
+		sensor_historical_retract(history);
+	}
+	train_state->next_sensor = NULL;
+	if (h->sensor < 0) {
+		sensor_historical_init(history);
+		train_state->last_known_position = (struct position) { NULL, 0 };
+		return;
+	}
+	sensor_historical_set(history, h->sensor, h->time);
+	train_state->last_known_position = (struct position) { &track_node_from_sensor(h->sensor)->edge[0], 0 };
+	train_state->last_known_time = h->time;
+	// whatever the filter learnt since was about some other train
+	kalman_init(&train_state->kalman, h->time, SENSOR_POSITION_STDDEV, INITIAL_VELOCITY_STDDEV);
 }
 
 static void reanchor_all(struct trainsrv_state *state) {
@@ -244,10 +473,8 @@ static void reanchor_all(struct trainsrv_state *state) {
 int update_train_speed(struct trainsrv_state *state, int train_id, int speed) {
 	struct internal_train_state *train_state = get_train_state(state, train_id);
 	if (train_state == NULL) {
-		// we've never seen this train before
-		ASSERT(state->unknown_train_id == 0);
-		state->unknown_train_id = train_id;
-
+		// we've never seen this train before, so we'll only know where it is
+		// once sensor attribution finds it
 		train_state = allocate_train_state(state, train_id);
 	}
 	// Just don't allow this so that we don't have to think about what the train
@@ -263,6 +490,12 @@ int update_train_speed(struct trainsrv_state *state, int train_id, int speed) {
 		reanchor(state, train_state);
 	}
 	speed_historical_set(&train_state->speed_history, speed, now);
+	start_speed_transition(train_state, now);
+	const int velocity_change = abs(train_state->transition.v1 - train_state->transition.v0);
+	kalman_velocity_changed(&train_state->kalman, MAX(MIN_VELOCITY_STDDEV, velocity_change / 4));
+	if (train_state->transition.v1 == 0) {
+		kalman_stops_at(&train_state->kalman, now + transition_duration(&train_state->transition));
+	}
 
 	ASSERT(train_state->speed_history.len > 0);
 	return 1;
@@ -298,7 +531,7 @@ static void log_position_estimation_error(const struct trainsrv_state *state,
 	if (train_state->next_sensor != NULL) {
 		char sens_name[4];
 		sensor_repr(sensor_node->num, sens_name);
-		ASSERTF(train_state->next_sensor->type == NODE_SENSOR, "sensor node was %x from %x, track = %x", (unsigned) train_state->next_sensor, (unsigned) train_state, (unsigned) track);
+		ASSERTF(train_state->next_sensor->type == NODE_SENSOR, "sensor node was %p from %p, track = %p", train_state->next_sensor, train_state, track);
 		if (train_state->next_sensor == sensor_node) {
 			const int delta_d = train_state->mm_to_next_sensor - get_estimated_distance_travelled(train_state, time());
 			train_state->measurement_error = delta_d;
@@ -331,10 +564,15 @@ static void log_position_estimation_error(const struct trainsrv_state *state,
 int calculate_actual_velocity(struct internal_train_state *train_state,
 		const struct track_node *sensor_node, const struct switch_state *switches, int ticks) {
 	// we think we're still accelerating, so we don't know how fast we are
-	// allow 4s after the last speed change to adjust to the new speed
-	if (train_state->speed_history.len > 0 &&
-			ticks < speed_historical_get_kvp_current(&train_state->speed_history).time + 400) {
-		return SILENT_ERROR;
+	// if we can't model the acceleration, allow 4s after the last speed change
+	// to adjust to the new speed
+	if (train_state->speed_history.len > 0) {
+		const struct speed_transition *tr = &train_state->transition;
+		int settled = speed_historical_get_kvp_current(&train_state->speed_history).time +
+			((tr->x_scale > 0) ? transition_duration(tr) : 400);
+		if (ticks < settled || train_state->last_known_time < settled) {
+			return SILENT_ERROR;
+		}
 	}
 	ASSERT(sensor_node != NULL);
 
@@ -362,13 +600,117 @@ static void update_train_velocity_estimate(const struct trainsrv_state *state, s
 		return;
 	}
 
-	// v' = (1 - alpha) * v + alpha * v_actual
-	// empirically chosen to give a good update
-	const int alpha = 100;
-	const int divisor = 1000;
+	const int index = train_speed_index(train_state, 1);
+	int *velocity_entry = &train_state->est_velocities[index];
+	const int old_velocity = *velocity_entry;
+	if (calibration_update(velocity_entry, &train_state->velocity_samples[index],
+				&train_state->velocity_outliers[index], actual_velocity) == CALIBRATION_OUTLIER) {
+		return;
+	}
+	// the filter's velocity correction is relative to the table, so whatever
+	// the table has picked up no longer needs correcting for
+	train_state->kalman.velocity -= *velocity_entry - old_velocity;
+	// we only get here once the train has settled at this speed
+	train_state->transition.v1 = *velocity_entry;
+
+	// The other entry for the same speed setting (approached from above rather
+	// than below, or vice versa) is close enough to be a better starting point
+	// than nothing.
+	const int sibling = (index % 2 == 1) ? index + 1 : index - 1;
+	if (0 < sibling && sibling < NUM_SPEED_SETTINGS && train_state->velocity_samples[sibling] == 0) {
+		train_state->est_velocities[sibling] = *velocity_entry;
+	}
+}
+
+// If we hit a sensor while stopping, we can work out how far the train will
+// take to stop: we find the stopping distance whose deceleration curve would
+// have covered the distance we actually covered in the time it took.
+static void update_stopping_distance_estimate(const struct trainsrv_state *state, struct internal_train_state *train_state,
+        const struct track_node *sensor_node, int ticks) {
+	const struct speed_transition *tr = &train_state->transition;
+	if (tr->v1 != 0 || tr->v0 <= 0 || train_state->speed_history.len < 2) return;
+	if (train_state->last_known_time < tr->start_time) return;
+	if (position_is_uninitialized(&train_state->last_known_position)) return;
+
+	const int index = train_speed_index(train_state, 2);
+	int *stopping_entry = &train_state->est_stopping_distances[index];
+	unsigned char *samples = &train_state->stopping_distance_samples[index];
+
+	// the stopping distance is for stopping after having settled at the speed
+	const int settled_velocity = train_state->est_velocities[index];
+	if (abs(tr->v0 - settled_velocity) > settled_velocity / 20) return;
+
+	// early on in the stop, the distance covered tells us very little about
+	// how long the stop will take
+	if (*samples > 0 && *stopping_entry > 0 &&
+			transition_velocity(tr, ticks - tr->start_time) > tr->v0 * 2 / 3) {
+		return;
+	}
+
+	struct switch_state switches = switch_historical_get_current(&state->switch_history);
+	struct position sensor_position = { &sensor_node->edge[0], 0 };
+	const int actual_distance = position_distance_apart(&train_state->last_known_position, &sensor_position, &switches);
+	if (actual_distance <= 0) return;
+
+	const int a = train_state->last_known_time - tr->start_time;
+	const int b = ticks - tr->start_time;
+	const long long target = actual_distance * 1000LL;
+
+	// the distance covered in [a, b] grows with the stopping distance
+	struct speed_transition candidate = *tr;
+	int lo = 1, hi = 3000;
+	candidate.x_scale = deceleration_x_scale(tr->v0, hi);
+	if (transition_distance(&candidate, a, b) < target) return;
+	while (lo < hi) {
+		int mid = (lo + hi) / 2;
+		candidate.x_scale = deceleration_x_scale(tr->v0, mid);
+		if (transition_distance(&candidate, a, b) >= target) hi = mid;
+		else lo = mid + 1;
+	}
 
-	int *velocity_entry = &train_state->est_velocities[train_speed_index(train_state, 1)];
-	*velocity_entry = ((divisor - alpha) * *velocity_entry + alpha * actual_velocity) / divisor;
+	if (calibration_update(stopping_entry, samples,
+				&train_state->stopping_distance_outliers[index], lo) == CALIBRATION_OUTLIER) {
+		logf("Train %d rejected stopping distance measurement of %d mm (expected %d mm)",
+				train_state->train_id, lo, *stopping_entry);
+	}
+}
+
+// Our model says the train should have covered a particular distance since
+// it was last anchored, and we know how far it actually went to hit this
+// sensor, so we correct the filter before reanchoring at the sensor.
+static void update_kalman_from_sensor(const struct trainsrv_state *state, struct internal_train_state *train_state,
+        const struct track_node *sensor_node, int ticks, int poll_ms) {
+	struct kalman_state *k = &train_state->kalman;
+	if (position_is_uninitialized(&train_state->last_known_position)) {
+		kalman_init(k, ticks, SENSOR_POSITION_STDDEV, INITIAL_VELOCITY_STDDEV);
+		return;
+	}
+
+	struct switch_state switches = switch_historical_get_current(&state->switch_history);
+	struct position sensor_position = { &sensor_node->edge[0], 0 };
+	const int actual_distance = position_distance_apart(&train_state->last_known_position, &sensor_position, &switches);
+	if (actual_distance < 0) {
+		// the train has turned up somewhere we didn't think it could get to
+		kalman_init(k, ticks, SENSOR_POSITION_STDDEV, INITIAL_VELOCITY_STDDEV);
+		return;
+	}
+
+	const struct speed_transition *tr = &train_state->transition;
+	const long long modelled = transition_distance(tr, train_state->last_known_time - tr->start_time,
+			ticks - tr->start_time);
+	kalman_predict(k, ticks, k);
+	const int innovation = actual_distance * 1000LL - (modelled + k->offset);
+
+	// The sensor could have tripped any time during the poll, which is a
+	// uniform distribution with variance poll^2 / 12.
+	const int velocity = train_current_velocity(train_state, ticks);
+	const int latency_stddev = velocity * poll_ms * 2 / (10 * 1000 * 7); // 2/7 ~= 1/sqrt(12)
+	const int measurement_stddev = sqrti(SENSOR_POSITION_STDDEV * SENSOR_POSITION_STDDEV +
+			latency_stddev * latency_stddev);
+	kalman_update(k, innovation, measurement_stddev);
+
+	// we're about to anchor at the sensor, so the offset becomes relative to it
+	k->offset += modelled - actual_distance * 1000LL;
 }
 
 static void notify_conductor_of_sensor(const struct internal_train_state *train_state,
@@ -382,15 +724,17 @@ static void notify_conductor_of_sensor(const struct internal_train_state *train_
 
 static void update_train_position_from_sensor(const struct trainsrv_state *state,
         struct internal_train_state *train_state,
-        int sensor, int ticks) {
+        int sensor, int ticks, int poll_ms) {
 
 	const struct track_node *sensor_node = track_node_from_sensor(sensor);
 	ASSERT(sensor_node != NULL && sensor_node->type == NODE_SENSOR && sensor_node->num == sensor);
 
 	log_position_estimation_error(state, train_state, sensor_node, ticks);
+	update_kalman_from_sensor(state, train_state, sensor_node, ticks, poll_ms);
 
 	// adjust estimate for train speed
 	update_train_velocity_estimate(state, train_state, sensor_node, ticks);
+	update_stopping_distance_estimate(state, train_state, sensor_node, ticks);
 
 	// update internal train state
 	train_state->last_known_position.edge = &sensor_node->edge[0];
@@ -403,41 +747,55 @@ static void update_train_position_from_sensor(const struct trainsrv_state *state
 			train_state->last_known_position.edge->src->name, train_state->last_known_position.displacement);
 
 	// tell the train_alert server about this
-	train_alert_update_train(train_state->train_id, train_state->last_known_position);
+	struct train_position_update update = { train_state->train_id, train_state->last_known_position };
+	pubsub_publish(TOPIC_TRAIN_POSITIONS, &update, sizeof(update));
 }
 
 struct sensor_context {
 	struct trainsrv_state *state;
-	int time;
+	const struct sensor_state *sensors;
+	int poll_ms;
 
 	unsigned train_already_hit[NUM_TRAIN / 32];
 };
 
 static void sensor_cb(int sensor, void *ctx) {
 	struct sensor_context *context = (struct sensor_context*) ctx;
-	struct attribution attr = attribute_sensor_to_train(context->state, sensor, context->time);
+	// everything downstream wants the time the sensor actually tripped, rather
+	// than the time we found out about it
+	const int time = sensor_trip_time(context->sensors, sensor);
+	struct attribution attr = attribute_sensor_to_train(context->state, sensor, time);
 	// TODO: we should use the attr.distance to inform the velocity calculation
 	const struct internal_train_state *train = attr.train;
 	char sensor_pretty[4];
 	sensor_repr(sensor, sensor_pretty);
 
+	// we never attribute multiple sensor hits to the same train in the same cycle
+	// we essentially assume that this must be a spurious signal
+	if (train != NULL) {
+		const int index = (train->train_id - 1) / 32;
+		const unsigned mask = 1 << ((train->train_id - 1) % 32);
+		if (context->train_already_hit[index] & mask) return;
+		context->train_already_hit[index] |= mask;
+	}
+
+	// this also moves the train back to where it really was, if that wasn't
+	// where we thought
+	attribution_record(context->state, &attr, sensor, time);
+
 	// spurious sensor signal
 	if (train == NULL) {
 		displaysrv_update_sensor_attribution(whois("displaysrv"), sensor, -1);
+		telemetry_sensor_attribution(sensor, -1, time);
 		logf("Ignoring spurious sensor hit %s", sensor_pretty);
 		return;
 	}
-
-	const int index = (train->train_id - 1) / 32;
-	const int offset = (train->train_id - 1) % 32;
-	const unsigned mask = 1 << offset;
-
-	// we never attribute multiple sensor hits to the same train in the same cycle
-	// we essentially assume that this must be a spurious signal
-	if (context->train_already_hit[index] & mask) return;
-	context->train_already_hit[index] |= mask;
+	if (attr.alternative >= 0) {
+		logf("Train %d was not where we thought, now at %s", train->train_id, sensor_pretty);
+	}
 
 	displaysrv_update_sensor_attribution(whois("displaysrv"), sensor, train->train_id);
+	telemetry_sensor_attribution(sensor, train->train_id, time);
 	//logf("Attributing sensor hit %s to %d", sensor_pretty, train->train_id);
 
 	if (attr.changed_switch != -1) {
@@ -455,18 +813,25 @@ static void sensor_cb(int sensor, void *ctx) {
 		train_m->reversed = false;
 	}
 
-	update_train_position_from_sensor(context->state, train_m, sensor, context->time);
-	notify_conductor_of_sensor(train, sensor, context->time);
+	update_train_position_from_sensor(context->state, train_m, sensor, time, context->poll_ms);
+	notify_conductor_of_sensor(train, sensor, time);
 }
 
 void update_sensors(struct trainsrv_state *state, struct sensor_state sens) {
 	if (state->sensors_are_known) {
 		struct sensor_context context;
 	    context.state = state;
-		context.time = sens.ticks;
+		context.sensors = &sens;
+		context.poll_ms = sens.poll_ms;
 		memset(&context.train_already_hit, 0, sizeof(context.train_already_hit));
 
+		const unsigned failures = state->reliability.failures;
 		sensor_each_new(&state->sens_prev, &sens, sensor_cb, &context);
+		if (state->reliability.failures != failures) {
+			struct reliability_report report;
+			reliability_report(&state->reliability, &report);
+			displaysrv_update_reliability(state->displaysrv_tid, &report);
+		}
 	} else {
 		state->sensors_are_known = 1;
 	}
@@ -478,15 +843,16 @@ void update_switch(struct trainsrv_state *state, int sw, enum sw_direction dir)
 	struct switch_state switches = switch_historical_get_current(&state->switch_history);
 	switch_set(&switches, sw, dir);
 	switch_historical_set(&state->switch_history, switches, time());
-	train_alert_update_switch(switches);
-	displaysrv_update_switch(state->displaysrv_tid, &switches);
+	pubsub_publish(TOPIC_SWITCHES, &switches, sizeof(switches));
 }
 
 void trainsrv_state_init(struct trainsrv_state *state) {
 	memset(state, 0, sizeof(*state));
+	train_models_init();
+	reliability_init(&state->reliability);
 	switch_historical_init(&state->switch_history);
 	switch_historical_set(&state->switch_history, tc_init_switches(), time());
 	state->displaysrv_tid = whois(DISPLAYSRV_NAME);
 	struct switch_state switches = switch_historical_get_current(&state->switch_history);
-	displaysrv_update_switch(state->displaysrv_tid, &switches);
+	pubsub_publish(TOPIC_SWITCHES, &switches, sizeof(switches));
 }
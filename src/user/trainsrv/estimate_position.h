@@ -4,12 +4,40 @@
 #include "trainsrv_internal.h"
 #include "speed_history.h"
 #include "sensor_history.h"
+#include "kalman.h"
+#include "reliability.h"
 
-extern const long long deceleration_model_coefs[6];
-extern const unsigned deceleration_model_arity;
+#include "../polymath.h"
+
+// the fitted curves, over x from 0 to stopping_time_coef or acceleration_time_coef
+extern struct polynomial deceleration_model;
 extern const long long stopping_time_coef;
-extern const long long acceleration_model_coefs[6];
-extern const unsigned acceleration_model_arity;
+extern struct polynomial acceleration_model;
+extern const long long acceleration_time_coef;
+
+// must be called before the models are used
+void train_models_init(void);
+
+// A change from one velocity to another, following the fitted acceleration or
+// deceleration curve.
+struct speed_transition {
+	int start_time;
+	int v0, v1; // micrometers per tick
+	// fixed point units of the model curve per tick, or 0 if the change is
+	// instantaneous (because we don't know enough about the train to model it)
+	long long x_scale;
+};
+
+// Somewhere other than its last sensor hit that a train might have been,
+// kept in case we attributed a sensor hit to the wrong train.
+struct sensor_hypothesis {
+	int sensor; // -1 if we hadn't found the train yet
+	int time;
+	// how much less likely this is than the train's sensor history, as a
+	// cost (see sensor_attribution.c)
+	int cost;
+};
+#define MAX_ALTERNATIVES 4
 
 // state about what we know about this train
 // (previous_speed_was_bigger, current)
@@ -17,7 +45,7 @@ extern const unsigned acceleration_model_arity;
 #define NUM_SPEED_SETTINGS 28
 struct internal_train_state {
 	//  1. Its current estimated position
-	//     position_unitialized(&position) iff train_id == state->unknown_train_id
+	//     position_unitialized(&position) iff we haven't attributed a sensor to it yet
 	//     "last known" is something of a misnomer - this changes when we reanchor the trains,
 	//     so it is subject to estimation error if we reanchor.
 	struct position last_known_position;
@@ -30,12 +58,24 @@ struct internal_train_state {
 	//     Therefore, 28 = 1 + 2 * 14 - 1.)
 	int est_velocities[NUM_SPEED_SETTINGS];
 	int est_stopping_distances[NUM_SPEED_SETTINGS];
+	//     These are learned online, see calibration.h.
+	//     We keep track of how many measurements each entry is based on.
+	unsigned char velocity_samples[NUM_SPEED_SETTINGS];
+	unsigned char stopping_distance_samples[NUM_SPEED_SETTINGS];
+	unsigned char velocity_outliers[NUM_SPEED_SETTINGS];
+	unsigned char stopping_distance_outliers[NUM_SPEED_SETTINGS];
 
 	//  3. Its current and historical speed
 	struct speed_historical_state speed_history;
 
-	//  4. Later, we'll have information about if (and at what rate) it is currently
-	//     accelerating
+	//  4. If (and at what rate) it is currently accelerating or decelerating.
+	//     Every speed change starts a new transition from the velocity we were
+	//     going at right then to the velocity of the new speed setting.
+	struct speed_transition transition;
+
+	//     How far off we think the model is from reality, and how sure we are
+	//     of where the train is. This is corrected each time we hit a sensor.
+	struct kalman_state kalman;
 
 	//  5. For debug purposes, we maintain info about the next sensor we expect to hit
 	//     When we hit the next sensor, this allows us to know how far off our estimates were
@@ -56,6 +96,11 @@ struct internal_train_state {
 	// amount estimate was off by the last time we hit a sensor
 	int measurement_error;
 
+	// the next most likely places it was when it hit its last sensor, most
+	// likely first
+	struct sensor_hypothesis alternatives[MAX_ALTERNATIVES];
+	int num_alternatives;
+
 	int conductor_tid;
 };
 
@@ -67,17 +112,8 @@ struct trainsrv_state {
 	struct internal_train_state *state_for_train[NUM_TRAIN];
 	int num_active_trains;
 
-	// The id of a train that we've instructed to start moving, but we don't
-	// know where it is on the track yet.
-	// 0 iff there is no such train.
-	// We don't allow multiple such trains on the track at once, since we wouldn't
-	// be able to tell which train corresponds to which sensor hit. (The only way
-	// we could do this would be to have them all going at different speeds, and
-	// work out which train it was from the approx speed it should be going at, but
-	// this is difficult, so we don't do this.)
-	int unknown_train_id;
-
 	struct switch_historical_state switch_history;
+	struct reliability reliability;
 	struct sensor_state sens_prev;
 	int sensors_are_known;
 };
@@ -85,12 +121,26 @@ struct trainsrv_state {
 int train_speed_index(const struct internal_train_state *train_state, int offset);
 int train_velocity_from_state(const struct internal_train_state *train_state);
 int train_velocity(struct trainsrv_state *state, int train);
+// velocity right now, accounting for any acceleration in progress
+int train_current_velocity(const struct internal_train_state *train_state, int now);
 struct position get_estimated_train_position(struct trainsrv_state *state,
         struct internal_train_state *train_state);
+// standard deviation of the estimated position, in mm
+int train_position_stddev(const struct internal_train_state *train_state, int now);
 int train_eta_from_state(const struct trainsrv_state *state, const struct internal_train_state *train_state, int distance);
+// ticks after the given time that the train will have gone the given distance
+int train_eta_from_time(const struct trainsrv_state *state, const struct internal_train_state *train_state,
+		int from, int distance);
 int train_eta(struct trainsrv_state *state, int train_id, int distance);
+// the quickest way to get a stopped train exactly distance mm further on,
+// going no faster than max_speed
+void train_plan_motion(const struct internal_train_state *train_state, int distance, int max_speed,
+		struct motion_plan *plan);
 
 struct internal_train_state* get_train_state(struct trainsrv_state *state, int train_id);
+// moves the train back to where a hypothesis says it was, forgetting the
+// sensor hits since
+void train_adopt_hypothesis(struct internal_train_state *train_state, const struct sensor_hypothesis *h);
 
 // returns 1 if we should actually set the speed
 int update_train_speed(struct trainsrv_state *state, int train_id, int speed);
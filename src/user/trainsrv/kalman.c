@@ -0,0 +1,82 @@
+#include "kalman.h"
+
+#include <util.h>
+#include <assert.h>
+
+// process noise, per tick
+// positions drift a little even at a known velocity (wheel slip, curves)
+#define POSITION_NOISE 1 // mm^2
+// and the velocity wanders due to track condition, power, etc.
+#define VELOCITY_NOISE 4 // (micrometers / tick)^2
+
+void kalman_init(struct kalman_state *k, int time, int position_stddev, int velocity_stddev) {
+	k->time = time;
+	k->offset = 0;
+	k->velocity = 0;
+	k->p00 = position_stddev * position_stddev;
+	k->p01 = 0;
+	k->p11 = velocity_stddev * velocity_stddev;
+	k->stopping = false;
+}
+
+void kalman_predict(const struct kalman_state *k, int now, struct kalman_state *out) {
+	// nothing changes once the train has stopped
+	const bool stopped = k->stopping && now >= k->stop_time;
+	const int end = stopped ? MAX(k->time, k->stop_time) : now;
+	const long long dt = MAX(0, end - k->time);
+	// x' = F x, with F = [1 dt; 0 1]
+	// P' = F P F^T + Q
+	const long long p00 = k->p00 + 2 * dt * k->p01 / 1000 + dt * dt * k->p11 / 1000000 + POSITION_NOISE * dt;
+	long long p01 = k->p01 + dt * k->p11 / 1000;
+	long long p11 = k->p11 + VELOCITY_NOISE * dt;
+	if (stopped) {
+		p01 = 0;
+		p11 = 0;
+	}
+
+	out->time = now;
+	out->offset = k->offset + dt * k->velocity;
+	out->velocity = stopped ? 0 : k->velocity;
+	// we'll have lost track of the train long before these saturate
+	out->p00 = MIN(p00, 0x7fffffffLL);
+	out->p01 = MAX(MIN(p01, 0x7fffffffLL), -0x7fffffffLL);
+	out->p11 = MIN(p11, 0x7fffffffLL);
+	out->stopping = k->stopping;
+	out->stop_time = k->stop_time;
+}
+
+void kalman_update(struct kalman_state *k, int innovation, int measurement_stddev) {
+	// S = H P H^T + R, with H = [1 0]
+	const long long r = measurement_stddev * measurement_stddev;
+	const long long s = k->p00 + r;
+	ASSERT(s > 0);
+
+	// K = P H^T / S, and x' = x + K y
+	k->offset += (long long) k->p00 * innovation / s;
+	k->velocity += (long long) k->p01 * innovation / 1000 / s;
+
+	// P' = (I - K H) P
+	const long long p01 = k->p01;
+	k->p00 = k->p00 * r / s;
+	k->p01 = p01 * r / s;
+	k->p11 -= p01 * p01 / s;
+	ASSERT(k->p00 >= 0 && k->p11 >= 0);
+}
+
+void kalman_velocity_changed(struct kalman_state *k, int velocity_stddev) {
+	// the old correction was for a different speed setting, and doesn't
+	// necessarily carry over
+	k->velocity = 0;
+	k->p01 = 0;
+	k->p11 = velocity_stddev * velocity_stddev;
+	k->stopping = false;
+}
+
+void kalman_stops_at(struct kalman_state *k, int time) {
+	k->stopping = true;
+	k->stop_time = time;
+}
+
+int kalman_position_stddev(const struct kalman_state *k) {
+	return sqrti(k->p00);
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <util.h>
+
+// Kalman filter over a train's position and velocity.
+//
+// Rather than tracking the position and velocity directly, the filter tracks
+// corrections to our model of the train (dead reckoning from the last sensor,
+// using the velocity tables and acceleration curves). This keeps the filter
+// linear: the model supplies the nonlinear part of the motion, and the filter
+// works out how far off it is, and how sure we are of that.
+//
+// Everything is integer arithmetic with fixed units, since we have no FPU:
+// offsets are in micrometers, velocities in micrometers per tick, and the
+// covariances in the corresponding squared units (mm^2 for position).
+struct kalman_state {
+	// tick the rest of the state is for
+	int time;
+
+	// correction to the position and velocity from the model
+	int offset; // micrometers
+	int velocity; // micrometers per tick
+
+	// covariance matrix of (offset, velocity)
+	int p00; // mm^2
+	int p01; // mm * micrometers / tick
+	int p11; // (micrometers / tick)^2
+
+	// if set, the train is stopped from stop_time on. A stopped train doesn't
+	// drift, and has no velocity to be wrong about.
+	bool stopping;
+	int stop_time;
+};
+
+void kalman_init(struct kalman_state *k, int time, int position_stddev, int velocity_stddev);
+
+// propagates the state forwards to the given time
+void kalman_predict(const struct kalman_state *k, int now, struct kalman_state *out);
+
+// corrects the state, given that we measured the train to be innovation
+// micrometers further along than the state predicted, with a measurement
+// standard deviation of measurement_stddev mm
+void kalman_update(struct kalman_state *k, int innovation, int measurement_stddev);
+
+// the model velocity has changed under us, so we're less sure how accurate it is
+void kalman_velocity_changed(struct kalman_state *k, int velocity_stddev);
+
+// the train will have come to a stop by the given time
+void kalman_stops_at(struct kalman_state *k, int time);
+
+int kalman_position_stddev(const struct kalman_state *k);
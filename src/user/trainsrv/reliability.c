@@ -0,0 +1,149 @@
+#include "reliability.h"
+
+#include <assert.h>
+
+// 100 ln(x), for x >= 1.
+// This works out log2(x) with 8 fractional bits, by repeatedly squaring the
+// mantissa, which is plenty for costs that are only rough guesses anyway.
+static int ln100(unsigned x) {
+	ASSERT(x >= 1);
+	int log2 = 0;
+	while ((x >> log2) >= 2) log2++;
+	// 1.15 fixed point, in [1, 2)
+	unsigned mantissa = (unsigned) (((unsigned long long) x << 15) >> log2);
+	log2 <<= 8;
+	for (int bit = 7; bit >= 0; bit--) {
+		mantissa = (mantissa * mantissa) >> 15;
+		if (mantissa >= (2u << 15)) {
+			mantissa >>= 1;
+			log2 |= 1 << bit;
+		}
+	}
+	return log2 * 6931 / (256 * 100);
+}
+
+// the cost of failing again, having failed failures times out of trials
+static int failure_cost(int failures, int trials, int prior_trials) {
+	return ln100(trials + prior_trials) - ln100(failures + 1);
+}
+
+static void update_sensor_costs(struct sensor_reliability *s) {
+	s->missed_cost = failure_cost(s->misses, s->hits + s->misses, MISS_PRIOR_TRIALS);
+	s->spurious_cost = failure_cost(s->phantoms, s->hits + s->phantoms, PHANTOM_PRIOR_TRIALS);
+	if (s->hits == 0) s->spurious_cost = MAX(s->spurious_cost, COST_UNKNOWN_TRAIN + 1);
+	s->blacklisted = s->hits > 0 && s->phantoms >= BLACKLIST_MIN_PHANTOMS && s->phantoms > s->hits;
+	// nothing it says can be trusted, including not triggering
+	if (s->blacklisted) s->missed_cost = 0;
+}
+
+static void update_switch_costs(struct reliability *r, int packed_num) {
+	struct switch_reliability *s = &r->switches[packed_num];
+	s->wrong_cost = failure_cost(s->misroutes, s->traversals, MISROUTE_PRIOR_TRIALS);
+	if (s->wrong_cost <= UNRELIABLE_SWITCH_COST) {
+		r->unreliable_switches |= 1u << packed_num;
+	} else {
+		r->unreliable_switches &= ~(1u << packed_num);
+	}
+}
+
+void reliability_init(struct reliability *r) {
+	memset(r, 0, sizeof(*r));
+	for (int i = 0; i < SENSOR_COUNT; i++) {
+		update_sensor_costs(&r->sensors[i]);
+	}
+	for (int i = 1; i <= SWITCH_COUNT; i++) {
+		update_switch_costs(r, i);
+	}
+}
+
+// the counts saturate rather than wrapping, which leaves the rates a bit off
+// after a very long run, but that hardly matters
+static void increment(unsigned short *count) {
+	if (*count < 0xffff) (*count)++;
+}
+
+void reliability_sensor_hit(struct reliability *r, int sensor) {
+	increment(&r->sensors[sensor].hits);
+	update_sensor_costs(&r->sensors[sensor]);
+}
+
+void reliability_sensor_missed(struct reliability *r, int sensor) {
+	// we ignore whatever a blacklisted sensor does, so can't say it missed
+	if (reliability_sensor_blacklisted(r, sensor)) return;
+	increment(&r->sensors[sensor].misses);
+	r->failures++;
+	update_sensor_costs(&r->sensors[sensor]);
+}
+
+void reliability_sensor_phantom(struct reliability *r, int sensor) {
+	increment(&r->sensors[sensor].phantoms);
+	r->failures++;
+	update_sensor_costs(&r->sensors[sensor]);
+}
+
+void reliability_switches_traversed(struct reliability *r, unsigned switches) {
+	for (int i = 1; i <= SWITCH_COUNT; i++) {
+		if (switches & (1u << i)) {
+			increment(&r->switches[i].traversals);
+			update_switch_costs(r, i);
+		}
+	}
+}
+
+void reliability_switch_misrouted(struct reliability *r, int sw) {
+	const int packed_num = switch_packed_num(sw);
+	// the train went through it, as well as going the wrong way
+	increment(&r->switches[packed_num].traversals);
+	increment(&r->switches[packed_num].misroutes);
+	r->failures++;
+	update_switch_costs(r, packed_num);
+}
+
+static void report_add(struct reliability_report *report, int *badness, int new_badness,
+		enum reliability_failure failure, int num, int failures, int trials, bool excluded) {
+	if (failures == 0) return;
+	int i = report->len;
+	if (i == RELIABILITY_REPORT_LEN) {
+		if (badness[i - 1] >= new_badness) return;
+		i--;
+	} else {
+		report->len++;
+	}
+	// worst first
+	for (; i > 0 && badness[i - 1] < new_badness; i--) {
+		badness[i] = badness[i - 1];
+		report->entries[i] = report->entries[i - 1];
+	}
+	badness[i] = new_badness;
+	report->entries[i].failure = failure;
+	report->entries[i].num = num;
+	report->entries[i].failures = failures;
+	report->entries[i].trials = trials;
+	report->entries[i].excluded = excluded;
+}
+
+void reliability_report(const struct reliability *r, struct reliability_report *report) {
+	// how far below the prior each cost has fallen
+	const int missed_prior = failure_cost(0, 0, MISS_PRIOR_TRIALS);
+	const int spurious_prior = failure_cost(0, 0, PHANTOM_PRIOR_TRIALS);
+	const int wrong_prior = failure_cost(0, 0, MISROUTE_PRIOR_TRIALS);
+	int badness[RELIABILITY_REPORT_LEN];
+	report->len = 0;
+
+	for (int i = 0; i < SENSOR_COUNT; i++) {
+		const struct sensor_reliability *s = &r->sensors[i];
+		const bool blacklisted = reliability_sensor_blacklisted(r, i);
+		report_add(report, badness, missed_prior - s->missed_cost, FAILURE_MISSED, i,
+				s->misses, s->hits + s->misses, blacklisted);
+		// blacklisted sensors are as bad as it gets
+		const int spurious_cost = blacklisted ? 0 : s->spurious_cost;
+		report_add(report, badness, spurious_prior - spurious_cost, FAILURE_PHANTOM, i,
+				s->phantoms, s->hits + s->phantoms, blacklisted);
+	}
+	for (int i = 1; i <= SWITCH_COUNT; i++) {
+		const struct switch_reliability *s = &r->switches[i];
+		report_add(report, badness, wrong_prior - s->wrong_cost, FAILURE_MISROUTE,
+				switch_from_bit(1u << i), s->misroutes, s->traversals,
+				(r->unreliable_switches & (1u << i)) != 0);
+	}
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <util.h>
+#include "../sensorsrv.h"
+#include "../switch_state.h"
+#include "../trainsrv.h"
+
+// How often each sensor and switch has let us down, as worked out by sensor
+// attribution, and so how much each failure should cost when attributing
+// later sensor hits (as a negative log likelihood, in hundredths of a nat;
+// see sensor_attribution.c).
+//
+// Before we've seen anything, each sensor is assumed to have failed to
+// trigger once in its first MISS_PRIOR_TRIALS passes, and so on, which
+// gives the default costs. Counts are kept until the next boot.
+
+#define MISS_PRIOR_TRIALS 55 // a missed sensor costs ~400
+#define MISROUTE_PRIOR_TRIALS 90 // a wrong switch costs ~450
+#define PHANTOM_PRIOR_TRIALS 2981 // a spurious hit costs ~800
+
+// A sensor which triggers on its own this often, and more often than under
+// trains, has its hits ignored, and may as well not be there. We keep
+// counting what it would have been hit by, though, so once trains have been
+// over it enough to outnumber the phantoms, it's trusted again.
+#define BLACKLIST_MIN_PHANTOMS 5
+
+// A train we haven't found yet can explain any sensor hit that would otherwise
+// be spurious. Until a sensor has been tripped by a train we know, its
+// phantoms may well have been one of those, so they never make it cheaper
+// to write off than this, and never get it blacklisted.
+#define COST_UNKNOWN_TRAIN 750
+
+// Routing avoids switches which go the wrong way more than ~5% of the time.
+#define UNRELIABLE_SWITCH_COST 300
+
+struct sensor_reliability {
+	unsigned short hits; // attributed to a train
+	unsigned short misses; // a train went over it without it triggering
+	unsigned short phantoms; // triggered with no train on it
+	// what it would cost for it to miss, or trigger spuriously, next time
+	short missed_cost;
+	short spurious_cost;
+	bool blacklisted;
+};
+
+struct switch_reliability {
+	unsigned short traversals; // a train went through it as a branch
+	unsigned short misroutes; // and went the other way to how we'd set it
+	short wrong_cost;
+};
+
+struct reliability {
+	struct sensor_reliability sensors[SENSOR_COUNT];
+	// indexed by switch_packed_num
+	struct switch_reliability switches[SWITCH_COUNT + 1];
+	// the switches to route around, as bits of struct switch_state
+	unsigned unreliable_switches;
+	// bumped on every failure, so it's cheap to tell if anything has changed
+	unsigned failures;
+};
+
+void reliability_init(struct reliability *r);
+
+void reliability_sensor_hit(struct reliability *r, int sensor);
+void reliability_sensor_missed(struct reliability *r, int sensor);
+void reliability_sensor_phantom(struct reliability *r, int sensor);
+// switches is a mask of the switches' bits
+void reliability_switches_traversed(struct reliability *r, unsigned switches);
+void reliability_switch_misrouted(struct reliability *r, int sw);
+
+static inline bool reliability_sensor_blacklisted(const struct reliability *r, int sensor) {
+	return r->sensors[sensor].blacklisted;
+}
+
+static inline int reliability_wrong_switch_cost(const struct reliability *r, int sw) {
+	return r->switches[switch_packed_num(sw)].wrong_cost;
+}
+
+// the sensors and switches which have been down-weighted the most
+void reliability_report(const struct reliability *r, struct reliability_report *report);
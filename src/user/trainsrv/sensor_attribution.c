@@ -8,9 +8,40 @@
 #include "../trainsrv.h"
 #include "../polymath.h"
 
-// We are willing to assume that the sensors / turnouts fail at most once - where
-// we missed a sensor hit in the past, or where a turnout was switched in the wrong direction.
-// We don't consider cases with multiple failures.
+// Every way a sensor hit could have come about is scored by how unlikely it
+// is, as a cost: a negative log likelihood, in hundredths of a nat, so that
+// the costs of independent events add up.
+//
+// The costs of a sensor not triggering under a train, a switch not going the
+// way we set it, or a sensor triggering with no train on it, are kept per
+// sensor and switch by reliability.c, from how often each has failed.
+// To begin with, any two failures together cost more than writing the sensor
+// hit off as spurious, so we never assume more than one.
+//
+// The graph search for reversed trains doesn't know which kind of failure it
+// assumed, so charges the costlier default.
+#define COST_REVERSED_FAILURE 450
+// a train which should have stopped before getting there
+#define COST_STOPPED 500
+// How late (or early) a train is.
+// This is capped, since trains get held up, and we'd rather have a late train
+// than a spurious hit.
+#define COST_MAX_TIMING 300
+// alternatives which are this much less likely than the best are forgotten
+#define COST_MAX_ALTERNATIVE 1000
+#define COST_IMPOSSIBLE 0x7fffffff
+
+// The velocity tables are good to about 10%, and the sensors are polled
+// every few ticks.
+#define TIMING_STDDEV_MIN 5 // ticks
+#define TIMING_STDDEV_PERCENT 10
+
+// alternatives older than this are forgotten, since the train has been
+// moving along regardless
+#define MAX_ALTERNATIVE_AGE 3000 // ticks
+
+// The graph search for reversed trains still counts failures rather than
+// scoring them, and assumes at most one.
 const int errors_assumed_threshold = 2;
 
 
@@ -150,9 +181,8 @@ static int build_reversed_positions(const struct trainsrv_state *state,
 				int stopping_distance = ts->est_stopping_distances[velocity_index];
 				long long velocity_fp = ((long long) velocity) * fixed_point_scale / 1000LL;
 
-				struct curve_scaling scale = scale_deceleration_curve(velocity_fp,
-						stopping_distance * fixed_point_scale, deceleration_model_coefs,
-						acceleration_model_arity, stopping_time_coef);
+				struct curve_scaling scale = polynomial_scale_deceleration(velocity_fp,
+						stopping_distance * fixed_point_scale, &deceleration_model);
 
 				struct sensor_historical_kvp last_sensor = sensor_historical_get_kvp_current(&ts->sensor_history);
 				const struct track_node *last_sensor_node = track_node_from_sensor(last_sensor.st);
@@ -170,8 +200,8 @@ static int build_reversed_positions(const struct trainsrv_state *state,
 				}
 
 				if (integral_start < integral_end) {
-					long long integral = integrate_polynomial(integral_start, integral_end,
-							deceleration_model_coefs, deceleration_model_arity);
+					long long integral = polynomial_integrate(&deceleration_model,
+							integral_start, integral_end);
 					int partial_stopping_distance = scale.y_scale * integral / scale.x_scale / fixed_point_scale;
 					// NOTE: this assertion may fail spuriously sometimes - our integration isn't that accurate
 					// it's still useful for debugging, though - let's keep this here until we're ~confident
@@ -225,38 +255,34 @@ struct train_candidate {
 	int distance;
 	int switch_to_adjust;
 	bool reversed;
+	// which of the train's alternatives it came from, or -1 if its sensor history
+	int alternative;
+	int cost;
+	// the sensor it went over without triggering, or -1
+	int missed_sensor;
+	// the switches it went through as branches, if known
+	unsigned switches;
 };
 
-// evaluate which train is more likely to be responsible for a given sensor hit
-static bool guess_improved(const struct trainsrv_state *state, int now,
-		const struct train_candidate *old, const struct train_candidate *new) {
-	if (old->train == NULL) {
-		// no previous guess
-		return true;
-	} else if (old->errors_assumed > new->errors_assumed) {
-		// always prefer a guess which assumes fewer track malfunctions
-		return true;
-	}
-
-	int old_eta = train_eta_from_state(state, old->train, old->distance);
-	int new_eta = train_eta_from_state(state, new->train, new->distance);
+// the cost of the train taking now - from ticks to go distance mm
+static int timing_cost(const struct trainsrv_state *state, const struct internal_train_state *train,
+		int from, int distance, int now) {
+	const int eta = train_eta_from_time(state, train, from, distance);
+	if (eta < 0) return COST_STOPPED;
+	const int stddev = TIMING_STDDEV_MIN + eta * TIMING_STDDEV_PERCENT / 100;
+	const int error = abs((now - from) - eta);
+	if (error >= 3 * stddev) return COST_MAX_TIMING;
+	// -ln of a normal distribution, less the constant
+	return MIN(COST_MAX_TIMING, 50 * error * error / (stddev * stddev));
+}
 
-	// if some of the etas are unknown, prefer the known ones
-	if (new_eta < 0 || old_eta < 0) {
-		return old_eta < 0;
+static void consider_candidate(struct train_candidate *best, const struct train_candidate *new) {
+	if (new->cost < best->cost) {
+		DEBUG("Train %d could have hit the sensor, cost %d" EOL, new->train->train_id, new->cost);
+		*best = *new;
 	}
-
-	// otherwise, base guess on which matches the eta better
-	int old_eta_error = abs((now - sensor_historical_get_kvp_current(&old->train->sensor_history).time) - old_eta);
-	int new_eta_error = abs((now - sensor_historical_get_kvp_current(&new->train->sensor_history).time) - new_eta);
-
-	DEBUG("Compared candidates: incumbent %d has eta err = %d, candidate %d has eta err = %d" EOL,
-			old->train->train_id, old_eta_error, new->train->train_id, new_eta_error);
-
-	return new_eta_error < old_eta_error;
 }
 
-
 static bool check_candidate_position_validity(const struct trainsrv_state *state, const struct search_context *context,
 		struct train_candidate *candidate, int train_start_time) {
 	// check if the train going up this path would have required going the wrong way over a switch
@@ -268,9 +294,8 @@ static bool check_candidate_position_validity(const struct trainsrv_state *state
 		ASSERT(branch->type == NODE_BRANCH);
 
 		const int distance_from_train = candidate->distance - context->merges_hit[m].distance;
-		// TODO: this doesn't work correctly while the train is stopping, or under
-		// acceleration, because train_eta_from_state doesn't do that
-		const int estimated_time = train_start_time + train_eta_from_state(state, candidate->train, distance_from_train);
+		const int estimated_time = train_start_time + train_eta_from_time(state, candidate->train,
+				train_start_time, distance_from_train);
 		const struct switch_state switches = switch_historical_get(&state->switch_history, estimated_time);
 		const int direction = switch_get(&switches, branch->num);
 
@@ -299,15 +324,83 @@ static bool check_candidate_position_validity(const struct trainsrv_state *state
 	return errors_assumed < errors_assumed_threshold;
 }
 
-struct attribution attribute_sensor_to_known_train(const struct trainsrv_state *state,
-		const struct track_node *sensor, int now) {
+// Trains which are sitting at one of the sensors leading up to this one.
+// parse_track has already found every way there, so this only has to check
+// the switches along each.
+static void find_train_behind(const struct trainsrv_state *state, const struct track_node *sensor,
+		int now, const struct internal_train_state *train, const struct sensor_hypothesis *h,
+		int alternative, struct train_candidate *best) {
+	struct train_candidate candidate = { train, 0, 0, -1, false, alternative, h->cost, -1, 0 };
+	if (h->sensor < 0) {
+		// we haven't found this train yet, so it could be anywhere, if it's moving
+		if (train->speed_history.len == 0 || speed_historical_get_current(&train->speed_history) == 0) return;
+		candidate.cost += COST_UNKNOWN_TRAIN;
+		consider_candidate(best, &candidate);
+		return;
+	}
 
-	DEBUG("STARTING RUN" EOL);
+	const struct reliability *reliability = &state->reliability;
+	const unsigned switches_now = switch_historical_get_current(&state->switch_history).packed;
+	const unsigned switches_then = switch_historical_get(&state->switch_history, h->time).packed;
+	for (int p = 0; p < sensor->num_predecessors; p++) {
+		const struct sensor_predecessor *pred = &sensor->predecessors[p];
+		if (pred->sensor != h->sensor) continue;
+
+		// The switches might have been thrown while the train was on its way, so
+		// we only assume one was the wrong way if it was both when the train hit
+		// its last sensor, and now.
+		const unsigned wrong = pred->switches & (pred->curved ^ switches_then) & (pred->curved ^ switches_now);
+		if (wrong & (wrong - 1)) continue;
+
+		candidate.distance = pred->distance;
+		candidate.switches = pred->switches;
+		candidate.cost = h->cost;
+		candidate.missed_sensor = -1;
+		if (pred->missed_sensor != NO_MISSED_SENSOR) {
+			candidate.cost += reliability->sensors[pred->missed_sensor].missed_cost;
+			candidate.missed_sensor = pred->missed_sensor;
+		}
+		candidate.switch_to_adjust = -1;
+		if (wrong) {
+			DEBUG("Train %d would have needed to go the wrong way at switch bit %x" EOL, train->train_id, wrong);
+			candidate.switch_to_adjust = switch_from_bit(wrong);
+			candidate.cost += reliability_wrong_switch_cost(reliability, candidate.switch_to_adjust);
+		}
+		candidate.cost += timing_cost(state, train, h->time, pred->distance, now);
+		consider_candidate(best, &candidate);
+	}
+}
+
+static void find_trains_behind(const struct trainsrv_state *state, const struct track_node *sensor,
+		int now, struct train_candidate *best) {
+	for (int i = 0; i < state->num_active_trains; i++) {
+		const struct internal_train_state *train = &state->train_states[i];
+
+		// where we think it was, then everywhere else it might have been
+		struct sensor_hypothesis h = { -1, 0, 0 };
+		if (train->sensor_history.len > 0) {
+			const struct sensor_historical_kvp last = sensor_historical_get_kvp_current(&train->sensor_history);
+			h.sensor = last.st;
+			h.time = last.time;
+		}
+		find_train_behind(state, sensor, now, train, &h, -1, &best[i]);
+		for (int a = 0; a < train->num_alternatives; a++) {
+			if (now - train->alternatives[a].time > MAX_ALTERNATIVE_AGE) continue;
+			find_train_behind(state, sensor, now, train, &train->alternatives[a], a, &best[i]);
+		}
+	}
+}
 
-	/* (void) build_reversed_positions; */
+// Trains which reversed after hitting their last sensor, and so might be
+// anywhere behind where they stopped.
+// This still has to search the track, since where they stopped depends on
+// how fast they were going.
+static void find_reversed_trains_behind(const struct trainsrv_state *state, const struct track_node *sensor,
+		int now, struct train_candidate *best) {
 	struct reversed_train_position reversed_position[MAX_REVERSED_POSITIONS];
 	int reversed_position_count = build_reversed_positions(state, reversed_position);
 	DEBUG("reverse_position_count = %d" EOL, reversed_position_count);
+	if (reversed_position_count == 0) return;
 
 	// this is much bigger than it needs to be - we should only need enough entries
 	// so that we can merge in every possible way without hitting a sensor.
@@ -320,8 +413,6 @@ struct attribution attribute_sensor_to_known_train(const struct trainsrv_state *
 
 	queue[0] = (struct search_context){ &sensor->reverse->edge[DIR_STRAIGHT], 0, 0 };
 
-	struct train_candidate candidate = { NULL, 0, 0, -1, false };
-
 	// TODO: should write this to eliminate copying context back and forth repeatedly
 	while (queue_len > 0) {
 		struct search_context context = queue[--queue_len];
@@ -330,14 +421,6 @@ struct attribution attribute_sensor_to_known_train(const struct trainsrv_state *
 
 		const struct track_node *node = context.edge->dest;
 
-		// Check if a train is on this segment of the track.
-		// When we look for trains, we look for the last sensor the train tripped - we don't care
-		// about the currently estimated position.
-		// This has two advantages:
-		//  1) The estimation assumes that the turnouts are in the position that we set them in,
-		//     but we want to be tolerant of the fact that this may not be the case.
-		//  2) Reanchoring doesn't happen, so we don't need to worry about the case where the train
-		//     is estimated to be *past* the sensor it just hit.
 		DEBUG("Traversing through node %s" EOL, node->name);
 		for (int i = 0; i < reversed_position_count; i++) {
 			const struct internal_train_state *train_state = state->state_for_train[reversed_position[i].train_id - 1];
@@ -346,7 +429,7 @@ struct attribution attribute_sensor_to_known_train(const struct trainsrv_state *
 			// in the opposite direction that the direction of a train headed towards our sensor
 			if (reversed_position[i].position.edge->src == context.edge->src) {
 				struct train_candidate new_candidate = { train_state, reversed_position[i].errors_assumed,
-					reversed_position[i].position.displacement + context.distance, reversed_position[i].failed_switch, true };
+					reversed_position[i].position.displacement + context.distance, reversed_position[i].failed_switch, true, -1, 0, -1, 0 };
 				int start_time = -1;
 				DEBUG("Found reversed train %d at %s" EOL, train_state->train_id, context.edge->src->name);
 				for (int j = 2; j <= train_state->speed_history.len - 1; j++) {
@@ -357,49 +440,14 @@ struct attribution attribute_sensor_to_known_train(const struct trainsrv_state *
 				}
 				ASSERT(start_time != -1);
 				if (!check_candidate_position_validity(state, &context, &new_candidate, start_time)) continue;
-				if (guess_improved(state, now, &candidate, &new_candidate)) {
-					DEBUG("Choosing train as new candidate" EOL);
-					candidate = new_candidate;
-				}
+				new_candidate.cost = new_candidate.errors_assumed * COST_REVERSED_FAILURE +
+					timing_cost(state, train_state, start_time, new_candidate.distance, now);
+				consider_candidate(&best[train_state - state->train_states], &new_candidate);
 			}
 		}
 		if (node->type == NODE_SENSOR) {
-			for (int i = 0; i < state->num_active_trains; i++) {
-				// note that this also excludes the unknown position train, since last_sensor_hit = -1
-				const struct internal_train_state *train_state = &state->train_states[i];
-
-				if (train_state->sensor_history.len == 0) {
-					ASSERT(train_state->train_id == state->unknown_train_id);
-					continue;
-				}
-
-				int last_sensor_hit = sensor_historical_get_current(&train_state->sensor_history);
-				if (last_sensor_hit == node->reverse->num) {
-					// there is a train here
-					DEBUG("Found train %d at sensor %s" EOL, train_state->train_id, node->name);
-
-					const int last_sensor_hit_time = sensor_historical_get_kvp_current(&train_state->sensor_history).time;
-					struct train_candidate new_candidate = { train_state, 0, context.distance, -1, false };
-					if (!check_candidate_position_validity(state, &context, &new_candidate, last_sensor_hit_time)) continue;
-					DEBUG("Errors are within tolerance" EOL);
-
-					// we want to figure out if this is a better guess for which train hit
-					// the sensor than any guess we might have so far
-					if (guess_improved(state, now, &candidate, &new_candidate)) {
-						DEBUG("Choosing train as new candidate" EOL);
-						candidate = new_candidate;
-					}
-				}
-			}
-			// Even if we find a train, we continue exploring this route until we pass the error tolerance.
-			// I initially though that we shouldn't abandon the route after hitting a single train, since a train
-			// behind this one would have had to go through the first train to hit the sensor.
-			// This is actually not quite right.
-			// There are some places on the track where a train can pass another if timed right,
-			// where the track branches and joins with itself.
-			// TODO: no, I was right - we should stop here if we saw a train
-			// we'll catch the other case by traversing through the other path
-
+			// a train coming from further back would have had to pass this sensor
+			// without triggering it
 			if (++context.errors_assumed >= errors_assumed_threshold) continue;
 		} else if (node->type == NODE_MERGE) {
 			// We're at a merge - this means the train would have gone through it the
@@ -429,27 +477,158 @@ struct attribution attribute_sensor_to_known_train(const struct trainsrv_state *
 
 		ASSERT(0 <= queue_len && queue_len <= queue_size);
 	}
+}
 
-	return (struct attribution) {
-		candidate.train,
-		candidate.switch_to_adjust,
-		candidate.distance,
-		candidate.reversed,
-	};
+static void add_alternative(struct internal_train_state *train, const struct sensor_hypothesis *h) {
+	if (h->cost > COST_MAX_ALTERNATIVE) return;
+	int i = 0;
+	for (; i < train->num_alternatives; i++) {
+		if (train->alternatives[i].sensor == h->sensor && train->alternatives[i].time == h->time) {
+			// we already had this, maybe with a different cost
+			if (train->alternatives[i].cost <= h->cost) return;
+			break;
+		}
+	}
+	if (i == train->num_alternatives) {
+		if (train->num_alternatives == MAX_ALTERNATIVES) {
+			if (train->alternatives[MAX_ALTERNATIVES - 1].cost <= h->cost) return;
+			i = MAX_ALTERNATIVES - 1;
+		} else {
+			i = train->num_alternatives++;
+		}
+	}
+	// keep them sorted, most likely first
+	for (; i > 0 && train->alternatives[i - 1].cost > h->cost; i--) {
+		train->alternatives[i] = train->alternatives[i - 1];
+	}
+	train->alternatives[i] = *h;
 }
 
-// TODO: this should probably also return the distance the train was thought to have travelled,
-// so we can delurk next_sensor & next_sensor_mm & simplify the actual_speed calculation
-struct attribution attribute_sensor_to_train(struct trainsrv_state *state, int sensor, int now) {
+struct attribution attribute_sensor_to_train(const struct trainsrv_state *state, int sensor, int now) {
+	DEBUG("STARTING RUN" EOL);
 	const struct track_node *sensor_node = track_node_from_sensor(sensor);
-	struct attribution attr = attribute_sensor_to_known_train(state, sensor_node, now);
-	if (attr.train == NULL && state->unknown_train_id > 0) {
-		attr.train = get_train_state(state, state->unknown_train_id);
-		attr.changed_switch = -1;
-		attr.distance_travelled = 0;
-		attr.reversed = false;
-
-		state->unknown_train_id = 0;
+
+	// When we look for trains, we look for the last sensor the train tripped - we don't care
+	// about the currently estimated position.
+	// This has two advantages:
+	//  1) The estimation assumes that the turnouts are in the position that we set them in,
+	//     but we want to be tolerant of the fact that this may not be the case.
+	//  2) Reanchoring doesn't happen, so we don't need to worry about the case where the train
+	//     is estimated to be *past* the sensor it just hit.
+	struct train_candidate best[MAX_ACTIVE_TRAINS];
+	for (int i = 0; i < state->num_active_trains; i++) {
+		best[i] = (struct train_candidate) { &state->train_states[i], 0, 0, -1, false, -1, COST_IMPOSSIBLE, -1, 0 };
+	}
+	find_trains_behind(state, sensor_node, now, best);
+	find_reversed_trains_behind(state, sensor_node, now, best);
+
+	// Nothing might have hit it at all, so that's the baseline.
+	const int spurious_cost = state->reliability.sensors[sensor].spurious_cost;
+	struct attribution attr = { NULL, -1, 0, false, -1, spurious_cost, spurious_cost, -1, 0 };
+	const struct train_candidate *winner = NULL;
+	for (int i = 0; i < state->num_active_trains; i++) {
+		attr.train_costs[i] = best[i].cost;
+		if (best[i].cost < attr.cost) {
+			attr.runner_up_cost = attr.cost;
+			attr.cost = best[i].cost;
+			winner = &best[i];
+		} else if (best[i].cost < attr.runner_up_cost) {
+			attr.runner_up_cost = best[i].cost;
+		}
+	}
+	if (winner != NULL) {
+		attr.train = winner->train;
+		attr.changed_switch = winner->switch_to_adjust;
+		attr.distance_travelled = winner->distance;
+		attr.reversed = winner->reversed;
+		attr.alternative = winner->alternative;
+		attr.missed_sensor = winner->missed_sensor;
+		attr.switches = winner->switches;
+	}
+	// we still work out who it would have been, but don't act on it
+	if (reliability_sensor_blacklisted(&state->reliability, sensor)) {
+		attr.ignored_train = attr.train;
+		attr.train = NULL;
 	}
 	return attr;
 }
+
+void attribution_record(struct trainsrv_state *state, const struct attribution *attr, int sensor, int now) {
+	struct reliability *reliability = &state->reliability;
+	// Every other train which could have hit the sensor might have, so we keep
+	// that in mind, unless we're not listening to the sensor at all.
+	const bool listening = !reliability_sensor_blacklisted(reliability, sensor);
+	for (int i = 0; listening && i < state->num_active_trains; i++) {
+		struct internal_train_state *train = &state->train_states[i];
+		if (train == attr->train || attr->train_costs[i] == COST_IMPOSSIBLE) continue;
+		const struct sensor_hypothesis h = { sensor, now, attr->train_costs[i] - attr->cost };
+		add_alternative(train, &h);
+	}
+
+	if (attr->ignored_train != NULL) {
+		reliability_sensor_hit(reliability, sensor);
+		return;
+	} else if (attr->train == NULL) {
+		reliability_sensor_phantom(reliability, sensor);
+		return;
+	}
+	reliability_sensor_hit(reliability, sensor);
+	if (attr->missed_sensor >= 0) reliability_sensor_missed(reliability, attr->missed_sensor);
+	unsigned traversed = attr->switches;
+	if (attr->changed_switch >= 0) {
+		reliability_switch_misrouted(reliability, attr->changed_switch);
+		traversed &= ~SWITCH_BIT(attr->changed_switch);
+	}
+	reliability_switches_traversed(reliability, traversed);
+
+	struct internal_train_state *winner = get_train_state(state, attr->train->train_id);
+	// Had it not hit the sensor, it would be wherever else we thought it might
+	// have been, and the runner-up would have hit the sensor instead.
+	const int penalty = attr->runner_up_cost - attr->cost;
+	struct sensor_hypothesis alternatives[MAX_ALTERNATIVES + 1];
+	int num_alternatives = 0;
+	struct sensor_hypothesis last_hit = { -1, 0, 0 };
+	if (winner->sensor_history.len > 0) {
+		const struct sensor_historical_kvp last = sensor_historical_get_kvp_current(&winner->sensor_history);
+		last_hit.sensor = last.st;
+		last_hit.time = last.time;
+	}
+	struct sensor_hypothesis came_from = last_hit;
+	if (attr->alternative >= 0) {
+		came_from = winner->alternatives[attr->alternative];
+	}
+	// the last sensor hit is an alternative either way
+	alternatives[num_alternatives++] = last_hit;
+	for (int a = 0; a < winner->num_alternatives; a++) {
+		if (a != attr->alternative) alternatives[num_alternatives++] = winner->alternatives[a];
+	}
+	winner->num_alternatives = 0;
+	for (int a = 0; a < num_alternatives; a++) {
+		alternatives[a].cost += penalty;
+		add_alternative(winner, &alternatives[a]);
+	}
+	if (attr->alternative < 0) return;
+
+	// We had this train somewhere else, so we got an earlier sensor hit wrong.
+	// The train it went to wasn't there, and falls back to wherever else it
+	// might have been.
+	for (int i = 0; came_from.sensor >= 0 && i < state->num_active_trains; i++) {
+		struct internal_train_state *train = &state->train_states[i];
+		if (train == winner || train->sensor_history.len == 0) continue;
+		const struct sensor_historical_kvp last = sensor_historical_get_kvp_current(&train->sensor_history);
+		if (last.st != came_from.sensor || last.time != came_from.time) continue;
+
+		struct sensor_hypothesis fallback = { -1, 0, 0 };
+		if (train->num_alternatives > 0) {
+			fallback = train->alternatives[0];
+			train->num_alternatives--;
+			for (int a = 0; a < train->num_alternatives; a++) {
+				train->alternatives[a] = train->alternatives[a + 1];
+				train->alternatives[a].cost = MAX(0, train->alternatives[a].cost - fallback.cost);
+			}
+		}
+		logf("Train %d was not at %d after all", train->train_id, came_from.sensor);
+		train_adopt_hypothesis(train, &fallback);
+	}
+	train_adopt_hypothesis(winner, &came_from);
+}
@@ -4,16 +4,46 @@
 
 struct attribution {
 	const struct internal_train_state* train;
-	// these two are undefined if train is null
+	// these are undefined if train is null
 	int changed_switch;
 	int distance_travelled;
 	bool reversed;
+	// which of the train's alternatives it came from, or -1 if from its last
+	// sensor hit
+	int alternative;
+
+	// how unlikely the explanation is, and the next most likely one
+	int cost, runner_up_cost;
+
+	// the sensor the train went over without it triggering, or -1, and the
+	// switches it went through as branches, if we know
+	int missed_sensor;
+	unsigned switches;
+
+	// the most likely way each train (by index into train_states) could have
+	// hit the sensor
+	int train_costs[MAX_ACTIVE_TRAINS];
+
+	// If the sensor is blacklisted, train is NULL, and this is the train which
+	// would otherwise have hit it, if any. It still counts as a hit, so that
+	// the sensor can be trusted again.
+	const struct internal_train_state *ignored_train;
 };
-// Returns the train id of the train though to have hit the sensor, or
-// NULL if the sensor is thought to have misfired
+
+// Works out which train most likely hit the sensor, or NULL if the sensor is
+// thought to have misfired.
 //
-// If there are multiple trains on the track in unknown positions, we
-// aren't able to determine which train hit which sensor.
-// This shouldn't even be a legal state for the train server to be in,
-// so we ignore it here, and assert against it elsewhere.
-struct attribution attribute_sensor_to_train(struct trainsrv_state *state, int sensor, int now);
+// Each train could have come from its last sensor hit, or one of the
+// alternatives we've kept in case that was wrong. Trains we haven't found
+// yet could have come from anywhere, and if there are several of them, which
+// one it was is sorted out by which one then goes on to hit the next sensor
+// at the right time.
+struct attribution attribute_sensor_to_train(const struct trainsrv_state *state, int sensor, int now);
+
+// Keeps the other ways the sensor hit could have come about as alternatives.
+// If the train came from one of its alternatives, this also moves it, and
+// whichever train we had there, back to where they really were.
+// It also counts the hit and any failures it implies towards the sensors' and
+// switches' reliability.
+// This doesn't record the sensor hit itself.
+void attribution_record(struct trainsrv_state *state, const struct attribution *attr, int sensor, int now);
@@ -5,6 +5,8 @@
 #include "../buffer.h"
 #include "../displaysrv.h"
 
+#include <timer_wheel.h>
+
 // Other tasks can message this service, and request to be woken up
 // when a train is at a particular point
 //
@@ -13,31 +15,24 @@
 // If this is the last sensor that we would hit before arriving at a requested location,
 // we begin counting down until the ETA of the train to that point.
 //
-// We need to be robust against a couple of conditions:
+// The countdowns run on our own timer wheel, driven by a single ticker task,
+// so that we never have more than one task outstanding for all of them.
 //
-// Neither of these are implemented yet (the first is closer to being implemented)
+// We need to be robust against a couple of conditions:
 //
 // 1. The switches changing after we begin a "final approach". This will
-//    redirect the train away from its predicted destination. We need to
-//    cancel any wakeups that might have been started because we thought
-//    we were on a final approach.
-// 2. In similar fashion, we want to be resilient to changing the speed
-//    of the train while it is on a final approach.
+//    redirect the train away from its predicted destination. We cancel the
+//    wakeup, and check again where the train is going.
+// 2. In similar fashion, changing the speed of the train while it is on a
+//    final approach cancels the wakeup, and recalculates the ETA.
 
 struct alert_request {
 	struct position position;
 	int train_id;
 };
 
-struct wakeup_call_data {
-	struct alert_request_state *state;
-	unsigned nonce;
-	int ticks;
-	bool actually_delay;
-};
-
 struct alertsrv_request {
-	enum { ALERT, TRAIN_UPDATE, TRAIN_SPEED_UPDATE, SWITCH_UPDATE, WAKEUP } type;
+	enum { ALERT, TRAIN_UPDATE, TRAIN_SPEED_UPDATE, SWITCH_UPDATE, TICK } type;
 	union {
 		struct alert_request alert;
 		struct {
@@ -48,7 +43,9 @@ struct alertsrv_request {
 			int train_id;
 		} train_speed_update;
 		struct switch_state switch_update;
-		struct wakeup_call_data wakeup;
+		struct {
+			int ticks;
+		} tick;
 	} u;
 };
 
@@ -64,31 +61,112 @@ struct alert_request_state {
 	// We maintain a list of switches that could, if switched, direct the train
 	// away from its intended destination.
 	// When one of these switches is switched while the train is in its final approach,
-	// we increment the nonce.
-	// Whenever we prepare a wakeup call, we tell it the nonce the request currently has.
-	// When the wakeup call is made, if the nonce has changed since, we ignore the wakeup,
-	// since it means that the switches changed, and the wakeup call was based on
-	// data which has since changed.
+	// we cancel the wakeup.
 	struct switch_state disrupting_switches;
-	unsigned nonce;
+	// pending while we're on our final approach
+	struct timer_wheel_entry wakeup;
+
+	// The last sensor the train passes before reaching the requested position,
+	// given the current switch positions (or -1 if there isn't one).
+	// The train can only start its final approach from this sensor, so we only
+	// look at this request when the train hits it.
+	int trigger_sensor;
+
+	// all requests for this train (also used for the freelist)
+	struct alert_request_state *next_state, *prev_state;
+	// all requests in the same bucket of the trigger index
+	struct alert_request_state *next_indexed, *prev_indexed;
+};
+
+// Bounded by the number of tasks which can be waiting on us
+#define MAX_ACTIVE_REQUESTS 200
+
+// Index of pending requests, keyed by (train, trigger sensor).
+// Requests without a trigger sensor all go in the last bucket.
+#define ALERT_INDEX_BUCKETS 128
+#define ALERT_INDEX_NO_TRIGGER ALERT_INDEX_BUCKETS
 
-	struct alert_request_state *next_state;
+struct alert_index {
+	struct alert_request_state *buckets[ALERT_INDEX_BUCKETS + 1];
 };
 
-#define MAX_ACTIVE_REQUESTS 30
+static int alert_index_bucket(int train_id, int sensor) {
+	if (sensor < 0) return ALERT_INDEX_NO_TRIGGER;
+	return (train_id * SENSOR_COUNT + sensor) % ALERT_INDEX_BUCKETS;
+}
+
+static void alert_index_insert(struct alert_index *index, struct alert_request_state *state) {
+	struct alert_request_state **head = &index->buckets[
+		alert_index_bucket(state->request.train_id, state->trigger_sensor)];
+	state->prev_indexed = NULL;
+	state->next_indexed = *head;
+	if (*head) (*head)->prev_indexed = state;
+	*head = state;
+}
+
+static void alert_index_remove(struct alert_index *index, struct alert_request_state *state) {
+	if (state->prev_indexed) {
+		state->prev_indexed->next_indexed = state->next_indexed;
+	} else {
+		struct alert_request_state **head = &index->buckets[
+			alert_index_bucket(state->request.train_id, state->trigger_sensor)];
+		ASSERT(*head == state);
+		*head = state->next_indexed;
+	}
+	if (state->next_indexed) state->next_indexed->prev_indexed = state->prev_indexed;
+	state->next_indexed = state->prev_indexed = NULL;
+}
 
-static void request_wakeup_call(struct alert_request_state *state, int time, bool actually_delay) {
+static bool break_at_sensor(const struct track_edge *edge, void *context) {
+	return edge->src->type == NODE_SENSOR;
+}
+
+static int find_trigger_sensor(const struct position *target, const struct switch_state *switches) {
+	const struct track_node *src = target->edge->src;
+	if (src->type == NODE_SENSOR) return src->num;
+	// walk backwards from the target until we find a sensor
+	const struct track_node *node = track_go_forwards(src->reverse, switches, break_at_sensor, NULL);
+	if (node == NULL || node->type != NODE_SENSOR) return -1;
+	return node->reverse->num;
+}
+
+static void alert_index_update(struct alert_index *index, struct alert_request_state *state,
+		const struct switch_state *switches) {
+	alert_index_remove(index, state);
+	state->trigger_sensor = find_trigger_sensor(&state->request.position, switches);
+	alert_index_insert(index, state);
+}
+
+// State of the server which isn't specific to any one request
+struct alert_server {
+	struct alert_request_state *states_for_train[NUM_TRAIN];
+	struct alert_request_state *freelist;
+	struct alert_index index;
+	struct timer_wheel wheel;
+	struct switch_state switches;
+	bool actually_delay;
+};
+
+static void finish_request(struct alert_server *srv, struct alert_request_state *state, int ticks);
+
+static void request_wakeup_call(struct alert_server *srv, struct alert_request_state *state, int time) {
 
 	ASSERT(state->state == WAITING);
 	state->state = FINAL_APPROACH;
 
-	struct alertsrv_request req;
-	req.type = WAKEUP;
-	req.u.wakeup.state = state;
-	req.u.wakeup.nonce = state->nonce;
-	req.u.wakeup.actually_delay = actually_delay;
+	if (!srv->actually_delay) {
+		// for testing: report the delay we would have waited
+		finish_request(srv, state, time);
+		return;
+	}
+	timer_wheel_insert(&srv->wheel, &state->wakeup, srv->wheel.now + time);
+}
 
-	delay_async(time, &req, sizeof(req), offsetof(struct alertsrv_request, u.wakeup.ticks));
+// Called if something changes under a train on its final approach
+static void cancel_wakeup_call(struct alert_request_state *state) {
+	ASSERT(state->state == FINAL_APPROACH);
+	timer_wheel_cancel(&state->wakeup);
+	state->state = WAITING;
 }
 
 struct final_approach_ctx {
@@ -111,9 +189,9 @@ static bool break_for_final_approach(const struct track_edge *edge, void *contex
 	return edge->dest->type == NODE_SENSOR;
 }
 
-static void check_if_train_on_final_approach(struct alert_request_state *state,
-        const struct position *current_position, const struct switch_state *switches,
-        bool actually_delay) {
+static void check_if_train_on_final_approach(struct alert_server *srv, struct alert_request_state *state,
+        const struct position *current_position) {
+	const struct switch_state *switches = &srv->switches;
 	if (position_is_uninitialized(current_position)) return;
 	const struct position *target_position = &state->request.position;
 
@@ -147,93 +225,177 @@ static void check_if_train_on_final_approach(struct alert_request_state *state,
 	logf("Train %d (at %s) on final approach to %s, %d ticks / %dmm left",
 		 state->request.train_id, current_repr, target_repr, arrival_time, distance_left);
 
-	request_wakeup_call(state, arrival_time, actually_delay);
+	state->disrupting_switches = context.disrupting_switches;
+	request_wakeup_call(srv, state, arrival_time);
 }
 
-static void handle_train_update(int train_id, struct position *position,
-                                struct alert_request_state **states_for_train, const struct switch_state *switches,
-                                bool actually_delay) {
-	struct alert_request_state *state = states_for_train[train_id - 1];
-	while (state) {
-		check_if_train_on_final_approach(state, position, switches, actually_delay);
-		state = state->next_state;
+static void handle_train_update(struct alert_server *srv, int train_id, struct position *position) {
+	const struct track_node *src = position->edge->src;
+	if (src->type != NODE_SENSOR) {
+		// not a sensor hit, so we don't know which requests it could affect
+		struct alert_request_state *state = srv->states_for_train[train_id - 1];
+		while (state) {
+			struct alert_request_state *next = state->next_state;
+			if (state->state == WAITING) {
+				check_if_train_on_final_approach(srv, state, position);
+			}
+			state = next;
+		}
+		return;
 	}
-}
 
-static void handle_alert_request(struct alert_request_state *state,
-                                 const struct switch_state *switches, bool actually_delay) {
+	const int buckets[] = {
+		alert_index_bucket(train_id, src->num),
+		ALERT_INDEX_NO_TRIGGER,
+	};
+	for (int i = 0; i < ARRAY_LENGTH(buckets); i++) {
+		struct alert_request_state *state = srv->index.buckets[buckets[i]];
+		while (state) {
+			// checking may remove the state from the index, so advance first
+			struct alert_request_state *next = state->next_indexed;
+			if (state->request.train_id == train_id && state->state == WAITING
+					&& (state->trigger_sensor == src->num || state->trigger_sensor < 0)) {
+				check_if_train_on_final_approach(srv, state, position);
+			}
+			state = next;
+		}
+	}
+}
 
-	state->nonce = 0;
+static void handle_alert_request(struct alert_server *srv, struct alert_request_state *state) {
 	state->state = WAITING;
+	state->wakeup.next = state->wakeup.prev = NULL;
+	state->trigger_sensor = find_trigger_sensor(&state->request.position, &srv->switches);
+	alert_index_insert(&srv->index, state);
 
 	struct train_state train_state;
 	trains_query_spatials(state->request.train_id, &train_state);
-	check_if_train_on_final_approach(state, &train_state.position, switches, actually_delay);
+	check_if_train_on_final_approach(srv, state, &train_state.position);
 }
 
-static void handle_wakeup_call(struct wakeup_call_data *data,
-                               struct alert_request_state **states_for_train, struct alert_request_state **freelist) {
-
-	struct alert_request_state *state = data->state;
-
-	// ignore wakeup calls that are outdated
-	if (data->nonce != state->nonce) return;
+static void finish_request(struct alert_server *srv, struct alert_request_state *state, int ticks) {
 	ASSERT(state->state == FINAL_APPROACH);
-
 	state->state = UNUSED;
 
 	// signal the awaiting task to tell it to wake up
-	reply(state->tid, &data->ticks, sizeof(data->ticks));
+	reply(state->tid, &ticks, sizeof(ticks));
+
+	// remove the state from the lists, and add it to the freelist
+	alert_index_remove(&srv->index, state);
+	struct alert_request_state **states_for_train = srv->states_for_train;
+	if (state->prev_state) {
+		state->prev_state->next_state = state->next_state;
+	} else {
+		ASSERT(states_for_train[state->request.train_id - 1] == state);
+		states_for_train[state->request.train_id - 1] = state->next_state;
+	}
+	if (state->next_state) state->next_state->prev_state = state->prev_state;
+
+	state->prev_state = NULL;
+	state->next_state = srv->freelist;
+	srv->freelist = state;
+}
 
-	// remove the state from the list, and add it to the freelist
-	struct alert_request_state **prev_state = &states_for_train[state->request.train_id - 1];
-	while (*prev_state && *prev_state != state) prev_state = &(*prev_state)->next_state;
+static void handle_tick(struct alert_server *srv, int ticks) {
+	struct timer_wheel_entry expired;
+	timer_wheel_list_init(&expired);
+	timer_wheel_advance(&srv->wheel, ticks, &expired);
 
-	// we should have found a state to remove
-	ASSERT(*prev_state != NULL);
+	struct timer_wheel_entry *e;
+	while ((e = timer_wheel_list_pop(&expired))) {
+		struct alert_request_state *state = (struct alert_request_state*)
+			((char*) e - offsetof(struct alert_request_state, wakeup));
+		finish_request(srv, state, ticks);
+	}
+}
 
-	*prev_state = state->next_state;
-	state->next_state = *freelist;
-	*freelist = state;
+// Recheck requests for a train whose final approach may have been disrupted
+static void recheck_train(struct alert_server *srv, struct alert_request_state *state) {
+	struct train_state train_state;
+	trains_query_spatials(state->request.train_id, &train_state);
+	check_if_train_on_final_approach(srv, state, &train_state.position);
 }
 
-static void handle_train_speed_update(int train_id, struct alert_request_state **states_for_train) {
-	struct alert_request_state *state = states_for_train[train_id - 1];
+static void handle_train_speed_update(struct alert_server *srv, int train_id) {
+	struct alert_request_state *state = srv->states_for_train[train_id - 1];
 	while (state != NULL) {
+		struct alert_request_state *next = state->next_state;
 		if (state->state == FINAL_APPROACH) {
-			ASSERTF(0, "Updated speed for train %d while on a final approach", train_id);
+			logf("Speed of train %d changed on final approach, recalculating", train_id);
+			cancel_wakeup_call(state);
+			recheck_train(srv, state);
 		}
-		state = state->next_state;
+		state = next;
 	}
 }
 
-static void handle_switch_update(const struct switch_state switches, const struct switch_state old_switches, struct alert_request_state **states_for_train) {
+static void handle_switch_update(struct alert_server *srv, const struct switch_state switches) {
+	const struct switch_state old_switches = srv->switches;
+	srv->switches = switches;
 	for (int i = 0; i < NUM_TRAIN; i++) {
-		struct alert_request_state *state = states_for_train[i];
+		struct alert_request_state *state = srv->states_for_train[i];
 		while (state != NULL) {
+			struct alert_request_state *next = state->next_state;
 			// do a bit of poking at the internals since I don't want to write
 			// a fancy interface for something I don't know if I'll do again
 			// If this pattern emerges elsewhere, revisit
 			if (state->state == FINAL_APPROACH && ((switches.packed ^ old_switches.packed) & state->disrupting_switches.packed)) {
-				ASSERTF(0, "Switches were updated under us while train %d was on final approach", state->request.train_id);
+				logf("Switches changed under train %d on final approach", state->request.train_id);
+				cancel_wakeup_call(state);
+				alert_index_update(&srv->index, state, &switches);
+				recheck_train(srv, state);
+			} else if (state->state == WAITING) {
+				// the last sensor before the target may have moved
+				alert_index_update(&srv->index, state, &switches);
 			}
-			state = state->next_state;
+			state = next;
 		}
 	}
 }
 
+struct alert_tick_params {
+	int start;
+};
+
+// Sends us a message once per tick to drive the timer wheel
+static void alert_ticker(void) {
+	int tid;
+	struct alert_tick_params params;
+	receive(&tid, &params, sizeof(params));
+	reply(tid, NULL, 0);
+
+	struct alertsrv_request req;
+	req.type = TICK;
+	int ticks = params.start;
+	for (;;) {
+		ticks = delay_until(ticks + 1);
+		req.u.tick.ticks = ticks;
+		send(tid, &req, sizeof(req), NULL, 0);
+	}
+}
+
 static void train_server_run(struct switch_state switches, bool actually_delay) {
 	struct alert_request_state states[MAX_ACTIVE_REQUESTS];
-	struct alert_request_state *states_for_train[NUM_TRAIN];
-	struct alert_request_state *freelist;
+	struct alert_server srv;
 
 	memset(&states, 0, sizeof(states));
-	memset(&states_for_train, 0, sizeof(states_for_train));
-	freelist = &states[0];
+	memset(&srv, 0, sizeof(srv));
+	srv.switches = switches;
+	srv.actually_delay = actually_delay;
+	srv.freelist = &states[0];
 	for (int i = 1; i < MAX_ACTIVE_REQUESTS; i++) {
 		states[i - 1].next_state = &states[i];
 	}
 
+	if (actually_delay) {
+		struct alert_tick_params params = { time() };
+		timer_wheel_init(&srv.wheel, params.start);
+		int ticker = create(PRIORITY_TRAIN_ALERT_SRV, alert_ticker);
+		send(ticker, &params, sizeof(params), NULL, 0);
+	} else {
+		timer_wheel_init(&srv.wheel, 0);
+	}
+
 	for (;;) {
 		int tid;
 		struct alertsrv_request req;
@@ -241,37 +403,37 @@ static void train_server_run(struct switch_state switches, bool actually_delay)
 
 		switch (req.type) {
 		case ALERT: {
-			ASSERTF(freelist != NULL, "Alert srv couldn't handle more requests");
+			ASSERTF(srv.freelist != NULL, "Alert srv couldn't handle more requests");
 
-			struct alert_request_state *state = freelist;
+			struct alert_request_state *state = srv.freelist;
 			state->tid = tid;
 			state->request = req.u.alert;
 
-			freelist = freelist->next_state;
+			srv.freelist = srv.freelist->next_state;
 			int offset = req.u.alert.train_id - 1;
-			state->next_state = states_for_train[offset];
-			states_for_train[offset] = state;
+			state->prev_state = NULL;
+			state->next_state = srv.states_for_train[offset];
+			if (state->next_state) state->next_state->prev_state = state;
+			srv.states_for_train[offset] = state;
 
-			handle_alert_request(state, &switches, actually_delay);
+			handle_alert_request(&srv, state);
 			break;
 		}
 		case TRAIN_UPDATE:
 			reply(tid, NULL, 0);
-			handle_train_update(req.u.train_update.train_id, &req.u.train_update.position,
-			                    states_for_train, &switches, actually_delay);
+			handle_train_update(&srv, req.u.train_update.train_id, &req.u.train_update.position);
 			break;
 		case TRAIN_SPEED_UPDATE:
 			reply(tid, NULL, 0);
-			handle_train_speed_update(req.u.train_speed_update.train_id, states_for_train);
+			handle_train_speed_update(&srv, req.u.train_speed_update.train_id);
 			break;
 		case SWITCH_UPDATE:
 			reply(tid, NULL, 0);
-			handle_switch_update(req.u.switch_update, switches, states_for_train);
-			switches = req.u.switch_update;
+			handle_switch_update(&srv, req.u.switch_update);
 			break;
-		case WAKEUP:
+		case TICK:
 			reply(tid, NULL, 0);
-			handle_wakeup_call(&req.u.wakeup, states_for_train, &freelist);
+			handle_tick(&srv, req.u.tick.ticks);
 			break;
 		default:
 			ASSERTF(0, "Unknown train alert srv request type %d", req.type);
@@ -298,11 +460,17 @@ static void train_alert_server(void) {
 }
 
 
+static void handle_switch_published(const void *msg, unsigned len);
+static void handle_train_position_published(const void *msg, unsigned len);
+
 void train_alert_start(struct switch_state switches, bool actually_delay) {
 	// one higher than train server
 	int tid = create(PRIORITY_TRAIN_ALERT_SRV, train_alert_server);
 	struct train_alert_params params = { switches, actually_delay };
 	send(tid, &params, sizeof(params), NULL, 0);
+
+	pubsub_subscribe(TOPIC_SWITCHES, PRIORITY_TRAIN_ALERT_SRV, handle_switch_published, false, NULL);
+	pubsub_subscribe(TOPIC_TRAIN_POSITIONS, PRIORITY_TRAIN_ALERT_SRV, handle_train_position_published, false, NULL);
 }
 
 static int train_alert_tid(void) {
@@ -344,3 +512,23 @@ int train_alert_at(int train_id, struct position position) {
 	send(train_alert_tid(), &req, sizeof(req), &resp, sizeof(resp));
 	return resp;
 }
+
+// these run on the subscription couriers, so they can just send directly
+
+static void handle_switch_published(const void *msg, unsigned len) {
+	ASSERT(len == sizeof(struct switch_state));
+	struct alertsrv_request req;
+	req.type = SWITCH_UPDATE;
+	memcpy(&req.u.switch_update, msg, sizeof(req.u.switch_update));
+	send(train_alert_tid(), &req, sizeof(req), NULL, 0);
+}
+
+static void handle_train_position_published(const void *msg, unsigned len) {
+	ASSERT(len == sizeof(struct train_position_update));
+	const struct train_position_update *update = msg;
+	struct alertsrv_request req;
+	req.type = TRAIN_UPDATE;
+	req.u.train_update.train_id = update->train_id;
+	req.u.train_update.position = update->position;
+	send(train_alert_tid(), &req, sizeof(req), NULL, 0);
+}
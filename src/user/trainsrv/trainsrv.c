@@ -7,6 +7,7 @@
 #include "track_control.h"
 #include "delayed_commands.h"
 #include "estimate_position.h"
+#include "calibration.h"
 #include "train_alert_srv.h"
 #include "trainsrv_request.h"
 #include "speed_history.h"
@@ -60,6 +61,7 @@ static struct train_state handle_query_spatials(struct trainsrv_state *state, in
 		out.position = get_estimated_train_position(state, train_state);
 		out.velocity = train_velocity_from_state(train_state);
 		out.speed_setting = speed_historical_get_current(&train_state->speed_history);
+		out.position_stddev = train_position_stddev(train_state, time());
 	}
 	return out;
 }
@@ -72,6 +74,15 @@ static int handle_query_error(struct trainsrv_state *state, int train) {
 	return train_state->measurement_error;
 }
 
+static int handle_query_velocity(struct trainsrv_state *state, int train, int speed) {
+	struct internal_train_state *train_state = get_train_state(state, train);
+	if (train_state == NULL || speed <= 0) {
+		return 0;
+	}
+	// accelerating from below into this speed
+	return train_state->est_velocities[speed * 2 - 1];
+}
+
 static int handle_query_active(struct trainsrv_state *state, int * const trains) {
 	int *p = trains;
 	for (int i = 0; i < NUM_TRAIN; i++) {
@@ -144,6 +155,19 @@ static void trains_server(void) {
 			reply(tid, &error, sizeof(error));
 			break;
 		}
+		case QUERY_VELOCITY: {
+			int velocity = handle_query_velocity(&state, req.train_number, req.speed);
+			reply(tid, &velocity, sizeof(velocity));
+			break;
+		}
+		case PLAN_MOTION: {
+			struct motion_plan plan;
+			memset(&plan, 0, sizeof(plan));
+			struct internal_train_state *ts = get_train_state(&state, req.train_number);
+			if (ts != NULL) train_plan_motion(ts, req.distance, req.speed, &plan);
+			reply(tid, &plan, sizeof(plan));
+			break;
+		}
 		case SEND_SENSORS:
 			handle_sensors(&state, req.sensors);
 			reply(tid, NULL, 0);
@@ -169,6 +193,9 @@ static void trains_server(void) {
 			reply(tid, &switches, sizeof(switches));
 			break;
 		}
+		case SWITCH_GET_UNRELIABLE:
+			reply(tid, &state.reliability.unreliable_switches, sizeof(state.reliability.unreliable_switches));
+			break;
 		case GET_STOPPING_DISTANCE: {
 			struct internal_train_state *ts = get_train_state(&state, req.train_number);
 			int distance = ts->est_stopping_distances[train_speed_index(ts, 1)];
@@ -181,9 +208,18 @@ static void trains_server(void) {
 			reply(tid, NULL, 0);
 			break;
 		}
+		case DUMP_CALIBRATION: {
+			struct internal_train_state *ts = get_train_state(&state, req.train_number);
+			if (ts != NULL) calibration_dump(ts);
+			reply(tid, NULL, 0);
+			break;
+		}
 		case GET_LAST_KNOWN_SENSOR: {
 			struct internal_train_state *ts = get_train_state(&state, req.train_number);
-			int last_sensor_hit = sensor_historical_get_current(&ts->sensor_history);
+			int last_sensor_hit = -1;
+			if (ts != NULL && ts->sensor_history.len > 0) {
+				last_sensor_hit = sensor_historical_get_current(&ts->sensor_history);
+			}
 			reply(tid, &last_sensor_hit, sizeof(last_sensor_hit));
 			break;
 		}
@@ -195,8 +231,15 @@ static void trains_server(void) {
 	}
 }
 
+static void handle_sensors_published(const void *msg, unsigned len) {
+	ASSERT(len == sizeof(struct sensor_dump));
+	const struct sensor_dump *dump = msg;
+	trains_send_sensors(dump->sensors);
+}
+
 void trains_start(void) {
 	create(PRIORITY_TRAINSRV, trains_server);
+	pubsub_subscribe(TOPIC_SENSORS, PRIORITY_TRAINSRV, handle_sensors_published, false, sensor_dump_merge);
 }
 
 static int trains_tid(void) {
@@ -234,6 +277,25 @@ int trains_query_error(int train) {
 	return error;
 }
 
+int trains_query_velocity(int train, int speed) {
+	int velocity;
+	TSEND2(((struct trains_request) {
+		.type = QUERY_VELOCITY,
+		 .train_number = train,
+		  .speed = speed,
+	}), &velocity);
+	return velocity;
+}
+
+void trains_plan_motion(int train, int distance, int max_speed, struct motion_plan *plan) {
+	TSEND2(((struct trains_request) {
+		.type = PLAN_MOTION,
+		 .train_number = train,
+		  .distance = distance,
+		   .speed = max_speed,
+	}), plan);
+}
+
 int trains_query_arrival_time(int train, int distance) {
 	int rpy = -1;
 	TSEND2(((struct trains_request) {
@@ -294,6 +356,14 @@ struct switch_state trains_get_switches(void) {
 	return switches;
 }
 
+unsigned trains_get_unreliable_switches(void) {
+	unsigned switches;
+	TSEND2(((struct trains_request) {
+		.type = SWITCH_GET_UNRELIABLE,
+	}), &switches);
+	return switches;
+}
+
 void trains_set_stopping_distance(int train_id, int stopping_distance) {
 	TSEND(((struct trains_request) {
 		.type = SET_STOPPING_DISTANCE,
@@ -319,3 +389,10 @@ int trains_get_last_known_sensor(int train_id) {
 	}), &sensor);
 	return sensor;
 }
+
+void trains_dump_calibration(int train_id) {
+	TSEND(((struct trains_request) {
+		.type = DUMP_CALIBRATION,
+		 .train_number = train_id,
+	}));
+}
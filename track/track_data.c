@@ -8,6 +8,307 @@ static void *memset(void *s, int c, unsigned int n) {
   return s;
 }
 
+static const struct sensor_predecessor tracka_predecessors[] = {
+  // A1
+  // A2
+  { 45, NO_MISSED_SENSOR, 462, SWITCH_BIT(12) | SWITCH_BIT(11), 0 },
+  { 71, 45, 1337, SWITCH_BIT(12) | SWITCH_BIT(11), 0 },
+  // A3
+  { 30, NO_MISSED_SENSOR, 437, 0, 0 },
+  { 37, 30, 920, 0, 0 },
+  { 40, 30, 813, 0, 0 },
+  // A4
+  { 45, NO_MISSED_SENSOR, 581, SWITCH_BIT(11), SWITCH_BIT(11) },
+  { 71, 45, 1456, SWITCH_BIT(11), SWITCH_BIT(11) },
+  { 43, NO_MISSED_SENSOR, 376, 0, 0 },
+  { 21, 43, 727, 0, 0 },
+  { 78, 43, 742, 0, 0 },
+  // A5
+  { 24, NO_MISSED_SENSOR, 642, 0, 0 },
+  // A6
+  { 39, NO_MISSED_SENSOR, 359, SWITCH_BIT(3), 0 },
+  { 35, 39, 984, SWITCH_BIT(3) | SWITCH_BIT(18), 0 },
+  { 75, 39, 1166, SWITCH_BIT(3) | SWITCH_BIT(18) | SWITCH_BIT(7), SWITCH_BIT(7) },
+  // A7
+  { 39, NO_MISSED_SENSOR, 542, SWITCH_BIT(2) | SWITCH_BIT(3), SWITCH_BIT(2) | SWITCH_BIT(3) },
+  { 35, 39, 1167, SWITCH_BIT(2) | SWITCH_BIT(3) | SWITCH_BIT(18), SWITCH_BIT(2) | SWITCH_BIT(3) },
+  { 75, 39, 1349, SWITCH_BIT(2) | SWITCH_BIT(3) | SWITCH_BIT(18) | SWITCH_BIT(7), SWITCH_BIT(2) | SWITCH_BIT(3) | SWITCH_BIT(7) },
+  // A8
+  { 26, NO_MISSED_SENSOR, 470, 0, 0 },
+  // A9
+  { 39, NO_MISSED_SENSOR, 730, SWITCH_BIT(1) | SWITCH_BIT(2) | SWITCH_BIT(3), SWITCH_BIT(1) | SWITCH_BIT(3) },
+  { 35, 39, 1355, SWITCH_BIT(1) | SWITCH_BIT(2) | SWITCH_BIT(3) | SWITCH_BIT(18), SWITCH_BIT(1) | SWITCH_BIT(3) },
+  { 75, 39, 1537, SWITCH_BIT(1) | SWITCH_BIT(2) | SWITCH_BIT(3) | SWITCH_BIT(18) | SWITCH_BIT(7), SWITCH_BIT(1) | SWITCH_BIT(3) | SWITCH_BIT(7) },
+  // A10
+  { 22, NO_MISSED_SENSOR, 289, 0, 0 },
+  // A11
+  // A12
+  { 39, NO_MISSED_SENSOR, 1019, SWITCH_BIT(1) | SWITCH_BIT(2) | SWITCH_BIT(3), SWITCH_BIT(3) },
+  { 35, 39, 1644, SWITCH_BIT(1) | SWITCH_BIT(2) | SWITCH_BIT(3) | SWITCH_BIT(18), SWITCH_BIT(3) },
+  { 75, 39, 1826, SWITCH_BIT(1) | SWITCH_BIT(2) | SWITCH_BIT(3) | SWITCH_BIT(18) | SWITCH_BIT(7), SWITCH_BIT(3) | SWITCH_BIT(7) },
+  // A13
+  // A14
+  { 45, NO_MISSED_SENSOR, 652, SWITCH_BIT(4) | SWITCH_BIT(12) | SWITCH_BIT(11), SWITCH_BIT(4) | SWITCH_BIT(12) },
+  { 71, 45, 1527, SWITCH_BIT(4) | SWITCH_BIT(12) | SWITCH_BIT(11), SWITCH_BIT(4) | SWITCH_BIT(12) },
+  // A15
+  { 45, NO_MISSED_SENSOR, 833, SWITCH_BIT(4) | SWITCH_BIT(12) | SWITCH_BIT(11), SWITCH_BIT(12) },
+  { 71, 45, 1708, SWITCH_BIT(4) | SWITCH_BIT(12) | SWITCH_BIT(11), SWITCH_BIT(12) },
+  // A16
+  // B1
+  { 41, NO_MISSED_SENSOR, 359, SWITCH_BIT(16), 0 },
+  { 31, 41, 735, SWITCH_BIT(16) | SWITCH_BIT(15), SWITCH_BIT(15) },
+  // B2
+  { 60, NO_MISSED_SENSOR, 404, 0, 0 },
+  { 76, 60, 686, SWITCH_BIT(17), 0 },
+  // B3
+  { 41, NO_MISSED_SENSOR, 367, SWITCH_BIT(16), SWITCH_BIT(16) },
+  { 31, 41, 743, SWITCH_BIT(16) | SWITCH_BIT(15), SWITCH_BIT(16) | SWITCH_BIT(15) },
+  // B4
+  { 32, NO_MISSED_SENSOR, 201, 0, 0 },
+  { 48, 32, 693, SWITCH_BIT(153) | SWITCH_BIT(154), SWITCH_BIT(153) },
+  { 64, 32, 686, SWITCH_BIT(153) | SWITCH_BIT(154), SWITCH_BIT(153) },
+  // B5
+  { 42, NO_MISSED_SENSOR, 351, SWITCH_BIT(13), 0 },
+  { 2, 42, 727, SWITCH_BIT(13) | SWITCH_BIT(14), SWITCH_BIT(14) },
+  // B6
+  { 51, NO_MISSED_SENSOR, 404, 0, 0 },
+  { 69, 51, 693, SWITCH_BIT(10), 0 },
+  // B7
+  // B8
+  { 8, NO_MISSED_SENSOR, 289, 0, 0 },
+  { 39, 8, 1019, SWITCH_BIT(1) | SWITCH_BIT(2) | SWITCH_BIT(3), SWITCH_BIT(1) | SWITCH_BIT(3) },
+  // B9
+  // B10
+  { 5, NO_MISSED_SENSOR, 642, 0, 0 },
+  { 39, 5, 1001, SWITCH_BIT(3), 0 },
+  // B11
+  // B12
+  { 6, NO_MISSED_SENSOR, 470, 0, 0 },
+  { 39, 6, 1012, SWITCH_BIT(2) | SWITCH_BIT(3), SWITCH_BIT(2) | SWITCH_BIT(3) },
+  // B13
+  { 62, NO_MISSED_SENSOR, 201, 0, 0 },
+  { 76, 62, 490, SWITCH_BIT(17), SWITCH_BIT(17) },
+  // B14
+  { 48, NO_MISSED_SENSOR, 485, SWITCH_BIT(154), SWITCH_BIT(154) },
+  { 66, 48, 686, SWITCH_BIT(154), SWITCH_BIT(154) },
+  { 64, NO_MISSED_SENSOR, 478, SWITCH_BIT(154), SWITCH_BIT(154) },
+  { 79, 64, 679, SWITCH_BIT(154), SWITCH_BIT(154) },
+  // B15
+  { 37, NO_MISSED_SENSOR, 483, 0, 0 },
+  { 47, 37, 783, 0, 0 },
+  { 35, 37, 1309, SWITCH_BIT(18), SWITCH_BIT(18) },
+  { 75, 37, 1491, SWITCH_BIT(18) | SWITCH_BIT(7), SWITCH_BIT(18) | SWITCH_BIT(7) },
+  { 40, NO_MISSED_SENSOR, 376, 0, 0 },
+  { 17, 40, 735, 0, 0 },
+  { 19, 40, 743, 0, 0 },
+  // B16
+  { 3, NO_MISSED_SENSOR, 437, 0, 0 },
+  { 45, 3, 1018, SWITCH_BIT(11), SWITCH_BIT(11) },
+  { 43, 3, 813, 0, 0 },
+  // C1
+  { 48, NO_MISSED_SENSOR, 492, SWITCH_BIT(153) | SWITCH_BIT(154), SWITCH_BIT(153) },
+  { 66, 48, 693, SWITCH_BIT(153) | SWITCH_BIT(154), SWITCH_BIT(153) },
+  { 64, NO_MISSED_SENSOR, 485, SWITCH_BIT(153) | SWITCH_BIT(154), SWITCH_BIT(153) },
+  { 79, 64, 686, SWITCH_BIT(153) | SWITCH_BIT(154), SWITCH_BIT(153) },
+  // C2
+  { 18, NO_MISSED_SENSOR, 201, 0, 0 },
+  { 41, 18, 568, SWITCH_BIT(16), SWITCH_BIT(16) },
+  // C3
+  { 38, NO_MISSED_SENSOR, 625, SWITCH_BIT(5), 0 },
+  { 4, 38, 984, SWITCH_BIT(5), 0 },
+  { 10, 38, 1644, SWITCH_BIT(5), 0 },
+  { 9, 38, 1355, SWITCH_BIT(5), 0 },
+  { 7, 38, 1167, SWITCH_BIT(5), 0 },
+  { 36, NO_MISSED_SENSOR, 826, SWITCH_BIT(5) | SWITCH_BIT(6), SWITCH_BIT(6) },
+  { 31, 36, 1309, SWITCH_BIT(5) | SWITCH_BIT(6) | SWITCH_BIT(15), SWITCH_BIT(6) },
+  // C4
+  // C5
+  { 31, NO_MISSED_SENSOR, 483, SWITCH_BIT(15), 0 },
+  { 3, 31, 920, SWITCH_BIT(15), 0 },
+  // C6
+  { 47, NO_MISSED_SENSOR, 300, 0, 0 },
+  { 58, 47, 704, 0, 0 },
+  { 35, NO_MISSED_SENSOR, 826, SWITCH_BIT(18), SWITCH_BIT(18) },
+  { 75, NO_MISSED_SENSOR, 1008, SWITCH_BIT(18) | SWITCH_BIT(7), SWITCH_BIT(18) | SWITCH_BIT(7) },
+  { 56, 75, 1377, SWITCH_BIT(18) | SWITCH_BIT(7), SWITCH_BIT(18) | SWITCH_BIT(7) },
+  // C7
+  { 4, NO_MISSED_SENSOR, 359, 0, 0 },
+  { 24, 4, 1001, 0, 0 },
+  { 10, NO_MISSED_SENSOR, 1019, 0, 0 },
+  { 9, NO_MISSED_SENSOR, 730, 0, 0 },
+  { 22, 9, 1019, 0, 0 },
+  { 7, NO_MISSED_SENSOR, 542, 0, 0 },
+  { 26, 7, 1012, 0, 0 },
+  // C8
+  { 35, NO_MISSED_SENSOR, 625, SWITCH_BIT(18), 0 },
+  { 75, NO_MISSED_SENSOR, 807, SWITCH_BIT(18) | SWITCH_BIT(7), SWITCH_BIT(7) },
+  { 56, 75, 1176, SWITCH_BIT(18) | SWITCH_BIT(7), SWITCH_BIT(7) },
+  // C9
+  { 17, NO_MISSED_SENSOR, 359, 0, 0 },
+  { 60, 17, 763, 0, 0 },
+  { 19, NO_MISSED_SENSOR, 367, 0, 0 },
+  { 32, 19, 568, 0, 0 },
+  // C10
+  { 31, NO_MISSED_SENSOR, 376, SWITCH_BIT(15), SWITCH_BIT(15) },
+  { 3, 31, 813, SWITCH_BIT(15), SWITCH_BIT(15) },
+  // C11
+  { 2, NO_MISSED_SENSOR, 376, SWITCH_BIT(14), SWITCH_BIT(14) },
+  { 30, 2, 813, SWITCH_BIT(14), SWITCH_BIT(14) },
+  // C12
+  { 21, NO_MISSED_SENSOR, 351, 0, 0 },
+  { 51, 21, 755, 0, 0 },
+  { 78, NO_MISSED_SENSOR, 366, 0, 0 },
+  { 65, 78, 567, 0, 0 },
+  // C13
+  { 0, NO_MISSED_SENSOR, 462, 0, 0 },
+  { 15, NO_MISSED_SENSOR, 833, 0, 0 },
+  { 12, NO_MISSED_SENSOR, 652, 0, 0 },
+  { 2, NO_MISSED_SENSOR, 581, SWITCH_BIT(14), 0 },
+  { 30, 2, 1018, SWITCH_BIT(14), 0 },
+  // C14
+  { 71, NO_MISSED_SENSOR, 875, 0, 0 },
+  { 55, 71, 1259, 0, 0 },
+  // C15
+  { 36, NO_MISSED_SENSOR, 300, SWITCH_BIT(6), 0 },
+  { 31, 36, 783, SWITCH_BIT(6) | SWITCH_BIT(15), 0 },
+  // C16
+  { 58, NO_MISSED_SENSOR, 404, 0, 0 },
+  { 75, 58, 685, SWITCH_BIT(7), 0 },
+  // D1
+  { 66, NO_MISSED_SENSOR, 201, 0, 0 },
+  { 69, 66, 490, SWITCH_BIT(10), SWITCH_BIT(10) },
+  // D2
+  { 33, NO_MISSED_SENSOR, 492, SWITCH_BIT(155) | SWITCH_BIT(156), SWITCH_BIT(155) },
+  { 18, 33, 693, SWITCH_BIT(155) | SWITCH_BIT(156), SWITCH_BIT(155) },
+  { 28, NO_MISSED_SENSOR, 485, SWITCH_BIT(155) | SWITCH_BIT(156), SWITCH_BIT(155) },
+  { 62, 28, 686, SWITCH_BIT(155) | SWITCH_BIT(156), SWITCH_BIT(155) },
+  // D3
+  { 20, NO_MISSED_SENSOR, 404, 0, 0 },
+  { 42, 20, 755, SWITCH_BIT(13), 0 },
+  // D4
+  { 69, NO_MISSED_SENSOR, 289, SWITCH_BIT(10), 0 },
+  { 52, 69, 665, SWITCH_BIT(10), 0 },
+  // D5
+  { 57, NO_MISSED_SENSOR, 710, SWITCH_BIT(9), SWITCH_BIT(9) },
+  { 74, 57, 1079, SWITCH_BIT(9), SWITCH_BIT(9) },
+  { 72, NO_MISSED_SENSOR, 633, SWITCH_BIT(9), SWITCH_BIT(9) },
+  { 77, 72, 1009, SWITCH_BIT(9), SWITCH_BIT(9) },
+  // D6
+  { 68, NO_MISSED_SENSOR, 376, 0, 0 },
+  { 50, 68, 665, 0, 0 },
+  { 67, 68, 665, 0, 0 },
+  // D7
+  { 70, NO_MISSED_SENSOR, 384, 0, 0 },
+  { 44, 70, 1259, 0, 0 },
+  // D8
+  { 57, NO_MISSED_SENSOR, 780, SWITCH_BIT(9), 0 },
+  { 74, 57, 1149, SWITCH_BIT(9), 0 },
+  { 72, NO_MISSED_SENSOR, 703, SWITCH_BIT(9), 0 },
+  { 77, 72, 1079, SWITCH_BIT(9), 0 },
+  // D9
+  { 54, NO_MISSED_SENSOR, 780, SWITCH_BIT(8), 0 },
+  { 70, 54, 1164, SWITCH_BIT(8), 0 },
+  { 53, NO_MISSED_SENSOR, 710, SWITCH_BIT(8), 0 },
+  { 68, 53, 1086, SWITCH_BIT(8), 0 },
+  // D10
+  { 74, NO_MISSED_SENSOR, 369, 0, 0 },
+  { 59, 74, 650, 0, 0 },
+  { 38, 74, 1176, SWITCH_BIT(5), SWITCH_BIT(5) },
+  { 36, 74, 1377, SWITCH_BIT(5) | SWITCH_BIT(6), SWITCH_BIT(5) | SWITCH_BIT(6) },
+  // D11
+  { 75, NO_MISSED_SENSOR, 281, SWITCH_BIT(7), 0 },
+  { 56, 75, 650, SWITCH_BIT(7), 0 },
+  // D12
+  { 46, NO_MISSED_SENSOR, 404, 0, 0 },
+  { 36, 46, 704, SWITCH_BIT(6), 0 },
+  // D13
+  { 76, NO_MISSED_SENSOR, 282, SWITCH_BIT(17), 0 },
+  { 73, 76, 658, SWITCH_BIT(17), 0 },
+  // D14
+  { 16, NO_MISSED_SENSOR, 404, 0, 0 },
+  { 41, 16, 763, SWITCH_BIT(16), 0 },
+  // D15
+  { 76, NO_MISSED_SENSOR, 289, SWITCH_BIT(17), SWITCH_BIT(17) },
+  { 73, 76, 665, SWITCH_BIT(17), SWITCH_BIT(17) },
+  // D16
+  { 29, NO_MISSED_SENSOR, 201, 0, 0 },
+  { 48, 29, 686, SWITCH_BIT(154), SWITCH_BIT(154) },
+  { 64, 29, 679, SWITCH_BIT(154), SWITCH_BIT(154) },
+  // E1
+  { 79, NO_MISSED_SENSOR, 201, 0, 0 },
+  { 42, 79, 567, SWITCH_BIT(13), SWITCH_BIT(13) },
+  // E2
+  { 33, NO_MISSED_SENSOR, 485, SWITCH_BIT(156), SWITCH_BIT(156) },
+  { 18, 33, 686, SWITCH_BIT(156), SWITCH_BIT(156) },
+  { 28, NO_MISSED_SENSOR, 478, SWITCH_BIT(156), SWITCH_BIT(156) },
+  { 62, 28, 679, SWITCH_BIT(156), SWITCH_BIT(156) },
+  // E3
+  { 69, NO_MISSED_SENSOR, 289, SWITCH_BIT(10), SWITCH_BIT(10) },
+  { 52, 69, 665, SWITCH_BIT(10), SWITCH_BIT(10) },
+  // E4
+  { 49, NO_MISSED_SENSOR, 201, 0, 0 },
+  { 33, 49, 693, SWITCH_BIT(155) | SWITCH_BIT(156), SWITCH_BIT(155) },
+  { 28, 49, 686, SWITCH_BIT(155) | SWITCH_BIT(156), SWITCH_BIT(155) },
+  // E5
+  { 50, NO_MISSED_SENSOR, 289, 0, 0 },
+  { 20, 50, 693, 0, 0 },
+  { 67, NO_MISSED_SENSOR, 289, 0, 0 },
+  { 49, 67, 490, 0, 0 },
+  // E6
+  { 52, NO_MISSED_SENSOR, 376, 0, 0 },
+  { 57, 52, 1086, SWITCH_BIT(9), SWITCH_BIT(9) },
+  { 72, 52, 1009, SWITCH_BIT(9), SWITCH_BIT(9) },
+  // E7
+  { 44, NO_MISSED_SENSOR, 875, 0, 0 },
+  { 0, 44, 1337, 0, 0 },
+  { 15, 44, 1708, 0, 0 },
+  { 12, 44, 1527, 0, 0 },
+  { 2, 44, 1456, SWITCH_BIT(14), 0 },
+  // E8
+  { 55, NO_MISSED_SENSOR, 384, 0, 0 },
+  { 57, 55, 1164, SWITCH_BIT(9), 0 },
+  { 72, 55, 1087, SWITCH_BIT(9), 0 },
+  // E9
+  { 77, NO_MISSED_SENSOR, 376, 0, 0 },
+  { 61, 77, 658, 0, 0 },
+  { 63, 77, 665, 0, 0 },
+  // E10
+  { 54, NO_MISSED_SENSOR, 703, SWITCH_BIT(8), SWITCH_BIT(8) },
+  { 70, 54, 1087, SWITCH_BIT(8), SWITCH_BIT(8) },
+  { 53, NO_MISSED_SENSOR, 633, SWITCH_BIT(8), SWITCH_BIT(8) },
+  { 68, 53, 1009, SWITCH_BIT(8), SWITCH_BIT(8) },
+  // E11
+  { 59, NO_MISSED_SENSOR, 281, 0, 0 },
+  { 46, 59, 685, 0, 0 },
+  { 38, NO_MISSED_SENSOR, 807, SWITCH_BIT(5), SWITCH_BIT(5) },
+  { 4, 38, 1166, SWITCH_BIT(5), SWITCH_BIT(5) },
+  { 10, 38, 1826, SWITCH_BIT(5), SWITCH_BIT(5) },
+  { 9, 38, 1537, SWITCH_BIT(5), SWITCH_BIT(5) },
+  { 7, 38, 1349, SWITCH_BIT(5), SWITCH_BIT(5) },
+  { 36, NO_MISSED_SENSOR, 1008, SWITCH_BIT(5) | SWITCH_BIT(6), SWITCH_BIT(5) | SWITCH_BIT(6) },
+  { 31, 36, 1491, SWITCH_BIT(5) | SWITCH_BIT(6) | SWITCH_BIT(15), SWITCH_BIT(5) | SWITCH_BIT(6) },
+  // E12
+  { 56, NO_MISSED_SENSOR, 369, 0, 0 },
+  { 54, 56, 1149, SWITCH_BIT(8), 0 },
+  { 53, 56, 1079, SWITCH_BIT(8), 0 },
+  // E13
+  { 73, NO_MISSED_SENSOR, 376, 0, 0 },
+  { 54, 73, 1079, SWITCH_BIT(8), SWITCH_BIT(8) },
+  { 53, 73, 1009, SWITCH_BIT(8), SWITCH_BIT(8) },
+  // E14
+  { 61, NO_MISSED_SENSOR, 282, 0, 0 },
+  { 16, 61, 686, 0, 0 },
+  { 63, NO_MISSED_SENSOR, 289, 0, 0 },
+  { 29, 63, 490, 0, 0 },
+  // E15
+  { 65, NO_MISSED_SENSOR, 201, 0, 0 },
+  { 33, 65, 686, SWITCH_BIT(156), SWITCH_BIT(156) },
+  { 28, 65, 679, SWITCH_BIT(156), SWITCH_BIT(156) },
+  // E16
+  { 42, NO_MISSED_SENSOR, 366, SWITCH_BIT(13), SWITCH_BIT(13) },
+  { 2, 42, 742, SWITCH_BIT(13) | SWITCH_BIT(14), SWITCH_BIT(13) | SWITCH_BIT(14) },
+};
+
 void init_tracka(track_node *track) {
   memset(track, 0, TRACK_MAX*sizeof(track_node));
   track[0].name = "A1";
@@ -20,6 +321,8 @@ void init_tracka(track_node *track) {
   track[0].edge[DIR_AHEAD].dist = 231;
   track[0].coord_x = 939;
   track[0].coord_y = 244;
+  track[0].predecessors = &tracka_predecessors[0];
+  track[0].num_predecessors = 0;
   track[1].name = "A2";
   track[1].type = NODE_SENSOR;
   track[1].num = 1;
@@ -30,6 +333,8 @@ void init_tracka(track_node *track) {
   track[1].edge[DIR_AHEAD].dist = 504;
   track[1].coord_x = 939;
   track[1].coord_y = 244;
+  track[1].predecessors = &tracka_predecessors[0];
+  track[1].num_predecessors = 2;
   track[2].name = "A3";
   track[2].type = NODE_SENSOR;
   track[2].num = 2;
@@ -40,6 +345,8 @@ void init_tracka(track_node *track) {
   track[2].edge[DIR_AHEAD].dist = 43;
   track[2].coord_x = 954;
   track[2].coord_y = 629;
+  track[2].predecessors = &tracka_predecessors[2];
+  track[2].num_predecessors = 3;
   track[3].name = "A4";
   track[3].type = NODE_SENSOR;
   track[3].num = 3;
@@ -50,6 +357,8 @@ void init_tracka(track_node *track) {
   track[3].edge[DIR_AHEAD].dist = 437;
   track[3].coord_x = 954;
   track[3].coord_y = 629;
+  track[3].predecessors = &tracka_predecessors[5];
+  track[3].num_predecessors = 5;
   track[4].name = "A5";
   track[4].type = NODE_SENSOR;
   track[4].num = 4;
@@ -60,6 +369,8 @@ void init_tracka(track_node *track) {
   track[4].edge[DIR_AHEAD].dist = 231;
   track[4].coord_x = 1163;
   track[4].coord_y = 1670;
+  track[4].predecessors = &tracka_predecessors[10];
+  track[4].num_predecessors = 1;
   track[5].name = "A6";
   track[5].type = NODE_SENSOR;
   track[5].num = 5;
@@ -70,6 +381,8 @@ void init_tracka(track_node *track) {
   track[5].edge[DIR_AHEAD].dist = 642;
   track[5].coord_x = 1163;
   track[5].coord_y = 1670;
+  track[5].predecessors = &tracka_predecessors[11];
+  track[5].num_predecessors = 3;
   track[6].name = "A7";
   track[6].type = NODE_SENSOR;
   track[6].num = 6;
@@ -80,6 +393,8 @@ void init_tracka(track_node *track) {
   track[6].edge[DIR_AHEAD].dist = 470;
   track[6].coord_x = 945;
   track[6].coord_y = 1572;
+  track[6].predecessors = &tracka_predecessors[14];
+  track[6].num_predecessors = 3;
   track[7].name = "A8";
   track[7].type = NODE_SENSOR;
   track[7].num = 7;
@@ -90,6 +405,8 @@ void init_tracka(track_node *track) {
   track[7].edge[DIR_AHEAD].dist = 229;
   track[7].coord_x = 945;
   track[7].coord_y = 1572;
+  track[7].predecessors = &tracka_predecessors[17];
+  track[7].num_predecessors = 1;
   track[8].name = "A9";
   track[8].type = NODE_SENSOR;
   track[8].num = 8;
@@ -100,6 +417,8 @@ void init_tracka(track_node *track) {
   track[8].edge[DIR_AHEAD].dist = 289;
   track[8].coord_x = 723;
   track[8].coord_y = 1477;
+  track[8].predecessors = &tracka_predecessors[18];
+  track[8].num_predecessors = 3;
   track[9].name = "A10";
   track[9].type = NODE_SENSOR;
   track[9].num = 9;
@@ -110,6 +429,8 @@ void init_tracka(track_node *track) {
   track[9].edge[DIR_AHEAD].dist = 229;
   track[9].coord_x = 723;
   track[9].coord_y = 1477;
+  track[9].predecessors = &tracka_predecessors[21];
+  track[9].num_predecessors = 1;
   track[10].name = "A11";
   track[10].type = NODE_SENSOR;
   track[10].num = 10;
@@ -120,6 +441,8 @@ void init_tracka(track_node *track) {
   track[10].edge[DIR_AHEAD].dist = 518;
   track[10].coord_x = 367;
   track[10].coord_y = 1374;
+  track[10].predecessors = &tracka_predecessors[22];
+  track[10].num_predecessors = 0;
   track[11].name = "A12";
   track[11].type = NODE_SENSOR;
   track[11].num = 11;
@@ -130,6 +453,8 @@ void init_tracka(track_node *track) {
   track[11].edge[DIR_AHEAD].dist = 43;
   track[11].coord_x = 367;
   track[11].coord_y = 1374;
+  track[11].predecessors = &tracka_predecessors[22];
+  track[11].num_predecessors = 3;
   track[12].name = "A13";
   track[12].type = NODE_SENSOR;
   track[12].num = 12;
@@ -140,6 +465,8 @@ void init_tracka(track_node *track) {
   track[12].edge[DIR_AHEAD].dist = 236;
   track[12].coord_x = 706;
   track[12].coord_y = 343;
+  track[12].predecessors = &tracka_predecessors[25];
+  track[12].num_predecessors = 0;
   track[13].name = "A14";
   track[13].type = NODE_SENSOR;
   track[13].num = 13;
@@ -150,6 +477,8 @@ void init_tracka(track_node *track) {
   track[13].edge[DIR_AHEAD].dist = 325;
   track[13].coord_x = 706;
   track[13].coord_y = 343;
+  track[13].predecessors = &tracka_predecessors[25];
+  track[13].num_predecessors = 2;
   track[14].name = "A15";
   track[14].type = NODE_SENSOR;
   track[14].num = 14;
@@ -160,6 +489,8 @@ void init_tracka(track_node *track) {
   track[14].edge[DIR_AHEAD].dist = 144;
   track[14].coord_x = 491;
   track[14].coord_y = 444;
+  track[14].predecessors = &tracka_predecessors[27];
+  track[14].num_predecessors = 2;
   track[15].name = "A16";
   track[15].type = NODE_SENSOR;
   track[15].num = 15;
@@ -170,6 +501,8 @@ void init_tracka(track_node *track) {
   track[15].edge[DIR_AHEAD].dist = 417;
   track[15].coord_x = 491;
   track[15].coord_y = 444;
+  track[15].predecessors = &tracka_predecessors[29];
+  track[15].num_predecessors = 0;
   track[16].name = "B1";
   track[16].type = NODE_SENSOR;
   track[16].num = 16;
@@ -180,6 +513,8 @@ void init_tracka(track_node *track) {
   track[16].edge[DIR_AHEAD].dist = 404;
   track[16].coord_x = 1749;
   track[16].coord_y = 1477;
+  track[16].predecessors = &tracka_predecessors[29];
+  track[16].num_predecessors = 2;
   track[17].name = "B2";
   track[17].type = NODE_SENSOR;
   track[17].num = 17;
@@ -190,6 +525,8 @@ void init_tracka(track_node *track) {
   track[17].edge[DIR_AHEAD].dist = 231;
   track[17].coord_x = 1749;
   track[17].coord_y = 1477;
+  track[17].predecessors = &tracka_predecessors[31];
+  track[17].num_predecessors = 2;
   track[18].name = "B3";
   track[18].type = NODE_SENSOR;
   track[18].num = 18;
@@ -200,6 +537,8 @@ void init_tracka(track_node *track) {
   track[18].edge[DIR_AHEAD].dist = 201;
   track[18].coord_x = 1745;
   track[18].coord_y = 1396;
+  track[18].predecessors = &tracka_predecessors[33];
+  track[18].num_predecessors = 2;
   track[19].name = "B4";
   track[19].type = NODE_SENSOR;
   track[19].num = 19;
@@ -210,6 +549,8 @@ void init_tracka(track_node *track) {
   track[19].edge[DIR_AHEAD].dist = 239;
   track[19].coord_x = 1745;
   track[19].coord_y = 1396;
+  track[19].predecessors = &tracka_predecessors[35];
+  track[19].num_predecessors = 3;
   track[20].name = "B5";
   track[20].type = NODE_SENSOR;
   track[20].num = 20;
@@ -220,6 +561,8 @@ void init_tracka(track_node *track) {
   track[20].edge[DIR_AHEAD].dist = 404;
   track[20].coord_x = 1780;
   track[20].coord_y = 367;
+  track[20].predecessors = &tracka_predecessors[38];
+  track[20].num_predecessors = 2;
   track[21].name = "B6";
   track[21].type = NODE_SENSOR;
   track[21].num = 21;
@@ -230,6 +573,8 @@ void init_tracka(track_node *track) {
   track[21].edge[DIR_AHEAD].dist = 231;
   track[21].coord_x = 1780;
   track[21].coord_y = 367;
+  track[21].predecessors = &tracka_predecessors[40];
+  track[21].num_predecessors = 2;
   track[22].name = "B7";
   track[22].type = NODE_SENSOR;
   track[22].num = 22;
@@ -240,6 +585,8 @@ void init_tracka(track_node *track) {
   track[22].edge[DIR_AHEAD].dist = 289;
   track[22].coord_x = 346;
   track[22].coord_y = 1473;
+  track[22].predecessors = &tracka_predecessors[42];
+  track[22].num_predecessors = 0;
   track[23].name = "B8";
   track[23].type = NODE_SENSOR;
   track[23].num = 23;
@@ -250,6 +597,8 @@ void init_tracka(track_node *track) {
   track[23].edge[DIR_AHEAD].dist = 43;
   track[23].coord_x = 346;
   track[23].coord_y = 1473;
+  track[23].predecessors = &tracka_predecessors[42];
+  track[23].num_predecessors = 2;
   track[24].name = "B9";
   track[24].type = NODE_SENSOR;
   track[24].num = 24;
@@ -260,6 +609,8 @@ void init_tracka(track_node *track) {
   track[24].edge[DIR_AHEAD].dist = 642;
   track[24].coord_x = 333;
   track[24].coord_y = 1665;
+  track[24].predecessors = &tracka_predecessors[44];
+  track[24].num_predecessors = 0;
   track[25].name = "B10";
   track[25].type = NODE_SENSOR;
   track[25].num = 25;
@@ -270,6 +621,8 @@ void init_tracka(track_node *track) {
   track[25].edge[DIR_AHEAD].dist = 50;
   track[25].coord_x = 333;
   track[25].coord_y = 1665;
+  track[25].predecessors = &tracka_predecessors[44];
+  track[25].num_predecessors = 2;
   track[26].name = "B11";
   track[26].type = NODE_SENSOR;
   track[26].num = 26;
@@ -280,6 +633,8 @@ void init_tracka(track_node *track) {
   track[26].edge[DIR_AHEAD].dist = 470;
   track[26].coord_x = 333;
   track[26].coord_y = 1562;
+  track[26].predecessors = &tracka_predecessors[46];
+  track[26].num_predecessors = 0;
   track[27].name = "B12";
   track[27].type = NODE_SENSOR;
   track[27].num = 27;
@@ -290,6 +645,8 @@ void init_tracka(track_node *track) {
   track[27].edge[DIR_AHEAD].dist = 50;
   track[27].coord_x = 333;
   track[27].coord_y = 1562;
+  track[27].predecessors = &tracka_predecessors[46];
+  track[27].num_predecessors = 2;
   track[28].name = "B13";
   track[28].type = NODE_SENSOR;
   track[28].num = 28;
@@ -300,6 +657,8 @@ void init_tracka(track_node *track) {
   track[28].edge[DIR_AHEAD].dist = 239;
   track[28].coord_x = 2092;
   track[28].coord_y = 1222;
+  track[28].predecessors = &tracka_predecessors[48];
+  track[28].num_predecessors = 2;
   track[29].name = "B14";
   track[29].type = NODE_SENSOR;
   track[29].num = 29;
@@ -310,6 +669,8 @@ void init_tracka(track_node *track) {
   track[29].edge[DIR_AHEAD].dist = 201;
   track[29].coord_x = 2092;
   track[29].coord_y = 1222;
+  track[29].predecessors = &tracka_predecessors[50];
+  track[29].num_predecessors = 4;
   track[30].name = "B15";
   track[30].type = NODE_SENSOR;
   track[30].num = 30;
@@ -320,6 +681,8 @@ void init_tracka(track_node *track) {
   track[30].edge[DIR_AHEAD].dist = 437;
   track[30].coord_x = 941;
   track[30].coord_y = 1182;
+  track[30].predecessors = &tracka_predecessors[54];
+  track[30].num_predecessors = 7;
   track[31].name = "B16";
   track[31].type = NODE_SENSOR;
   track[31].num = 31;
@@ -330,6 +693,8 @@ void init_tracka(track_node *track) {
   track[31].edge[DIR_AHEAD].dist = 50;
   track[31].coord_x = 941;
   track[31].coord_y = 1182;
+  track[31].predecessors = &tracka_predecessors[61];
+  track[31].num_predecessors = 3;
   track[32].name = "C1";
   track[32].type = NODE_SENSOR;
   track[32].num = 32;
@@ -340,6 +705,8 @@ void init_tracka(track_node *track) {
   track[32].edge[DIR_AHEAD].dist = 201;
   track[32].coord_x = 1928;
   track[32].coord_y = 1226;
+  track[32].predecessors = &tracka_predecessors[64];
+  track[32].num_predecessors = 4;
   track[33].name = "C2";
   track[33].type = NODE_SENSOR;
   track[33].num = 33;
@@ -350,6 +717,8 @@ void init_tracka(track_node *track) {
   track[33].edge[DIR_AHEAD].dist = 246;
   track[33].coord_x = 1928;
   track[33].coord_y = 1226;
+  track[33].predecessors = &tracka_predecessors[68];
+  track[33].num_predecessors = 2;
   track[34].name = "C3";
   track[34].type = NODE_SENSOR;
   track[34].num = 34;
@@ -360,6 +729,8 @@ void init_tracka(track_node *track) {
   track[34].edge[DIR_AHEAD].dist = 514;
   track[34].coord_x = 2391;
   track[34].coord_y = 1676;
+  track[34].predecessors = &tracka_predecessors[70];
+  track[34].num_predecessors = 7;
   track[35].name = "C4";
   track[35].type = NODE_SENSOR;
   track[35].num = 35;
@@ -370,6 +741,8 @@ void init_tracka(track_node *track) {
   track[35].edge[DIR_AHEAD].dist = 239;
   track[35].coord_x = 2391;
   track[35].coord_y = 1676;
+  track[35].predecessors = &tracka_predecessors[77];
+  track[35].num_predecessors = 0;
   track[36].name = "C5";
   track[36].type = NODE_SENSOR;
   track[36].num = 36;
@@ -380,6 +753,8 @@ void init_tracka(track_node *track) {
   track[36].edge[DIR_AHEAD].dist = 61;
   track[36].coord_x = 1382;
   track[36].coord_y = 1562;
+  track[36].predecessors = &tracka_predecessors[77];
+  track[36].num_predecessors = 2;
   track[37].name = "C6";
   track[37].type = NODE_SENSOR;
   track[37].num = 37;
@@ -390,6 +765,8 @@ void init_tracka(track_node *track) {
   track[37].edge[DIR_AHEAD].dist = 433;
   track[37].coord_x = 1382;
   track[37].coord_y = 1562;
+  track[37].predecessors = &tracka_predecessors[79];
+  track[37].num_predecessors = 5;
   track[38].name = "C7";
   track[38].type = NODE_SENSOR;
   track[38].num = 38;
@@ -400,6 +777,8 @@ void init_tracka(track_node *track) {
   track[38].edge[DIR_AHEAD].dist = 231;
   track[38].coord_x = 1615;
   track[38].coord_y = 1669;
+  track[38].predecessors = &tracka_predecessors[84];
+  track[38].num_predecessors = 7;
   track[39].name = "C8";
   track[39].type = NODE_SENSOR;
   track[39].num = 39;
@@ -410,6 +789,8 @@ void init_tracka(track_node *track) {
   track[39].edge[DIR_AHEAD].dist = 128;
   track[39].coord_x = 1615;
   track[39].coord_y = 1669;
+  track[39].predecessors = &tracka_predecessors[91];
+  track[39].num_predecessors = 3;
   track[40].name = "C9";
   track[40].type = NODE_SENSOR;
   track[40].num = 40;
@@ -420,6 +801,8 @@ void init_tracka(track_node *track) {
   track[40].edge[DIR_AHEAD].dist = 326;
   track[40].coord_x = 1299;
   track[40].coord_y = 1464;
+  track[40].predecessors = &tracka_predecessors[94];
+  track[40].num_predecessors = 4;
   track[41].name = "C10";
   track[41].type = NODE_SENSOR;
   track[41].num = 41;
@@ -430,6 +813,8 @@ void init_tracka(track_node *track) {
   track[41].edge[DIR_AHEAD].dist = 128;
   track[41].coord_x = 1299;
   track[41].coord_y = 1464;
+  track[41].predecessors = &tracka_predecessors[98];
+  track[41].num_predecessors = 2;
   track[42].name = "C11";
   track[42].type = NODE_SENSOR;
   track[42].num = 42;
@@ -440,6 +825,8 @@ void init_tracka(track_node *track) {
   track[42].edge[DIR_AHEAD].dist = 120;
   track[42].coord_x = 1326;
   track[42].coord_y = 352;
+  track[42].predecessors = &tracka_predecessors[100];
+  track[42].num_predecessors = 2;
   track[43].name = "C12";
   track[43].type = NODE_SENSOR;
   track[43].num = 43;
@@ -450,6 +837,8 @@ void init_tracka(track_node *track) {
   track[43].edge[DIR_AHEAD].dist = 333;
   track[43].coord_x = 1326;
   track[43].coord_y = 352;
+  track[43].predecessors = &tracka_predecessors[102];
+  track[43].num_predecessors = 4;
   track[44].name = "C13";
   track[44].type = NODE_SENSOR;
   track[44].num = 44;
@@ -460,6 +849,8 @@ void init_tracka(track_node *track) {
   track[44].edge[DIR_AHEAD].dist = 875;
   track[44].coord_x = 1540;
   track[44].coord_y = 255;
+  track[44].predecessors = &tracka_predecessors[106];
+  track[44].num_predecessors = 5;
   track[45].name = "C14";
   track[45].type = NODE_SENSOR;
   track[45].num = 45;
@@ -470,6 +861,8 @@ void init_tracka(track_node *track) {
   track[45].edge[DIR_AHEAD].dist = 43;
   track[45].coord_x = 1540;
   track[45].coord_y = 255;
+  track[45].predecessors = &tracka_predecessors[111];
+  track[45].num_predecessors = 2;
   track[46].name = "C15";
   track[46].type = NODE_SENSOR;
   track[46].num = 46;
@@ -480,6 +873,8 @@ void init_tracka(track_node *track) {
   track[46].edge[DIR_AHEAD].dist = 404;
   track[46].coord_x = 1747;
   track[46].coord_y = 1573;
+  track[46].predecessors = &tracka_predecessors[113];
+  track[46].num_predecessors = 2;
   track[47].name = "C16";
   track[47].type = NODE_SENSOR;
   track[47].num = 47;
@@ -490,6 +885,8 @@ void init_tracka(track_node *track) {
   track[47].edge[DIR_AHEAD].dist = 239;
   track[47].coord_x = 1747;
   track[47].coord_y = 1573;
+  track[47].predecessors = &tracka_predecessors[115];
+  track[47].num_predecessors = 2;
   track[48].name = "D1";
   track[48].type = NODE_SENSOR;
   track[48].num = 48;
@@ -500,6 +897,8 @@ void init_tracka(track_node *track) {
   track[48].edge[DIR_AHEAD].dist = 246;
   track[48].coord_x = 2119;
   track[48].coord_y = 641;
+  track[48].predecessors = &tracka_predecessors[117];
+  track[48].num_predecessors = 2;
   track[49].name = "D2";
   track[49].type = NODE_SENSOR;
   track[49].num = 49;
@@ -510,6 +909,8 @@ void init_tracka(track_node *track) {
   track[49].edge[DIR_AHEAD].dist = 201;
   track[49].coord_x = 2119;
   track[49].coord_y = 641;
+  track[49].predecessors = &tracka_predecessors[119];
+  track[49].num_predecessors = 4;
   track[50].name = "D3";
   track[50].type = NODE_SENSOR;
   track[50].num = 50;
@@ -520,6 +921,8 @@ void init_tracka(track_node *track) {
   track[50].edge[DIR_AHEAD].dist = 239;
   track[50].coord_x = 2296;
   track[50].coord_y = 378;
+  track[50].predecessors = &tracka_predecessors[123];
+  track[50].num_predecessors = 2;
   track[51].name = "D4";
   track[51].type = NODE_SENSOR;
   track[51].num = 51;
@@ -530,6 +933,8 @@ void init_tracka(track_node *track) {
   track[51].edge[DIR_AHEAD].dist = 404;
   track[51].coord_x = 2296;
   track[51].coord_y = 378;
+  track[51].predecessors = &tracka_predecessors[125];
+  track[51].num_predecessors = 2;
   track[52].name = "D5";
   track[52].type = NODE_SENSOR;
   track[52].num = 52;
@@ -540,6 +945,8 @@ void init_tracka(track_node *track) {
   track[52].edge[DIR_AHEAD].dist = 376;
   track[52].coord_x = 3076;
   track[52].coord_y = 578;
+  track[52].predecessors = &tracka_predecessors[127];
+  track[52].num_predecessors = 4;
   track[53].name = "D6";
   track[53].type = NODE_SENSOR;
   track[53].num = 53;
@@ -550,6 +957,8 @@ void init_tracka(track_node *track) {
   track[53].edge[DIR_AHEAD].dist = 239;
   track[53].coord_x = 3076;
   track[53].coord_y = 578;
+  track[53].predecessors = &tracka_predecessors[131];
+  track[53].num_predecessors = 3;
   track[54].name = "D7";
   track[54].type = NODE_SENSOR;
   track[54].num = 54;
@@ -560,6 +969,8 @@ void init_tracka(track_node *track) {
   track[54].edge[DIR_AHEAD].dist = 309;
   track[54].coord_x = 3080;
   track[54].coord_y = 477;
+  track[54].predecessors = &tracka_predecessors[134];
+  track[54].num_predecessors = 2;
   track[55].name = "D8";
   track[55].type = NODE_SENSOR;
   track[55].num = 55;
@@ -570,6 +981,8 @@ void init_tracka(track_node *track) {
   track[55].edge[DIR_AHEAD].dist = 384;
   track[55].coord_x = 3080;
   track[55].coord_y = 477;
+  track[55].predecessors = &tracka_predecessors[136];
+  track[55].num_predecessors = 4;
   track[56].name = "D9";
   track[56].type = NODE_SENSOR;
   track[56].num = 56;
@@ -580,6 +993,8 @@ void init_tracka(track_node *track) {
   track[56].edge[DIR_AHEAD].dist = 369;
   track[56].coord_x = 3029;
   track[56].coord_y = 1425;
+  track[56].predecessors = &tracka_predecessors[140];
+  track[56].num_predecessors = 4;
   track[57].name = "D10";
   track[57].type = NODE_SENSOR;
   track[57].num = 57;
@@ -590,6 +1005,8 @@ void init_tracka(track_node *track) {
   track[57].edge[DIR_AHEAD].dist = 316;
   track[57].coord_x = 3029;
   track[57].coord_y = 1425;
+  track[57].predecessors = &tracka_predecessors[144];
+  track[57].num_predecessors = 4;
   track[58].name = "D11";
   track[58].type = NODE_SENSOR;
   track[58].num = 58;
@@ -600,6 +1017,8 @@ void init_tracka(track_node *track) {
   track[58].edge[DIR_AHEAD].dist = 404;
   track[58].coord_x = 2256;
   track[58].coord_y = 1578;
+  track[58].predecessors = &tracka_predecessors[148];
+  track[58].num_predecessors = 2;
   track[59].name = "D12";
   track[59].type = NODE_SENSOR;
   track[59].num = 59;
@@ -610,6 +1029,8 @@ void init_tracka(track_node *track) {
   track[59].edge[DIR_AHEAD].dist = 231;
   track[59].coord_x = 2256;
   track[59].coord_y = 1578;
+  track[59].predecessors = &tracka_predecessors[150];
+  track[59].num_predecessors = 2;
   track[60].name = "D13";
   track[60].type = NODE_SENSOR;
   track[60].num = 60;
@@ -620,6 +1041,8 @@ void init_tracka(track_node *track) {
   track[60].edge[DIR_AHEAD].dist = 404;
   track[60].coord_x = 2252;
   track[60].coord_y = 1487;
+  track[60].predecessors = &tracka_predecessors[152];
+  track[60].num_predecessors = 2;
   track[61].name = "D14";
   track[61].type = NODE_SENSOR;
   track[61].num = 61;
@@ -630,6 +1053,8 @@ void init_tracka(track_node *track) {
   track[61].edge[DIR_AHEAD].dist = 239;
   track[61].coord_x = 2252;
   track[61].coord_y = 1487;
+  track[61].predecessors = &tracka_predecessors[154];
+  track[61].num_predecessors = 2;
   track[62].name = "D15";
   track[62].type = NODE_SENSOR;
   track[62].num = 62;
@@ -640,6 +1065,8 @@ void init_tracka(track_node *track) {
   track[62].edge[DIR_AHEAD].dist = 201;
   track[62].coord_x = 2262;
   track[62].coord_y = 1404;
+  track[62].predecessors = &tracka_predecessors[156];
+  track[62].num_predecessors = 2;
   track[63].name = "D16";
   track[63].type = NODE_SENSOR;
   track[63].num = 63;
@@ -650,6 +1077,8 @@ void init_tracka(track_node *track) {
   track[63].edge[DIR_AHEAD].dist = 246;
   track[63].coord_x = 2262;
   track[63].coord_y = 1404;
+  track[63].predecessors = &tracka_predecessors[158];
+  track[63].num_predecessors = 3;
   track[64].name = "E1";
   track[64].type = NODE_SENSOR;
   track[64].num = 64;
@@ -660,6 +1089,8 @@ void init_tracka(track_node *track) {
   track[64].edge[DIR_AHEAD].dist = 239;
   track[64].coord_x = 1952;
   track[64].coord_y = 642;
+  track[64].predecessors = &tracka_predecessors[161];
+  track[64].num_predecessors = 2;
   track[65].name = "E2";
   track[65].type = NODE_SENSOR;
   track[65].num = 65;
@@ -670,6 +1101,8 @@ void init_tracka(track_node *track) {
   track[65].edge[DIR_AHEAD].dist = 201;
   track[65].coord_x = 1952;
   track[65].coord_y = 642;
+  track[65].predecessors = &tracka_predecessors[163];
+  track[65].num_predecessors = 4;
   track[66].name = "E3";
   track[66].type = NODE_SENSOR;
   track[66].num = 66;
@@ -680,6 +1113,8 @@ void init_tracka(track_node *track) {
   track[66].edge[DIR_AHEAD].dist = 201;
   track[66].coord_x = 2307;
   track[66].coord_y = 462;
+  track[66].predecessors = &tracka_predecessors[167];
+  track[66].num_predecessors = 2;
   track[67].name = "E4";
   track[67].type = NODE_SENSOR;
   track[67].num = 67;
@@ -690,6 +1125,8 @@ void init_tracka(track_node *track) {
   track[67].edge[DIR_AHEAD].dist = 239;
   track[67].coord_x = 2307;
   track[67].coord_y = 462;
+  track[67].predecessors = &tracka_predecessors[169];
+  track[67].num_predecessors = 3;
   track[68].name = "E5";
   track[68].type = NODE_SENSOR;
   track[68].num = 68;
@@ -700,6 +1137,8 @@ void init_tracka(track_node *track) {
   track[68].edge[DIR_AHEAD].dist = 376;
   track[68].coord_x = 2667;
   track[68].coord_y = 384;
+  track[68].predecessors = &tracka_predecessors[172];
+  track[68].num_predecessors = 4;
   track[69].name = "E6";
   track[69].type = NODE_SENSOR;
   track[69].num = 69;
@@ -710,6 +1149,8 @@ void init_tracka(track_node *track) {
   track[69].edge[DIR_AHEAD].dist = 50;
   track[69].coord_x = 2667;
   track[69].coord_y = 384;
+  track[69].predecessors = &tracka_predecessors[176];
+  track[69].num_predecessors = 3;
   track[70].name = "E7";
   track[70].type = NODE_SENSOR;
   track[70].num = 70;
@@ -720,6 +1161,8 @@ void init_tracka(track_node *track) {
   track[70].edge[DIR_AHEAD].dist = 384;
   track[70].coord_x = 2660;
   track[70].coord_y = 281;
+  track[70].predecessors = &tracka_predecessors[179];
+  track[70].num_predecessors = 5;
   track[71].name = "E8";
   track[71].type = NODE_SENSOR;
   track[71].num = 71;
@@ -730,6 +1173,8 @@ void init_tracka(track_node *track) {
   track[71].edge[DIR_AHEAD].dist = 875;
   track[71].coord_x = 2660;
   track[71].coord_y = 281;
+  track[71].predecessors = &tracka_predecessors[184];
+  track[71].num_predecessors = 3;
   track[72].name = "E9";
   track[72].type = NODE_SENSOR;
   track[72].num = 72;
@@ -740,6 +1185,8 @@ void init_tracka(track_node *track) {
   track[72].edge[DIR_AHEAD].dist = 239;
   track[72].coord_x = 3033;
   track[72].coord_y = 1328;
+  track[72].predecessors = &tracka_predecessors[187];
+  track[72].num_predecessors = 3;
   track[73].name = "E10";
   track[73].type = NODE_SENSOR;
   track[73].num = 73;
@@ -750,6 +1197,8 @@ void init_tracka(track_node *track) {
   track[73].edge[DIR_AHEAD].dist = 376;
   track[73].coord_x = 3033;
   track[73].coord_y = 1328;
+  track[73].predecessors = &tracka_predecessors[190];
+  track[73].num_predecessors = 4;
   track[74].name = "E11";
   track[74].type = NODE_SENSOR;
   track[74].num = 74;
@@ -760,6 +1209,8 @@ void init_tracka(track_node *track) {
   track[74].edge[DIR_AHEAD].dist = 369;
   track[74].coord_x = 2609;
   track[74].coord_y = 1585;
+  track[74].predecessors = &tracka_predecessors[194];
+  track[74].num_predecessors = 9;
   track[75].name = "E12";
   track[75].type = NODE_SENSOR;
   track[75].num = 75;
@@ -770,6 +1221,8 @@ void init_tracka(track_node *track) {
   track[75].edge[DIR_AHEAD].dist = 50;
   track[75].coord_x = 2609;
   track[75].coord_y = 1585;
+  track[75].predecessors = &tracka_predecessors[203];
+  track[75].num_predecessors = 3;
   track[76].name = "E13";
   track[76].type = NODE_SENSOR;
   track[76].num = 76;
@@ -780,6 +1233,8 @@ void init_tracka(track_node *track) {
   track[76].edge[DIR_AHEAD].dist = 43;
   track[76].coord_x = 2605;
   track[76].coord_y = 1493;
+  track[76].predecessors = &tracka_predecessors[206];
+  track[76].num_predecessors = 3;
   track[77].name = "E14";
   track[77].type = NODE_SENSOR;
   track[77].num = 77;
@@ -790,6 +1245,8 @@ void init_tracka(track_node *track) {
   track[77].edge[DIR_AHEAD].dist = 376;
   track[77].coord_x = 2605;
   track[77].coord_y = 1493;
+  track[77].predecessors = &tracka_predecessors[209];
+  track[77].num_predecessors = 4;
   track[78].name = "E15";
   track[78].type = NODE_SENSOR;
   track[78].num = 78;
@@ -800,6 +1257,8 @@ void init_tracka(track_node *track) {
   track[78].edge[DIR_AHEAD].dist = 246;
   track[78].coord_x = 1779;
   track[78].coord_y = 456;
+  track[78].predecessors = &tracka_predecessors[213];
+  track[78].num_predecessors = 3;
   track[79].name = "E16";
   track[79].type = NODE_SENSOR;
   track[79].num = 79;
@@ -810,6 +1269,8 @@ void init_tracka(track_node *track) {
   track[79].edge[DIR_AHEAD].dist = 201;
   track[79].coord_x = 1779;
   track[79].coord_y = 456;
+  track[79].predecessors = &tracka_predecessors[216];
+  track[79].num_predecessors = 2;
   track[80].name = "BR1";
   track[80].type = NODE_BRANCH;
   track[80].num = 1;
@@ -1504,6 +1965,313 @@ void init_tracka(track_node *track) {
   track[143].reverse = &track[142];
 }
 
+static const struct sensor_predecessor trackb_predecessors[] = {
+  // A1
+  // A2
+  { 45, NO_MISSED_SENSOR, 469, SWITCH_BIT(12) | SWITCH_BIT(11), 0 },
+  { 71, 45, 1249, SWITCH_BIT(12) | SWITCH_BIT(11), 0 },
+  // A3
+  { 30, NO_MISSED_SENSOR, 437, 0, 0 },
+  { 37, 30, 920, 0, 0 },
+  { 40, 30, 813, 0, 0 },
+  // A4
+  { 45, NO_MISSED_SENSOR, 588, SWITCH_BIT(11), SWITCH_BIT(11) },
+  { 71, 45, 1368, SWITCH_BIT(11), SWITCH_BIT(11) },
+  { 43, NO_MISSED_SENSOR, 376, 0, 0 },
+  { 21, 43, 727, 0, 0 },
+  { 78, 43, 742, 0, 0 },
+  // A5
+  { 24, NO_MISSED_SENSOR, 642, 0, 0 },
+  // A6
+  { 39, NO_MISSED_SENSOR, 359, SWITCH_BIT(3), 0 },
+  { 35, 39, 984, SWITCH_BIT(3) | SWITCH_BIT(18), 0 },
+  { 75, 39, 1159, SWITCH_BIT(3) | SWITCH_BIT(18) | SWITCH_BIT(7), SWITCH_BIT(7) },
+  // A7
+  { 39, NO_MISSED_SENSOR, 542, SWITCH_BIT(2) | SWITCH_BIT(3), SWITCH_BIT(2) | SWITCH_BIT(3) },
+  { 35, 39, 1167, SWITCH_BIT(2) | SWITCH_BIT(3) | SWITCH_BIT(18), SWITCH_BIT(2) | SWITCH_BIT(3) },
+  { 75, 39, 1342, SWITCH_BIT(2) | SWITCH_BIT(3) | SWITCH_BIT(18) | SWITCH_BIT(7), SWITCH_BIT(2) | SWITCH_BIT(3) | SWITCH_BIT(7) },
+  // A8
+  { 26, NO_MISSED_SENSOR, 470, 0, 0 },
+  // A9
+  { 39, NO_MISSED_SENSOR, 730, SWITCH_BIT(1) | SWITCH_BIT(2) | SWITCH_BIT(3), SWITCH_BIT(1) | SWITCH_BIT(3) },
+  { 35, 39, 1355, SWITCH_BIT(1) | SWITCH_BIT(2) | SWITCH_BIT(3) | SWITCH_BIT(18), SWITCH_BIT(1) | SWITCH_BIT(3) },
+  { 75, 39, 1530, SWITCH_BIT(1) | SWITCH_BIT(2) | SWITCH_BIT(3) | SWITCH_BIT(18) | SWITCH_BIT(7), SWITCH_BIT(1) | SWITCH_BIT(3) | SWITCH_BIT(7) },
+  // A10
+  { 22, NO_MISSED_SENSOR, 289, 0, 0 },
+  // A11
+  { 14, NO_MISSED_SENSOR, 814, 0, 0 },
+  { 45, 14, 1512, SWITCH_BIT(4) | SWITCH_BIT(12) | SWITCH_BIT(11), SWITCH_BIT(12) },
+  // A12
+  { 39, NO_MISSED_SENSOR, 783, SWITCH_BIT(1) | SWITCH_BIT(2) | SWITCH_BIT(3), SWITCH_BIT(3) },
+  { 35, 39, 1408, SWITCH_BIT(1) | SWITCH_BIT(2) | SWITCH_BIT(3) | SWITCH_BIT(18), SWITCH_BIT(3) },
+  { 75, 39, 1583, SWITCH_BIT(1) | SWITCH_BIT(2) | SWITCH_BIT(3) | SWITCH_BIT(18) | SWITCH_BIT(7), SWITCH_BIT(3) | SWITCH_BIT(7) },
+  // A13
+  // A14
+  { 45, NO_MISSED_SENSOR, 659, SWITCH_BIT(4) | SWITCH_BIT(12) | SWITCH_BIT(11), SWITCH_BIT(4) | SWITCH_BIT(12) },
+  { 71, 45, 1439, SWITCH_BIT(4) | SWITCH_BIT(12) | SWITCH_BIT(11), SWITCH_BIT(4) | SWITCH_BIT(12) },
+  // A15
+  { 45, NO_MISSED_SENSOR, 698, SWITCH_BIT(4) | SWITCH_BIT(12) | SWITCH_BIT(11), SWITCH_BIT(12) },
+  { 71, 45, 1478, SWITCH_BIT(4) | SWITCH_BIT(12) | SWITCH_BIT(11), SWITCH_BIT(12) },
+  // A16
+  { 11, NO_MISSED_SENSOR, 814, 0, 0 },
+  { 39, 11, 1597, SWITCH_BIT(1) | SWITCH_BIT(2) | SWITCH_BIT(3), SWITCH_BIT(3) },
+  // B1
+  { 41, NO_MISSED_SENSOR, 359, SWITCH_BIT(16), 0 },
+  { 31, 41, 735, SWITCH_BIT(16) | SWITCH_BIT(15), SWITCH_BIT(15) },
+  // B2
+  { 60, NO_MISSED_SENSOR, 404, 0, 0 },
+  { 76, 60, 686, SWITCH_BIT(17), 0 },
+  // B3
+  { 41, NO_MISSED_SENSOR, 367, SWITCH_BIT(16), SWITCH_BIT(16) },
+  { 31, 41, 743, SWITCH_BIT(16) | SWITCH_BIT(15), SWITCH_BIT(16) | SWITCH_BIT(15) },
+  // B4
+  { 32, NO_MISSED_SENSOR, 201, 0, 0 },
+  { 48, 32, 693, SWITCH_BIT(153) | SWITCH_BIT(154), SWITCH_BIT(153) },
+  { 64, 32, 686, SWITCH_BIT(153) | SWITCH_BIT(154), SWITCH_BIT(153) },
+  // B5
+  { 42, NO_MISSED_SENSOR, 351, SWITCH_BIT(13), 0 },
+  { 2, 42, 727, SWITCH_BIT(13) | SWITCH_BIT(14), SWITCH_BIT(14) },
+  // B6
+  { 51, NO_MISSED_SENSOR, 404, 0, 0 },
+  { 69, 51, 693, SWITCH_BIT(10), 0 },
+  // B7
+  // B8
+  { 8, NO_MISSED_SENSOR, 289, 0, 0 },
+  { 39, 8, 1019, SWITCH_BIT(1) | SWITCH_BIT(2) | SWITCH_BIT(3), SWITCH_BIT(1) | SWITCH_BIT(3) },
+  // B9
+  // B10
+  { 5, NO_MISSED_SENSOR, 642, 0, 0 },
+  { 39, 5, 1001, SWITCH_BIT(3), 0 },
+  // B11
+  // B12
+  { 6, NO_MISSED_SENSOR, 470, 0, 0 },
+  { 39, 6, 1012, SWITCH_BIT(2) | SWITCH_BIT(3), SWITCH_BIT(2) | SWITCH_BIT(3) },
+  // B13
+  { 62, NO_MISSED_SENSOR, 201, 0, 0 },
+  { 76, 62, 490, SWITCH_BIT(17), SWITCH_BIT(17) },
+  // B14
+  { 48, NO_MISSED_SENSOR, 485, SWITCH_BIT(154), SWITCH_BIT(154) },
+  { 66, 48, 686, SWITCH_BIT(154), SWITCH_BIT(154) },
+  { 64, NO_MISSED_SENSOR, 478, SWITCH_BIT(154), SWITCH_BIT(154) },
+  { 79, 64, 679, SWITCH_BIT(154), SWITCH_BIT(154) },
+  // B15
+  { 37, NO_MISSED_SENSOR, 483, 0, 0 },
+  { 47, 37, 783, 0, 0 },
+  { 35, 37, 1309, SWITCH_BIT(18), SWITCH_BIT(18) },
+  { 75, 37, 1484, SWITCH_BIT(18) | SWITCH_BIT(7), SWITCH_BIT(18) | SWITCH_BIT(7) },
+  { 40, NO_MISSED_SENSOR, 376, 0, 0 },
+  { 17, 40, 735, 0, 0 },
+  { 19, 40, 743, 0, 0 },
+  // B16
+  { 3, NO_MISSED_SENSOR, 437, 0, 0 },
+  { 45, 3, 1025, SWITCH_BIT(11), SWITCH_BIT(11) },
+  { 43, 3, 813, 0, 0 },
+  // C1
+  { 48, NO_MISSED_SENSOR, 492, SWITCH_BIT(153) | SWITCH_BIT(154), SWITCH_BIT(153) },
+  { 66, 48, 693, SWITCH_BIT(153) | SWITCH_BIT(154), SWITCH_BIT(153) },
+  { 64, NO_MISSED_SENSOR, 485, SWITCH_BIT(153) | SWITCH_BIT(154), SWITCH_BIT(153) },
+  { 79, 64, 686, SWITCH_BIT(153) | SWITCH_BIT(154), SWITCH_BIT(153) },
+  // C2
+  { 18, NO_MISSED_SENSOR, 201, 0, 0 },
+  { 41, 18, 568, SWITCH_BIT(16), SWITCH_BIT(16) },
+  // C3
+  { 38, NO_MISSED_SENSOR, 625, SWITCH_BIT(5), 0 },
+  { 4, 38, 984, SWITCH_BIT(5), 0 },
+  { 10, 38, 1408, SWITCH_BIT(5), 0 },
+  { 9, 38, 1355, SWITCH_BIT(5), 0 },
+  { 7, 38, 1167, SWITCH_BIT(5), 0 },
+  { 36, NO_MISSED_SENSOR, 826, SWITCH_BIT(5) | SWITCH_BIT(6), SWITCH_BIT(6) },
+  { 31, 36, 1309, SWITCH_BIT(5) | SWITCH_BIT(6) | SWITCH_BIT(15), SWITCH_BIT(6) },
+  // C4
+  // C5
+  { 31, NO_MISSED_SENSOR, 483, SWITCH_BIT(15), 0 },
+  { 3, 31, 920, SWITCH_BIT(15), 0 },
+  // C6
+  { 47, NO_MISSED_SENSOR, 300, 0, 0 },
+  { 58, 47, 704, 0, 0 },
+  { 35, NO_MISSED_SENSOR, 826, SWITCH_BIT(18), SWITCH_BIT(18) },
+  { 75, NO_MISSED_SENSOR, 1001, SWITCH_BIT(18) | SWITCH_BIT(7), SWITCH_BIT(18) | SWITCH_BIT(7) },
+  { 56, 75, 1283, SWITCH_BIT(18) | SWITCH_BIT(7), SWITCH_BIT(18) | SWITCH_BIT(7) },
+  // C7
+  { 4, NO_MISSED_SENSOR, 359, 0, 0 },
+  { 24, 4, 1001, 0, 0 },
+  { 10, NO_MISSED_SENSOR, 783, 0, 0 },
+  { 14, 10, 1597, 0, 0 },
+  { 9, NO_MISSED_SENSOR, 730, 0, 0 },
+  { 22, 9, 1019, 0, 0 },
+  { 7, NO_MISSED_SENSOR, 542, 0, 0 },
+  { 26, 7, 1012, 0, 0 },
+  // C8
+  { 35, NO_MISSED_SENSOR, 625, SWITCH_BIT(18), 0 },
+  { 75, NO_MISSED_SENSOR, 800, SWITCH_BIT(18) | SWITCH_BIT(7), SWITCH_BIT(7) },
+  { 56, 75, 1082, SWITCH_BIT(18) | SWITCH_BIT(7), SWITCH_BIT(7) },
+  // C9
+  { 17, NO_MISSED_SENSOR, 359, 0, 0 },
+  { 60, 17, 763, 0, 0 },
+  { 19, NO_MISSED_SENSOR, 367, 0, 0 },
+  { 32, 19, 568, 0, 0 },
+  // C10
+  { 31, NO_MISSED_SENSOR, 376, SWITCH_BIT(15), SWITCH_BIT(15) },
+  { 3, 31, 813, SWITCH_BIT(15), SWITCH_BIT(15) },
+  // C11
+  { 2, NO_MISSED_SENSOR, 376, SWITCH_BIT(14), SWITCH_BIT(14) },
+  { 30, 2, 813, SWITCH_BIT(14), SWITCH_BIT(14) },
+  // C12
+  { 21, NO_MISSED_SENSOR, 351, 0, 0 },
+  { 51, 21, 755, 0, 0 },
+  { 78, NO_MISSED_SENSOR, 366, 0, 0 },
+  { 65, 78, 567, 0, 0 },
+  // C13
+  { 0, NO_MISSED_SENSOR, 469, 0, 0 },
+  { 15, NO_MISSED_SENSOR, 698, 0, 0 },
+  { 11, 15, 1512, 0, 0 },
+  { 12, NO_MISSED_SENSOR, 659, 0, 0 },
+  { 2, NO_MISSED_SENSOR, 588, SWITCH_BIT(14), 0 },
+  { 30, 2, 1025, SWITCH_BIT(14), 0 },
+  // C14
+  { 71, NO_MISSED_SENSOR, 780, 0, 0 },
+  { 55, 71, 1156, 0, 0 },
+  // C15
+  { 36, NO_MISSED_SENSOR, 300, SWITCH_BIT(6), 0 },
+  { 31, 36, 783, SWITCH_BIT(6) | SWITCH_BIT(15), 0 },
+  // C16
+  { 58, NO_MISSED_SENSOR, 404, 0, 0 },
+  { 75, 58, 678, SWITCH_BIT(7), 0 },
+  // D1
+  { 66, NO_MISSED_SENSOR, 201, 0, 0 },
+  { 69, 66, 490, SWITCH_BIT(10), SWITCH_BIT(10) },
+  // D2
+  { 33, NO_MISSED_SENSOR, 492, SWITCH_BIT(155) | SWITCH_BIT(156), SWITCH_BIT(155) },
+  { 18, 33, 693, SWITCH_BIT(155) | SWITCH_BIT(156), SWITCH_BIT(155) },
+  { 28, NO_MISSED_SENSOR, 485, SWITCH_BIT(155) | SWITCH_BIT(156), SWITCH_BIT(155) },
+  { 62, 28, 686, SWITCH_BIT(155) | SWITCH_BIT(156), SWITCH_BIT(155) },
+  // D3
+  { 20, NO_MISSED_SENSOR, 404, 0, 0 },
+  { 42, 20, 755, SWITCH_BIT(13), 0 },
+  // D4
+  { 69, NO_MISSED_SENSOR, 289, SWITCH_BIT(10), 0 },
+  { 52, 69, 571, SWITCH_BIT(10), 0 },
+  // D5
+  { 57, NO_MISSED_SENSOR, 700, SWITCH_BIT(9), SWITCH_BIT(9) },
+  { 74, 57, 982, SWITCH_BIT(9), SWITCH_BIT(9) },
+  { 72, NO_MISSED_SENSOR, 623, SWITCH_BIT(9), SWITCH_BIT(9) },
+  { 77, 72, 905, SWITCH_BIT(9), SWITCH_BIT(9) },
+  // D6
+  { 68, NO_MISSED_SENSOR, 282, 0, 0 },
+  { 50, 68, 571, 0, 0 },
+  { 67, 68, 571, 0, 0 },
+  // D7
+  { 70, NO_MISSED_SENSOR, 376, 0, 0 },
+  { 44, 70, 1156, 0, 0 },
+  // D8
+  { 57, NO_MISSED_SENSOR, 780, SWITCH_BIT(9), 0 },
+  { 74, 57, 1062, SWITCH_BIT(9), 0 },
+  { 72, NO_MISSED_SENSOR, 703, SWITCH_BIT(9), 0 },
+  { 77, 72, 985, SWITCH_BIT(9), 0 },
+  // D9
+  { 54, NO_MISSED_SENSOR, 780, SWITCH_BIT(8), 0 },
+  { 70, 54, 1156, SWITCH_BIT(8), 0 },
+  { 53, NO_MISSED_SENSOR, 700, SWITCH_BIT(8), 0 },
+  { 68, 53, 982, SWITCH_BIT(8), 0 },
+  // D10
+  { 74, NO_MISSED_SENSOR, 282, 0, 0 },
+  { 59, 74, 556, 0, 0 },
+  { 38, 74, 1082, SWITCH_BIT(5), SWITCH_BIT(5) },
+  { 36, 74, 1283, SWITCH_BIT(5) | SWITCH_BIT(6), SWITCH_BIT(5) | SWITCH_BIT(6) },
+  // D11
+  { 75, NO_MISSED_SENSOR, 274, SWITCH_BIT(7), 0 },
+  { 56, 75, 556, SWITCH_BIT(7), 0 },
+  // D12
+  { 46, NO_MISSED_SENSOR, 404, 0, 0 },
+  { 36, 46, 704, SWITCH_BIT(6), 0 },
+  // D13
+  { 76, NO_MISSED_SENSOR, 282, SWITCH_BIT(17), 0 },
+  { 73, 76, 564, SWITCH_BIT(17), 0 },
+  // D14
+  { 16, NO_MISSED_SENSOR, 404, 0, 0 },
+  { 41, 16, 763, SWITCH_BIT(16), 0 },
+  // D15
+  { 76, NO_MISSED_SENSOR, 289, SWITCH_BIT(17), SWITCH_BIT(17) },
+  { 73, 76, 571, SWITCH_BIT(17), SWITCH_BIT(17) },
+  // D16
+  { 29, NO_MISSED_SENSOR, 201, 0, 0 },
+  { 48, 29, 686, SWITCH_BIT(154), SWITCH_BIT(154) },
+  { 64, 29, 679, SWITCH_BIT(154), SWITCH_BIT(154) },
+  // E1
+  { 79, NO_MISSED_SENSOR, 201, 0, 0 },
+  { 42, 79, 567, SWITCH_BIT(13), SWITCH_BIT(13) },
+  // E2
+  { 33, NO_MISSED_SENSOR, 485, SWITCH_BIT(156), SWITCH_BIT(156) },
+  { 18, 33, 686, SWITCH_BIT(156), SWITCH_BIT(156) },
+  { 28, NO_MISSED_SENSOR, 478, SWITCH_BIT(156), SWITCH_BIT(156) },
+  { 62, 28, 679, SWITCH_BIT(156), SWITCH_BIT(156) },
+  // E3
+  { 69, NO_MISSED_SENSOR, 289, SWITCH_BIT(10), SWITCH_BIT(10) },
+  { 52, 69, 571, SWITCH_BIT(10), SWITCH_BIT(10) },
+  // E4
+  { 49, NO_MISSED_SENSOR, 201, 0, 0 },
+  { 33, 49, 693, SWITCH_BIT(155) | SWITCH_BIT(156), SWITCH_BIT(155) },
+  { 28, 49, 686, SWITCH_BIT(155) | SWITCH_BIT(156), SWITCH_BIT(155) },
+  // E5
+  { 50, NO_MISSED_SENSOR, 289, 0, 0 },
+  { 20, 50, 693, 0, 0 },
+  { 67, NO_MISSED_SENSOR, 289, 0, 0 },
+  { 49, 67, 490, 0, 0 },
+  // E6
+  { 52, NO_MISSED_SENSOR, 282, 0, 0 },
+  { 57, 52, 982, SWITCH_BIT(9), SWITCH_BIT(9) },
+  { 72, 52, 905, SWITCH_BIT(9), SWITCH_BIT(9) },
+  // E7
+  { 44, NO_MISSED_SENSOR, 780, 0, 0 },
+  { 0, 44, 1249, 0, 0 },
+  { 15, 44, 1478, 0, 0 },
+  { 12, 44, 1439, 0, 0 },
+  { 2, 44, 1368, SWITCH_BIT(14), 0 },
+  // E8
+  { 55, NO_MISSED_SENSOR, 376, 0, 0 },
+  { 57, 55, 1156, SWITCH_BIT(9), 0 },
+  { 72, 55, 1079, SWITCH_BIT(9), 0 },
+  // E9
+  { 77, NO_MISSED_SENSOR, 282, 0, 0 },
+  { 61, 77, 564, 0, 0 },
+  { 63, 77, 571, 0, 0 },
+  // E10
+  { 54, NO_MISSED_SENSOR, 703, SWITCH_BIT(8), SWITCH_BIT(8) },
+  { 70, 54, 1079, SWITCH_BIT(8), SWITCH_BIT(8) },
+  { 53, NO_MISSED_SENSOR, 623, SWITCH_BIT(8), SWITCH_BIT(8) },
+  { 68, 53, 905, SWITCH_BIT(8), SWITCH_BIT(8) },
+  // E11
+  { 59, NO_MISSED_SENSOR, 274, 0, 0 },
+  { 46, 59, 678, 0, 0 },
+  { 38, NO_MISSED_SENSOR, 800, SWITCH_BIT(5), SWITCH_BIT(5) },
+  { 4, 38, 1159, SWITCH_BIT(5), SWITCH_BIT(5) },
+  { 10, 38, 1583, SWITCH_BIT(5), SWITCH_BIT(5) },
+  { 9, 38, 1530, SWITCH_BIT(5), SWITCH_BIT(5) },
+  { 7, 38, 1342, SWITCH_BIT(5), SWITCH_BIT(5) },
+  { 36, NO_MISSED_SENSOR, 1001, SWITCH_BIT(5) | SWITCH_BIT(6), SWITCH_BIT(5) | SWITCH_BIT(6) },
+  { 31, 36, 1484, SWITCH_BIT(5) | SWITCH_BIT(6) | SWITCH_BIT(15), SWITCH_BIT(5) | SWITCH_BIT(6) },
+  // E12
+  { 56, NO_MISSED_SENSOR, 282, 0, 0 },
+  { 54, 56, 1062, SWITCH_BIT(8), 0 },
+  { 53, 56, 982, SWITCH_BIT(8), 0 },
+  // E13
+  { 73, NO_MISSED_SENSOR, 282, 0, 0 },
+  { 54, 73, 985, SWITCH_BIT(8), SWITCH_BIT(8) },
+  { 53, 73, 905, SWITCH_BIT(8), SWITCH_BIT(8) },
+  // E14
+  { 61, NO_MISSED_SENSOR, 282, 0, 0 },
+  { 16, 61, 686, 0, 0 },
+  { 63, NO_MISSED_SENSOR, 289, 0, 0 },
+  { 29, 63, 490, 0, 0 },
+  // E15
+  { 65, NO_MISSED_SENSOR, 201, 0, 0 },
+  { 33, 65, 686, SWITCH_BIT(156), SWITCH_BIT(156) },
+  { 28, 65, 679, SWITCH_BIT(156), SWITCH_BIT(156) },
+  // E16
+  { 42, NO_MISSED_SENSOR, 366, SWITCH_BIT(13), SWITCH_BIT(13) },
+  { 2, 42, 742, SWITCH_BIT(13) | SWITCH_BIT(14), SWITCH_BIT(13) | SWITCH_BIT(14) },
+};
+
 void init_trackb(track_node *track) {
   memset(track, 0, TRACK_MAX*sizeof(track_node));
   track[0].name = "A1";
@@ -1516,6 +2284,8 @@ void init_trackb(track_node *track) {
   track[0].edge[DIR_AHEAD].dist = 231;
   track[0].coord_x = 2317;
   track[0].coord_y = 1635;
+  track[0].predecessors = &trackb_predecessors[0];
+  track[0].num_predecessors = 0;
   track[1].name = "A2";
   track[1].type = NODE_SENSOR;
   track[1].num = 1;
@@ -1526,6 +2296,8 @@ void init_trackb(track_node *track) {
   track[1].edge[DIR_AHEAD].dist = 504;
   track[1].coord_x = 2317;
   track[1].coord_y = 1635;
+  track[1].predecessors = &trackb_predecessors[0];
+  track[1].num_predecessors = 2;
   track[2].name = "A3";
   track[2].type = NODE_SENSOR;
   track[2].num = 2;
@@ -1536,6 +2308,8 @@ void init_trackb(track_node *track) {
   track[2].edge[DIR_AHEAD].dist = 43;
   track[2].coord_x = 2295;
   track[2].coord_y = 1271;
+  track[2].predecessors = &trackb_predecessors[2];
+  track[2].num_predecessors = 3;
   track[3].name = "A4";
   track[3].type = NODE_SENSOR;
   track[3].num = 3;
@@ -1546,6 +2320,8 @@ void init_trackb(track_node *track) {
   track[3].edge[DIR_AHEAD].dist = 437;
   track[3].coord_x = 2295;
   track[3].coord_y = 1271;
+  track[3].predecessors = &trackb_predecessors[5];
+  track[3].num_predecessors = 5;
   track[4].name = "A5";
   track[4].type = NODE_SENSOR;
   track[4].num = 4;
@@ -1556,6 +2332,8 @@ void init_trackb(track_node *track) {
   track[4].edge[DIR_AHEAD].dist = 231;
   track[4].coord_x = 2048;
   track[4].coord_y = 238;
+  track[4].predecessors = &trackb_predecessors[10];
+  track[4].num_predecessors = 1;
   track[5].name = "A6";
   track[5].type = NODE_SENSOR;
   track[5].num = 5;
@@ -1566,6 +2344,8 @@ void init_trackb(track_node *track) {
   track[5].edge[DIR_AHEAD].dist = 642;
   track[5].coord_x = 2048;
   track[5].coord_y = 238;
+  track[5].predecessors = &trackb_predecessors[11];
+  track[5].num_predecessors = 3;
   track[6].name = "A7";
   track[6].type = NODE_SENSOR;
   track[6].num = 6;
@@ -1576,6 +2356,8 @@ void init_trackb(track_node *track) {
   track[6].edge[DIR_AHEAD].dist = 470;
   track[6].coord_x = 2281;
   track[6].coord_y = 331;
+  track[6].predecessors = &trackb_predecessors[14];
+  track[6].num_predecessors = 3;
   track[7].name = "A8";
   track[7].type = NODE_SENSOR;
   track[7].num = 7;
@@ -1586,6 +2368,8 @@ void init_trackb(track_node *track) {
   track[7].edge[DIR_AHEAD].dist = 229;
   track[7].coord_x = 2281;
   track[7].coord_y = 331;
+  track[7].predecessors = &trackb_predecessors[17];
+  track[7].num_predecessors = 1;
   track[8].name = "A9";
   track[8].type = NODE_SENSOR;
   track[8].num = 8;
@@ -1596,6 +2380,8 @@ void init_trackb(track_node *track) {
   track[8].edge[DIR_AHEAD].dist = 289;
   track[8].coord_x = 2504;
   track[8].coord_y = 421;
+  track[8].predecessors = &trackb_predecessors[18];
+  track[8].num_predecessors = 3;
   track[9].name = "A10";
   track[9].type = NODE_SENSOR;
   track[9].num = 9;
@@ -1606,6 +2392,8 @@ void init_trackb(track_node *track) {
   track[9].edge[DIR_AHEAD].dist = 229;
   track[9].coord_x = 2504;
   track[9].coord_y = 421;
+  track[9].predecessors = &trackb_predecessors[21];
+  track[9].num_predecessors = 1;
   track[10].name = "A11";
   track[10].type = NODE_SENSOR;
   track[10].num = 10;
@@ -1616,6 +2404,8 @@ void init_trackb(track_node *track) {
   track[10].edge[DIR_AHEAD].dist = 282;
   track[10].coord_x = 2537;
   track[10].coord_y = 531;
+  track[10].predecessors = &trackb_predecessors[22];
+  track[10].num_predecessors = 2;
   track[11].name = "A12";
   track[11].type = NODE_SENSOR;
   track[11].num = 11;
@@ -1626,6 +2416,8 @@ void init_trackb(track_node *track) {
   track[11].edge[DIR_AHEAD].dist = 814;
   track[11].coord_x = 2537;
   track[11].coord_y = 531;
+  track[11].predecessors = &trackb_predecessors[24];
+  track[11].num_predecessors = 3;
   track[12].name = "A13";
   track[12].type = NODE_SENSOR;
   track[12].num = 12;
@@ -1636,6 +2428,8 @@ void init_trackb(track_node *track) {
   track[12].edge[DIR_AHEAD].dist = 236;
   track[12].coord_x = 2532;
   track[12].coord_y = 1529;
+  track[12].predecessors = &trackb_predecessors[27];
+  track[12].num_predecessors = 0;
   track[13].name = "A14";
   track[13].type = NODE_SENSOR;
   track[13].num = 13;
@@ -1646,6 +2440,8 @@ void init_trackb(track_node *track) {
   track[13].edge[DIR_AHEAD].dist = 325;
   track[13].coord_x = 2532;
   track[13].coord_y = 1529;
+  track[13].predecessors = &trackb_predecessors[27];
+  track[13].num_predecessors = 2;
   track[14].name = "A15";
   track[14].type = NODE_SENSOR;
   track[14].num = 14;
@@ -1656,6 +2452,8 @@ void init_trackb(track_node *track) {
   track[14].edge[DIR_AHEAD].dist = 814;
   track[14].coord_x = 2557;
   track[14].coord_y = 1426;
+  track[14].predecessors = &trackb_predecessors[29];
+  track[14].num_predecessors = 2;
   track[15].name = "A16";
   track[15].type = NODE_SENSOR;
   track[15].num = 15;
@@ -1666,6 +2464,8 @@ void init_trackb(track_node *track) {
   track[15].edge[DIR_AHEAD].dist = 275;
   track[15].coord_x = 2557;
   track[15].coord_y = 1426;
+  track[15].predecessors = &trackb_predecessors[31];
+  track[15].num_predecessors = 2;
   track[16].name = "B1";
   track[16].type = NODE_SENSOR;
   track[16].num = 16;
@@ -1676,6 +2476,8 @@ void init_trackb(track_node *track) {
   track[16].edge[DIR_AHEAD].dist = 404;
   track[16].coord_x = 1451;
   track[16].coord_y = 474;
+  track[16].predecessors = &trackb_predecessors[33];
+  track[16].num_predecessors = 2;
   track[17].name = "B2";
   track[17].type = NODE_SENSOR;
   track[17].num = 17;
@@ -1686,6 +2488,8 @@ void init_trackb(track_node *track) {
   track[17].edge[DIR_AHEAD].dist = 231;
   track[17].coord_x = 1451;
   track[17].coord_y = 474;
+  track[17].predecessors = &trackb_predecessors[35];
+  track[17].num_predecessors = 2;
   track[18].name = "B3";
   track[18].type = NODE_SENSOR;
   track[18].num = 18;
@@ -1696,6 +2500,8 @@ void init_trackb(track_node *track) {
   track[18].edge[DIR_AHEAD].dist = 201;
   track[18].coord_x = 1471;
   track[18].coord_y = 557;
+  track[18].predecessors = &trackb_predecessors[37];
+  track[18].num_predecessors = 2;
   track[19].name = "B4";
   track[19].type = NODE_SENSOR;
   track[19].num = 19;
@@ -1706,6 +2512,8 @@ void init_trackb(track_node *track) {
   track[19].edge[DIR_AHEAD].dist = 239;
   track[19].coord_x = 1471;
   track[19].coord_y = 557;
+  track[19].predecessors = &trackb_predecessors[39];
+  track[19].num_predecessors = 3;
   track[20].name = "B5";
   track[20].type = NODE_SENSOR;
   track[20].num = 20;
@@ -1716,6 +2524,8 @@ void init_trackb(track_node *track) {
   track[20].edge[DIR_AHEAD].dist = 404;
   track[20].coord_x = 1500;
   track[20].coord_y = 1575;
+  track[20].predecessors = &trackb_predecessors[42];
+  track[20].num_predecessors = 2;
   track[21].name = "B6";
   track[21].type = NODE_SENSOR;
   track[21].num = 21;
@@ -1726,6 +2536,8 @@ void init_trackb(track_node *track) {
   track[21].edge[DIR_AHEAD].dist = 231;
   track[21].coord_x = 1500;
   track[21].coord_y = 1575;
+  track[21].predecessors = &trackb_predecessors[44];
+  track[21].num_predecessors = 2;
   track[22].name = "B7";
   track[22].type = NODE_SENSOR;
   track[22].num = 22;
@@ -1736,6 +2548,8 @@ void init_trackb(track_node *track) {
   track[22].edge[DIR_AHEAD].dist = 289;
   track[22].coord_x = 2865;
   track[22].coord_y = 402;
+  track[22].predecessors = &trackb_predecessors[46];
+  track[22].num_predecessors = 0;
   track[23].name = "B8";
   track[23].type = NODE_SENSOR;
   track[23].num = 23;
@@ -1746,6 +2560,8 @@ void init_trackb(track_node *track) {
   track[23].edge[DIR_AHEAD].dist = 43;
   track[23].coord_x = 2865;
   track[23].coord_y = 402;
+  track[23].predecessors = &trackb_predecessors[46];
+  track[23].num_predecessors = 2;
   track[24].name = "B9";
   track[24].type = NODE_SENSOR;
   track[24].num = 24;
@@ -1756,6 +2572,8 @@ void init_trackb(track_node *track) {
   track[24].edge[DIR_AHEAD].dist = 642;
   track[24].coord_x = 2915;
   track[24].coord_y = 188;
+  track[24].predecessors = &trackb_predecessors[48];
+  track[24].num_predecessors = 0;
   track[25].name = "B10";
   track[25].type = NODE_SENSOR;
   track[25].num = 25;
@@ -1766,6 +2584,8 @@ void init_trackb(track_node *track) {
   track[25].edge[DIR_AHEAD].dist = 50;
   track[25].coord_x = 2915;
   track[25].coord_y = 188;
+  track[25].predecessors = &trackb_predecessors[48];
+  track[25].num_predecessors = 2;
   track[26].name = "B11";
   track[26].type = NODE_SENSOR;
   track[26].num = 26;
@@ -1776,6 +2596,8 @@ void init_trackb(track_node *track) {
   track[26].edge[DIR_AHEAD].dist = 470;
   track[26].coord_x = 2885;
   track[26].coord_y = 297;
+  track[26].predecessors = &trackb_predecessors[50];
+  track[26].num_predecessors = 0;
   track[27].name = "B12";
   track[27].type = NODE_SENSOR;
   track[27].num = 27;
@@ -1786,6 +2608,8 @@ void init_trackb(track_node *track) {
   track[27].edge[DIR_AHEAD].dist = 50;
   track[27].coord_x = 2885;
   track[27].coord_y = 297;
+  track[27].predecessors = &trackb_predecessors[50];
+  track[27].num_predecessors = 2;
   track[28].name = "B13";
   track[28].type = NODE_SENSOR;
   track[28].num = 28;
@@ -1796,6 +2620,8 @@ void init_trackb(track_node *track) {
   track[28].edge[DIR_AHEAD].dist = 239;
   track[28].coord_x = 1128;
   track[28].coord_y = 753;
+  track[28].predecessors = &trackb_predecessors[52];
+  track[28].num_predecessors = 2;
   track[29].name = "B14";
   track[29].type = NODE_SENSOR;
   track[29].num = 29;
@@ -1806,6 +2632,8 @@ void init_trackb(track_node *track) {
   track[29].edge[DIR_AHEAD].dist = 201;
   track[29].coord_x = 1128;
   track[29].coord_y = 753;
+  track[29].predecessors = &trackb_predecessors[54];
+  track[29].num_predecessors = 4;
   track[30].name = "B15";
   track[30].type = NODE_SENSOR;
   track[30].num = 30;
@@ -1816,6 +2644,8 @@ void init_trackb(track_node *track) {
   track[30].edge[DIR_AHEAD].dist = 437;
   track[30].coord_x = 2288;
   track[30].coord_y = 727;
+  track[30].predecessors = &trackb_predecessors[58];
+  track[30].num_predecessors = 7;
   track[31].name = "B16";
   track[31].type = NODE_SENSOR;
   track[31].num = 31;
@@ -1826,6 +2656,8 @@ void init_trackb(track_node *track) {
   track[31].edge[DIR_AHEAD].dist = 50;
   track[31].coord_x = 2288;
   track[31].coord_y = 727;
+  track[31].predecessors = &trackb_predecessors[65];
+  track[31].num_predecessors = 3;
   track[32].name = "C1";
   track[32].type = NODE_SENSOR;
   track[32].num = 32;
@@ -1836,6 +2668,8 @@ void init_trackb(track_node *track) {
   track[32].edge[DIR_AHEAD].dist = 201;
   track[32].coord_x = 1295;
   track[32].coord_y = 744;
+  track[32].predecessors = &trackb_predecessors[68];
+  track[32].num_predecessors = 4;
   track[33].name = "C2";
   track[33].type = NODE_SENSOR;
   track[33].num = 33;
@@ -1846,6 +2680,8 @@ void init_trackb(track_node *track) {
   track[33].edge[DIR_AHEAD].dist = 246;
   track[33].coord_x = 1295;
   track[33].coord_y = 744;
+  track[33].predecessors = &trackb_predecessors[72];
+  track[33].num_predecessors = 2;
   track[34].name = "C3";
   track[34].type = NODE_SENSOR;
   track[34].num = 34;
@@ -1856,6 +2692,8 @@ void init_trackb(track_node *track) {
   track[34].edge[DIR_AHEAD].dist = 514;
   track[34].coord_x = 787;
   track[34].coord_y = 293;
+  track[34].predecessors = &trackb_predecessors[74];
+  track[34].num_predecessors = 7;
   track[35].name = "C4";
   track[35].type = NODE_SENSOR;
   track[35].num = 35;
@@ -1866,6 +2704,8 @@ void init_trackb(track_node *track) {
   track[35].edge[DIR_AHEAD].dist = 239;
   track[35].coord_x = 787;
   track[35].coord_y = 293;
+  track[35].predecessors = &trackb_predecessors[81];
+  track[35].num_predecessors = 0;
   track[36].name = "C5";
   track[36].type = NODE_SENSOR;
   track[36].num = 36;
@@ -1876,6 +2716,8 @@ void init_trackb(track_node *track) {
   track[36].edge[DIR_AHEAD].dist = 61;
   track[36].coord_x = 1830;
   track[36].coord_y = 359;
+  track[36].predecessors = &trackb_predecessors[81];
+  track[36].num_predecessors = 2;
   track[37].name = "C6";
   track[37].type = NODE_SENSOR;
   track[37].num = 37;
@@ -1886,6 +2728,8 @@ void init_trackb(track_node *track) {
   track[37].edge[DIR_AHEAD].dist = 433;
   track[37].coord_x = 1830;
   track[37].coord_y = 359;
+  track[37].predecessors = &trackb_predecessors[83];
+  track[37].num_predecessors = 5;
   track[38].name = "C7";
   track[38].type = NODE_SENSOR;
   track[38].num = 38;
@@ -1896,6 +2740,8 @@ void init_trackb(track_node *track) {
   track[38].edge[DIR_AHEAD].dist = 231;
   track[38].coord_x = 1584;
   track[38].coord_y = 259;
+  track[38].predecessors = &trackb_predecessors[88];
+  track[38].num_predecessors = 8;
   track[39].name = "C8";
   track[39].type = NODE_SENSOR;
   track[39].num = 39;
@@ -1906,6 +2752,8 @@ void init_trackb(track_node *track) {
   track[39].edge[DIR_AHEAD].dist = 128;
   track[39].coord_x = 1584;
   track[39].coord_y = 259;
+  track[39].predecessors = &trackb_predecessors[96];
+  track[39].num_predecessors = 3;
   track[40].name = "C9";
   track[40].type = NODE_SENSOR;
   track[40].num = 40;
@@ -1916,6 +2764,8 @@ void init_trackb(track_node *track) {
   track[40].edge[DIR_AHEAD].dist = 326;
   track[40].coord_x = 1919;
   track[40].coord_y = 455;
+  track[40].predecessors = &trackb_predecessors[99];
+  track[40].num_predecessors = 4;
   track[41].name = "C10";
   track[41].type = NODE_SENSOR;
   track[41].num = 41;
@@ -1926,6 +2776,8 @@ void init_trackb(track_node *track) {
   track[41].edge[DIR_AHEAD].dist = 128;
   track[41].coord_x = 1919;
   track[41].coord_y = 455;
+  track[41].predecessors = &trackb_predecessors[103];
+  track[41].num_predecessors = 2;
   track[42].name = "C11";
   track[42].type = NODE_SENSOR;
   track[42].num = 42;
@@ -1936,6 +2788,8 @@ void init_trackb(track_node *track) {
   track[42].edge[DIR_AHEAD].dist = 120;
   track[42].coord_x = 1939;
   track[42].coord_y = 1552;
+  track[42].predecessors = &trackb_predecessors[105];
+  track[42].num_predecessors = 2;
   track[43].name = "C12";
   track[43].type = NODE_SENSOR;
   track[43].num = 43;
@@ -1946,6 +2800,8 @@ void init_trackb(track_node *track) {
   track[43].edge[DIR_AHEAD].dist = 333;
   track[43].coord_x = 1939;
   track[43].coord_y = 1552;
+  track[43].predecessors = &trackb_predecessors[107];
+  track[43].num_predecessors = 4;
   track[44].name = "C13";
   track[44].type = NODE_SENSOR;
   track[44].num = 44;
@@ -1956,6 +2812,8 @@ void init_trackb(track_node *track) {
   track[44].edge[DIR_AHEAD].dist = 780;
   track[44].coord_x = 1730;
   track[44].coord_y = 1661;
+  track[44].predecessors = &trackb_predecessors[111];
+  track[44].num_predecessors = 6;
   track[45].name = "C14";
   track[45].type = NODE_SENSOR;
   track[45].num = 45;
@@ -1966,6 +2824,8 @@ void init_trackb(track_node *track) {
   track[45].edge[DIR_AHEAD].dist = 50;
   track[45].coord_x = 1730;
   track[45].coord_y = 1661;
+  track[45].predecessors = &trackb_predecessors[117];
+  track[45].num_predecessors = 2;
   track[46].name = "C15";
   track[46].type = NODE_SENSOR;
   track[46].num = 46;
@@ -1976,6 +2836,8 @@ void init_trackb(track_node *track) {
   track[46].edge[DIR_AHEAD].dist = 404;
   track[46].coord_x = 1456;
   track[46].coord_y = 370;
+  track[46].predecessors = &trackb_predecessors[119];
+  track[46].num_predecessors = 2;
   track[47].name = "C16";
   track[47].type = NODE_SENSOR;
   track[47].num = 47;
@@ -1986,6 +2848,8 @@ void init_trackb(track_node *track) {
   track[47].edge[DIR_AHEAD].dist = 239;
   track[47].coord_x = 1456;
   track[47].coord_y = 370;
+  track[47].predecessors = &trackb_predecessors[121];
+  track[47].num_predecessors = 2;
   track[48].name = "D1";
   track[48].type = NODE_SENSOR;
   track[48].num = 48;
@@ -1996,6 +2860,8 @@ void init_trackb(track_node *track) {
   track[48].edge[DIR_AHEAD].dist = 246;
   track[48].coord_x = 1149;
   track[48].coord_y = 1339;
+  track[48].predecessors = &trackb_predecessors[123];
+  track[48].num_predecessors = 2;
   track[49].name = "D2";
   track[49].type = NODE_SENSOR;
   track[49].num = 49;
@@ -2006,6 +2872,8 @@ void init_trackb(track_node *track) {
   track[49].edge[DIR_AHEAD].dist = 201;
   track[49].coord_x = 1149;
   track[49].coord_y = 1339;
+  track[49].predecessors = &trackb_predecessors[125];
+  track[49].num_predecessors = 4;
   track[50].name = "D3";
   track[50].type = NODE_SENSOR;
   track[50].num = 50;
@@ -2016,6 +2884,8 @@ void init_trackb(track_node *track) {
   track[50].edge[DIR_AHEAD].dist = 239;
   track[50].coord_x = 988;
   track[50].coord_y = 1597;
+  track[50].predecessors = &trackb_predecessors[129];
+  track[50].num_predecessors = 2;
   track[51].name = "D4";
   track[51].type = NODE_SENSOR;
   track[51].num = 51;
@@ -2026,6 +2896,8 @@ void init_trackb(track_node *track) {
   track[51].edge[DIR_AHEAD].dist = 404;
   track[51].coord_x = 988;
   track[51].coord_y = 1597;
+  track[51].predecessors = &trackb_predecessors[131];
+  track[51].num_predecessors = 2;
   track[52].name = "D5";
   track[52].type = NODE_SENSOR;
   track[52].num = 52;
@@ -2036,6 +2908,8 @@ void init_trackb(track_node *track) {
   track[52].edge[DIR_AHEAD].dist = 282;
   track[52].coord_x = 316;
   track[52].coord_y = 1445;
+  track[52].predecessors = &trackb_predecessors[133];
+  track[52].num_predecessors = 4;
   track[53].name = "D6";
   track[53].type = NODE_SENSOR;
   track[53].num = 53;
@@ -2046,6 +2920,8 @@ void init_trackb(track_node *track) {
   track[53].edge[DIR_AHEAD].dist = 229;
   track[53].coord_x = 316;
   track[53].coord_y = 1445;
+  track[53].predecessors = &trackb_predecessors[137];
+  track[53].num_predecessors = 3;
   track[54].name = "D7";
   track[54].type = NODE_SENSOR;
   track[54].num = 54;
@@ -2056,6 +2932,8 @@ void init_trackb(track_node *track) {
   track[54].edge[DIR_AHEAD].dist = 309;
   track[54].coord_x = 321;
   track[54].coord_y = 1543;
+  track[54].predecessors = &trackb_predecessors[140];
+  track[54].num_predecessors = 2;
   track[55].name = "D8";
   track[55].type = NODE_SENSOR;
   track[55].num = 55;
@@ -2066,6 +2944,8 @@ void init_trackb(track_node *track) {
   track[55].edge[DIR_AHEAD].dist = 376;
   track[55].coord_x = 321;
   track[55].coord_y = 1543;
+  track[55].predecessors = &trackb_predecessors[142];
+  track[55].num_predecessors = 4;
   track[56].name = "D9";
   track[56].type = NODE_SENSOR;
   track[56].num = 56;
@@ -2076,6 +2956,8 @@ void init_trackb(track_node *track) {
   track[56].edge[DIR_AHEAD].dist = 282;
   track[56].coord_x = 270;
   track[56].coord_y = 589;
+  track[56].predecessors = &trackb_predecessors[146];
+  track[56].num_predecessors = 4;
   track[57].name = "D10";
   track[57].type = NODE_SENSOR;
   track[57].num = 57;
@@ -2086,6 +2968,8 @@ void init_trackb(track_node *track) {
   track[57].edge[DIR_AHEAD].dist = 316;
   track[57].coord_x = 270;
   track[57].coord_y = 589;
+  track[57].predecessors = &trackb_predecessors[150];
+  track[57].num_predecessors = 4;
   track[58].name = "D11";
   track[58].type = NODE_SENSOR;
   track[58].num = 58;
@@ -2096,6 +2980,8 @@ void init_trackb(track_node *track) {
   track[58].edge[DIR_AHEAD].dist = 404;
   track[58].coord_x = 936;
   track[58].coord_y = 385;
+  track[58].predecessors = &trackb_predecessors[154];
+  track[58].num_predecessors = 2;
   track[59].name = "D12";
   track[59].type = NODE_SENSOR;
   track[59].num = 59;
@@ -2106,6 +2992,8 @@ void init_trackb(track_node *track) {
   track[59].edge[DIR_AHEAD].dist = 231;
   track[59].coord_x = 936;
   track[59].coord_y = 385;
+  track[59].predecessors = &trackb_predecessors[156];
+  track[59].num_predecessors = 2;
   track[60].name = "D13";
   track[60].type = NODE_SENSOR;
   track[60].num = 60;
@@ -2116,6 +3004,8 @@ void init_trackb(track_node *track) {
   track[60].edge[DIR_AHEAD].dist = 404;
   track[60].coord_x = 933;
   track[60].coord_y = 491;
+  track[60].predecessors = &trackb_predecessors[158];
+  track[60].num_predecessors = 2;
   track[61].name = "D14";
   track[61].type = NODE_SENSOR;
   track[61].num = 61;
@@ -2126,6 +3016,8 @@ void init_trackb(track_node *track) {
   track[61].edge[DIR_AHEAD].dist = 239;
   track[61].coord_x = 933;
   track[61].coord_y = 491;
+  track[61].predecessors = &trackb_predecessors[160];
+  track[61].num_predecessors = 2;
   track[62].name = "D15";
   track[62].type = NODE_SENSOR;
   track[62].num = 62;
@@ -2136,6 +3028,8 @@ void init_trackb(track_node *track) {
   track[62].edge[DIR_AHEAD].dist = 201;
   track[62].coord_x = 942;
   track[62].coord_y = 580;
+  track[62].predecessors = &trackb_predecessors[162];
+  track[62].num_predecessors = 2;
   track[63].name = "D16";
   track[63].type = NODE_SENSOR;
   track[63].num = 63;
@@ -2146,6 +3040,8 @@ void init_trackb(track_node *track) {
   track[63].edge[DIR_AHEAD].dist = 246;
   track[63].coord_x = 942;
   track[63].coord_y = 580;
+  track[63].predecessors = &trackb_predecessors[164];
+  track[63].num_predecessors = 3;
   track[64].name = "E1";
   track[64].type = NODE_SENSOR;
   track[64].num = 64;
@@ -2156,6 +3052,8 @@ void init_trackb(track_node *track) {
   track[64].edge[DIR_AHEAD].dist = 239;
   track[64].coord_x = 1313;
   track[64].coord_y = 1324;
+  track[64].predecessors = &trackb_predecessors[167];
+  track[64].num_predecessors = 2;
   track[65].name = "E2";
   track[65].type = NODE_SENSOR;
   track[65].num = 65;
@@ -2166,6 +3064,8 @@ void init_trackb(track_node *track) {
   track[65].edge[DIR_AHEAD].dist = 201;
   track[65].coord_x = 1313;
   track[65].coord_y = 1324;
+  track[65].predecessors = &trackb_predecessors[169];
+  track[65].num_predecessors = 4;
   track[66].name = "E3";
   track[66].type = NODE_SENSOR;
   track[66].num = 66;
@@ -2176,6 +3076,8 @@ void init_trackb(track_node *track) {
   track[66].edge[DIR_AHEAD].dist = 201;
   track[66].coord_x = 976;
   track[66].coord_y = 1520;
+  track[66].predecessors = &trackb_predecessors[173];
+  track[66].num_predecessors = 2;
   track[67].name = "E4";
   track[67].type = NODE_SENSOR;
   track[67].num = 67;
@@ -2186,6 +3088,8 @@ void init_trackb(track_node *track) {
   track[67].edge[DIR_AHEAD].dist = 239;
   track[67].coord_x = 976;
   track[67].coord_y = 1520;
+  track[67].predecessors = &trackb_predecessors[175];
+  track[67].num_predecessors = 3;
   track[68].name = "E5";
   track[68].type = NODE_SENSOR;
   track[68].num = 68;
@@ -2196,6 +3100,8 @@ void init_trackb(track_node *track) {
   track[68].edge[DIR_AHEAD].dist = 282;
   track[68].coord_x = 629;
   track[68].coord_y = 1609;
+  track[68].predecessors = &trackb_predecessors[178];
+  track[68].num_predecessors = 4;
   track[69].name = "E6";
   track[69].type = NODE_SENSOR;
   track[69].num = 69;
@@ -2206,6 +3112,8 @@ void init_trackb(track_node *track) {
   track[69].edge[DIR_AHEAD].dist = 50;
   track[69].coord_x = 629;
   track[69].coord_y = 1609;
+  track[69].predecessors = &trackb_predecessors[182];
+  track[69].num_predecessors = 3;
   track[70].name = "E7";
   track[70].type = NODE_SENSOR;
   track[70].num = 70;
@@ -2216,6 +3124,8 @@ void init_trackb(track_node *track) {
   track[70].edge[DIR_AHEAD].dist = 376;
   track[70].coord_x = 755;
   track[70].coord_y = 1703;
+  track[70].predecessors = &trackb_predecessors[185];
+  track[70].num_predecessors = 5;
   track[71].name = "E8";
   track[71].type = NODE_SENSOR;
   track[71].num = 71;
@@ -2226,6 +3136,8 @@ void init_trackb(track_node *track) {
   track[71].edge[DIR_AHEAD].dist = 780;
   track[71].coord_x = 755;
   track[71].coord_y = 1703;
+  track[71].predecessors = &trackb_predecessors[190];
+  track[71].num_predecessors = 3;
   track[72].name = "E9";
   track[72].type = NODE_SENSOR;
   track[72].num = 72;
@@ -2236,6 +3148,8 @@ void init_trackb(track_node *track) {
   track[72].edge[DIR_AHEAD].dist = 239;
   track[72].coord_x = 290;
   track[72].coord_y = 669;
+  track[72].predecessors = &trackb_predecessors[193];
+  track[72].num_predecessors = 3;
   track[73].name = "E10";
   track[73].type = NODE_SENSOR;
   track[73].num = 73;
@@ -2246,6 +3160,8 @@ void init_trackb(track_node *track) {
   track[73].edge[DIR_AHEAD].dist = 282;
   track[73].coord_x = 290;
   track[73].coord_y = 669;
+  track[73].predecessors = &trackb_predecessors[196];
+  track[73].num_predecessors = 4;
   track[74].name = "E11";
   track[74].type = NODE_SENSOR;
   track[74].num = 74;
@@ -2256,6 +3172,8 @@ void init_trackb(track_node *track) {
   track[74].edge[DIR_AHEAD].dist = 282;
   track[74].coord_x = 571;
   track[74].coord_y = 402;
+  track[74].predecessors = &trackb_predecessors[200];
+  track[74].num_predecessors = 9;
   track[75].name = "E12";
   track[75].type = NODE_SENSOR;
   track[75].num = 75;
@@ -2266,6 +3184,8 @@ void init_trackb(track_node *track) {
   track[75].edge[DIR_AHEAD].dist = 43;
   track[75].coord_x = 571;
   track[75].coord_y = 402;
+  track[75].predecessors = &trackb_predecessors[209];
+  track[75].num_predecessors = 3;
   track[76].name = "E13";
   track[76].type = NODE_SENSOR;
   track[76].num = 76;
@@ -2276,6 +3196,8 @@ void init_trackb(track_node *track) {
   track[76].edge[DIR_AHEAD].dist = 43;
   track[76].coord_x = 577;
   track[76].coord_y = 502;
+  track[76].predecessors = &trackb_predecessors[212];
+  track[76].num_predecessors = 3;
   track[77].name = "E14";
   track[77].type = NODE_SENSOR;
   track[77].num = 77;
@@ -2286,6 +3208,8 @@ void init_trackb(track_node *track) {
   track[77].edge[DIR_AHEAD].dist = 282;
   track[77].coord_x = 577;
   track[77].coord_y = 502;
+  track[77].predecessors = &trackb_predecessors[215];
+  track[77].num_predecessors = 4;
   track[78].name = "E15";
   track[78].type = NODE_SENSOR;
   track[78].num = 78;
@@ -2296,6 +3220,8 @@ void init_trackb(track_node *track) {
   track[78].edge[DIR_AHEAD].dist = 246;
   track[78].coord_x = 1494;
   track[78].coord_y = 1490;
+  track[78].predecessors = &trackb_predecessors[219];
+  track[78].num_predecessors = 3;
   track[79].name = "E16";
   track[79].type = NODE_SENSOR;
   track[79].num = 79;
@@ -2306,6 +3232,8 @@ void init_trackb(track_node *track) {
   track[79].edge[DIR_AHEAD].dist = 201;
   track[79].coord_x = 1494;
   track[79].coord_y = 1490;
+  track[79].predecessors = &trackb_predecessors[222];
+  track[79].num_predecessors = 2;
   track[80].name = "BR1";
   track[80].type = NODE_BRANCH;
   track[80].num = 1;
@@ -9,5 +9,8 @@
 #define TRACK_MAX 140
 #endif
 
+// The most sensors a train could have come from to hit any one sensor.
+#define MAX_SENSOR_PREDECESSORS 9
+
 void init_tracka(track_node *track);
 void init_trackb(track_node *track);
@@ -23,6 +23,25 @@ struct track_edge {
 	int dist;             /* in millimetres */
 };
 
+// The bit for a switch in struct switch_state (see switch_packed_num)
+#define SWITCH_BIT(num) (1u << ((num) <= 18 ? (num) : (num) - 145 + 18 + 1))
+
+#define NO_MISSED_SENSOR 0xff
+
+// A sensor that a train could have hit last before hitting another, worked
+// out by parse_track.
+struct sensor_predecessor {
+	unsigned char sensor;
+	// the sensor in between which must have failed to trigger, or
+	// NO_MISSED_SENSOR
+	unsigned char missed_sensor;
+	short distance;       /* in millimetres */
+	// the switches between the two which the train must have gone through
+	// the other way (as branches), and which of those it took curved
+	unsigned switches;
+	unsigned curved;
+};
+
 struct track_node {
 	const char *name;
 	node_type type;
@@ -32,4 +51,7 @@ struct track_node {
 	// so it's only useful for computing relative distance.
 	int coord_x, coord_y;
 	track_edge edge[2];
+	// for sensors, every way a train could have got here
+	const struct sensor_predecessor *predecessors;
+	int num_predecessors;
 };